@@ -45,6 +45,7 @@ public:
 
     String() : val("") {}
     String(const char* s) : val(s ? s : "") {}
+    String(const char* s, unsigned int length) : val(s ? std::string(s, length) : std::string()) {}
     String(const std::string& s) : val(s) {}
     String(char c) : val(1, c) {}
     String(int n) : val(std::to_string(n)) {}
@@ -150,6 +151,10 @@ public:
         val += (str ? str : "");
         return true;
     }
+    bool concat(const char* str, unsigned int length) {
+        if (str) val.append(str, length);
+        return true;
+    }
 
     void replace(const String& find_str, const String& replace_str) {
         if (find_str.isEmpty()) return;
@@ -14,6 +14,7 @@
 #include <dirent.h>
 #include <unistd.h>
 #include <cstring>
+#include <ctime>
 
 #define O_RDONLY 0x01
 #define O_WRONLY 0x02
@@ -212,16 +213,41 @@ public:
         return name.length();
     }
 
+    // Real SdFat allocates contiguous clusters to an empty file and sets
+    // its size; the contents are undefined (zeros here).
+    bool preAllocate(uint64_t length) {
+        if (!stream.is_open() || size() != 0) return false;
+        std::vector<char> zeros(static_cast<size_t>(length), 0);
+        stream.seekp(0);
+        stream.write(zeros.data(), zeros.size());
+        stream.flush();
+        return true;
+    }
+
     bool sync() {
         if (stream.is_open()) {
             stream.flush();
+            syncCounter()++;
         }
         return true;
     }
 
+    // Syncs of any file, counted so save paths can be checked
+    static uint32_t& syncCounter() {
+        static uint32_t count = 0;
+        return count;
+    }
+
+    // Host mtime packed like a FAT directory entry
     bool getModifyDateTime(uint16_t* date, uint16_t* time) {
         if (date) *date = 0;
         if (time) *time = 0;
+        struct stat st;
+        if (stat(mapPath(path).c_str(), &st) != 0) return true;
+        struct tm parts;
+        localtime_r(&st.st_mtime, &parts);
+        if (date) *date = static_cast<uint16_t>(((parts.tm_year - 80) << 9) | ((parts.tm_mon + 1) << 5) | parts.tm_mday);
+        if (time) *time = static_cast<uint16_t>((parts.tm_hour << 11) | (parts.tm_min << 5) | (parts.tm_sec / 2));
         return true;
     }
 
@@ -230,15 +256,59 @@ public:
     }
 };
 
+// Raw sector access. The FAT is synthesised for a FAT32 volume whose first
+// half of clusters is allocated, matching SdFat::freeClusterCount().
+class SdCard {
+public:
+    static const uint32_t kFatStartSector = 32;
+    static const uint32_t kUsedClusters = 500;
+
+    bool readSector(uint32_t sector, uint8_t* dst) {
+        sectorReads++;
+        if (failingReads > 0) {
+            failingReads--;
+            return false;
+        }
+        memset(dst, 0, 512);
+        if (sector < kFatStartSector) return true;
+        const uint32_t first = (sector - kFatStartSector) * 128;
+        for (uint32_t i = 0; i < 128; i++) {
+            const uint32_t cluster = first + i;
+            if (cluster < 2 + kUsedClusters) {
+                const uint32_t value = cluster < 2 ? 0x0FFFFFF8 : 0x0FFFFFFF;
+                memcpy(dst + i * 4, &value, 4);
+            }
+        }
+        return true;
+    }
+    uint32_t getSectorReadCount() const { return sectorReads; }
+    // Make the next count readSector() calls fail, as a flaky card would
+    void failNextReads(uint32_t count) { failingReads = count; }
+
+private:
+    uint32_t sectorReads = 0;
+    uint32_t failingReads = 0;
+};
+
 class SdFat {
 public:
-    bool begin(const SdSpiConfig& config) { return true; }
-    void end() {}
+    // Simulated card init/unmount, counted so session reuse can be checked
+    bool begin(const SdSpiConfig& config) { mountCount++; mounted = true; return true; }
+    void end() { if (mounted) unmountCount++; mounted = false; }
+    bool isMounted() const { return mounted; }
+    uint32_t getMountCount() const { return mountCount; }
+    uint32_t getUnmountCount() const { return unmountCount; }
+    uint32_t getSyncCount() const { return FsFile::syncCounter(); }
     int sdErrorCode() { return 0; }
     int sdErrorData() { return 0; }
     uint32_t clusterCount() { return 1000; }
     uint32_t sectorsPerCluster() { return 8; }
-    uint32_t freeClusterCount() { return 500; }
+    int32_t freeClusterCount() { freeCountCalls++; return 1000 - SdCard::kUsedClusters; }
+    uint32_t getFreeCountCalls() const { return freeCountCalls; }
+    uint8_t fatType() { return 32; }
+    uint32_t fatStartSector() { return SdCard::kFatStartSector; }
+    uint32_t bytesPerCluster() { return sectorsPerCluster() * 512; }
+    SdCard* card() { return &sdCard; }
 
     bool exists(const char* filepath) {
         std::string realPath = mapPath(filepath);
@@ -260,6 +330,19 @@ public:
         std::string realPath = mapPath(dirpath);
         return ::rmdir(realPath.c_str()) == 0;
     }
+
+    bool rename(const char* oldPath, const char* newPath) {
+        std::string realOld = mapPath(oldPath);
+        std::string realNew = mapPath(newPath);
+        return ::rename(realOld.c_str(), realNew.c_str()) == 0;
+    }
+
+private:
+    bool mounted = false;
+    uint32_t mountCount = 0;
+    uint32_t unmountCount = 0;
+    uint32_t freeCountCalls = 0;
+    SdCard sdCard;
 };
 
 extern SdFat sdFat;
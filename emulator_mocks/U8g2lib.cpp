@@ -2,6 +2,7 @@
 // Description: U8g2 graphics implementation including Sinclair 5x7 font and console renderer.
 
 #include "U8g2lib.h"
+#include <cstring>
 #include <iostream>
 
 // Real fonts are now linked from u8g2_fonts.cpp
@@ -112,6 +113,11 @@ U8G2::U8G2() {
     drawColor = 1;
     contrast = 200;
     fontMode = 1; // Default to transparent
+    bitmapMode = 0;
+    bytesSent = 0;
+    transferCount = 0;
+    terminalOutput = true;
+    memset(displayRam, 0, sizeof(displayRam));
 }
 
 // U8g2 font decoder implementation
@@ -368,30 +374,100 @@ int U8G2::getStrWidth(const char* str) {
     u8g2_read_font_info(&font_info, currentFont);
     
     int total_width = 0;
+    int8_t last_d = 0;
+    int last_width = 0;
+    int last_x = 0;
     while (*str) {
         uint16_t encoding = get_next_utf8_char(str);
         const uint8_t *glyph_data = u8g2_font_get_glyph_data(currentFont, encoding, font_info);
         if (glyph_data) {
             u8g2_font_decode_t decode;
             u8g2_font_setup_decode(&decode, glyph_data, font_info, drawColor);
-            u8g2_font_decode_get_signed_bits(&decode, font_info.bits_per_char_x);
+            int8_t x = u8g2_font_decode_get_signed_bits(&decode, font_info.bits_per_char_x);
             u8g2_font_decode_get_signed_bits(&decode, font_info.bits_per_char_y);
-            int8_t d = u8g2_font_decode_get_signed_bits(&decode, font_info.bits_per_delta_x);
-            total_width += d;
+            last_d = u8g2_font_decode_get_signed_bits(&decode, font_info.bits_per_delta_x);
+            last_width = decode.glyph_width;
+            last_x = x;
+            total_width += last_d;
         }
     }
+    // Like u8g2_string_width(): the last glyph counts with its bounding box
+    if (last_width != 0) {
+        total_width += last_width + last_x - last_d;
+    }
     return total_width;
 }
 
+int U8G2::getMaxCharHeight() {
+    if (!currentFont) {
+        currentFont = u8g2_font_5x7_tf; // fallback
+    }
+    return (int8_t)u8g2_font_get_byte(currentFont, 10);
+}
+
+// Pack the 1-byte-per-pixel mock buffer into the ST7920 horizontal layout the
+// real U8G2 full buffer uses: 16 bytes per pixel row, MSB = leftmost pixel.
+uint8_t* U8G2::getBufferPtr() {
+    for (int y = 0; y < 64; ++y) {
+        for (int bx = 0; bx < 16; ++bx) {
+            uint8_t packed = 0;
+            for (int bit = 0; bit < 8; ++bit) {
+                if (buffer[y * 128 + bx * 8 + bit]) {
+                    packed |= (uint8_t)(0x80 >> bit);
+                }
+            }
+            tileBuffer[y * 16 + bx] = packed;
+        }
+    }
+    return tileBuffer;
+}
+
+// Copy tile rows into displayRam the way the real library does. As in
+// u8g2_UpdateDisplayArea(), the source starts at tx*8 + page_size*ty, which
+// assumes the vertical tile layout. As in the ST7920 DRAW_TILE handler, each
+// of the 8 pixel rows then takes tw bytes and advances the source by tw,
+// starting at GDRAM word tx*8/16. Only full-width rows land where they
+// belong in the horizontal ST7920 buffer.
+void U8G2::drawTiles(int tx, int ty, int tw, int th) {
+    const uint8_t* source = getBufferPtr();
+    const int pageSize = getBufferTileWidth() * 8;
+    const uint8_t* ptr = source + tx * 8 + pageSize * ty;
+    const int column = ((tx * 8) >> 4) * 2;
+    for (int row = ty; row < ty + th; row++, ptr += pageSize) {
+        const uint8_t* rowPtr = ptr;
+        for (int i = 0; i < 8; i++, rowPtr += tw) {
+            const int y = row * 8 + i;
+            for (int b = 0; b < tw && column + b < 16 && y < 64; b++) {
+                displayRam[y * 16 + column + b] = rowPtr[b];
+            }
+        }
+    }
+}
+
 void U8G2::sendBuffer() {
-    // Print the frame buffer in-place on the terminal using Unicode half block character pairs
+    drawTiles(0, 0, getBufferTileWidth(), getBufferTileHeight());
+    bytesSent += sizeof(tileBuffer);
+    transferCount++;
+    if (terminalOutput) renderTerminal();
+}
+
+void U8G2::updateDisplayArea(int tx, int ty, int tw, int th) {
+    if (tw <= 0 || th <= 0) return;
+    drawTiles(tx, ty, tw, th);
+    bytesSent += (uint32_t)(tw * th * 8);
+    transferCount++;
+    if (terminalOutput) renderTerminal();
+}
+
+void U8G2::renderTerminal() {
+    // Print the panel GDRAM in-place on the terminal using Unicode half block character pairs
     std::cout << "\033[H"; // Cursor to home position
     std::cout << "+--------------------------------------------------------------------------------------------------------------------------------+\n";
     for (int y = 0; y < 64; y += 2) {
         std::cout << "|";
         for (int x = 0; x < 128; ++x) {
-            int top = buffer[y * 128 + x];
-            int bottom = buffer[(y + 1) * 128 + x];
+            int top = displayRam[y * 16 + x / 8] & (0x80 >> (x % 8));
+            int bottom = displayRam[(y + 1) * 16 + x / 8] & (0x80 >> (x % 8));
             if (top && bottom) {
                 std::cout << "█";
             } else if (top) {
@@ -405,5 +481,6 @@ void U8G2::sendBuffer() {
         std::cout << "|\n";
     }
     std::cout << "+--------------------------------------------------------------------------------------------------------------------------------+\n";
+    std::cout << "LCD tx: " << bytesSent << " bytes in " << transferCount << " transfers\033[K\n";
     std::cout.flush();
 }
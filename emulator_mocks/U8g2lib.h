@@ -23,17 +23,23 @@ extern const uint8_t u8g2_font_6x13_t_cyrillic[];
 class U8G2 {
 public:
     uint8_t buffer[128 * 64];
+    uint8_t tileBuffer[128 * 64 / 8]; // Packed ST7920 layout, refreshed by getBufferPtr()
+    uint8_t displayRam[128 * 64 / 8]; // What the panel's GDRAM holds after the transfers
     const uint8_t* currentFont;
     int drawColor;
     int contrast;
     int fontMode; // 0: solid, 1: transparent
+    int bitmapMode; // 0: solid, 1: transparent
+    uint32_t bytesSent;      // Framebuffer bytes the SW SPI link would have carried
+    uint32_t transferCount;  // sendBuffer()/updateDisplayArea() calls
+    bool terminalOutput;     // Draw the panel on the terminal after each transfer
 
     U8G2();
 
     void begin() {}
     void setContrast(int c) { contrast = c; }
     void setFontMode(int mode) { fontMode = mode; }
-    void setBitmapMode(int mode) {}
+    void setBitmapMode(int mode) { bitmapMode = mode; }
     void enableUTF8Print() {}
     void setFont(const uint8_t* font) { currentFont = font; }
     void setDrawColor(int color) { drawColor = color; }
@@ -43,6 +49,11 @@ public:
     }
 
     void sendBuffer();
+    void updateDisplayArea(int tx, int ty, int tw, int th);
+    uint8_t* getBufferPtr();
+    int getBufferTileWidth() { return 16; }
+    int getBufferTileHeight() { return 8; }
+    uint32_t getBytesSent() const { return bytesSent; }
 
     void drawPixel(int x, int y) {
         if (x >= 0 && x < 128 && y >= 0 && y < 64) {
@@ -94,6 +105,24 @@ public:
         }
     }
 
+    // XBM layout: rows padded to whole bytes, LSB = leftmost pixel.
+    void drawXBM(int x, int y, int w, int h, const uint8_t* bitmap) {
+        const int rowBytes = (w + 7) / 8;
+        const int savedColor = drawColor;
+        for (int row = 0; row < h; ++row) {
+            for (int col = 0; col < w; ++col) {
+                const bool lit = (bitmap[row * rowBytes + (col >> 3)] >> (col & 7)) & 1;
+                if (lit) {
+                    drawPixel(x + col, y + row);
+                } else if (bitmapMode == 0) {
+                    drawColor = savedColor == 0 ? 1 : 0;
+                    drawPixel(x + col, y + row);
+                    drawColor = savedColor;
+                }
+            }
+        }
+    }
+
     void drawCircle(int x, int y, int r) {}
     void drawDisc(int x, int y, int r) {}
     int getDisplayWidth() { return 128; }
@@ -103,6 +132,11 @@ public:
     void drawUTF8(int x, int y, const char* str) { drawStr(x, y, str); }
     int getStrWidth(const char* str);
     int getUTF8Width(const char* str) { return getStrWidth(str); }
+    int getMaxCharHeight();
+
+private:
+    void drawTiles(int tx, int ty, int tw, int th);
+    void renderTerminal();
 };
 
 class U8G2_ST7920_128X64_F_SW_SPI : public U8G2 {
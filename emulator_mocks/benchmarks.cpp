@@ -0,0 +1,611 @@
+// PROJECT: ESP32-Handheld
+// MODULE: emulator_mocks/benchmarks.cpp
+// STATUS: [Level 2 - Implementation]
+// TRUTH_LINK: TRUTH_PROJECT.md § Validation Boundary
+// LOG_REF: 2026-10-16
+
+#include "benchmarks.h"
+#include "Arduino.h"
+#include "../src/lua_vm.h"
+#include "../src/gui.h"
+#include "../src/hal.h"
+#include "../src/text_wrap.h"
+#include "../src/stream_search.h"
+#include "../src/t9_dict.h"
+#include "../src/t9_predict.h"
+#include <cstring>
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+namespace {
+
+typedef std::chrono::steady_clock BenchClock;
+
+static double elapsedMs(BenchClock::time_point start) {
+    return std::chrono::duration<double, std::milli>(BenchClock::now() - start).count();
+}
+
+static bool loadLuaBenchmark(const char* params, const char* script, const char* name) {
+    if (!LuaVM::init()) {
+        std::printf("[bench] LuaVM init failed: %s\n", LuaVM::getLastError());
+        return false;
+    }
+    if (!LuaVM::executeString(params, "bench_params") || !LuaVM::executeString(script, name)) {
+        std::printf("[bench] script failed: %s\n", LuaVM::getLastError());
+        LuaVM::shutdown();
+        return false;
+    }
+    return true;
+}
+
+static bool timeLuaFunction(const char* name, double& ms) {
+    BenchClock::time_point start = BenchClock::now();
+    if (!LuaVM::callGlobalFunction(name)) {
+        std::printf("[bench] %s failed: %s\n", name, LuaVM::getLastError());
+        return false;
+    }
+    ms = elapsedMs(start);
+    return true;
+}
+
+// --------------------------------------------------------------------------
+// gfx3d: native fixed-point pipeline vs the old per-vertex Lua path
+// --------------------------------------------------------------------------
+
+static const int kGfx3dBenchFrames = 500;
+static const int kGfx3dBenchMeshes = 3;
+
+// Same sphere, same transforms. The Lua variant is the float pipeline that
+// render3d.lua used before gfx3d existed (rotate, project, cull, gfx.line).
+static const char kGfx3dBenchScript[] = R"LUA(
+local FRAMES, MESHES = BENCH_FRAMES, BENCH_MESHES
+
+local verts, faces = {}, {}
+local LAT, LON, R = 6, 10, 0.6
+for lat = 0, LAT do
+    local t = lat * math.pi / LAT
+    for lon = 0, LON - 1 do
+        local p = lon * 2 * math.pi / LON
+        verts[#verts + 1] = {R * math.sin(t) * math.cos(p), R * math.cos(t), R * math.sin(t) * math.sin(p)}
+    end
+end
+for lat = 0, LAT - 1 do
+    for lon = 0, LON - 1 do
+        local n = (lon + 1) % LON
+        local p1, p2 = lat * LON + lon + 1, lat * LON + n + 1
+        local p3, p4 = (lat + 1) * LON + lon + 1, (lat + 1) * LON + n + 1
+        faces[#faces + 1] = {p1, p2, p3}
+        faces[#faces + 1] = {p2, p4, p3}
+    end
+end
+local mesh = gfx3d.mesh(verts, faces)
+
+local function draw_lua(px, py, pz, ax, ay, az)
+    local sx, cx = math.sin(ax), math.cos(ax)
+    local sy, cy = math.sin(ay), math.cos(ay)
+    local sz, cz = math.sin(az), math.cos(az)
+    local world, screen = {}, {}
+    for i, v in ipairs(verts) do
+        local x, y, z = v[1] * cy + v[3] * sy, v[2], -v[1] * sy + v[3] * cy
+        y, z = y * cx - z * sx, y * sx + z * cx
+        x, y = x * cz - y * sz, x * sz + y * cz
+        x, y, z = x + px, y + py, z + pz
+        world[i] = {x = x, y = y, z = z}
+        local d = z < 0.1 and 0.1 or z
+        screen[i] = {x = math.floor(64 + x * 90 / d), y = math.floor(32 - y * 90 / d)}
+    end
+    for _, f in ipairs(faces) do
+        local p1, p2, p3 = world[f[1]], world[f[2]], world[f[3]]
+        local ax_, ay_, az_ = p2.x - p1.x, p2.y - p1.y, p2.z - p1.z
+        local bx, by, bz = p3.x - p1.x, p3.y - p1.y, p3.z - p1.z
+        local nx, ny, nz = ay_ * bz - az_ * by, az_ * bx - ax_ * bz, ax_ * by - ay_ * bx
+        if nx * p1.x + ny * p1.y + nz * p1.z < 0 then
+            for i = 1, 3 do
+                local a, b = screen[f[i]], screen[f[i % 3 + 1]]
+                gfx.line(a.x, a.y, b.x, b.y)
+            end
+        end
+    end
+end
+
+function bench_lua()
+    for frame = 1, FRAMES do
+        gfx.clear()
+        for m = 1, MESHES do
+            draw_lua((m - 2) * 1.6, 0, 4.5, frame * 0.02, frame * 0.03 + m, 0)
+        end
+    end
+end
+
+function bench_native()
+    gfx3d.setView(64, 32, 90, true, true)
+    for frame = 1, FRAMES do
+        gfx.clear()
+        for m = 1, MESHES do
+            mesh:draw((m - 2) * 1.6, 0, 4.5, frame * 0.02, frame * 0.03 + m, 0)
+        end
+    end
+end
+
+function bench_native_fill()
+    gfx3d.setView(64, 32, 90, true, true)
+    local mode = gfx3d.FILL + gfx3d.WIREFRAME
+    for frame = 1, FRAMES do
+        gfx.clear()
+        for m = 1, MESHES do
+            mesh:draw((m - 2) * 1.6, 0, 4.5, frame * 0.02, frame * 0.03 + m, 0, mode)
+        end
+    end
+end
+)LUA";
+
+static int runGfx3dBenchmark() {
+    char params[64];
+    std::snprintf(params, sizeof(params), "BENCH_FRAMES, BENCH_MESHES = %d, %d",
+                  kGfx3dBenchFrames, kGfx3dBenchMeshes);
+    if (!loadLuaBenchmark(params, kGfx3dBenchScript, "bench_gfx3d")) {
+        return 1;
+    }
+
+    double luaMs = 0.0;
+    double nativeMs = 0.0;
+    double fillMs = 0.0;
+    if (!timeLuaFunction("bench_lua", luaMs) ||
+        !timeLuaFunction("bench_native", nativeMs) ||
+        !timeLuaFunction("bench_native_fill", fillMs)) {
+        LuaVM::shutdown();
+        return 1;
+    }
+
+    const double meshes = static_cast<double>(kGfx3dBenchFrames) * kGfx3dBenchMeshes;
+    std::printf("gfx3d: %d frames x %d spheres (70 vertices, 120 faces)\n", kGfx3dBenchFrames, kGfx3dBenchMeshes);
+    std::printf("  lua float:  %9.2f ms  %10.0f meshes/s\n", luaMs, meshes / (luaMs / 1000.0));
+    std::printf("  native:     %9.2f ms  %10.0f meshes/s\n", nativeMs, meshes / (nativeMs / 1000.0));
+    std::printf("  native+fill:%9.2f ms  %10.0f meshes/s\n", fillMs, meshes / (fillMs / 1000.0));
+    std::printf("  speedup:    %9.2fx\n", nativeMs > 0.0 ? luaMs / nativeMs : 0.0);
+    LuaVM::shutdown();
+    return 0;
+}
+
+// --------------------------------------------------------------------------
+// text: glyph cache vs u8g2 font decoding
+// --------------------------------------------------------------------------
+
+static const int kTextBenchIterations = 20000;
+
+static int runTextBenchmark() {
+    static const char* const kLines[] = {
+        "The quick brown fox jumps",
+        "over the lazy dog 0123456",
+        "[Files] /apps/render3d.lua",
+        "1:Proj 2:Cull 3:Auto 4:New",
+    };
+    static const char* const kFontNames[GUI::FONT_SIZE_COUNT] = {"tiny", "small", "medium"};
+    const int lineCount = sizeof(kLines) / sizeof(kLines[0]);
+
+    for (int size = 0; size < GUI::FONT_SIZE_COUNT; size++) {
+        GUI::setFontBySize(size);
+        double timings[4];
+        volatile int sink = 0;
+
+        BenchClock::time_point start = BenchClock::now();
+        for (int i = 0; i < kTextBenchIterations; i++) {
+            u8g2.drawUTF8(0, 10 + (i % 6) * 9, kLines[i % lineCount]);
+        }
+        timings[0] = elapsedMs(start);
+
+        start = BenchClock::now();
+        for (int i = 0; i < kTextBenchIterations; i++) {
+            GUI::drawText(0, 10 + (i % 6) * 9, kLines[i % lineCount]);
+        }
+        timings[1] = elapsedMs(start);
+
+        start = BenchClock::now();
+        for (int i = 0; i < kTextBenchIterations; i++) {
+            sink += u8g2.getUTF8Width(kLines[i % lineCount]);
+        }
+        timings[2] = elapsedMs(start);
+
+        start = BenchClock::now();
+        for (int i = 0; i < kTextBenchIterations; i++) {
+            sink += GUI::getTextWidth(kLines[i % lineCount]);
+        }
+        timings[3] = elapsedMs(start);
+
+        std::printf("text [%s]: %d strings\n", kFontNames[size], kTextBenchIterations);
+        std::printf("  draw   u8g2: %8.2f ms  cached: %8.2f ms  (%.1fx)\n",
+                    timings[0], timings[1], timings[1] > 0.0 ? timings[0] / timings[1] : 0.0);
+        std::printf("  width  u8g2: %8.2f ms  cached: %8.2f ms  (%.1fx)\n",
+                    timings[2], timings[3], timings[3] > 0.0 ? timings[2] / timings[3] : 0.0);
+    }
+    return 0;
+}
+
+// --------------------------------------------------------------------------
+// layout: single-pass word wrap vs re-measuring every prefix
+// --------------------------------------------------------------------------
+
+static const int kLayoutBenchDocBytes = 16 * 1024;
+static const int kLayoutBenchPasses = 20;
+static const int kLayoutBenchWidth = GUI::SCREEN_WIDTH - 14;   // Editor with gutter
+
+// The T9 editor's wrap before TextWrap: grow a substring one byte at a time
+// and measure the whole prefix again after each byte.
+static int legacyFitLength(const String& segment, int segStart, int segmentLen, int textAreaWidth) {
+    int fitLen = 0;
+    int lastBoundaryLen = -1;
+
+    while (segStart + fitLen < segmentLen) {
+        String sub = segment.substring(segStart, segStart + fitLen + 1);
+        if (GUI::getTextWidth(sub.c_str()) > textAreaWidth) break;
+        fitLen++;
+
+        if (TextWrap::isBreakChar(segment[segStart + fitLen - 1])) {
+            lastBoundaryLen = fitLen;
+        }
+    }
+
+    if (fitLen == 0 && segStart < segmentLen) return 1;
+    if (segStart + fitLen < segmentLen && lastBoundaryLen > 0) return lastBoundaryLen;
+    return fitLen;
+}
+
+// Prose-like text: words of 1-11 letters, some punctuation, a paragraph
+// break roughly every 60 words.
+static String buildLayoutBenchDocument() {
+    String doc;
+    doc.reserve(kLayoutBenchDocBytes);
+    uint32_t seed = 12345;
+    int wordsInParagraph = 0;
+    while (static_cast<int>(doc.length()) < kLayoutBenchDocBytes) {
+        seed = seed * 1103515245u + 12345u;
+        const int wordLen = 1 + static_cast<int>((seed >> 16) % 11);
+        for (int i = 0; i < wordLen; i++) {
+            seed = seed * 1103515245u + 12345u;
+            doc += static_cast<char>('a' + (seed >> 16) % 26);
+        }
+        const uint32_t tail = (seed >> 8) % 16;
+        if (tail == 0) doc += ',';
+        else if (tail == 1) doc += '.';
+        if (++wordsInParagraph >= 40 + static_cast<int>((seed >> 4) % 40)) {
+            doc += '\n';
+            wordsInParagraph = 0;
+        } else {
+            doc += ' ';
+        }
+    }
+    return doc.substring(0, kLayoutBenchDocBytes);
+}
+
+// Visual line start offsets for the whole document, as recalculateLayout()
+// splits it: per '\n' segment, then wrapped.
+static void layoutDocument(const String& doc, const uint8_t* font, bool legacy, std::vector<int>& starts) {
+    starts.clear();
+    const char* text = doc.c_str();
+    const int length = doc.length();
+    int start = 0;
+    while (start <= length) {
+        int end = doc.indexOf('\n', start);
+        if (end == -1) end = length;
+        const int segmentLen = end - start;
+        if (segmentLen == 0) {
+            starts.push_back(start);
+        } else if (legacy) {
+            String segment = doc.substring(start, end);
+            for (int segStart = 0; segStart < segmentLen;) {
+                starts.push_back(start + segStart);
+                segStart += legacyFitLength(segment, segStart, segmentLen, kLayoutBenchWidth);
+            }
+        } else {
+            for (int segStart = 0; segStart < segmentLen;) {
+                starts.push_back(start + segStart);
+                segStart += TextWrap::fitLength(font, text + start + segStart,
+                                                segmentLen - segStart, kLayoutBenchWidth);
+            }
+        }
+        start = end + 1;
+    }
+}
+
+static int runLayoutBenchmark() {
+    static const char* const kFontNames[GUI::FONT_SIZE_COUNT] = {"tiny", "small", "medium"};
+    const String doc = buildLayoutBenchDocument();
+    int status = 0;
+
+    for (int size = 0; size < GUI::FONT_SIZE_COUNT; size++) {
+        GUI::setFontBySize(size);
+        const uint8_t* font = GUI::getFontMetrics(size).font;
+        std::vector<int> legacyStarts;
+        std::vector<int> wrapStarts;
+
+        BenchClock::time_point start = BenchClock::now();
+        for (int pass = 0; pass < kLayoutBenchPasses; pass++) {
+            layoutDocument(doc, font, true, legacyStarts);
+        }
+        const double legacyMs = elapsedMs(start) / kLayoutBenchPasses;
+
+        start = BenchClock::now();
+        for (int pass = 0; pass < kLayoutBenchPasses; pass++) {
+            layoutDocument(doc, font, false, wrapStarts);
+        }
+        const double wrapMs = elapsedMs(start) / kLayoutBenchPasses;
+
+        const bool match = (legacyStarts == wrapStarts);
+        if (!match) status = 1;
+        std::printf("layout [%s]: %u bytes, %u visual lines, breaks %s\n", kFontNames[size],
+                    static_cast<unsigned>(doc.length()), static_cast<unsigned>(wrapStarts.size()),
+                    match ? "identical" : "DIFFER");
+        std::printf("  per layout  prefix: %8.3f ms  single-pass: %8.3f ms  (%.1fx)\n",
+                    legacyMs, wrapMs, wrapMs > 0.0 ? legacyMs / wrapMs : 0.0);
+    }
+    return status;
+}
+
+// --------------------------------------------------------------------------
+// search: chunked Boyer-Moore-Horspool vs a byte-by-byte scan
+// --------------------------------------------------------------------------
+
+static const size_t kSearchBenchBytes = 4 * 1024 * 1024;
+static const size_t kSearchBenchChunk = 4096;      // As the editor uses
+static const size_t kSearchBenchBudget = 32 * 1024;
+
+static int readSearchBenchBuffer(void* context, size_t offset, char* out, size_t length) {
+    const std::vector<char>* source = static_cast<const std::vector<char>*>(context);
+    if (offset >= source->size()) return 0;
+    length = std::min(length, source->size() - offset);
+    std::memcpy(out, source->data() + offset, length);
+    return static_cast<int>(length);
+}
+
+static inline char foldSearchBenchCase(char c) {
+    return (c >= 'A' && c <= 'Z') ? static_cast<char>(c + ('a' - 'A')) : c;
+}
+
+// The straightforward case-insensitive scan: compare at every position.
+static size_t naiveFind(const std::vector<char>& source, const char* pattern, size_t patternLength) {
+    for (size_t pos = 0; pos + patternLength <= source.size(); pos++) {
+        size_t i = 0;
+        while (i < patternLength && foldSearchBenchCase(source[pos + i]) == pattern[i]) i++;
+        if (i == patternLength) return pos;
+    }
+    return source.size();
+}
+
+static size_t streamFind(StreamSearch& search, std::vector<char>& source, const char* pattern, int& steps) {
+    steps = 0;
+    if (!search.start(pattern, source.size(), 0)) return source.size();
+    while (true) {
+        steps++;
+        const StreamSearch::Status status = search.step(readSearchBenchBuffer, &source, kSearchBenchBudget);
+        if (status == StreamSearch::FOUND) {
+            const size_t offset = search.getMatchOffset();
+            search.cancel();
+            return offset;
+        }
+        if (status != StreamSearch::SEARCHING) return source.size();
+    }
+}
+
+static int runSearchBenchmark() {
+    // Log-like text with the needle only in the last line, so both scans
+    // cover the whole buffer.
+    static const char* const kPatterns[] = {"panic", "watchdog reset", "sd card mount failed at boot"};
+    std::vector<char> source;
+    source.reserve(kSearchBenchBytes);
+    uint32_t seed = 12345;
+    while (source.size() < kSearchBenchBytes - 64) {
+        seed = seed * 1103515245u + 12345u;
+        const char* word = (seed >> 16) % 5 == 0 ? "INFO " : "";
+        source.insert(source.end(), word, word + std::strlen(word));
+        const int wordLen = 1 + static_cast<int>((seed >> 8) % 9);
+        for (int i = 0; i < wordLen; i++) {
+            seed = seed * 1103515245u + 12345u;
+            source.push_back(static_cast<char>('a' + (seed >> 16) % 26));
+        }
+        source.push_back((seed >> 4) % 12 == 0 ? '\n' : ' ');
+    }
+    int status = 0;
+    StreamSearch search(kSearchBenchChunk);
+    const double megabytes = static_cast<double>(kSearchBenchBytes) / (1024.0 * 1024.0);
+
+    for (const char* pattern : kPatterns) {
+        std::vector<char> text = source;
+        const size_t patternLength = std::strlen(pattern);
+        const std::string tail = std::string("\nERR ") + pattern;
+        text.insert(text.end(), tail.begin(), tail.end());
+        const size_t expected = text.size() - patternLength;
+
+        BenchClock::time_point start = BenchClock::now();
+        const size_t naiveOffset = naiveFind(text, pattern, patternLength);
+        const double naiveMs = elapsedMs(start);
+
+        int steps = 0;
+        start = BenchClock::now();
+        const size_t streamOffset = streamFind(search, text, pattern, steps);
+        const double streamMs = elapsedMs(start);
+
+        const bool match = naiveOffset == expected && streamOffset == expected;
+        if (!match) status = 1;
+        std::printf("search [%u bytes]: %.1f MB, hit %s, %d steps of %u KB\n",
+                    static_cast<unsigned>(patternLength), megabytes, match ? "identical" : "DIFFERS", steps,
+                    static_cast<unsigned>(kSearchBenchBudget / 1024));
+        std::printf("  naive: %8.1f MB/s  BMH: %8.1f MB/s  (%.1fx)\n",
+                    naiveMs > 0.0 ? megabytes * 1000.0 / naiveMs : 0.0,
+                    streamMs > 0.0 ? megabytes * 1000.0 / streamMs : 0.0,
+                    streamMs > 0.0 ? naiveMs / streamMs : 0.0);
+    }
+    return status;
+}
+
+// --------------------------------------------------------------------------
+// t9: dictionary index size and lookup time while typing
+// --------------------------------------------------------------------------
+
+static const int kT9BenchRounds = 2;
+static const int kT9BenchBarRepeats = 16;   // Redraws per input state
+
+static char t9DigitFor(char letter) {
+    static const char kDigits[] = "22233344455566677778889999";
+    return (letter >= 'a' && letter <= 'z') ? kDigits[letter - 'a'] : '\0';
+}
+
+// Type every dictionary word key by key. Each key press runs the exact
+// lookup and the prefix scan; the per-length query is what the editor's
+// inline suggestion asks for after each press.
+static int runT9Benchmark() {
+    std::vector<std::string> sequences;
+    std::string word;
+    for (uint32_t i = 0; i < T9_WORD_POOL_SIZE; i++) {
+        const char c = t9_word_pool[i];
+        if (c != '\0') {
+            word += t9DigitFor(c);
+            continue;
+        }
+        sequences.push_back(word);
+        word.clear();
+    }
+
+    T9Predict predict;
+    uint64_t checksum = 0;
+    uint32_t presses = 0;
+    BenchClock::time_point start = BenchClock::now();
+    for (int round = 0; round < kT9BenchRounds; round++) {
+        for (const std::string& sequence : sequences) {
+            predict.reset();
+            for (char digit : sequence) {
+                predict.pushDigit(digit);
+                presses++;
+                checksum += static_cast<uint64_t>(predict.getCandidateCount()) * 131u +
+                            static_cast<uint64_t>(predict.getPrefixCandidateCount()) * 7u +
+                            static_cast<uint64_t>(predict.getPrefixCandidateCountForLength(predict.getDigitCount()));
+                const char* selected = predict.getSelectedPrefixWord();
+                if (selected != nullptr) checksum += static_cast<uint8_t>(selected[0]);
+            }
+        }
+    }
+    const double ms = elapsedMs(start);
+
+    // A candidate bar reads every exact and prefix candidate of the input.
+    uint32_t barWords = 0;
+    size_t barBytes = 0;
+    start = BenchClock::now();
+    for (int round = 0; round < kT9BenchRounds; round++) {
+        for (const std::string& sequence : sequences) {
+            predict.reset();
+            for (size_t i = 0; i < sequence.size() && i < 3; i++) predict.pushDigit(sequence[i]);
+            for (int repeat = 0; repeat < kT9BenchBarRepeats; repeat++) {
+                for (int i = 0; i < predict.getCandidateCount(); i++) {
+                    barBytes += static_cast<size_t>(predict.getCandidateView(i).length);
+                    barWords++;
+                }
+                for (int i = 0; i < predict.getPrefixCandidateCount(); i++) {
+                    barBytes += static_cast<size_t>(predict.getPrefixCandidateView(i).length);
+                    barWords++;
+                }
+            }
+        }
+    }
+    const double barMs = elapsedMs(start);
+
+    // Cycling through the suggestions of the typed length, as the editor
+    // does on each arrow key.
+    const int kCycleSteps = 8;
+    uint32_t cycleSteps = 0;
+    uint64_t cycleChecksum = 0;
+    double cycleMs = 0.0;
+    for (int round = 0; round < kT9BenchRounds; round++) {
+        for (const std::string& sequence : sequences) {
+            predict.reset();
+            for (char digit : sequence) predict.pushDigit(digit);
+            const int length = predict.getDigitCount();
+            start = BenchClock::now();
+            for (int step = 0; step < kCycleSteps; step++) {
+                predict.nextPrefixCandidateForLength(length);
+                cycleChecksum += static_cast<uint64_t>(predict.getSelectedPrefixIndex()) +
+                                 static_cast<uint64_t>(predict.getPrefixCandidateCountForLength(length));
+            }
+            cycleMs += elapsedMs(start);
+            cycleSteps += kCycleSteps;
+        }
+    }
+
+    // Among the 1000 most common words, how often the first prefix
+    // suggestion spells the letters typed so far (what the editor previews)
+    // after each of the first three keys, and whether the full sequence
+    // lists the word at all.
+    uint32_t earlyPresses = 0;
+    uint32_t earlyRight = 0;
+    uint32_t commonWords = 0;
+    uint32_t listed = 0;
+    for (uint32_t w = 0; w < T9_WORD_COUNT; w++) {
+        if (t9_word_ranks[w] >= 1000) continue;
+        const char* typed = &t9_word_pool[t9_word_starts[w]];
+        const std::string& sequence = sequences[w];
+        commonWords++;
+        predict.reset();
+        for (size_t i = 0; i < sequence.size(); i++) {
+            predict.pushDigit(sequence[i]);
+            if (i < 3) {
+                earlyPresses++;
+                const char* first = predict.getPrefixCandidate(0);
+                if (first != nullptr && std::strncmp(first, typed, i + 1) == 0) earlyRight++;
+            }
+        }
+        for (int i = 0; i < predict.getPrefixCandidateCount(); i++) {
+            if (std::strcmp(predict.getPrefixCandidate(i), typed) == 0) {
+                listed++;
+                break;
+            }
+        }
+    }
+
+    std::printf("t9: %u sequences, %u words, index %u bytes (%u per entry), word pool %u bytes\n",
+                static_cast<unsigned>(T9_INDEX_COUNT), static_cast<unsigned>(sequences.size()),
+                static_cast<unsigned>(sizeof(t9_index)), static_cast<unsigned>(sizeof(T9IndexEntry)),
+                static_cast<unsigned>(T9_WORD_POOL_SIZE));
+    std::printf("  %u key presses: %.1f ms, %.0f ns/press, checksum %llu\n", static_cast<unsigned>(presses), ms,
+                presses > 0 ? ms * 1000000.0 / presses : 0.0, static_cast<unsigned long long>(checksum));
+    std::printf("  %u candidate bar words: %.1f ms, %.0f ns/word, %u bytes\n", static_cast<unsigned>(barWords), barMs,
+                barWords > 0 ? barMs * 1000000.0 / barWords : 0.0, static_cast<unsigned>(barBytes));
+    std::printf("  %u same-length cycle steps: %.1f ms, %.0f ns/step, checksum %llu\n",
+                static_cast<unsigned>(cycleSteps), cycleMs, cycleSteps > 0 ? cycleMs * 1000000.0 / cycleSteps : 0.0,
+                static_cast<unsigned long long>(cycleChecksum));
+    std::printf("  1000 most common words: preview right on %u of %u early presses, listed at the end for %u of %u\n",
+                static_cast<unsigned>(earlyRight), static_cast<unsigned>(earlyPresses), static_cast<unsigned>(listed),
+                static_cast<unsigned>(commonWords));
+    return 0;
+}
+
+struct EmulatorBenchmark {
+    const char* name;
+    const char* description;
+    int (*run)();
+};
+
+static const EmulatorBenchmark kBenchmarks[] = {
+    {"gfx3d", "gfx3d mesh:draw vs the old float Lua 3D pipeline", runGfx3dBenchmark},
+    {"text", "glyph-cache text draw/measure vs u8g2 font decoding", runTextBenchmark},
+    {"layout", "T9 editor word wrap of a 16 KB document, single-pass vs prefix", runLayoutBenchmark},
+    {"search", "T9 editor find over 4 MB, chunked BMH vs byte-by-byte scan", runSearchBenchmark},
+    {"t9", "T9 dictionary index size and lookup time typing every word", runT9Benchmark},
+};
+
+} // namespace
+
+void listEmulatorBenchmarks() {
+    for (const EmulatorBenchmark& bench : kBenchmarks) {
+        std::printf("  %-10s %s\n", bench.name, bench.description);
+    }
+}
+
+int runEmulatorBenchmark(const std::string& name) {
+    for (const EmulatorBenchmark& bench : kBenchmarks) {
+        if (name == bench.name) {
+            return bench.run();
+        }
+    }
+    std::printf("Unknown benchmark '%s'. Available:\n", name.c_str());
+    listEmulatorBenchmarks();
+    return 2;
+}
@@ -0,0 +1,20 @@
+// PROJECT: ESP32-Handheld
+// MODULE: emulator_mocks/benchmarks.h
+// STATUS: [Level 2 - Implementation]
+// TRUTH_LINK: TRUTH_PROJECT.md § Validation Boundary
+// LOG_REF: 2026-10-16
+
+#ifndef EMULATOR_BENCHMARKS_H
+#define EMULATOR_BENCHMARKS_H
+
+#include <string>
+
+// Host-side microbenchmarks, selected with `--bench <name>`.
+// Each benchmark runs headless (no terminal rendering, no key thread),
+// prints its results to stdout and returns a process exit code.
+int runEmulatorBenchmark(const std::string& name);
+
+// Print the names of all registered benchmarks.
+void listEmulatorBenchmarks();
+
+#endif // EMULATOR_BENCHMARKS_H
@@ -14,6 +14,8 @@
 #include <thread>
 #include <atomic>
 #include "../src/config.h"
+#include "benchmarks.h"
+#include "self_tests.h"
 
 extern void setup();
 extern void loop();
@@ -109,9 +111,27 @@ void input_thread() {
 
 int main(int argc, char* argv[]) {
     // Parse arguments
+    std::string benchmarkName;
+    std::string selfTestName;
     for (int i = 1; i < argc; i++) {
         std::string arg = argv[i];
-        if (arg == "--clock" && i + 1 < argc) {
+        if (arg == "--bench") {
+            if (i + 1 < argc) {
+                benchmarkName = argv[++i];
+            } else {
+                std::cout << "Usage: --bench <name>\n";
+                listEmulatorBenchmarks();
+                return 2;
+            }
+        } else if (arg == "--test") {
+            if (i + 1 < argc) {
+                selfTestName = argv[++i];
+            } else {
+                std::cout << "Usage: --test <name|all>\n";
+                listEmulatorSelfTests();
+                return 2;
+            }
+        } else if (arg == "--clock" && i + 1 < argc) {
             try {
                 emulator_frame_overhead_ms = std::stoi(argv[i + 1]);
                 i++;
@@ -121,6 +141,14 @@ int main(int argc, char* argv[]) {
         }
     }
 
+    // Headless benchmark/test modes: no terminal takeover, no firmware loop
+    if (!benchmarkName.empty()) {
+        return runEmulatorBenchmark(benchmarkName);
+    }
+    if (!selfTestName.empty()) {
+        return runEmulatorSelfTest(selfTestName);
+    }
+
     // Make sure stdout is clean
     std::cout << "\033[2J\033[H"; // Clear screen
     std::cout << "Starting ESP32 Handheld Desktop Emulator (Clock Overhead: " << emulator_frame_overhead_ms << "ms)...\n";
@@ -0,0 +1,1530 @@
+// PROJECT: ESP32-Handheld
+// MODULE: emulator_mocks/self_tests.cpp
+// STATUS: [Level 2 - Implementation]
+// TRUTH_LINK: TRUTH_PROJECT.md § Validation Boundary
+// LOG_REF: 2026-10-16
+
+#include "self_tests.h"
+#include "Arduino.h"
+#include "../src/apps/t9_editor.h"
+#include "../src/clipboard_ring.h"
+#include "../src/display.h"
+#include "../src/hal.h"
+#include "../src/history_index.h"
+#include "../src/history_journal.h"
+#include "../src/paged_reader.h"
+#include "../src/sd_io_queue.h"
+#include "../src/span_document.h"
+#include "../src/stream_search.h"
+#include "../src/text_buffer.h"
+#include "../src/undo_log.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+static int gChecks = 0;
+static int gFailures = 0;
+
+#define SELF_CHECK(cond) checkResult((cond), #cond, __FILE__, __LINE__)
+
+static void checkResult(bool ok, const char* expr, const char* file, int line) {
+    gChecks++;
+    if (!ok) {
+        gFailures++;
+        std::printf("  FAIL %s:%d: %s\n", file, line, expr);
+    }
+}
+
+// --------------------------------------------------------------------------
+// text_buffer: gap buffer document model
+// --------------------------------------------------------------------------
+
+static bool sameText(const TextBuffer& buffer, const std::string& expected) {
+    return buffer.equals(expected.c_str(), expected.size()) &&
+           std::string(buffer.toString().c_str(), buffer.length()) == expected;
+}
+
+static void testTextBufferBasics() {
+    TextBuffer buffer;
+    SELF_CHECK(buffer.isEmpty());
+    SELF_CHECK(buffer.toString() == "");
+    SELF_CHECK(buffer.indexOf('a') == -1);
+
+    SELF_CHECK(buffer.assign("hello world"));
+    SELF_CHECK(sameText(buffer, "hello world"));
+    SELF_CHECK(buffer.insert(5, ","));
+    SELF_CHECK(sameText(buffer, "hello, world"));
+    buffer.erase(0, 7);
+    SELF_CHECK(sameText(buffer, "world"));
+    SELF_CHECK(buffer.replace(1, 3, "ORL", 3));
+    SELF_CHECK(sameText(buffer, "wORLd"));
+
+    // Out-of-range positions clamp to the text
+    SELF_CHECK(buffer.insert(100, "!", 1));
+    SELF_CHECK(sameText(buffer, "wORLd!"));
+    buffer.erase(4, 100);
+    SELF_CHECK(sameText(buffer, "wORL"));
+
+    buffer.clear();
+    SELF_CHECK(buffer.isEmpty());
+    SELF_CHECK(buffer.getMemoryUsage() > 0);
+}
+
+static void testTextBufferRanges() {
+    TextBuffer buffer;
+    buffer.assign("line one\nline two\nline three");
+    buffer.insert(9, "X", 1);   // Leaves the gap inside the text
+
+    SELF_CHECK(buffer.substring(0, 4) == "line");
+    SELF_CHECK(buffer.substring(8, 12) == "\nXli");
+    SELF_CHECK(buffer.substring(5, 5) == "");
+    SELF_CHECK(buffer.indexOf('\n') == 8);
+    SELF_CHECK(buffer.indexOf('\n', 9) == 18);
+    SELF_CHECK(buffer.indexOf('q') == -1);
+    SELF_CHECK(buffer.lastIndexOf('\n', 18) == 8);
+    SELF_CHECK(buffer.count('\n') == 2);
+    SELF_CHECK(buffer.count('e') == 6);
+
+    // rangePtr only answers for ranges on one side of the gap
+    SELF_CHECK(buffer.rangePtr(0, 10) != nullptr);
+    SELF_CHECK(buffer.rangePtr(10, 5) != nullptr);
+    SELF_CHECK(buffer.rangePtr(8, 4) == nullptr);
+    SELF_CHECK(std::string(buffer.rangePtr(10, 4), 4) == "line");
+
+    char out[8] = {0};
+    SELF_CHECK(buffer.copyRange(7, 5, out) == 5);
+    SELF_CHECK(std::string(out, 5) == "e\nXli");
+    SELF_CHECK(buffer.copyRange(26, 10, out) == 3);
+
+    std::string walked;
+    for (TextBuffer::Iterator it = buffer.iteratorAt(19); it != buffer.end(); ++it) {
+        walked += *it;
+    }
+    SELF_CHECK(walked == "line three");
+
+    TextBuffer other;
+    other.assign("line one\nXline two!");
+    SELF_CHECK(buffer.commonPrefixLength(other) == 18);
+    other.assign("the second line three");
+    SELF_CHECK(buffer.commonSuffixLength(other, 100) == 10);
+    SELF_CHECK(buffer.commonSuffixLength(other, 4) == 4);
+}
+
+static void testTextBufferUtf8() {
+    TextBuffer buffer;
+    buffer.assign("a\xC3\xA9z\xE2\x82\xAC");   // a, e-acute, z, euro sign
+    SELF_CHECK(buffer.isUtf8Boundary(0));
+    SELF_CHECK(buffer.isUtf8Boundary(1));
+    SELF_CHECK(!buffer.isUtf8Boundary(2));
+    SELF_CHECK(buffer.isUtf8Boundary(3));
+    SELF_CHECK(!buffer.isUtf8Boundary(6));
+    SELF_CHECK(buffer.isUtf8Boundary(7));
+    SELF_CHECK(buffer.nextUtf8Boundary(1) == 3);
+    SELF_CHECK(buffer.nextUtf8Boundary(4) == 7);
+    SELF_CHECK(buffer.nextUtf8Boundary(7) == 7);
+    SELF_CHECK(buffer.prevUtf8Boundary(3) == 1);
+    SELF_CHECK(buffer.prevUtf8Boundary(7) == 4);
+    SELF_CHECK(buffer.prevUtf8Boundary(0) == 0);
+}
+
+// Random edits against std::string, including growth past several gaps.
+static void testTextBufferRandomEdits() {
+    TextBuffer buffer;
+    std::string expected;
+    uint32_t seed = 2024;
+    bool allMatch = true;
+    for (int step = 0; step < 20000 && allMatch; step++) {
+        seed = seed * 1103515245u + 12345u;
+        const size_t pos = expected.empty() ? 0 : (seed >> 8) % (expected.size() + 1);
+        const int op = (seed >> 4) % 4;
+        if (op < 2 || expected.size() < 64) {
+            char text[24];
+            const size_t len = 1 + (seed >> 20) % (op == 0 ? 1 : sizeof(text));
+            for (size_t i = 0; i < len; i++) text[i] = static_cast<char>('a' + (seed + i) % 26);
+            allMatch = buffer.insert(pos, text, len);
+            expected.insert(pos, text, len);
+        } else if (op == 2) {
+            const size_t len = (seed >> 20) % 16;
+            buffer.erase(pos, len);
+            expected.erase(pos, len);
+        } else {
+            const size_t len = (seed >> 20) % 8;
+            allMatch = buffer.replace(pos, len, "\nxy", 3);
+            expected.replace(pos, len < expected.size() - pos ? len : expected.size() - pos, "\nxy");
+        }
+        if (expected.size() > 40000) {
+            buffer.erase(0, 20000);
+            expected.erase(0, 20000);
+        }
+        allMatch = allMatch && buffer.length() == expected.size();
+        if (allMatch && pos < expected.size()) allMatch = buffer.charAt(pos) == expected[pos];
+        if (allMatch && (step % 997) == 0) allMatch = sameText(buffer, expected);
+    }
+    SELF_CHECK(allMatch);
+    SELF_CHECK(sameText(buffer, expected));
+    SELF_CHECK(buffer.count('\n') == static_cast<size_t>(std::count(expected.begin(), expected.end(), '\n')));
+}
+
+static void runTextBufferTests() {
+    testTextBufferBasics();
+    testTextBufferRanges();
+    testTextBufferUtf8();
+    testTextBufferRandomEdits();
+}
+
+// --------------------------------------------------------------------------
+// undo_log: delta undo/redo ring arena
+// --------------------------------------------------------------------------
+
+static void applyEdit(TextBuffer& buffer, UndoLog& log, int position, int deletedLength,
+                      const char* inserted, bool typed, int cursor) {
+    UndoLog::State before = {cursor, 0, -1, -1, false};
+    log.record(buffer, position, deletedLength, inserted, strlen(inserted), before, typed);
+    buffer.replace(position, deletedLength, inserted, strlen(inserted));
+}
+
+static void testUndoLogCoalescing() {
+    TextBuffer buffer;
+    UndoLog log(1024, 32);
+    const char* typed = "hello world";
+    for (int i = 0; typed[i]; i++) {
+        char c[2] = {typed[i], '\0'};
+        applyEdit(buffer, log, i, 0, c, true, i);
+    }
+    SELF_CHECK(sameText(buffer, "hello world"));
+    SELF_CHECK(log.getStepCount() == 2);   // "hello " and "world"
+
+    UndoLog::State state = {11, 7, -1, -1, false};
+    UndoLog::Change change;
+    SELF_CHECK(log.undo(buffer, state, change));
+    SELF_CHECK(sameText(buffer, "hello "));
+    SELF_CHECK(state.cursorPos == 6 && state.snapshotId == 0);
+    SELF_CHECK(change.position == 6 && change.removedLength == 5 && change.insertedLength == 0);
+    SELF_CHECK(log.undo(buffer, state, change));
+    SELF_CHECK(buffer.isEmpty());
+    SELF_CHECK(!log.undo(buffer, state, change));
+
+    // Redo hands back the state that was current when undoing
+    SELF_CHECK(log.redo(buffer, state, change));
+    SELF_CHECK(log.redo(buffer, state, change));
+    SELF_CHECK(sameText(buffer, "hello world"));
+    SELF_CHECK(state.cursorPos == 11 && state.snapshotId == 7);
+    SELF_CHECK(!log.canRedo());
+
+    // A new edit after undo drops redo, and does not merge into an old step
+    SELF_CHECK(log.undo(buffer, state, change));
+    applyEdit(buffer, log, 6, 0, "x", true, 6);
+    SELF_CHECK(!log.canRedo());
+    SELF_CHECK(log.getStepCount() == 2);
+    SELF_CHECK(sameText(buffer, "hello x"));
+
+    // Non-contiguous or untyped inserts start new steps
+    applyEdit(buffer, log, 0, 0, ">", true, 0);
+    applyEdit(buffer, log, 1, 0, ">", false, 1);
+    SELF_CHECK(log.getStepCount() == 4);
+}
+
+static void testUndoLogRecordUndone() {
+    TextBuffer buffer;
+    UndoLog log(1024, 32);
+    buffer.assign("current text");
+    UndoLog::State state = {12, 5, -1, -1, false};
+    SELF_CHECK(log.recordUndone(buffer, 0, buffer.length(), "snapshot", 8, state));
+    buffer.replace(0, buffer.length(), "snapshot", 8);
+    SELF_CHECK(!log.canUndo());
+    SELF_CHECK(log.canRedo());
+
+    UndoLog::State now = {0, 4, -1, -1, false};
+    UndoLog::Change change;
+    SELF_CHECK(log.redo(buffer, now, change));
+    SELF_CHECK(sameText(buffer, "current text"));
+    SELF_CHECK(now.cursorPos == 12 && now.snapshotId == 5);
+    SELF_CHECK(log.undo(buffer, now, change));
+    SELF_CHECK(sameText(buffer, "snapshot"));
+}
+
+// Undo hands back the selection that was active before the edit, and
+// redo the one that was active before the undo.
+static void testUndoLogSelectionState() {
+    TextBuffer buffer;
+    UndoLog log(1024, 32);
+    buffer.assign("select me");
+    UndoLog::State before = {9, 0, 2, 6, true};
+    SELF_CHECK(log.record(buffer, 2, 4, "X", 1, before, false));
+    buffer.replace(2, 4, "X", 1);
+
+    UndoLog::State state = {3, 0, -1, -1, false};
+    UndoLog::Change change;
+    SELF_CHECK(log.undo(buffer, state, change));
+    SELF_CHECK(sameText(buffer, "select me"));
+    SELF_CHECK(state.selectionMode && state.selectionAnchorPos == 2 && state.selectionFocusPos == 6);
+    SELF_CHECK(log.redo(buffer, state, change));
+    SELF_CHECK(!state.selectionMode && state.selectionAnchorPos == -1 && state.cursorPos == 3);
+}
+
+// Random edits through a small arena. Each step still in the log must undo
+// to the exact text it was recorded against, and redo must restore the rest.
+static std::string bufferText(const TextBuffer& buffer) {
+    return std::string(buffer.toString().c_str(), buffer.length());
+}
+
+static void testUndoLogRandomEdits() {
+    TextBuffer buffer;
+    UndoLog log(600, 24);
+    std::vector<std::string> history;   // Text before each edit
+    uint32_t seed = 99;
+    bool allMatch = true;
+    int evictions = 0;
+    for (int step = 0; step < 5000 && allMatch; step++) {
+        seed = seed * 1103515245u + 12345u;
+        const int length = buffer.length();
+        const int position = length == 0 ? 0 : static_cast<int>((seed >> 8) % (length + 1));
+        const int deleted = static_cast<int>((seed >> 16) % 6);
+        const int clamped = deleted < length - position ? deleted : length - position;
+        char text[40];
+        const int insertLength = static_cast<int>((seed >> 4) % (step % 50 == 0 ? 39 : 4));
+        for (int i = 0; i < insertLength; i++) text[i] = static_cast<char>('a' + (seed >> i) % 26);
+        text[insertLength] = '\0';
+
+        history.push_back(bufferText(buffer));
+        const int stepsBefore = log.getStepCount();
+        applyEdit(buffer, log, position, clamped, text, false, position);
+        if (log.getStepCount() <= stepsBefore) evictions++;
+
+        if ((seed >> 24) % 8 == 0) {
+            const std::string latest = bufferText(buffer);
+            const int steps = log.getStepCount();
+            allMatch = steps <= static_cast<int>(history.size());
+            UndoLog::State state = {0, 0, -1, -1, false};
+            UndoLog::Change change;
+            for (int i = 1; i <= steps && allMatch; i++) {
+                allMatch = log.undo(buffer, state, change) &&
+                           bufferText(buffer) == history[history.size() - i];
+            }
+            allMatch = allMatch && !log.canUndo();
+            while (allMatch && log.canRedo()) {
+                allMatch = log.redo(buffer, state, change);
+            }
+            allMatch = allMatch && bufferText(buffer) == latest;
+        }
+        if (buffer.length() > 400) {
+            buffer.clear();
+            log.clear();
+            history.clear();
+        }
+    }
+    SELF_CHECK(allMatch);
+    SELF_CHECK(evictions > 0);
+    SELF_CHECK(log.getMemoryUsage() <= 600 + 24 * 8);
+}
+
+static void runUndoLogTests() {
+    testUndoLogCoalescing();
+    testUndoLogRecordUndone();
+    testUndoLogSelectionState();
+    testUndoLogRandomEdits();
+}
+
+// --------------------------------------------------------------------------
+// sd_session: persistent SD mount with idle release
+// --------------------------------------------------------------------------
+
+static void testSdSessionReuse() {
+    sdReleaseSession();
+    const unsigned long savedIdle = sdGetIdleReleaseMs();
+    sdSetIdleReleaseMs(60000);
+    const uint32_t cardMounts = sdFat.getMountCount();
+    const uint32_t mounts = sdGetMountCount();
+    const uint32_t reuses = sdGetReuseCount();
+
+    // Twenty back-to-back file operations share one card init.
+    bool allBegun = true;
+    for (int i = 0; i < 20; i++) {
+        allBegun = sdBeginSession() && allBegun;
+        sdEndSession();
+        sdServiceSession();
+    }
+    SELF_CHECK(allBegun);
+    SELF_CHECK(sdFat.getMountCount() == cardMounts + 1);
+    SELF_CHECK(sdGetMountCount() == mounts + 1);
+    SELF_CHECK(sdGetReuseCount() == reuses + 19);
+    SELF_CHECK(sdIsSessionMounted() && sdFat.isMounted());
+
+    // An idle volume is released; an open session never is.
+    sdSetIdleReleaseMs(0);
+    SELF_CHECK(sdBeginSession());
+    SELF_CHECK(sdBeginSession());
+    sdEndSession();
+    sdServiceSession();
+    SELF_CHECK(sdIsSessionMounted());
+    sdEndSession();
+    const uint32_t unmounts = sdFat.getUnmountCount();
+    sdServiceSession();
+    SELF_CHECK(!sdIsSessionMounted() && !sdFat.isMounted());
+    SELF_CHECK(sdFat.getUnmountCount() == unmounts + 1);
+
+    // The next operation mounts again; a forced release (sleep) unmounts.
+    SELF_CHECK(sdBeginSession());
+    SELF_CHECK(sdFat.getMountCount() == cardMounts + 2);
+    sdEndSession();
+    sdReleaseSession();
+    SELF_CHECK(!sdFat.isMounted());
+    sdEndSession();   // Unbalanced end after release is harmless
+    SELF_CHECK(!sdIsSessionMounted());
+
+    sdSetIdleReleaseMs(savedIdle);
+}
+
+static void testSdFreeSpaceScan() {
+    const uint64_t clusterBytes = sdFat.bytesPerCluster();
+    const uint64_t usedBytes = SdCard::kUsedClusters * clusterBytes;
+    const uint32_t fullCounts = sdFat.getFreeCountCalls();
+
+    // Mounting caches the size only; used space is pending until the
+    // background scan has counted the whole FAT a slice per frame.
+    SELF_CHECK(mountSD());
+    SELF_CHECK(!sdIsUsedBytesReady());
+    SELF_CHECK(sdUsedBytes() == 0);
+    SELF_CHECK(sdTotalBytes() == sdFat.clusterCount() * clusterBytes);
+    const uint32_t reads = sdFat.card()->getSectorReadCount();
+    int frames = 0;
+    while (!sdIsUsedBytesReady() && frames < 100) {
+        sdServiceFreeSpace();
+        frames++;
+    }
+    const uint32_t fatSectors = (sdFat.clusterCount() + 2 + 127) / 128;
+    SELF_CHECK(sdIsUsedBytesReady());
+    SELF_CHECK(sdUsedBytes() == usedBytes);
+    SELF_CHECK(sdFat.card()->getSectorReadCount() - reads == fatSectors);
+    SELF_CHECK(frames == static_cast<int>((fatSectors + SD_FREE_SCAN_SECTORS_PER_FRAME - 1) /
+                                          SD_FREE_SCAN_SECTORS_PER_FRAME));
+    SELF_CHECK(sdFat.getFreeCountCalls() == fullCounts);
+
+    // Our own writes adjust the cached figure by whole clusters.
+    sdNoteFileResized(0, clusterBytes + 1);
+    SELF_CHECK(sdUsedBytes() == usedBytes + 2 * clusterBytes);
+    sdNoteFileResized(clusterBytes + 1, 10);
+    SELF_CHECK(sdUsedBytes() == usedBytes + clusterBytes);
+    sdNoteFileResized(10, 0);
+    SELF_CHECK(sdUsedBytes() == usedBytes);
+
+    // A write during the scan is folded into its result.
+    SELF_CHECK(mountSD());
+    sdServiceFreeSpace();
+    SELF_CHECK(!sdIsUsedBytesReady());
+    sdNoteFileResized(0, 3 * clusterBytes);
+    while (!sdIsUsedBytesReady() && frames < 200) {
+        sdServiceFreeSpace();
+        frames++;
+    }
+    SELF_CHECK(sdUsedBytes() == usedBytes + 3 * clusterBytes);
+
+    // A failed FAT read is retried from the same cluster on a later frame.
+    SELF_CHECK(mountSD());
+    sdServiceFreeSpace();
+    sdFat.card()->failNextReads(SD_FREE_SCAN_MAX_RETRIES);
+    frames = 0;
+    while (!sdIsUsedBytesReady() && !sdIsUsedBytesUnknown() && frames < 100) {
+        sdServiceFreeSpace();
+        frames++;
+    }
+    SELF_CHECK(sdIsUsedBytesReady() && sdUsedBytes() == usedBytes);
+
+    // A card that keeps failing reports unknown instead of pending forever.
+    SELF_CHECK(mountSD());
+    sdFat.card()->failNextReads(1000);
+    frames = 0;
+    while (!sdIsUsedBytesReady() && !sdIsUsedBytesUnknown() && frames < 100) {
+        sdServiceFreeSpace();
+        frames++;
+    }
+    SELF_CHECK(sdIsUsedBytesUnknown() && !sdIsUsedBytesReady());
+    SELF_CHECK(frames == SD_FREE_SCAN_MAX_RETRIES + 1);
+    sdFat.card()->failNextReads(0);
+
+    unmountSD();
+    SELF_CHECK(!sdIsUsedBytesReady() && !sdIsUsedBytesUnknown() && sdUsedBytes() == 0);
+    SELF_CHECK(mountSD());
+    frames = 0;
+    while (!sdIsUsedBytesReady() && frames < 100) {
+        sdServiceFreeSpace();
+        frames++;
+    }
+    SELF_CHECK(sdIsUsedBytesReady() && sdUsedBytes() == usedBytes);
+}
+
+static void runSdSessionTests() {
+    testSdSessionReuse();
+    testSdFreeSpaceScan();
+}
+
+// --------------------------------------------------------------------------
+// history_journal: append-only editor history
+// --------------------------------------------------------------------------
+
+static const char* kJournalTestDir = "/.selftest";
+static const char* kJournalTestPath = "/.selftest/journal.bin";
+
+static bool snapshotIs(const HistoryJournal& journal, uint32_t snapshotId, const std::string& expected) {
+    TextBuffer text;
+    String error;
+    return journal.readSnapshot(snapshotId, text, error) && bufferText(text) == expected;
+}
+
+static void testHistoryJournalAppendAndReopen() {
+    sdFat.remove(kJournalTestPath);
+    sdFat.mkdir(kJournalTestDir);
+    HistoryJournal journal;
+    String error;
+    SELF_CHECK(journal.open(kJournalTestPath, error));
+    SELF_CHECK(journal.getLatestId() == 0);
+
+    // Random edits recorded as single-range deltas; every version is kept
+    // to check reconstruction through checkpoints and compaction.
+    TextBuffer text;
+    std::vector<std::string> versions(1);   // Index = snapshot id
+    uint32_t snapshotId = 0;
+    bool changed = false;
+    text.assign(std::string(6000, 'x').c_str(), 6000);
+    SELF_CHECK(journal.appendText(text, snapshotId, changed, error) && changed && snapshotId == 1);
+    versions.push_back(bufferText(text));
+
+    uint32_t seed = 7;
+    bool appended = true;
+    size_t largestDelta = 0;
+    int deltaCount = 0;
+    for (int step = 0; step < 700 && appended; step++) {
+        seed = seed * 1103515245u + 12345u;
+        const size_t length = text.length();
+        const size_t position = (seed >> 8) % (length + 1);
+        size_t removed = (seed >> 16) % 5;
+        if (removed > length - position) removed = length - position;
+        char inserted[8];
+        const size_t insertedLength = (seed >> 4) % 6;
+        for (size_t i = 0; i < insertedLength; i++) inserted[i] = static_cast<char>('a' + (seed >> i) % 26);
+        text.replace(position, removed, inserted, insertedLength);
+        appended = journal.appendEdit(text, position, removed, insertedLength, snapshotId, error) &&
+                   snapshotId == versions.size();
+        versions.push_back(bufferText(text));
+        if (journal.getLastAppendBytes() < 1000) {
+            deltaCount++;
+            largestDelta = std::max(largestDelta, journal.getLastAppendBytes());
+        }
+    }
+    SELF_CHECK(appended);
+    SELF_CHECK(deltaCount > 600);
+    SELF_CHECK(largestDelta <= 64);                // Cost follows the edit, not the file
+    SELF_CHECK(journal.getFirstId() > 1);          // Compaction dropped old snapshots
+    SELF_CHECK(journal.getDataBytes() <= 160 * 1024);
+
+    bool allMatch = true;
+    for (uint32_t id = journal.getFirstId(); id <= journal.getLatestId() && allMatch; id += 7) {
+        allMatch = snapshotIs(journal, id, versions[id]);
+    }
+    SELF_CHECK(allMatch);
+    SELF_CHECK(snapshotIs(journal, journal.getLatestId(), versions.back()));
+    SELF_CHECK(!snapshotIs(journal, journal.getFirstId() - 1, versions[1]));
+
+    // Unchanged text writes nothing; a changed one is diffed against the latest.
+    const uint32_t latest = journal.getLatestId();
+    SELF_CHECK(journal.appendText(text, snapshotId, changed, error) && !changed && snapshotId == latest);
+    text.insert(10, "diffed", 6);
+    const uint32_t syncs = sdFat.getSyncCount();
+    SELF_CHECK(journal.appendText(text, snapshotId, changed, error) && changed && snapshotId == latest + 1);
+    SELF_CHECK(sdFat.getSyncCount() == syncs + 1);   // Record and footer share one sync
+    versions.push_back(bufferText(text));
+
+    // A reopened journal finds every snapshot through the footer index.
+    const uint32_t firstId = journal.getFirstId();
+    journal.close();
+    SELF_CHECK(journal.open(kJournalTestPath, error));
+    SELF_CHECK(journal.getFirstId() == firstId && journal.getLatestId() == latest + 1);
+    SELF_CHECK(snapshotIs(journal, latest + 1, versions.back()));
+    SELF_CHECK(snapshotIs(journal, firstId + 3, versions[firstId + 3]));
+    journal.close();
+}
+
+// Overwrite bytes of the journal file behind the mock's back.
+static void damageJournal(long offsetFromEnd, size_t length) {
+    std::fstream file(mapPath(kJournalTestPath), std::ios::in | std::ios::out | std::ios::binary);
+    file.seekp(offsetFromEnd, std::ios::end);
+    for (size_t i = 0; i < length; i++) file.put(static_cast<char>(0xA5));
+}
+
+static void testHistoryJournalRecovery() {
+    sdFat.remove(kJournalTestPath);
+    HistoryJournal journal;
+    String error;
+    SELF_CHECK(journal.open(kJournalTestPath, error));
+    TextBuffer text;
+    text.assign("first version");
+    uint32_t snapshotId = 0;
+    bool changed = false;
+    SELF_CHECK(journal.appendText(text, snapshotId, changed, error));
+    text.replace(0, 5, "second", 6);
+    SELF_CHECK(journal.appendEdit(text, 0, 5, 6, snapshotId, error) && snapshotId == 2);
+    const size_t dataBytes = journal.getDataBytes();
+    journal.close();
+
+    // Lost footer: the records are replayed.
+    damageJournal(-8, 8);
+    SELF_CHECK(journal.open(kJournalTestPath, error));
+    SELF_CHECK(journal.getLatestId() == 2 && journal.getDataBytes() == dataBytes);
+    SELF_CHECK(snapshotIs(journal, 2, "second version"));
+    SELF_CHECK(snapshotIs(journal, 1, "first version"));
+
+    // Torn last record (payload written, footer not): it is dropped.
+    text.insert(text.length(), "!", 1);
+    SELF_CHECK(journal.appendEdit(text, text.length() - 1, 0, 1, snapshotId, error) && snapshotId == 3);
+    journal.close();
+    {
+        std::fstream file(mapPath(kJournalTestPath), std::ios::in | std::ios::out | std::ios::binary);
+        file.seekp(static_cast<std::streamoff>(dataBytes) + 32);   // Payload of record 3
+        file.put('?');
+    }
+    damageJournal(-8, 8);
+    SELF_CHECK(journal.open(kJournalTestPath, error));
+    SELF_CHECK(journal.getLatestId() == 2);
+    SELF_CHECK(snapshotIs(journal, 2, "second version"));
+
+    // Appends continue after the repaired tail.
+    SELF_CHECK(journal.appendEdit(text, text.length() - 1, 0, 1, snapshotId, error) && snapshotId == 3);
+    SELF_CHECK(snapshotIs(journal, 3, "second version!"));
+    journal.close();
+    sdFat.remove(kJournalTestPath);
+    sdFat.rmdir(kJournalTestDir);
+}
+
+static void runHistoryJournalTests() {
+    const bool ownSession = sdBeginSession();
+    testHistoryJournalAppendAndReopen();
+    testHistoryJournalRecovery();
+    if (ownSession) sdEndSession();
+}
+
+// --------------------------------------------------------------------------
+// history_index: sorted path-hash index of history documents
+// --------------------------------------------------------------------------
+
+static const char* kIndexTestPath = "/.selftest/index.bin";
+
+static String indexTestPath(int n) {
+    return String("/docs/file_") + String(n) + ".txt";
+}
+
+static void testHistoryIndexInsertFind() {
+    sdFat.mkdir(kJournalTestDir);
+    sdFat.remove(kIndexTestPath);
+    HistoryIndex index(kIndexTestPath);
+    String error;
+    String found;
+    SELF_CHECK(!index.isAvailable());
+    SELF_CHECK(!index.find("/docs/missing.txt", found));
+
+    bool inserted = true;
+    for (int n = 0; n < 150 && inserted; n++) {
+        inserted = index.insert(indexTestPath(n), String("doc_") + String(n), error);
+    }
+    SELF_CHECK(inserted);
+    SELF_CHECK(index.getCount() == 150);
+
+    // A fresh instance reads the fence once, then one page per lookup.
+    HistoryIndex reopened(kIndexTestPath);
+    SELF_CHECK(reopened.isAvailable());
+    bool allFound = true;
+    for (int n = 0; n < 150 && allFound; n++) {
+        allFound = reopened.find(indexTestPath(n), found) && found == String("doc_") + String(n);
+    }
+    SELF_CHECK(allFound);
+    SELF_CHECK(reopened.getPageReads() <= 150 + 150 / 8);
+    SELF_CHECK(!reopened.find("/docs/missing.txt", found));
+
+    // Re-inserting a path replaces its entry instead of adding one.
+    SELF_CHECK(reopened.insert(indexTestPath(7), "renamed_7", error));
+    SELF_CHECK(reopened.getCount() == 150);
+    SELF_CHECK(reopened.find(indexTestPath(7), found) && found == "renamed_7");
+    HistoryIndex::Entry tooLong;
+    SELF_CHECK(!HistoryIndex::makeEntry("/x", String(std::string(60, 'a').c_str()), tooLong));
+}
+
+// A card init after a release may be a different card, so the cached
+// fence must not outlive it.
+static void testHistoryIndexRemount() {
+    String error;
+    String found;
+    std::vector<HistoryIndex::Entry> entries(1);
+    HistoryIndex::makeEntry(indexTestPath(1), "first_card", entries[0]);
+    HistoryIndex cached(kIndexTestPath);
+    SELF_CHECK(cached.rebuild(entries, error));
+    SELF_CHECK(cached.find(indexTestPath(1), found) && found == "first_card");
+
+    entries.clear();
+    for (int n = 0; n < 40; n++) {
+        HistoryIndex::Entry entry;
+        HistoryIndex::makeEntry(indexTestPath(n), String("second_card_") + String(n), entry);
+        entries.push_back(entry);
+    }
+    HistoryIndex other(kIndexTestPath);
+    SELF_CHECK(other.rebuild(entries, error));
+    sdReleaseSession();
+    SELF_CHECK(sdBeginSession());
+    SELF_CHECK(cached.find(indexTestPath(1), found) && found == "second_card_1");
+    SELF_CHECK(cached.getCount() == 40);
+}
+
+static void testHistoryIndexRebuildAndRecovery() {
+    HistoryIndex index(kIndexTestPath);
+    String error;
+    String found;
+    std::vector<HistoryIndex::Entry> entries;
+    for (int n = 0; n < 20; n++) {
+        HistoryIndex::Entry entry;
+        HistoryIndex::makeEntry(indexTestPath(n), String("rebuilt_") + String(n), entry);
+        entries.push_back(entry);
+        entries.push_back(entry);   // Duplicates collapse
+    }
+    SELF_CHECK(index.rebuild(entries, error));
+    SELF_CHECK(index.isAvailable() && index.getCount() == 20);
+    SELF_CHECK(index.find(indexTestPath(19), found) && found == "rebuilt_19");
+    SELF_CHECK(!index.find(indexTestPath(20), found));
+
+    // A rewrite interrupted after removing the old file is finished on load.
+    const String tempPath = String(kIndexTestPath) + ".tmp";
+    SELF_CHECK(sdFat.rename(kIndexTestPath, tempPath.c_str()));
+    index.invalidate();
+    SELF_CHECK(index.isAvailable() && index.getCount() == 20);
+    SELF_CHECK(!sdFat.exists(tempPath.c_str()));
+
+    // A damaged fence makes the index unavailable so the caller rebuilds it.
+    {
+        std::fstream file(mapPath(kIndexTestPath), std::ios::in | std::ios::out | std::ios::binary);
+        file.seekp(20);
+        file.put(static_cast<char>(0x5A));
+    }
+    index.invalidate();
+    SELF_CHECK(!index.isAvailable());
+    sdFat.remove(kIndexTestPath);
+    sdFat.rmdir(kJournalTestDir);
+}
+
+static void runHistoryIndexTests() {
+    const bool ownSession = sdBeginSession();
+    testHistoryIndexInsertFind();
+    testHistoryIndexRemount();
+    testHistoryIndexRebuildAndRecovery();
+    if (ownSession) sdEndSession();
+}
+
+// --------------------------------------------------------------------------
+// clipboard_ring: RAM clipboard with lazy write-back
+// --------------------------------------------------------------------------
+
+static const char* kClipboardTestPath = "/.selftest/clipboard.bin";
+
+static void testClipboardRingWriteBack() {
+    sdFat.mkdir(kJournalTestDir);
+    sdFat.remove(kClipboardTestPath);
+    String error;
+    int slot = -1;
+    {
+        ClipboardRing ring(kClipboardTestPath, 4, 64);
+        SELF_CHECK(ring.load(error) && !ring.hasFile() && !ring.isDirty());
+        SELF_CHECK(ring.getMaxTextBytes() == 56);
+
+        // Copies stay in RAM until flushed.
+        SELF_CHECK(ring.push("alpha", slot, error) && slot == 0);
+        SELF_CHECK(ring.push("beta", slot, error) && slot == 1);
+        SELF_CHECK(ring.isDirty() && !sdFat.exists(kClipboardTestPath));
+        SELF_CHECK(ring.getSlot(ring.slotForAge(0)) == "beta");
+        SELF_CHECK(ring.getSlot(ring.slotForAge(1)) == "alpha");
+        SELF_CHECK(ring.getSlot(ring.slotForAge(2)).length() == 0);
+        SELF_CHECK(!ring.push(String(std::string(57, 'x').c_str()), slot, error));
+
+        // Creating the file writes every slot once; later flushes only the changed ones.
+        SELF_CHECK(ring.flush(error) && !ring.isDirty() && ring.getSlotWrites() == 4);
+        SELF_CHECK(ring.flush(error) && ring.getSlotWrites() == 4);
+        SELF_CHECK(ring.push("gamma", slot, error) && slot == 2);
+        SELF_CHECK(ring.flush(error) && ring.getSlotWrites() == 5);
+    }
+
+    // The ring wraps around, overwriting the oldest entry.
+    ClipboardRing reopened(kClipboardTestPath, 4, 64);
+    SELF_CHECK(reopened.load(error) && reopened.hasFile() && !reopened.isDirty());
+    SELF_CHECK(reopened.getSlot(reopened.slotForAge(0)) == "gamma");
+    SELF_CHECK(reopened.getSlot(reopened.slotForAge(2)) == "alpha");
+    SELF_CHECK(reopened.push("delta", slot, error) && reopened.push("epsilon", slot, error) && slot == 0);
+    SELF_CHECK(reopened.getSlot(reopened.slotForAge(3)) == "beta");
+    SELF_CHECK(reopened.flush(error));
+}
+
+static void testClipboardRingRecovery() {
+    String error;
+
+    // A torn slot loses only that entry.
+    {
+        std::fstream file(mapPath(kClipboardTestPath), std::ios::in | std::ios::out | std::ios::binary);
+        file.seekp(24 + 64 * 1 + 8);   // Payload of slot 1
+        file.put('?');
+    }
+    ClipboardRing ring(kClipboardTestPath, 4, 64);
+    SELF_CHECK(ring.load(error));
+    SELF_CHECK(ring.getSlot(1).length() == 0 && ring.isDirty());
+    SELF_CHECK(ring.getSlot(0) == "epsilon" && ring.getSlot(2) == "gamma");
+    SELF_CHECK(ring.flush(error) && ring.getSlotWrites() == 1);
+
+    // A file with another layout is ignored and rewritten.
+    ClipboardRing resized(kClipboardTestPath, 6, 64);
+    SELF_CHECK(resized.load(error) && resized.hasFile() && resized.isDirty());
+    SELF_CHECK(resized.getSlot(resized.slotForAge(0)).length() == 0);
+    SELF_CHECK(resized.flush(error) && resized.getSlotWrites() == 6);
+    sdFat.remove(kClipboardTestPath);
+    sdFat.rmdir(kJournalTestDir);
+}
+
+static void runClipboardRingTests() {
+    const bool ownSession = sdBeginSession();
+    testClipboardRingWriteBack();
+    testClipboardRingRecovery();
+    if (ownSession) sdEndSession();
+}
+
+// --------------------------------------------------------------------------
+// paged_reader: line-aligned viewer pages, LRU cache and index cache
+// --------------------------------------------------------------------------
+
+static const char* kViewerTestPath = "/.selftest/view.txt";
+static const char* kViewerTestCacheRoot = "/.selftest/viewer";
+
+static std::string buildViewerTestFile() {
+    std::string text;
+    for (int line = 1; line <= 400; line++) {
+        text += "line " + std::to_string(line) + " ";
+        text += std::string(static_cast<size_t>(line * 7 % 50), 'a' + line % 26);
+        if (line == 120) {
+            // Longer than a page, with two-byte characters across the cut
+            for (int i = 0; i < 150; i++) text += "\xC3\xA9";
+        }
+        text += "\n";
+    }
+    return text;
+}
+
+static void writeViewerTestFile(const std::string& text) {
+    std::ofstream file(mapPath(kViewerTestPath), std::ios::binary | std::ios::trunc);
+    file.write(text.data(), static_cast<std::streamsize>(text.size()));
+}
+
+static uint32_t lineNumberAt(const std::string& text, size_t offset) {
+    return static_cast<uint32_t>(std::count(text.begin(), text.begin() + offset, '\n')) + 1;
+}
+
+static void testPagedReaderPages() {
+    sdFat.mkdir(kJournalTestDir);
+    const std::string text = buildViewerTestFile();
+    writeViewerTestFile(text);
+
+    PagedReader reader(kViewerTestCacheRoot);
+    String error;
+    SELF_CHECK(reader.open(kViewerTestPath, 256, error));
+    SELF_CHECK(!reader.isIndexComplete() && reader.getBytesScanned() < text.size());
+    SELF_CHECK(reader.getPageCount() >= 1);
+    while (reader.service(1024)) {
+    }
+    SELF_CHECK(reader.isIndexComplete() && reader.getLineCount() == 401);
+
+    // Pages cover the file in order, fit the page size and start on a line
+    // unless a single line is longer than a page.
+    std::string joined;
+    bool boundsOk = true;
+    bool linesOk = true;
+    int midLinePages = 0;
+    for (int page = 0; page < reader.getPageCount(); page++) {
+        String pageText;
+        if (!reader.readPage(page, pageText, error)) {
+            boundsOk = false;
+            break;
+        }
+        const size_t start = joined.size();
+        joined.append(pageText.c_str(), pageText.length());
+        boundsOk = boundsOk && pageText.length() > 0 && pageText.length() <= 256;
+        const bool lineStart = start == 0 || text[start - 1] == '\n';
+        if (reader.pageStartsMidLine(page)) {
+            midLinePages++;
+            linesOk = linesOk && !lineStart && (static_cast<uint8_t>(text[start]) & 0xC0) != 0x80;
+        } else {
+            linesOk = linesOk && lineStart;
+        }
+        linesOk = linesOk && reader.getPageFirstLine(page) == lineNumberAt(text, start);
+    }
+    SELF_CHECK(boundsOk && joined == text);
+    SELF_CHECK(linesOk);
+    SELF_CHECK(midLinePages >= 1);
+
+    // Jump to a line: the offset lands on its first byte.
+    bool jumpsOk = true;
+    const uint32_t targets[] = {1, 2, 119, 120, 121, 250, 400, 401};
+    for (uint32_t target : targets) {
+        int page = -1;
+        size_t offset = 0;
+        String pageText;
+        jumpsOk = jumpsOk && reader.findLine(target, page, offset, error) && reader.readPage(page, pageText, error);
+        if (!jumpsOk) break;
+        std::string prefix;
+        for (int p = 0; p < page; p++) {
+            String before;
+            reader.readPage(p, before, error);
+            prefix += before.c_str();
+        }
+        const size_t absolute = prefix.size() + offset;
+        jumpsOk = (absolute == 0 || text[absolute - 1] == '\n') && lineNumberAt(text, absolute) == target;
+    }
+    SELF_CHECK(jumpsOk);
+    int page = 0;
+    size_t offset = 0;
+    SELF_CHECK(!reader.findLine(402, page, offset, error));
+}
+
+static void testPagedReaderCaches() {
+    const std::string text = buildViewerTestFile();
+    String error;
+    String pageText;
+    {
+        PagedReader reader(kViewerTestCacheRoot);
+        SELF_CHECK(reader.open(kViewerTestPath, 256, error) && reader.wasIndexCached());
+        SELF_CHECK(reader.isIndexComplete() && reader.getBytesScanned() == 0);
+
+        // Reading a page queues the next one; service() loads it so the flip hits.
+        SELF_CHECK(reader.readPage(3, pageText, error) && reader.getCacheMisses() == 1);
+        SELF_CHECK(reader.hasPendingWork());
+        reader.service(1024);
+        SELF_CHECK(!reader.hasPendingWork());
+        SELF_CHECK(reader.readPage(4, pageText, error) && reader.getCacheHits() == 1);
+        reader.service(1024);
+        SELF_CHECK(reader.readPage(5, pageText, error) && reader.getCacheHits() == 2);
+        // Going back reads ahead backwards.
+        SELF_CHECK(reader.readPage(3, pageText, error));
+        reader.service(1024);
+        SELF_CHECK(reader.readPage(2, pageText, error) && reader.getCacheMisses() == 1);
+    }
+
+    // A changed file does not reuse the cached index.
+    writeViewerTestFile(text + "tail\n");
+    PagedReader changed(kViewerTestCacheRoot);
+    SELF_CHECK(changed.open(kViewerTestPath, 256, error) && !changed.wasIndexCached());
+    while (changed.service(4096)) {
+    }
+    SELF_CHECK(changed.getLineCount() == 402);
+
+    sdFat.remove(kViewerTestPath);
+    FsFile dir;
+    if (dir.open(kViewerTestCacheRoot, O_RDONLY)) {
+        FsFile entry;
+        std::vector<std::string> names;
+        while (entry.openNext(&dir, O_RDONLY)) {
+            char name[64];
+            entry.getName(name, sizeof(name));
+            names.push_back(std::string(kViewerTestCacheRoot) + "/" + name);
+            entry.close();
+        }
+        dir.close();
+        for (const std::string& name : names) sdFat.remove(name.c_str());
+    }
+    sdFat.rmdir(kViewerTestCacheRoot);
+    sdFat.rmdir(kJournalTestDir);
+}
+
+static void runPagedReaderTests() {
+    const bool ownSession = sdBeginSession();
+    testPagedReaderPages();
+    testPagedReaderCaches();
+    if (ownSession) sdEndSession();
+}
+
+// --------------------------------------------------------------------------
+// stream_search: chunked Boyer-Moore-Horspool search
+// --------------------------------------------------------------------------
+
+static int readSearchTestString(void* context, size_t offset, char* out, size_t length) {
+    const std::string* text = static_cast<const std::string*>(context);
+    if (offset >= text->size()) return 0;
+    length = std::min(length, text->size() - offset);
+    std::memcpy(out, text->data() + offset, length);
+    return static_cast<int>(length);
+}
+
+static std::string lowerCopy(const std::string& text) {
+    std::string lower = text;
+    for (char& c : lower) {
+        if (c >= 'A' && c <= 'Z') c = static_cast<char>(c + ('a' - 'A'));
+    }
+    return lower;
+}
+
+// Every hit from `from`, in search order, as the naive scan sees them.
+static std::vector<size_t> expectedHits(const std::string& text, const std::string& pattern, size_t from) {
+    const std::string lowerText = lowerCopy(text);
+    const std::string lowerPattern = lowerCopy(pattern);
+    std::vector<size_t> hits;
+    for (size_t pos = lowerText.find(lowerPattern, from); pos != std::string::npos;
+         pos = lowerText.find(lowerPattern, pos + 1)) {
+        hits.push_back(pos);
+    }
+    for (size_t pos = lowerText.find(lowerPattern); pos != std::string::npos && pos < from;
+         pos = lowerText.find(lowerPattern, pos + 1)) {
+        hits.push_back(pos);
+    }
+    return hits;
+}
+
+static std::vector<size_t> streamHits(StreamSearch& search, const std::string& text, const std::string& pattern,
+                                      size_t from, size_t budget) {
+    std::vector<size_t> hits;
+    if (!search.start(pattern.c_str(), text.size(), from)) return hits;
+    std::string source = text;
+    for (int steps = 0; steps < 100000; steps++) {
+        const StreamSearch::Status status = search.step(readSearchTestString, &source, budget);
+        if (status == StreamSearch::FOUND) hits.push_back(search.getMatchOffset());
+        if (status == StreamSearch::NOT_FOUND || status == StreamSearch::FAILED) break;
+    }
+    return hits;
+}
+
+static void testStreamSearchMatches() {
+    // A tiny chunk puts most matches across a chunk edge.
+    StreamSearch search(7);
+    const std::string text = "The cat sat on the MAT; the Cat ate the mat. cattle catalog concat";
+    SELF_CHECK(streamHits(search, text, "cat", 0, 5) == expectedHits(text, "cat", 0));
+    SELF_CHECK(streamHits(search, text, "the mat", 0, 3) == expectedHits(text, "the mat", 0));
+    SELF_CHECK(streamHits(search, text, "cat", 30, 64) == expectedHits(text, "cat", 30));
+    SELF_CHECK(streamHits(search, text, "dog", 10, 64).empty());
+    SELF_CHECK(streamHits(search, text, text.substr(2, StreamSearch::MAX_PATTERN), 0, 1).size() == 1);
+    SELF_CHECK(streamHits(search, "aaaaaa", "aa", 3, 2) == expectedHits("aaaaaa", "aa", 3));
+    SELF_CHECK(!search.start("", text.size(), 0));
+    SELF_CHECK(!search.start(String(std::string(StreamSearch::MAX_PATTERN + 1, 'x').c_str()), text.size(), 0));
+
+    // Wrapped hits are flagged.
+    std::string source = text;
+    SELF_CHECK(search.start("the mat", text.size(), 40));
+    SELF_CHECK(search.step(readSearchTestString, &source, 1024) == StreamSearch::FOUND);
+    SELF_CHECK(search.isMatchWrapped() && search.getMatchOffset() == 15);
+
+    // Random text over a small alphabet, random chunk sizes and budgets.
+    srand(7);
+    bool allMatch = true;
+    for (int round = 0; round < 200 && allMatch; round++) {
+        std::string random(static_cast<size_t>(rand() % 400), 'a');
+        for (char& c : random) c = "abAB c"[rand() % 6];
+        std::string pattern(static_cast<size_t>(1 + rand() % 5), 'a');
+        for (char& c : pattern) c = "abAB c"[rand() % 6];
+        const size_t from = random.empty() ? 0 : static_cast<size_t>(rand()) % random.size();
+        StreamSearch randomSearch(static_cast<size_t>(1 + rand() % 40));
+        allMatch = streamHits(randomSearch, random, pattern, from, static_cast<size_t>(1 + rand() % 50)) ==
+                   expectedHits(random, pattern, from);
+    }
+    SELF_CHECK(allMatch);
+}
+
+static int readSearchTestFile(void* context, size_t offset, char* out, size_t length) {
+    FsFile* file = static_cast<FsFile*>(context);
+    if (!file->seekSet(offset)) return -1;
+    return file->read(out, length);
+}
+
+// Search the viewer test file from SD and land on the hit's page.
+static void testStreamSearchFile() {
+    sdFat.mkdir(kJournalTestDir);
+    const std::string text = buildViewerTestFile();
+    writeViewerTestFile(text);
+    const size_t expected = text.find("line 377 ");
+
+    FsFile file;
+    SELF_CHECK(file.open(kViewerTestPath, O_RDONLY));
+    StreamSearch search(512);
+    SELF_CHECK(search.start("LINE 377 ", static_cast<size_t>(file.size()), 100));
+    StreamSearch::Status status = StreamSearch::SEARCHING;
+    int steps = 0;
+    while (status == StreamSearch::SEARCHING && steps < 1000) {
+        status = search.step(readSearchTestFile, &file, 1024);
+        steps++;
+    }
+    file.close();
+    SELF_CHECK(status == StreamSearch::FOUND && search.getMatchOffset() == expected);
+    SELF_CHECK(steps > 1 && search.getBytesRead() < text.size());
+
+    PagedReader reader(kViewerTestCacheRoot);
+    String error;
+    int page = -1;
+    size_t offsetInPage = 0;
+    String pageText;
+    SELF_CHECK(reader.open(kViewerTestPath, 256, error));
+    SELF_CHECK(reader.findOffset(expected, page, offsetInPage, error));
+    SELF_CHECK(reader.readPage(page, pageText, error));
+    SELF_CHECK(std::string(pageText.c_str()).compare(offsetInPage, 9, "line 377 ") == 0);
+    reader.close();
+}
+
+static void runStreamSearchTests() {
+    testStreamSearchMatches();
+    testStreamSearchFile();
+}
+
+// --------------------------------------------------------------------------
+// span_document: copy-on-write edits over a file
+// --------------------------------------------------------------------------
+
+static const char* kSpanTestPath = "/.selftest/spans.txt";
+
+static std::string readSpanDocument(const SpanDocument& document, size_t offset, size_t length) {
+    FsFile file;
+    std::string out(length, '\0');
+    if (!file.open(kSpanTestPath, O_RDONLY)) return "";
+    const int got = document.read(file, offset, &out[0], length);
+    out.resize(got < 0 ? 0 : static_cast<size_t>(got));
+    return out;
+}
+
+static void testSpanDocumentEdits() {
+    sdFat.mkdir(kJournalTestDir);
+    std::string model;
+    for (int line = 1; line <= 2000; line++) model += "row " + std::to_string(line) + "\n";
+    {
+        std::ofstream file(mapPath(kSpanTestPath), std::ios::binary | std::ios::trunc);
+        file.write(model.data(), static_cast<std::streamsize>(model.size()));
+    }
+
+    SpanDocument document;
+    String error;
+    SELF_CHECK(document.open(kSpanTestPath, error));
+    SELF_CHECK(document.length() == model.size() && document.getSpanCount() == 1 && !document.isModified());
+
+    // Typing runs extend one added span.
+    bool editsOk = true;
+    for (int i = 0; i < 10; i++) {
+        const char c = static_cast<char>('a' + i);
+        editsOk = document.replace(100 + i, 0, &c, 1, error) && editsOk;
+        model.insert(100 + i, 1, c);
+    }
+    SELF_CHECK(document.getSpanCount() == 3 && document.getAddedBytes() == 10);
+    // Backspacing over them takes the bytes back.
+    SELF_CHECK(document.replace(107, 3, "", 0, error));
+    model.erase(107, 3);
+    SELF_CHECK(document.replace(107, 0, "xy", 2, error));
+    model.insert(107, "xy");
+    SELF_CHECK(document.getSpanCount() == 3 && document.getAddedBytes() == 9);
+
+    srand(17);
+    bool rangesMatch = true;
+    for (int round = 0; round < 300; round++) {
+        const size_t offset = static_cast<size_t>(rand()) % (model.size() + 1);
+        const size_t removed = std::min(static_cast<size_t>(rand() % 40), model.size() - offset);
+        const std::string text(static_cast<size_t>(rand() % 12), static_cast<char>('A' + round % 26));
+        editsOk = document.replace(offset, removed, text.data(), text.size(), error) && editsOk;
+        model.replace(offset, removed, text);
+
+        const size_t start = static_cast<size_t>(rand()) % (model.size() + 1);
+        const size_t length = std::min(static_cast<size_t>(rand() % 300), model.size() - start);
+        if (readSpanDocument(document, start, length) != model.substr(start, length)) rangesMatch = false;
+    }
+    SELF_CHECK(editsOk && rangesMatch);
+    SELF_CHECK(document.length() == model.size() && document.isModified());
+    SELF_CHECK(readSpanDocument(document, 0, model.size()) == model);
+    SELF_CHECK(!document.replace(model.size(), 1, "x", 1, error));
+    SELF_CHECK(readSpanDocument(document, model.size() - 5, 50) == model.substr(model.size() - 5));
+
+    // Deleting everything leaves an empty document.
+    SELF_CHECK(document.replace(0, model.size(), "", 0, error));
+    SELF_CHECK(document.length() == 0 && document.getSpanCount() == 0);
+    document.close();
+}
+
+static void runSpanDocumentTests() {
+    testSpanDocumentEdits();
+}
+
+// --------------------------------------------------------------------------
+// sd_io_queue: SD requests serviced a slice per frame
+// --------------------------------------------------------------------------
+
+static const char* kIoQueueTestPath = "/.selftest/queue.txt";
+
+static std::string readHostFile(const char* path) {
+    std::ifstream file(mapPath(path), std::ios::binary);
+    return std::string((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+}
+
+static int serviceUntilIdle(SdIoQueue& queue, size_t budget) {
+    int frames = 0;
+    while (queue.service(budget) && frames < 1000) frames++;
+    return frames + 1;
+}
+
+static void testSdIoQueueTransfers() {
+    mountSD();
+    sdFat.mkdir(kJournalTestDir);
+    {
+        std::ofstream file(mapPath(kIoQueueTestPath), std::ios::binary | std::ios::trunc);
+        file << "old";
+    }
+    // A user's own "<name>.tmp" is not the save's temp file.
+    const std::string userTempPath = std::string(kIoQueueTestPath) + ".tmp";
+    {
+        std::ofstream file(mapPath(userTempPath.c_str()), std::ios::binary | std::ios::trunc);
+        file << "mine";
+    }
+    std::string text;
+    for (int line = 1; line <= 1500; line++) text += "queued line " + std::to_string(line) + "\n";
+
+    // A write moves one budget per frame and replaces the file at the end.
+    SdIoQueue queue;
+    String error;
+    const int write = queue.submitWrite(kIoQueueTestPath, text.data(), text.size(), error);
+    SELF_CHECK(write > 0 && queue.getState(write) == SdIoQueue::STATE_PENDING);
+    SELF_CHECK(queue.service(4096));
+    SELF_CHECK(queue.getState(write) == SdIoQueue::STATE_RUNNING);
+    SELF_CHECK(queue.getProgressPercent(write) == static_cast<int>(4096 * 100 / text.size()));
+    SELF_CHECK(readHostFile(kIoQueueTestPath) == "old");
+    const int frames = serviceUntilIdle(queue, 4096);
+    SELF_CHECK(frames + 1 == static_cast<int>((text.size() + 4095) / 4096));
+    SELF_CHECK(queue.getState(write) == SdIoQueue::STATE_DONE);
+    SELF_CHECK(readHostFile(kIoQueueTestPath) == text);
+    SELF_CHECK(!sdFat.exists(sdSaveTempPath(kIoQueueTestPath).c_str()));
+    SELF_CHECK(readHostFile(userTempPath.c_str()) == "mine");
+    sdFat.remove(userTempPath.c_str());
+    queue.release(write);
+    SELF_CHECK(queue.getState(write) == SdIoQueue::STATE_UNKNOWN);
+
+    // Append, read, stat and list run in order behind each other.
+    const int append = queue.submitAppend(kIoQueueTestPath, "tail\n", 5, error);
+    const int read = queue.submitRead(kIoQueueTestPath, 1 << 20, error);
+    const int stat = queue.submitStat(kIoQueueTestPath, error);
+    const int list = queue.submitList(kJournalTestDir, error);
+    const int tooBig = queue.submitRead(kIoQueueTestPath, 100, error);
+    const int missing = queue.submitRead("/.selftest/none.txt", 100, error);
+    serviceUntilIdle(queue, 1024);
+    const SdIoQueue::Request* readResult = queue.getRequest(read);
+    SELF_CHECK(queue.getState(append) == SdIoQueue::STATE_DONE);
+    SELF_CHECK(readResult != nullptr && readResult->state == SdIoQueue::STATE_DONE &&
+               std::string(readResult->data.data(), readResult->data.size()) == text + "tail\n");
+    const SdIoQueue::Request* statResult = queue.getRequest(stat);
+    SELF_CHECK(statResult != nullptr && !statResult->isDir && statResult->size == text.size() + 5);
+    const SdIoQueue::Request* listResult = queue.getRequest(list);
+    bool listed = false;
+    for (const SdIoQueue::ListEntry& entry : listResult->entries) {
+        if (entry.name == "queue.txt" && entry.size == text.size() + 5) listed = true;
+    }
+    SELF_CHECK(listed);
+    SELF_CHECK(queue.getState(tooBig) == SdIoQueue::STATE_FAILED);
+    SELF_CHECK(queue.getState(missing) == SdIoQueue::STATE_FAILED && queue.getRequest(missing)->error.length() > 0);
+    SELF_CHECK(queue.getCompletedCount() == 7);
+}
+
+static void countCompletion(const SdIoQueue::Request& request, void* context) {
+    if (request.state == SdIoQueue::STATE_DONE) (*static_cast<int*>(context))++;
+}
+
+struct CallbackProbe {
+    SdIoQueue* queue;
+    int other;            // Released from inside the callback
+    int submitted;        // Submitted from inside the callback, into a full queue
+    bool requestIntact;
+};
+
+static void probeCallback(const SdIoQueue::Request& request, void* context) {
+    CallbackProbe& probe = *static_cast<CallbackProbe*>(context);
+    String error;
+    const int handle = request.handle;
+    const size_t length = request.data.size();
+    probe.queue->release(probe.other);
+    probe.submitted = probe.queue->submitStat(kIoQueueTestPath, error);
+    probe.requestIntact = request.handle == handle && request.state == SdIoQueue::STATE_DONE &&
+                          length > 0 && request.data.size() == length;
+}
+
+static void testSdIoQueueLifecycle() {
+    SdIoQueue queue;
+    String error;
+    std::string text(20000, 'q');
+
+    // A write dropped part-way leaves the old file and no temp file.
+    const std::string before = readHostFile(kIoQueueTestPath);
+    const int write = queue.submitWrite(kIoQueueTestPath, text.data(), text.size(), error);
+    queue.service(4096);
+    queue.release(write);
+    SELF_CHECK(!queue.hasPendingWork());
+    SELF_CHECK(readHostFile(kIoQueueTestPath) == before);
+    SELF_CHECK(!sdFat.exists(sdSaveTempPath(kIoQueueTestPath).c_str()));
+
+    // Callback requests release themselves.
+    int completions = 0;
+    int handle = -1;
+    for (int i = 0; i < 3; i++) handle = queue.submitStat(kIoQueueTestPath, error, countCompletion, &completions);
+    serviceUntilIdle(queue, 4096);
+    SELF_CHECK(completions == 3 && queue.getRequest(handle) == nullptr);
+
+    // A full queue refuses new work; finished results stay until collected.
+    int first = -1;
+    for (int i = 0; i < SdIoQueue::MAX_REQUESTS; i++) {
+        const int handle = queue.submitStat(kIoQueueTestPath, error);
+        if (i == 0) first = handle;
+    }
+    SELF_CHECK(queue.submitStat(kIoQueueTestPath, error) < 0 && error.length() > 0);
+    serviceUntilIdle(queue, 4096);
+    SELF_CHECK(queue.submitStat(kIoQueueTestPath, error) < 0);
+    SELF_CHECK(queue.getState(first) == SdIoQueue::STATE_DONE);
+    queue.release(first);
+    const int extra = queue.submitStat(kIoQueueTestPath, error);
+    SELF_CHECK(extra > 0);
+    serviceUntilIdle(queue, 4096);
+    SELF_CHECK(queue.getState(extra) == SdIoQueue::STATE_DONE);
+    for (int handle = first; handle <= extra; handle++) queue.release(handle);
+
+    // A callback may submit and release freely; its own request stays put.
+    CallbackProbe probe = {&queue, -1, -1, false};
+    probe.other = queue.submitStat(kIoQueueTestPath, error);
+    for (int i = 0; i < SdIoQueue::MAX_REQUESTS - 2; i++) queue.submitStat(kIoQueueTestPath, error);
+    queue.submitRead(kIoQueueTestPath, 1 << 20, error, probeCallback, &probe);
+    serviceUntilIdle(queue, 4096);
+    SELF_CHECK(probe.requestIntact);
+    SELF_CHECK(probe.submitted < 0 && queue.getState(probe.other) == SdIoQueue::STATE_UNKNOWN);
+    SELF_CHECK(queue.submitStat(kIoQueueTestPath, error) > 0);
+
+    // Without a card every request fails instead of waiting forever.
+    unmountSD();
+    const int orphan = queue.submitRead(kIoQueueTestPath, 100, error);
+    SELF_CHECK(!queue.service(4096));
+    SELF_CHECK(queue.getState(orphan) == SdIoQueue::STATE_FAILED);
+    mountSD();
+    sdFat.remove(kIoQueueTestPath);
+}
+
+static void runSdIoQueueTests() {
+    testSdIoQueueTransfers();
+    testSdIoQueueLifecycle();
+}
+
+// --------------------------------------------------------------------------
+// display: dirty-tile flush against the panel's GDRAM
+// --------------------------------------------------------------------------
+
+static bool panelMatchesBuffer() {
+    return memcmp(u8g2.displayRam, u8g2.getBufferPtr(), sizeof(u8g2.displayRam)) == 0;
+}
+
+// Random boxes each frame, flushed through the dirty tiles. The mock applies
+// u8g2's partial-update pointer math, so a wrong transfer shows up as a
+// panel that no longer matches the buffer.
+static void testDisplayPartialFlush() {
+    Display::clear();
+    Display::flushFull();
+    SELF_CHECK(panelMatchesBuffer());
+
+    uint32_t seed = 99;
+    bool allMatch = true;
+    int sentFrames = 0;
+    for (int frame = 0; frame < 300 && allMatch; frame++) {
+        if (frame % 5 == 0) Display::clear();
+        for (int i = 0; i < 3; i++) {
+            seed = seed * 1103515245u + 12345u;
+            const int x = (seed >> 8) % 128;
+            const int y = (seed >> 16) % 64;
+            const int w = 1 + (seed >> 4) % 20;
+            const int h = 1 + (seed >> 24) % 12;
+            u8g2.setDrawColor((seed >> 12) % 4 == 0 ? 0 : 1);
+            Display::markDirty(x, y, w, h);
+            u8g2.drawBox(x, y, w, h);
+        }
+        u8g2.setDrawColor(1);
+        if (Display::flush() > 0) sentFrames++;
+        allMatch = panelMatchesBuffer();
+    }
+    SELF_CHECK(allMatch);
+    SELF_CHECK(sentFrames > 0);
+
+    // The mock reproduces the bug: a span narrower than a row, or one that
+    // does not start at tile 0, lands on the wrong bytes.
+    Display::clear();
+    Display::flushFull();
+    u8g2.drawBox(40, 16, 24, 8);
+    u8g2.updateDisplayArea(4, 2, 4, 1);
+    SELF_CHECK(!panelMatchesBuffer());
+    Display::flushFull();
+    SELF_CHECK(panelMatchesBuffer());
+}
+
+static void runDisplayTests() {
+    const bool terminalOutput = u8g2.terminalOutput;
+    u8g2.terminalOutput = false;
+    testDisplayPartialFlush();
+    Display::clear();
+    Display::flushFull();
+    u8g2.terminalOutput = terminalOutput;
+}
+
+} // namespace
+
+// --------------------------------------------------------------------------
+// t9_editor: incremental layout
+// --------------------------------------------------------------------------
+
+// Friend of T9EditorApp in emulator builds, so edits can be driven through
+// the same private paths the key handlers use.
+struct T9EditorLayoutSelfTest {
+    static bool sameRows(const std::vector<VisualLine>& a, const std::vector<VisualLine>& b) {
+        if (a.size() != b.size()) return false;
+        for (size_t i = 0; i < a.size(); i++) {
+            if (a[i].byteStartIndex != b[i].byteStartIndex || a[i].byteLength != b[i].byteLength ||
+                a[i].logicalLineNum != b[i].logicalLineNum || a[i].wrapped != b[i].wrapped) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Relayout after the pending edits, then again from scratch; both must
+    // give the same rows, cursor row and line count.
+    static bool matchesFullLayout(T9EditorApp& app) {
+        app.recalculateLayout();
+        const std::vector<VisualLine> incremental = app.visualLines;
+        const int cursorLine = app.cursorLineIndex;
+        const int lineCount = app.layoutLogicalLineCount;
+        app.invalidateLayout();
+        app.recalculateLayout();
+        return sameRows(incremental, app.visualLines) && cursorLine == app.cursorLineIndex &&
+               lineCount == app.layoutLogicalLineCount;
+    }
+
+    // Random edits, undo/redo, T9 and multi-tap previews and view mode
+    // changes, sometimes several edits per layout.
+    static void testRandomEdits() {
+        static const char* const kWords[] = {"alpha", "be", "c", "delta,", "epsilonic", "f.", "gamma_ray",
+                                             "\n", "\n\n", " ", "abcdefghijklmnopqrstuvwxyz0123"};
+        const int wordCount = static_cast<int>(sizeof(kWords) / sizeof(kWords[0]));
+        uint32_t seed = 7;
+        auto next = [&seed](int range) {
+            seed = seed * 1103515245u + 12345u;
+            return static_cast<int>((seed >> 8) % static_cast<uint32_t>(range));
+        };
+
+        T9EditorApp app;
+        String doc;
+        for (int i = 0; i < 400; i++) {
+            doc += kWords[next(wordCount)];
+            doc += ' ';
+        }
+        app.documentBuffer.assign(doc);
+        app.resetEditorSession();
+        app.recalculateLayout();
+        SELF_CHECK(!app.visualLines.empty());
+
+        int mismatches = 0;
+        for (int step = 0; step < 20000; step++) {
+            const int len = app.getDocumentLength();
+            const int op = next(10);
+            app.tapKey = '\0';
+            app.zeroPending = false;
+            if (op < 4) {
+                const int pos = next(len + 1);
+                String text = next(2) ? String(static_cast<char>('a' + next(26))) : String(kWords[next(wordCount)]);
+                app.cursorPos = pos;
+                app.replaceDocumentRange(pos, pos, text, pos + text.length(), false);
+            } else if (op < 7) {
+                const int pos = next(len + 1);
+                app.removeDocumentRange(pos, pos + next(12), false);
+            } else if (op < 8) {
+                app.cursorPos = next(len + 1);
+            } else if (op < 9) {
+                app.zeroPending = true;
+            } else {
+                app.inputMode = MODE_ABC;
+                app.tapKey = static_cast<char>('2' + next(7));
+                app.tapIndex = next(3);
+            }
+            if (next(3) == 0) {
+                const int pos = next(app.getDocumentLength() + 1);
+                app.replaceDocumentRange(pos, pos + next(3), "xy z\n", pos, false);
+            }
+            if (next(7) == 0) {
+                app.cursorPos = next(app.getDocumentLength() + 1);
+                app.tryInsertTextAtCursor("q", 1);
+                app.tryInsertTextAtCursor("r", 1);
+            }
+            if (next(9) == 0) app.undoEdit();
+            if (next(13) == 0) app.redoEdit();
+            if (next(500) == 0) app.viewMode = static_cast<T9ViewMode>(next(4));
+            if (app.getDocumentLength() > 12000) app.removeDocumentRange(0, 3000, false);
+            if (!matchesFullLayout(app) && mismatches++ == 0) {
+                std::printf("  layout mismatch at step %d (op %d)\n", step, op);
+            }
+            app.inputMode = MODE_T9;
+        }
+        SELF_CHECK(mismatches == 0);
+    }
+
+    static void run() {
+        testRandomEdits();
+    }
+};
+
+namespace {
+
+struct EmulatorSelfTest {
+    const char* name;
+    const char* description;
+    void (*run)();
+};
+
+static const EmulatorSelfTest kSelfTests[] = {
+    {"text_buffer", "gap buffer edits, ranges, iteration and UTF-8 helpers", runTextBufferTests},
+    {"undo_log", "delta undo/redo steps, typing coalescing and arena eviction", runUndoLogTests},
+    {"sd_session", "persistent SD mount, reuse counters, idle release and free-space scan", runSdSessionTests},
+    {"history_journal", "append-only history deltas, checkpoints, compaction and replay", runHistoryJournalTests},
+    {"history_index", "sorted history document index, single-page lookups and recovery", runHistoryIndexTests},
+    {"clipboard_ring", "RAM clipboard ring, dirty-slot write-back and slot checksums", runClipboardRingTests},
+    {"paged_reader", "line-aligned viewer pages, jump to line, page cache and index cache", runPagedReaderTests},
+    {"stream_search", "chunked BMH search, matches across chunk edges and wrap-around", runStreamSearchTests},
+    {"span_document", "copy-on-write spans over a file and reads across spans", runSpanDocumentTests},
+    {"sd_io_queue", "queued SD reads, writes, lists and stats in per-frame slices", runSdIoQueueTests},
+    {"display", "dirty-tile flush keeps the emulated ST7920 GDRAM in step with the buffer", runDisplayTests},
+    {"editor_layout", "incremental editor layout against a full re-layout over random edits", T9EditorLayoutSelfTest::run},
+};
+
+static bool runSuite(const EmulatorSelfTest& test) {
+    const int failuresBefore = gFailures;
+    const int checksBefore = gChecks;
+    test.run();
+    const int failed = gFailures - failuresBefore;
+    std::printf("%-16s %s (%d checks, %d failed)\n", test.name, failed == 0 ? "ok" : "FAILED",
+                gChecks - checksBefore, failed);
+    return failed == 0;
+}
+
+} // namespace
+
+void listEmulatorSelfTests() {
+    for (const EmulatorSelfTest& test : kSelfTests) {
+        std::printf("  %-16s %s\n", test.name, test.description);
+    }
+}
+
+int runEmulatorSelfTest(const std::string& name) {
+    bool found = false;
+    bool passed = true;
+    for (const EmulatorSelfTest& test : kSelfTests) {
+        if (name == "all" || name == test.name) {
+            found = true;
+            passed = runSuite(test) && passed;
+        }
+    }
+    if (!found) {
+        std::printf("Unknown test suite '%s'. Available:\n", name.c_str());
+        listEmulatorSelfTests();
+        return 2;
+    }
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,20 @@
+// PROJECT: ESP32-Handheld
+// MODULE: emulator_mocks/self_tests.h
+// STATUS: [Level 2 - Implementation]
+// TRUTH_LINK: TRUTH_PROJECT.md § Validation Boundary
+// LOG_REF: 2026-10-16
+
+#ifndef EMULATOR_SELF_TESTS_H
+#define EMULATOR_SELF_TESTS_H
+
+#include <string>
+
+// Host-side unit tests for firmware modules, selected with `--test <name>`
+// (or `--test all`). Each suite runs headless, prints one line per failed
+// check plus a summary, and returns a process exit code.
+int runEmulatorSelfTest(const std::string& name);
+
+// Print the names of all registered test suites.
+void listEmulatorSelfTests();
+
+#endif // EMULATOR_SELF_TESTS_H
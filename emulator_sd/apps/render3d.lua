@@ -22,6 +22,7 @@ APP = {
     shapes = {},
     perspective_enabled = true,
     culling_enabled = true,
+    fill_enabled = false,
     auto_rotate = true,
     speed_multiplier = 1.0,
     zoom_factor = 1.0,
@@ -32,14 +33,8 @@ APP = {
 function APP:createCube(size)
     local h = size / 2
     local vertices = {
-        {x = -h, y = -h, z = -h},
-        {x =  h, y = -h, z = -h},
-        {x =  h, y =  h, z = -h},
-        {x = -h, y =  h, z = -h},
-        {x = -h, y = -h, z =  h},
-        {x =  h, y = -h, z =  h},
-        {x =  h, y =  h, z =  h},
-        {x = -h, y =  h, z =  h}
+        {-h, -h, -h}, { h, -h, -h}, { h,  h, -h}, {-h,  h, -h},
+        {-h, -h,  h}, { h, -h,  h}, { h,  h,  h}, {-h,  h,  h}
     }
     local faces = {
         {1, 4, 3}, {1, 3, 2}, -- Front
@@ -49,17 +44,14 @@ function APP:createCube(size)
         {1, 5, 8}, {1, 8, 4}, -- Left
         {2, 3, 7}, {2, 7, 6}  -- Right
     }
-    return {vertices = vertices, faces = faces}
+    return gfx3d.mesh(vertices, faces)
 end
 
 function APP:createPyramid(size)
     local h = size / 2
     local vertices = {
-        {x = -h, y = -h, z = -h},
-        {x =  h, y = -h, z = -h},
-        {x =  h, y = -h, z =  h},
-        {x = -h, y = -h, z =  h},
-        {x =  0, y =  h, z =  0}
+        {-h, -h, -h}, { h, -h, -h}, { h, -h,  h}, {-h, -h,  h},
+        { 0,  h,  0}
     }
     local faces = {
         {1, 2, 3}, {1, 3, 4}, -- Base
@@ -68,24 +60,21 @@ function APP:createPyramid(size)
         {3, 5, 4},            -- Back
         {4, 5, 1}             -- Left
     }
-    return {vertices = vertices, faces = faces}
+    return gfx3d.mesh(vertices, faces)
 end
 
 function APP:createOctahedron(size)
     local h = size / 2
     local vertices = {
-        {x =  0, y =  h, z =  0}, -- Top Apex
-        {x =  0, y = -h, z =  0}, -- Bottom Apex
-        {x = -h, y =  0, z = -h},
-        {x =  h, y =  0, z = -h},
-        {x =  h, y =  0, z =  h},
-        {x = -h, y =  0, z =  h}
+        { 0,  h,  0}, -- Top Apex
+        { 0, -h,  0}, -- Bottom Apex
+        {-h,  0, -h}, { h,  0, -h}, { h,  0,  h}, {-h,  0,  h}
     }
     local faces = {
         {1, 4, 3}, {1, 5, 4}, {1, 6, 5}, {1, 3, 6}, -- Top faces
         {2, 3, 4}, {2, 4, 5}, {2, 5, 6}, {2, 6, 3}  -- Bottom faces
     }
-    return {vertices = vertices, faces = faces}
+    return gfx3d.mesh(vertices, faces)
 end
 
 function APP:createSphere(radius, lat_count, lon_count)
@@ -98,10 +87,11 @@ function APP:createSphere(radius, lat_count, lon_count)
         local cos_theta = math.cos(theta)
         for lon = 0, lon_count - 1 do
             local phi = lon * 2 * math.pi / lon_count
-            local x = radius * sin_theta * math.cos(phi)
-            local y = radius * cos_theta
-            local z = radius * sin_theta * math.sin(phi)
-            table.insert(vertices, {x = x, y = y, z = z})
+            vertices[#vertices + 1] = {
+                radius * sin_theta * math.cos(phi),
+                radius * cos_theta,
+                radius * sin_theta * math.sin(phi)
+            }
         end
     end
     
@@ -113,12 +103,12 @@ function APP:createSphere(radius, lat_count, lon_count)
             local p3 = (lat + 1) * lon_count + lon + 1
             local p4 = (lat + 1) * lon_count + next_lon + 1
             
-            table.insert(faces, {p1, p3, p2})
-            table.insert(faces, {p2, p3, p4})
+            faces[#faces + 1] = {p1, p2, p3}
+            faces[#faces + 1] = {p2, p4, p3}
         end
     end
     
-    return {vertices = vertices, faces = faces}
+    return gfx3d.mesh(vertices, faces)
 end
 
 function APP:spawnShapes()
@@ -138,7 +128,7 @@ function APP:spawnShapes()
     
     for i = 1, 3 do
         local factory = shape_factories[math.random(1, #shape_factories)]
-        local shape = factory(0.65)
+        local shape = {mesh = factory(0.65)}
         
         shape.pos = {
             x = positions[i].x + (math.random() - 0.5) * 0.25,
@@ -160,6 +150,9 @@ function APP:spawnShapes()
         
         table.insert(self.shapes, shape)
     end
+    
+    -- Far to near, so filled meshes overlap correctly
+    table.sort(self.shapes, function(a, b) return a.pos.z > b.pos.z end)
 end
 
 function APP:init()
@@ -167,48 +160,13 @@ function APP:init()
     self:spawnShapes()
     self.perspective_enabled = true
     self.culling_enabled = true
+    self.fill_enabled = false
     self.auto_rotate = true
     self.speed_multiplier = 1.0
     self.zoom_factor = 1.0
     self.camera_pan_x = 0.0
 end
 
-local function rotate_x(x, y, z, angle)
-    local cos_a = math.cos(angle)
-    local sin_a = math.sin(angle)
-    return x, y * cos_a - z * sin_a, y * sin_a + z * cos_a
-end
-
-local function rotate_y(x, y, z, angle)
-    local cos_a = math.cos(angle)
-    local sin_a = math.sin(angle)
-    return x * cos_a + z * sin_a, y, -x * sin_a + z * cos_a
-end
-
-local function rotate_z(x, y, z, angle)
-    local cos_a = math.cos(angle)
-    local sin_a = math.sin(angle)
-    return x * cos_a - y * sin_a, x * sin_a + y * cos_a, z
-end
-
-local function is_face_front(p1, p2, p3, is_perspective)
-    local ax = p2.x - p1.x
-    local ay = p2.y - p1.y
-    local az = p2.z - p1.z
-    local bx = p3.x - p1.x
-    local by = p3.y - p1.y
-    local bz = p3.z - p1.z
-    local nx = ay * bz - az * by
-    local ny = az * bx - ax * bz
-    local nz = ax * by - ay * bx
-    
-    if is_perspective then
-        return (nx * p1.x + ny * p1.y + nz * p1.z) < 0
-    else
-        return nz < 0
-    end
-end
-
 function APP:update()
     if not self.auto_rotate then return end
     
@@ -225,69 +183,23 @@ function APP:draw()
     
     local proj_str = self.perspective_enabled and "PERS" or "ORTH"
     local cull_str = self.culling_enabled and "CUL" or "OFF"
-    local info_str = string.format("%s|%s Z:%.1f P:%.1f", proj_str:sub(1,1), cull_str:sub(1,1), self.zoom_factor, self.camera_pan_x)
+    local fill_str = self.fill_enabled and "F" or "W"
+    local info_str = string.format("%s|%s|%s Z:%.1f P:%.1f", proj_str:sub(1,1), cull_str:sub(1,1), fill_str, self.zoom_factor, self.camera_pan_x)
     ui.header("3D Renderer", info_str)
     
     local layout = ui.metrics()
     local cx = math.floor(layout.screen_width / 2)
     local cy = math.floor((layout.content_top + layout.content_bottom) / 2)
+    local scale = (self.perspective_enabled and 90 or 22) * self.zoom_factor
+    gfx3d.setView(cx, cy, scale, self.perspective_enabled, self.culling_enabled)
     
-    local fov_scale = 90 * self.zoom_factor
-    local ortho_scale = 22 * self.zoom_factor
-    
+    local mode = self.fill_enabled and (gfx3d.FILL + gfx3d.WIREFRAME) or gfx3d.WIREFRAME
     for _, shape in ipairs(self.shapes) do
-        local transformed = {}
-        for _, v in ipairs(shape.vertices) do
-            local rx, ry, rz = rotate_y(v.x, v.y, v.z, shape.rot.y)
-            rx, ry, rz = rotate_x(rx, ry, rz, shape.rot.x)
-            rx, ry, rz = rotate_z(rx, ry, rz, shape.rot.z)
-            
-            local wx = rx + shape.pos.x - self.camera_pan_x
-            local wy = ry + shape.pos.y
-            local wz = rz + shape.pos.z
-            
-            table.insert(transformed, {x = wx, y = wy, z = wz})
-        end
-        
-        local projected = {}
-        for _, w in ipairs(transformed) do
-            local sx, sy
-            if self.perspective_enabled then
-                local depth = w.z
-                if depth < 0.1 then depth = 0.1 end
-                sx = cx + (w.x * fov_scale) / depth
-                sy = cy - (w.y * fov_scale) / depth
-            else
-                sx = cx + w.x * ortho_scale
-                sy = cy - w.y * ortho_scale
-            end
-            table.insert(projected, {x = math.floor(sx), y = math.floor(sy)})
-        end
-        
-        for _, face in ipairs(shape.faces) do
-            local p1 = transformed[face[1]]
-            local p2 = transformed[face[2]]
-            local p3 = transformed[face[3]]
-            
-            local show = true
-            if self.culling_enabled then
-                show = is_face_front(p1, p2, p3, self.perspective_enabled)
-            end
-            
-            if show then
-                for i = 1, #face do
-                    local next_idx = i % #face + 1
-                    local v1 = projected[face[i]]
-                    local v2 = projected[face[next_idx]]
-                    if v1 and v2 then
-                        gfx.line(v1.x, v1.y, v2.x, v2.y)
-                    end
-                end
-            end
-        end
+        local pos, rot = shape.pos, shape.rot
+        shape.mesh:draw(pos.x - self.camera_pan_x, pos.y, pos.z, rot.x, rot.y, rot.z, mode)
     end
     
-    ui.footer("1:Proj 2:Cull 3:Auto 4:New", "Arrows: Camera")
+    ui.footer("1:Proj 2:Cull 3:Auto 4:New 5:Fill", "Arrows: Camera")
 end
 
 function APP:input(key)
@@ -303,6 +215,9 @@ function APP:input(key)
     elseif key == "4" then
         self:spawnShapes()
         host.notice("Shapes Randomized", 1000)
+    elseif key == "5" then
+        self.fill_enabled = not self.fill_enabled
+        host.notice(self.fill_enabled and "Flat Fill" or "Wireframe", 1000)
     elseif key == input.KEY_UP then
         self.zoom_factor = math.min(3.0, self.zoom_factor + 0.1)
         host.notice(string.format("Zoom: %.1f", self.zoom_factor), 500)
@@ -178,23 +178,38 @@ def word_to_digits(word):
     return ''.join(digits)
 
 
-def digits_to_key(digits):
-    """Convert digit string to uint64 sort key.
-    
-    Left-aligned in a 15-digit field so that prefix ordering is
-    preserved in integer sort.  e.g. "7663" -> 766300000000000.
-    Max 15 digits supported.
+KEY_DIGITS = 16      # 6 bytes of 3-bit digit codes
+MAX_DIGITS = 15      # Longest sequence the length nibble can hold
+MAX_WORD_INDEX = 1 << 24
+BEST_DIGITS = 3      # Prefixes up to this long get a precomputed completion list
+BEST_COUNT = 64      # Completions kept per prefix (T9Predict::MAX_PREFIX_MATCHES)
+
+
+def digits_to_code(digits):
+    """Pack a digit string into a 48-bit code, 3 bits per digit (2-9 -> 0-7).
+
+    The first digit sits in the top bits and unused digits are zero, so
+    every sequence that starts with "7663" falls in the contiguous range
+    [code("7663"), code("7663") | low bits]. "2" and "22" share a code;
+    the explicit length breaks the tie, shorter first.
     """
-    key = 0
-    for i, d in enumerate(digits[:15]):
-        key = key * 10 + int(d)
-    # Left-align: pad to 15 digits
-    key *= 10 ** (15 - len(digits[:15]))
-    return key
+    code = 0
+    for d in digits:
+        code = (code << 3) | (int(d) - 2)
+    return code << (3 * (KEY_DIGITS - len(digits)))
+
+
+def digits_to_key(digits):
+    """Sort key: the packed code, then the digit count."""
+    return (digits_to_code(digits) << 4) | len(digits)
 
 
 def generate_dict(words, max_candidates_per_seq=8, max_word_len=15):
-    """Group words by T9 digit sequence and build index."""
+    """Group words by T9 digit sequence and build index.
+
+    Returns the sorted groups and each word's frequency rank, its position
+    in the de-duplicated input (0 = most common).
+    """
     
     # De-duplicate while preserving order (first occurrence wins = highest freq)
     seen = set()
@@ -209,17 +224,41 @@ def generate_dict(words, max_candidates_per_seq=8, max_word_len=15):
     groups = defaultdict(list)
     for word in unique_words:
         digits = word_to_digits(word)
-        if digits and len(digits) <= 15:
+        if digits and len(digits) <= MAX_DIGITS:
             if len(groups[digits]) < max_candidates_per_seq:
                 groups[digits].append(word)
     
     # Sort groups by digit key
     sorted_groups = sorted(groups.items(), key=lambda x: digits_to_key(x[0]))
+    ranks = {w: i for i, w in enumerate(unique_words)}
     
-    return sorted_groups
+    return sorted_groups, ranks
+
+
+def best_slot(digits):
+    """Row of a 1..BEST_DIGITS digit prefix in t9_best_starts.
+
+    Rows run through all 1-digit prefixes, then 2-digit, then 3-digit, each
+    block in digit order, so "2" is 0, "9" is 7, "22" is 8 and "999" is 583.
+    """
+    base = sum(8 ** n for n in range(1, len(digits)))
+    value = 0
+    for d in digits:
+        value = value * 8 + (int(d) - 2)
+    return base + value
 
 
-def emit_header(sorted_groups, out=sys.stdout):
+def best_completions(sorted_groups, word_ids, ranks):
+    """Top BEST_COUNT word ids by rank for every prefix up to BEST_DIGITS."""
+    slots = [[] for _ in range(sum(8 ** n for n in range(1, BEST_DIGITS + 1)))]
+    for digits, word_list in sorted_groups:
+        for w in word_list:
+            for n in range(1, min(len(digits), BEST_DIGITS) + 1):
+                slots[best_slot(digits[:n])].append(w)
+    return [[word_ids[w] for w in sorted(slot, key=lambda w: ranks[w])[:BEST_COUNT]] for slot in slots]
+
+
+def emit_header(sorted_groups, ranks, out=sys.stdout):
     """Emit C header with PROGMEM dictionary data."""
     
     total_words = sum(len(ws) for _, ws in sorted_groups)
@@ -228,15 +267,23 @@ def emit_header(sorted_groups, out=sys.stdout):
     word_pool = bytearray()
     index_entries = []
     
+    word_starts = []
+    word_ids = {}
+    
     for digits, word_list in sorted_groups:
-        key = digits_to_key(digits)
-        offset = len(word_pool)
+        first_word = len(word_starts)
         count = len(word_list)
         for w in word_list:
+            word_ids[w] = len(word_starts)
+            word_starts.append(len(word_pool))
             word_pool.extend(w.encode('ascii'))
             word_pool.append(0)
-        index_entries.append((key, offset, count))
-    
+        index_entries.append((digits, first_word, count))
+    word_starts.append(len(word_pool))
+    assert len(word_starts) < MAX_WORD_INDEX, 'word count does not fit 24-bit indices'
+    assert len(word_starts) <= 1 << 16, 'word count does not fit 16-bit ranks and completions'
+    best = best_completions(sorted_groups, word_ids, ranks)
+
     out.write('// AUTO-GENERATED — do not edit. Run: python3 scripts/gen_t9_dict.py > src/t9_dict.h\n')
     out.write(f'// {len(index_entries)} digit sequences, {total_words} words, {len(word_pool)} bytes word pool\n')
     out.write('#ifndef T9_DICT_DATA_H\n')
@@ -244,11 +291,11 @@ def emit_header(sorted_groups, out=sys.stdout):
     out.write('#include <Arduino.h>\n\n')
     
     # Index entry struct
+    out.write('// 10 bytes, sorted by code then length so every prefix is one range.\n')
     out.write('struct T9IndexEntry {\n')
-    out.write('    uint64_t key;      // Digit sequence as decimal (e.g., "4663" = 4663)\n')
-    out.write('    uint32_t offset;   // Byte offset into t9_word_pool\n')
-    out.write('    uint8_t  count;    // Number of words for this sequence\n')
-    out.write('    uint8_t  _pad[3];\n')
+    out.write('    uint8_t code[6];      // 3 bits per digit (digit - 2), first digit in the top bits\n')
+    out.write('    uint8_t lengthCount;  // Digit count << 4 | number of words\n')
+    out.write('    uint8_t firstWord[3]; // Index of the first word in t9_word_starts, little-endian\n')
     out.write('};\n\n')
     
     # Word pool
@@ -261,23 +308,63 @@ def emit_header(sorted_groups, out=sys.stdout):
         out.write(f'    {hex_vals},  // {ascii_repr}\n')
     out.write('};\n\n')
     
+    # Word starts: word i is t9_word_pool[starts[i] .. starts[i + 1] - 1),
+    # NUL-terminated, so any candidate is one lookup away.
+    out.write(f'const uint32_t t9_word_starts[{len(word_starts)}] PROGMEM = {{\n')
+    for i in range(0, len(word_starts), 8):
+        out.write('    ' + ', '.join(str(v) for v in word_starts[i:i+8]) + ',\n')
+    out.write('};\n\n')
+    
+    # Ranks: words of one sequence are stored most common first, so within
+    # an index entry the ranks only grow.
+    word_ranks = [0] * (len(word_starts) - 1)
+    for w, i in word_ids.items():
+        word_ranks[i] = min(ranks[w], 0xFFFF)
+    out.write('// Frequency rank of each word, 0 = most common.\n')
+    out.write(f'const uint16_t t9_word_ranks[{len(word_ranks)}] PROGMEM = {{\n')
+    for i in range(0, len(word_ranks), 12):
+        out.write('    ' + ', '.join(str(v) for v in word_ranks[i:i+12]) + ',\n')
+    out.write('};\n\n')
+
+    # Best completions: the most common words starting with each short
+    # prefix, as word indices, in rank order. Prefix row r owns
+    # t9_best_words[t9_best_starts[r] .. t9_best_starts[r + 1]).
+    best_starts = [0]
+    for slot in best:
+        best_starts.append(best_starts[-1] + len(slot))
+    best_words = [w for slot in best for w in slot]
+    out.write('// Rows: "2".."9", then "22".."99", then "222".."999".\n')
+    out.write(f'const uint16_t t9_best_starts[{len(best_starts)}] PROGMEM = {{\n')
+    for i in range(0, len(best_starts), 12):
+        out.write('    ' + ', '.join(str(v) for v in best_starts[i:i+12]) + ',\n')
+    out.write('};\n\n')
+    out.write(f'const uint16_t t9_best_words[{len(best_words)}] PROGMEM = {{\n')
+    for i in range(0, len(best_words), 12):
+        out.write('    ' + ', '.join(str(v) for v in best_words[i:i+12]) + ',\n')
+    out.write('};\n\n')
+
     # Index
     out.write(f'const T9IndexEntry t9_index[{len(index_entries)}] PROGMEM = {{\n')
-    for key, offset, count in index_entries:
-        # Recover digit string for comment
-        digit_str = str(key)
+    for digits, first, count in index_entries:
+        code = digits_to_code(digits).to_bytes(6, 'big')
+        code_vals = ', '.join(f'0x{b:02X}' for b in code)
+        first_vals = ', '.join(f'0x{b:02X}' for b in first.to_bytes(3, 'little'))
+        offset = word_starts[first]
         # Find first word for context
         first_word = ''
         for b in word_pool[offset:offset+30]:
             if b == 0:
                 break
             first_word += chr(b)
-        out.write(f'    {{{key}ULL, {offset}, {count}, {{0}}}},')
-        out.write(f'  // "{digit_str}" -> "{first_word}"...\n')
+        out.write(f'    {{{{{code_vals}}}, 0x{(len(digits) << 4) | count:02X}, {{{first_vals}}}}},')
+        out.write(f'  // "{digits}" -> "{first_word}"...\n')
     out.write('};\n\n')
     
     out.write(f'const uint32_t T9_INDEX_COUNT = {len(index_entries)};\n')
-    out.write(f'const uint32_t T9_WORD_POOL_SIZE = {len(word_pool)};\n\n')
+    out.write(f'const uint32_t T9_WORD_POOL_SIZE = {len(word_pool)};\n')
+    out.write(f'const uint32_t T9_WORD_COUNT = {len(word_starts) - 1};\n')
+    out.write(f'const int T9_BEST_DIGITS = {BEST_DIGITS};\n')
+    out.write(f'const int T9_BEST_COUNT = {BEST_COUNT};\n\n')
     out.write('#endif // T9_DICT_DATA_H\n')
 
 
@@ -313,8 +400,8 @@ def main():
         words.extend(LUA_WORDS)
         print(f'// Source: built-in + lua ({len(words)} input words)', file=sys.stderr)
     
-    sorted_groups = generate_dict(words)
-    emit_header(sorted_groups)
+    sorted_groups, ranks = generate_dict(words)
+    emit_header(sorted_groups, ranks)
     
     total_words = sum(len(ws) for _, ws in sorted_groups)
     print(f'// Generated: {len(sorted_groups)} sequences, {total_words} words', file=sys.stderr)
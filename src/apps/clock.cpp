@@ -125,18 +125,18 @@ void ClockApp::render() {
     char timeBuf[12];
     snprintf(timeBuf, sizeof(timeBuf), "%02d:%02d:%02d", h, m, s);
     
-    int width = u8g2.getStrWidth(timeBuf);
+    int width = GUI::getTextWidth(timeBuf);
     int x = (GUI::SCREEN_WIDTH - width) / 2;
     int y = GUI::getContentBaselineStart() + metrics.lineHeight;
     
-    u8g2.drawStr(x, y, timeBuf);
+    GUI::drawText(x, y, timeBuf);
     
     // In edit mode, draw underline for selected field
     if (editMode && blinkOn) {
         // Calculate position of each field
         // Format: "HH:MM:SS" - each digit pair is ~18px wide at this font
-        int charWidth = u8g2.getStrWidth("00");
-        int colonWidth = u8g2.getStrWidth(":");
+        int charWidth = GUI::getTextWidth("00");
+        int colonWidth = GUI::getTextWidth(":");
         
         int fieldX = x;
         if (editField == 1) fieldX = x + charWidth + colonWidth;
@@ -351,12 +351,12 @@ void FileBrowserApp::renderLuaRunning() {
     String name = currentLuaScript;
     if (name.startsWith("/")) name = name.substring(1);
     name = GUI::truncateStringToWidth(name, GUI::SCREEN_WIDTH - 4);
-    u8g2.drawUTF8(2, GUI::getContentBaselineStart(), name.c_str());
-    u8g2.drawUTF8(2, GUI::getContentBaselineStart() + (metrics.lineHeight * 2), "Press ESC to exit");
+    GUI::drawText(2, GUI::getContentBaselineStart(), name.c_str());
+    GUI::drawText(2, GUI::getContentBaselineStart() + (metrics.lineHeight * 2), "Press ESC to exit");
     
     char memStr[32];
     snprintf(memStr, sizeof(memStr), "Mem: %d KB", (int)(LuaVM::getMemoryUsage() / 1024));
-    u8g2.drawUTF8(2, GUI::getFooterBaselineY(), memStr);
+    GUI::drawText(2, GUI::getFooterBaselineY(), memStr);
 }
 
 void FileBrowserApp::renderLuaError() {
@@ -366,14 +366,14 @@ void FileBrowserApp::renderLuaError() {
     
     int y = GUI::getContentBaselineStart();
     int lineStart = 0;
-    int charWidth = static_cast<int>(u8g2.getStrWidth("W"));
+    int charWidth = static_cast<int>(GUI::getTextWidth("W"));
     if (charWidth < 1) charWidth = 1;
     const int maxChars = max(1, (GUI::SCREEN_WIDTH - 4) / charWidth);
     
     for (int i = 0; i <= (int)luaErrorMessage.length() && y <= GUI::getContentBottom(); i++) {
         if (i == (int)luaErrorMessage.length() || (i - lineStart) >= maxChars) {
             String line = GUI::truncateStringToWidth(luaErrorMessage.substring(lineStart, i), GUI::SCREEN_WIDTH - 4);
-            u8g2.drawUTF8(2, y, line.c_str());
+            GUI::drawText(2, y, line.c_str());
             y += metrics.lineHeight;
             lineStart = i;
         }
@@ -420,7 +420,7 @@ void FileBrowserApp::renderFileList() {
         }
 
         String displayName = GUI::truncateStringToWidth(fileList[listIndex].name, GUI::SCREEN_WIDTH - GUI::SCROLLBAR_WIDTH - 6);
-        u8g2.drawUTF8(2, y, displayName.c_str());
+        GUI::drawText(2, y, displayName.c_str());
 
         if (isSelected) u8g2.setDrawColor(1);
     }
@@ -53,28 +53,28 @@ void KeyTesterApp::render() {
     const GUI::FontMetrics& metrics = GUI::getSystemFontMetrics();
 
     // Last Key Display
-    u8g2.drawUTF8(0, GUI::getContentBaselineStart(), "LAST:");
+    GUI::drawText(0, GUI::getContentBaselineStart(), "LAST:");
     if (lastPressedKey != ' ') {
         const char* name = getKeyName(lastPressedKey);
         if (name) {
-            u8g2.drawStr(35, GUI::getContentBaselineStart() + metrics.lineHeight, name);
+            GUI::drawText(35, GUI::getContentBaselineStart() + metrics.lineHeight, name);
         } else {
             char keyStr[2] = {lastPressedKey, '\0'}; 
-            u8g2.drawUTF8(50, GUI::getContentBaselineStart() + metrics.lineHeight, keyStr);
+            GUI::drawText(50, GUI::getContentBaselineStart() + metrics.lineHeight, keyStr);
         }
     }
     
-    u8g2.drawUTF8(0, GUI::getFooterBaselineY(), "HELD:");
+    GUI::drawText(0, GUI::getFooterBaselineY(), "HELD:");
     int xPos = 28;
     
     for(int i=0; i<activeKeyCount; i++) {
         const char* name = getKeyName(activeKeys[i]);
         if (name) {
-            u8g2.drawStr(xPos, GUI::getFooterBaselineY(), name);
-            xPos += u8g2.getStrWidth(name) + 3;
+            GUI::drawText(xPos, GUI::getFooterBaselineY(), name);
+            xPos += GUI::getTextWidth(name) + 3;
         } else {
             char buf[4] = {'[', activeKeys[i], ']', '\0'};
-            u8g2.drawStr(xPos, GUI::getFooterBaselineY(), buf);
+            GUI::drawText(xPos, GUI::getFooterBaselineY(), buf);
             xPos += 15;
         }
     }
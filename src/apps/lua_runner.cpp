@@ -55,8 +55,8 @@ void LuaRunnerApp::drawBrowser() {
     
     if (fileCount == 0) {
         GUI::setFontSystem();
-        u8g2.drawUTF8(10, GUI::getContentBaselineStart() + metrics.lineHeight, "No .lua files found");
-        u8g2.drawUTF8(10, GUI::getContentBaselineStart() + (metrics.lineHeight * 2), "Upload via SPIFFS");
+        GUI::drawText(10, GUI::getContentBaselineStart() + metrics.lineHeight, "No .lua files found");
+        GUI::drawText(10, GUI::getContentBaselineStart() + (metrics.lineHeight * 2), "Upload via SPIFFS");
     } else {
         GUI::setFontSystem();
         for (int i = 0; i < visibleLines && (scrollOffset + i) < fileCount; i++) {
@@ -73,7 +73,7 @@ void LuaRunnerApp::drawBrowser() {
                 displayName = displayName.substring(1);
             }
             displayName = GUI::truncateStringToWidth(displayName, GUI::SCREEN_WIDTH - GUI::SCROLLBAR_WIDTH - 6);
-            u8g2.drawUTF8(2, y, displayName.c_str());
+            GUI::drawText(2, y, displayName.c_str());
             
             u8g2.setDrawColor(1);
         }
@@ -97,13 +97,13 @@ void LuaRunnerApp::drawRunning() {
     String name = currentScript;
     if (name.startsWith("/")) name = name.substring(1);
     name = GUI::truncateStringToWidth(name, GUI::SCREEN_WIDTH - 4);
-    u8g2.drawUTF8(2, GUI::getContentBaselineStart(), name.c_str());
+    GUI::drawText(2, GUI::getContentBaselineStart(), name.c_str());
     
-    u8g2.drawUTF8(2, GUI::getContentBaselineStart() + (metrics.lineHeight * 2), "Press ESC to exit");
+    GUI::drawText(2, GUI::getContentBaselineStart() + (metrics.lineHeight * 2), "Press ESC to exit");
     
     char memStr[32];
     snprintf(memStr, sizeof(memStr), "Mem: %d KB", (int)(LuaVM::getMemoryUsage() / 1024));
-    u8g2.drawUTF8(2, GUI::getFooterBaselineY(), memStr);
+    GUI::drawText(2, GUI::getFooterBaselineY(), memStr);
 }
 
 void LuaRunnerApp::drawError() {
@@ -114,14 +114,14 @@ void LuaRunnerApp::drawError() {
     
     int y = GUI::getContentBaselineStart();
     int lineStart = 0;
-    int charWidth = static_cast<int>(u8g2.getStrWidth("W"));
+    int charWidth = static_cast<int>(GUI::getTextWidth("W"));
     if (charWidth < 1) charWidth = 1;
     int maxChars = max(1, (GUI::SCREEN_WIDTH - 4) / charWidth);
     
     for (int i = 0; i <= (int)errorMessage.length() && y <= GUI::getContentBottom(); i++) {
         if (i == (int)errorMessage.length() || (i - lineStart) >= maxChars) {
             String line = GUI::truncateStringToWidth(errorMessage.substring(lineStart, i), GUI::SCREEN_WIDTH - 4);
-            u8g2.drawUTF8(2, y, line.c_str());
+            GUI::drawText(2, y, line.c_str());
             y += metrics.lineHeight;
             lineStart = i;
         }
@@ -9,6 +9,7 @@
 #include "../app_control.h"
 #include "../app_transfer.h"
 #include "../gui.h"
+#include "../display.h"
 #include "../lua_binding_help.h"
 #include "../lua_blank_app_template.h"
 #include "../config.h"
@@ -21,7 +22,6 @@ extern T9EditorApp appT9Editor;
 extern bool sleepEnabled;
 
 static const char* kSettingsBatteryStub = "BAT --.-V";
-static const uint32_t kSettingsPhysicalRamK = 320;
 
 namespace {
 
@@ -156,6 +156,7 @@ static bool createBlankLuaAppOnSd(String& createdPath, String& error) {
             error = String("Failed to sync: ") + candidate;
             return false;
         }
+        sdNoteFileResized(0, templateText.length());
 
         createdPath = candidate;
         return true;
@@ -254,7 +255,7 @@ static void drawHighlightedChoiceBar(int xStart, int baselineY, const char* choi
     int safeCount = min(count, 40);
     for (int i = 0; i < safeCount; i++) {
         char item[2] = {choices[i], '\0'};
-        widths[i] = u8g2.getStrWidth(item) + 2;
+        widths[i] = GUI::getTextWidth(item) + 2;
     }
 
     int startIndex = 0;
@@ -267,14 +268,14 @@ static void drawHighlightedChoiceBar(int xStart, int baselineY, const char* choi
 
     int x = xStart;
     if (startIndex > 0) {
-        u8g2.drawStr(x, baselineY, "<");
-        x += u8g2.getStrWidth("<") + 2;
+        GUI::drawText(x, baselineY, "<");
+        x += GUI::getTextWidth("<") + 2;
     }
 
     bool clippedRight = false;
     for (int i = startIndex; i < safeCount; i++) {
         char item[2] = {choices[i], '\0'};
-        int charWidth = u8g2.getStrWidth(item);
+        int charWidth = GUI::getTextWidth(item);
         int paddedWidth = charWidth + 2;
         if (x + paddedWidth > GUI::SCREEN_WIDTH - 5) {
             clippedRight = (i < safeCount);
@@ -284,16 +285,16 @@ static void drawHighlightedChoiceBar(int xStart, int baselineY, const char* choi
         if (i == selectedIndex) {
             u8g2.drawBox(x - 1, GUI::getHighlightTop(baselineY), paddedWidth + 1, GUI::getHighlightHeight());
             u8g2.setDrawColor(0);
-            u8g2.drawStr(x, baselineY, item);
+            GUI::drawText(x, baselineY, item);
             u8g2.setDrawColor(1);
         } else {
-            u8g2.drawStr(x, baselineY, item);
+            GUI::drawText(x, baselineY, item);
         }
         x += paddedWidth;
     }
 
     if (clippedRight) {
-        u8g2.drawStr(GUI::SCREEN_WIDTH - 5, baselineY, ">");
+        GUI::drawText(GUI::SCREEN_WIDTH - 5, baselineY, ">");
     }
 }
 
@@ -574,12 +575,12 @@ void SettingsApp::renderInfoHeader() {
 
     auto drawInfoRow = [](int baselineY, const char* leftText, const char* rightText) {
         if (leftText && leftText[0] != '\0') {
-            u8g2.drawStr(2, baselineY, leftText);
+            GUI::drawText(2, baselineY, leftText);
         }
         if (rightText && rightText[0] != '\0') {
-            int rightX = GUI::SCREEN_WIDTH - 2 - u8g2.getStrWidth(rightText);
+            int rightX = GUI::SCREEN_WIDTH - 2 - GUI::getTextWidth(rightText);
             if (rightX < 2) rightX = 2;
-            u8g2.drawStr(rightX, baselineY, rightText);
+            GUI::drawText(rightX, baselineY, rightText);
         }
     };
 
@@ -588,8 +589,9 @@ void SettingsApp::renderInfoHeader() {
     snprintf(heapLeft, sizeof(heapLeft), "HEAP %lu/%luk",
              static_cast<unsigned long>(usedHeapK),
              static_cast<unsigned long>(totalHeapK));
-    snprintf(heapRight, sizeof(heapRight), "INT %luk",
-             static_cast<unsigned long>(kSettingsPhysicalRamK));
+    // Share of identical frames whose LCD transfer was skipped. A raw
+    // counter would change every frame and defeat the suppression itself.
+    snprintf(heapRight, sizeof(heapRight), "SKIP %d%%", Display::getSkippedFramePercent());
     const int row1Y = infoMetrics.baselineOffset;
     const int row2Y = row1Y + infoMetrics.lineHeight;
     const int row3Y = row2Y + infoMetrics.lineHeight;
@@ -610,7 +612,13 @@ void SettingsApp::renderInfoHeader() {
     SystemClock::getTimeString(timeBuf, sizeof(timeBuf));
 
     char sdLeft[24];
-    if (isSDMounted()) {
+    if (isSDMounted() && sdIsUsedBytesUnknown()) {
+        const uint64_t totalMb = sdTotalBytes() / (1024 * 1024);
+        snprintf(sdLeft, sizeof(sdLeft), "SD ?/%lluM", static_cast<unsigned long long>(totalMb));
+    } else if (isSDMounted() && !sdIsUsedBytesReady()) {
+        const uint64_t totalMb = sdTotalBytes() / (1024 * 1024);
+        snprintf(sdLeft, sizeof(sdLeft), "SD ../%lluM", static_cast<unsigned long long>(totalMb));
+    } else if (isSDMounted()) {
         const uint64_t totalMb = sdTotalBytes() / (1024 * 1024);
         const uint64_t usedMb = sdUsedBytes() / (1024 * 1024);
         snprintf(sdLeft, sizeof(sdLeft), "SD %llu/%lluM",
@@ -703,7 +711,7 @@ void SettingsApp::renderSettingsList() {
         }
 
         String text = GUI::truncateStringToWidth(String(buf), GUI::SCREEN_WIDTH - GUI::SCROLLBAR_WIDTH - 6);
-        u8g2.drawUTF8(2, y, text.c_str());
+        GUI::drawText(2, y, text.c_str());
         if (isSelected) u8g2.setDrawColor(0);
     }
 
@@ -745,10 +753,10 @@ void SettingsApp::renderKeyTester() {
 
     char lineBuf[32];
     snprintf(lineBuf, sizeof(lineBuf), "LAST:%s", lastBuf);
-    u8g2.drawStr(0, line1, lineBuf);
+    GUI::drawText(0, line1, lineBuf);
 
     snprintf(lineBuf, sizeof(lineBuf), "EVT:%s", keyHistory);
-    u8g2.drawStr(0, line2, lineBuf);
+    GUI::drawText(0, line2, lineBuf);
 
     const uint32_t rawDelta = getMatrixRawHitCount() - keyTesterRawHitBaseline;
     const uint32_t latchedDelta = getMatrixLatchedHitCount() - keyTesterLatchedBaseline;
@@ -758,30 +766,30 @@ void SettingsApp::renderKeyTester() {
     snprintf(lineBuf, sizeof(lineBuf), "RAW:%lu LAT:%lu",
              static_cast<unsigned long>(rawDelta),
              static_cast<unsigned long>(latchedDelta));
-    u8g2.drawStr(0, line3, lineBuf);
+    GUI::drawText(0, line3, lineBuf);
 
     snprintf(lineBuf, sizeof(lineBuf), "DUP:%lu IN:%lu",
              static_cast<unsigned long>(duplicateDelta),
              static_cast<unsigned long>(keyTesterDeliveredCount));
-    u8g2.drawStr(0, line4, lineBuf);
+    GUI::drawText(0, line4, lineBuf);
 
     snprintf(lineBuf, sizeof(lineBuf), "SET:%uus P:%lu",
              static_cast<unsigned>(getMatrixSettleDelayUs()),
              static_cast<unsigned long>(pollDelta));
-    u8g2.drawStr(0, line5, lineBuf);
+    GUI::drawText(0, line5, lineBuf);
 
-    u8g2.drawStr(0, GUI::getFooterBaselineY() - metrics.lineHeight, "A+L/R:set A+E:rst");
+    GUI::drawText(0, GUI::getFooterBaselineY() - metrics.lineHeight, "A+L/R:set A+E:rst");
 
     int xPos = 28;
-    u8g2.drawUTF8(0, GUI::getFooterBaselineY(), "HLD:");
+    GUI::drawText(0, GUI::getFooterBaselineY(), "HLD:");
     for (int i = 0; i < activeKeyCount; i++) {
         const char* name = getKeyName(activeKeys[i]);
         if (name) {
-            u8g2.drawStr(xPos, GUI::getFooterBaselineY(), name);
-            xPos += u8g2.getStrWidth(name) + 3;
+            GUI::drawText(xPos, GUI::getFooterBaselineY(), name);
+            xPos += GUI::getTextWidth(name) + 3;
         } else {
             char buf[4] = {'[', activeKeys[i], ']', '\0'};
-            u8g2.drawStr(xPos, GUI::getFooterBaselineY(), buf);
+            GUI::drawText(xPos, GUI::getFooterBaselineY(), buf);
             xPos += 15;
         }
     }
@@ -826,9 +834,9 @@ void SettingsApp::renderLcdTest() {
         u8g2.drawBox(0, 0, 128, 64);
         u8g2.setDrawColor(0);
         GUI::setFontSystem();
-        u8g2.drawStr(2, 8, "ALL PIXELS ON");
-        u8g2.drawStr(108, 8, stepBuf);
-        u8g2.drawStr(36, 63, "Enter:Next");
+        GUI::drawText(2, 8, "ALL PIXELS ON");
+        GUI::drawText(108, 8, stepBuf);
+        GUI::drawText(36, 63, "Enter:Next");
         u8g2.setDrawColor(1);
         break;
     }
@@ -845,10 +853,10 @@ void SettingsApp::renderLcdTest() {
         GUI::setFontSystem();
         u8g2.drawBox(0, 0, 128, 9);
         u8g2.setDrawColor(0);
-        u8g2.drawStr(2, 8, "ALL HLINES");
-        u8g2.drawStr(108, 8, stepBuf);
+        GUI::drawText(2, 8, "ALL HLINES");
+        GUI::drawText(108, 8, stepBuf);
         u8g2.setDrawColor(1);
-        u8g2.drawStr(36, 63, "Enter:Next");
+        GUI::drawText(36, 63, "Enter:Next");
         break;
     }
 
@@ -860,10 +868,10 @@ void SettingsApp::renderLcdTest() {
         GUI::setFontSystem();
         u8g2.drawBox(0, 0, 128, 9);
         u8g2.setDrawColor(0);
-        u8g2.drawStr(2, 8, "EVEN ROWS");
-        u8g2.drawStr(108, 8, stepBuf);
+        GUI::drawText(2, 8, "EVEN ROWS");
+        GUI::drawText(108, 8, stepBuf);
         u8g2.setDrawColor(1);
-        u8g2.drawStr(36, 63, "Enter:Next");
+        GUI::drawText(36, 63, "Enter:Next");
         break;
     }
 
@@ -875,10 +883,10 @@ void SettingsApp::renderLcdTest() {
         GUI::setFontSystem();
         u8g2.drawBox(0, 0, 128, 9);
         u8g2.setDrawColor(0);
-        u8g2.drawStr(2, 8, "ODD ROWS");
-        u8g2.drawStr(108, 8, stepBuf);
+        GUI::drawText(2, 8, "ODD ROWS");
+        GUI::drawText(108, 8, stepBuf);
         u8g2.setDrawColor(1);
-        u8g2.drawStr(36, 63, "Enter:Next");
+        GUI::drawText(36, 63, "Enter:Next");
         break;
     }
 
@@ -892,12 +900,12 @@ void SettingsApp::renderLcdTest() {
                 u8g2.setDrawColor(0);
                 char buf[8];
                 snprintf(buf, sizeof(buf), "%d-%d", y0, y0 + 7);
-                u8g2.drawStr(2, y0 + 7, buf);
+                GUI::drawText(2, y0 + 7, buf);
                 u8g2.setDrawColor(1);
             } else {
                 char buf[8];
                 snprintf(buf, sizeof(buf), "%d-%d", y0, y0 + 7);
-                u8g2.drawStr(2, y0 + 7, buf);
+                GUI::drawText(2, y0 + 7, buf);
             }
         }
         break;
@@ -920,10 +928,10 @@ void SettingsApp::renderLcdTest() {
         GUI::setFontSystem();
         u8g2.drawBox(0, 0, 128, 9);
         u8g2.setDrawColor(0);
-        u8g2.drawStr(2, 8, "8px GRID");
-        u8g2.drawStr(108, 8, stepBuf);
+        GUI::drawText(2, 8, "8px GRID");
+        GUI::drawText(108, 8, stepBuf);
         u8g2.setDrawColor(1);
-        u8g2.drawStr(28, 63, "Enter:Exit");
+        GUI::drawText(28, 63, "Enter:Exit");
         break;
     }
 
@@ -1170,12 +1178,12 @@ void SettingsApp::renderSdTest() {
 
     int y = GUI::getContentAreaTop() + metrics.baselineOffset;
     for (int i = 0; i < sdTestLineCount && y <= GUI::getContentBottom() - metrics.lineHeight; i++) {
-        u8g2.drawStr(1, y, sdTestResults[i]);
+        GUI::drawText(1, y, sdTestResults[i]);
         y += metrics.lineHeight;
     }
 
     GUI::setFontSystem();
-    u8g2.drawStr(1, GUI::getFooterBaselineY(), "Esc:Back  >:Retest");
+    GUI::drawText(1, GUI::getFooterBaselineY(), "Esc:Back  >:Retest");
 }
 
 // --------------------------------------------------------------------------
@@ -1351,20 +1359,20 @@ void SettingsApp::t9HandleSavePromptInput(char key) {
 void SettingsApp::renderT9SavePrompt() {
     u8g2.drawBox(16, 18, 96, 28);
     u8g2.setDrawColor(0);
-    u8g2.drawStr(22, 30, "Save buffer?");
+    GUI::drawText(22, 30, "Save buffer?");
 
     const bool noSel = (t9SavePromptSelection == 0);
     if (noSel) {
         u8g2.drawBox(24, 34, 26, 10);
         u8g2.setDrawColor(1);
-        u8g2.drawStr(29, 42, "No");
+        GUI::drawText(29, 42, "No");
         u8g2.setDrawColor(0);
-        u8g2.drawStr(68, 42, "Yes");
+        GUI::drawText(68, 42, "Yes");
     } else {
-        u8g2.drawStr(29, 42, "No");
+        GUI::drawText(29, 42, "No");
         u8g2.drawBox(62, 34, 30, 10);
         u8g2.setDrawColor(1);
-        u8g2.drawStr(68, 42, "Yes");
+        GUI::drawText(68, 42, "Yes");
     }
     u8g2.setDrawColor(1);
 }
@@ -1694,7 +1702,7 @@ void SettingsApp::renderT9Editor() {
     int maxVisibleLines = (textBottom - textTop + 1) / lineHeight;
     if (maxVisibleLines < 1) maxVisibleLines = 1;
     int textX = showLineNumbers ? 12 : 1;
-    int charWidth = u8g2.getStrWidth("W");
+    int charWidth = GUI::getTextWidth("W");
     if (charWidth < 1) charWidth = 1;
     int maxCharsPerLine = (GUI::SCREEN_WIDTH - textX - 1) / charWidth;
     if (maxCharsPerLine < 1) maxCharsPerLine = 1;
@@ -1754,7 +1762,7 @@ void SettingsApp::renderT9Editor() {
         if (showLineNumbers) {
             char ln[5];
             snprintf(ln, sizeof(ln), "%d", li + 1);
-            u8g2.drawStr(1, y, ln);
+            GUI::drawText(1, y, ln);
         }
 
         if (fbDispStart >= 0 && fbDispStart < lEnd && fbDispEnd > lStart) {
@@ -1763,29 +1771,29 @@ void SettingsApp::renderT9Editor() {
 
             if (regionS > 0) {
                 String before = line.substring(0, regionS);
-                u8g2.drawStr(textX, y, before.c_str());
+                GUI::drawText(textX, y, before.c_str());
             }
 
             String fbPart = line.substring(regionS, regionE);
-            int xFb = textX + u8g2.getStrWidth(line.substring(0, regionS).c_str());
-            int wFb = u8g2.getStrWidth(fbPart.c_str());
+            int xFb = textX + GUI::getTextWidth(line.substring(0, regionS).c_str());
+            int wFb = GUI::getTextWidth(fbPart.c_str());
             u8g2.drawBox(xFb, GUI::getHighlightTop(y), wFb, GUI::getHighlightHeight());
             u8g2.setDrawColor(0);
-            u8g2.drawStr(xFb, y, fbPart.c_str());
+            GUI::drawText(xFb, y, fbPart.c_str());
             u8g2.setDrawColor(1);
 
             if (regionE < (int)line.length()) {
                 String after = line.substring(regionE);
-                u8g2.drawStr(xFb + wFb, y, after.c_str());
+                GUI::drawText(xFb + wFb, y, after.c_str());
             }
         } else {
-            u8g2.drawStr(textX, y, line.c_str());
+            GUI::drawText(textX, y, line.c_str());
         }
 
         if (li == cursorLine && cursorScreenX < 0) {
             int localIdx = t9Cursor - lineStarts[li];
             String before = displayText.substring(lineStarts[li], lineStarts[li] + localIdx);
-            cursorScreenX = textX + u8g2.getStrWidth(before.c_str());
+            cursorScreenX = textX + GUI::getTextWidth(before.c_str());
             cursorScreenY = y;
         }
         y += lineHeight;
@@ -1793,7 +1801,7 @@ void SettingsApp::renderT9Editor() {
 
     if (cursorScreenX >= 0) {
         if (preview.length() > 0) {
-            int pw = u8g2.getStrWidth(preview.c_str());
+            int pw = GUI::getTextWidth(preview.c_str());
             u8g2.drawHLine(cursorScreenX, cursorScreenY + 2, pw);
         } else {
             bool recentMove = (millis() - t9CursorMoveTime < CURSOR_BLINK_RATE);
@@ -1812,9 +1820,9 @@ void SettingsApp::renderT9Editor() {
             char bar[32];
             snprintf(bar, sizeof(bar), "?[%s] %d/%d", map, t9TapIndex + 1, (int)strlen(map));
             String text = GUI::truncateStringToWidth(String(bar), GUI::SCREEN_WIDTH - 2);
-            u8g2.drawUTF8(1, footerBaselineY, text.c_str());
+            GUI::drawText(1, footerBaselineY, text.c_str());
         } else if (t9Fallback) {
-            u8g2.drawStr(1, footerBaselineY, "?ABC 0:sp exits");
+            GUI::drawText(1, footerBaselineY, "?ABC 0:sp exits");
         } else if (t9InputMode == MODE_T9 && t9predict.hasInput()) {
             char bar[40];
             int dc = t9predict.getDigitCount();
@@ -1847,7 +1855,7 @@ void SettingsApp::renderT9Editor() {
                 }
             }
             String text = GUI::truncateStringToWidth(String(bar), GUI::SCREEN_WIDTH - 2);
-            u8g2.drawUTF8(1, footerBaselineY, text.c_str());
+            GUI::drawText(1, footerBaselineY, text.c_str());
         } else if (t9InputMode == MODE_T9 && t9TapKey == '1') {
             drawHighlightedChoiceBar(1, footerBaselineY, multiTapMap[1], t9TapIndex);
         } else if (t9InputMode == MODE_ABC && t9TapKey != '\0') {
@@ -1855,13 +1863,13 @@ void SettingsApp::renderT9Editor() {
             char bar[32];
             snprintf(bar, sizeof(bar), "[%s] %d/%d", map, t9TapIndex + 1, (int)strlen(map));
             String text = GUI::truncateStringToWidth(String(bar), GUI::SCREEN_WIDTH - 2);
-            u8g2.drawUTF8(1, footerBaselineY, text.c_str());
+            GUI::drawText(1, footerBaselineY, text.c_str());
         } else {
             const char* hint = (t9InputMode == MODE_T9)  ? "ALT:ABC 2-9:T9 0:sp" :
                                (t9InputMode == MODE_ABC) ? "ALT:123 0-9:tap" :
                                                            "ALT:T9 0-9:digits";
             String text = GUI::truncateStringToWidth(String(hint), GUI::SCREEN_WIDTH - 2);
-            u8g2.drawUTF8(1, footerBaselineY, text.c_str());
+            GUI::drawText(1, footerBaselineY, text.c_str());
         }
     }
 
@@ -69,8 +69,8 @@ void StopwatchApp::render() {
     char buf[16];
     sprintf(buf, "%02lu:%02lu:%02lu", hours, minutes, seconds);
     
-    int width = u8g2.getStrWidth(buf);
-    u8g2.drawStr((GUI::SCREEN_WIDTH - width) / 2, GUI::getContentBaselineStart() + metrics.lineHeight, buf); 
+    int width = GUI::getTextWidth(buf);
+    GUI::drawText((GUI::SCREEN_WIDTH - width) / 2, GUI::getContentBaselineStart() + metrics.lineHeight, buf); 
     
     // Draw Controls
     if (isRunning) {
@@ -3,11 +3,15 @@
 // STATUS: [Level 2 - Implementation]
 // TRUTH_LINK: TACTICAL_TODO TASK_2
 // LOG_REF: 2026-05-02
-// Description: Canonical T9 editor/viewer app with predictive input, split RO paging, and capped RW file editing.
+// Description: Canonical T9 editor/viewer app with predictive input, split RO paging, and windowed RW file editing.
 
 #include "t9_editor.h"
 #include "../app_transfer.h"
+#include "../clipboard_ring.h"
 #include "../gui.h"
+#include "../display.h"
+#include "../history_index.h"
+#include "../text_wrap.h"
 #include <cstdlib>
 #include <cstring>
 
@@ -28,10 +32,20 @@ static const uint32_t kEditorRecordMagic = 0x54494348UL;
 static const uint32_t kEditorRecordVersion = 1;
 static const uint32_t kEditorRecordKindClipboardSlot = 3;
 static const int kClipboardSlotCount = 12;
-static const size_t kEditorUndoHistoryLimit = 16;
+static const size_t kEditorUndoArenaBytes = 16 * 1024;
+static const int kEditorUndoMaxSteps = 256;
 static const char* kEditorSystemRoot = "/.t9sys";
 static const char* kEditorHistoryRoot = "/.t9sys/history";
+static const char* kEditorHistoryIndexPath = "/.t9sys/history/index.bin";
 static const char* kEditorClipboardRoot = "/.t9sys/clipboard";
+static const char* kEditorClipboardPath = "/.t9sys/clipboard/clipboard.bin";
+static const char* kEditorViewerIndexRoot = "/.t9sys/viewer";
+static const size_t kViewerIndexBytesPerUpdate = 4096;
+static const size_t kSearchChunkBytes = 4096;
+static const size_t kSearchBytesPerUpdate = 32 * 1024;
+static const size_t kEditorWindowBytes = 8 * 1024;
+static const size_t kEditorEditLogMaxBytes = 32 * 1024;
+static const int kEditorEditLogMaxSpans = 2048;
 const size_t kT9EditorReadOnlyPageSizeOptions[] = {2048, 1024, 512, 256};
 const int kT9EditorReadOnlyPageSizeOptionCount = 4;
 const char* kT9EditorFontSizeOptionLabels[] = {"Medium", "Small", "Tiny"};
@@ -69,6 +83,11 @@ class EditorSdSessionGuard {
 
 int EditorSdSessionGuard::depth_ = 0;
 
+// Shared by all editor sessions so its fence table stays cached.
+static HistoryIndex gHistoryIndex(kEditorHistoryIndexPath);
+// Shared by all editor sessions; loaded once, written back when idle.
+static ClipboardRing gClipboard(kEditorClipboardPath, kClipboardSlotCount, kEditorRecordSize);
+
 size_t getT9EditorReadOnlyPageBytes() {
     return kT9EditorReadOnlyPageSizeOptions[gT9EditorReadOnlyPageSizeOptionIndex];
 }
@@ -247,6 +266,66 @@ static bool writeSmallFileUnlocked(const String& path, const String& content, St
     return true;
 }
 
+// Write text to sdSaveTempPath(path) with one sync, then swap it in. A crash
+// before the rename leaves the old file; recoverInterruptedSaveUnlocked()
+// finishes a swap cut off between remove and rename.
+static bool writeFileAtomicUnlocked(const String& path, const TextBuffer& text, String& error) {
+    if (!ensureDirectoryChainUnlocked(parentPathOf(path), error)) {
+        return false;
+    }
+
+    const String tempPath = sdSaveTempPath(path);
+    FsFile file;
+    if (!file.open(tempPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC)) {
+        error = String("Failed to open file for write: ") + tempPath;
+        return false;
+    }
+    char chunk[256];
+    const size_t length = text.length();
+    for (size_t done = 0; done < length; done += sizeof(chunk)) {
+        const size_t part = (length - done) < sizeof(chunk) ? (length - done) : sizeof(chunk);
+        text.copyRange(done, part, chunk);
+        if (file.write(reinterpret_cast<const uint8_t*>(chunk), part) != part) {
+            file.close();
+            sdFat.remove(tempPath.c_str());
+            error = String("Failed to write file: ") + tempPath;
+            return false;
+        }
+    }
+    if (!file.sync()) {
+        file.close();
+        sdFat.remove(tempPath.c_str());
+        error = String("Failed to sync file: ") + tempPath;
+        return false;
+    }
+    file.close();
+
+    uint64_t previousSize = 0;
+    if (file.open(path.c_str(), O_RDONLY)) {
+        previousSize = file.size();
+        file.close();
+    }
+    if ((sdFat.exists(path.c_str()) && !sdFat.remove(path.c_str())) ||
+        !sdFat.rename(tempPath.c_str(), path.c_str())) {
+        error = String("Failed to replace file: ") + path;
+        return false;
+    }
+    sdNoteFileResized(previousSize, length);
+    error = "";
+    return true;
+}
+
+static void recoverInterruptedSaveUnlocked(const String& path) {
+    const String tempPath = sdSaveTempPath(path);
+    if (!sdFat.exists(tempPath.c_str())) return;
+    if (!sdFat.exists(path.c_str())) {
+        sdFat.rename(tempPath.c_str(), path.c_str());
+        Serial.printf("[T9Editor] Finished interrupted save: %s\n", path.c_str());
+    } else {
+        sdFat.remove(tempPath.c_str());
+    }
+}
+
 static String manifestValue(const String& manifest, const char* key) {
     String prefix = String(key) + "=";
     int start = 0;
@@ -263,78 +342,19 @@ static String manifestValue(const String& manifest, const char* key) {
     return "";
 }
 
-static bool manifestContainsAlias(const String& manifest, const String& path) {
+static void collectManifestAliases(const String& manifest, std::vector<String>& aliases) {
     const String prefix = "alias=";
     int start = 0;
     while (start <= manifest.length()) {
         int end = manifest.indexOf('\n', start);
         if (end < 0) end = manifest.length();
         String line = manifest.substring(start, end);
-        if (line.startsWith(prefix) && line.substring(prefix.length()) == path) {
-            return true;
+        if (line.startsWith(prefix)) {
+            aliases.push_back(line.substring(prefix.length()));
         }
         if (end >= manifest.length()) break;
         start = end + 1;
     }
-    return false;
-}
-
-static bool writeFixedRecordUnlocked(const String& path,
-                                     uint32_t kind,
-                                     uint32_t index,
-                                     uint32_t documentLength,
-                                     uint32_t flags,
-                                     const String& content,
-                                     String& error) {
-    if (static_cast<size_t>(content.length()) > kEditorRecordPayloadBytes) {
-        error = String("Payload exceeds fixed record size: ") + path;
-        return false;
-    }
-    if (!ensureDirectoryChainUnlocked(parentPathOf(path), error)) {
-        return false;
-    }
-
-    uint8_t record[kEditorRecordSize];
-    memset(record, 0, sizeof(record));
-
-    EditorRecordHeader header;
-    header.magic = kEditorRecordMagic;
-    header.version = kEditorRecordVersion;
-    header.kind = kind;
-    header.index = index;
-    header.payloadLength = static_cast<uint32_t>(content.length());
-    header.documentLength = documentLength;
-    header.flags = flags;
-    header.checksum = fnv1aBytes(reinterpret_cast<const uint8_t*>(content.c_str()),
-                                 static_cast<size_t>(content.length()));
-
-    memcpy(record, &header, sizeof(header));
-    if (content.length() > 0) {
-        memcpy(record + sizeof(header), content.c_str(), static_cast<size_t>(content.length()));
-    }
-
-    FsFile file;
-    if (!file.open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC)) {
-        error = String("Failed to open fixed record for write: ") + path;
-        return false;
-    }
-    if (file.isDir()) {
-        error = String("Path is a directory: ") + path;
-        return false;
-    }
-
-    size_t bytesWritten = file.write(record, sizeof(record));
-    if (bytesWritten != sizeof(record)) {
-        error = String("Failed to write fixed record: ") + path;
-        return false;
-    }
-    if (!file.sync()) {
-        error = String("Failed to sync fixed record: ") + path;
-        return false;
-    }
-
-    error = "";
-    return true;
 }
 
 static bool readFixedRecordUnlocked(const String& path,
@@ -483,9 +503,10 @@ static void drawCenteredStatusDialog(const char* message) {
     GUI::drawPopupFrame(18, 22, 92, 20, true);
     GUI::setFontSystem();
     String text = GUI::truncateStringToWidth(String(message ? message : ""), 84);
-    int msgWidth = u8g2.getUTF8Width(text.c_str());
-    u8g2.drawUTF8((GUI::SCREEN_WIDTH - msgWidth) / 2, 35, text.c_str());
-    u8g2.sendBuffer();
+    int msgWidth = GUI::getTextWidth(text.c_str());
+    GUI::drawText((GUI::SCREEN_WIDTH - msgWidth) / 2, 35, text.c_str());
+    Display::markAllDirty();
+    Display::flush();
 }
 
 static void drawHighlightedChoiceBar(int xStart, int baselineY, const char* choices, int selectedIndex) {
@@ -504,7 +525,7 @@ static void drawHighlightedChoiceBar(int xStart, int baselineY, const char* choi
     int safeCount = min(count, 40);
     for (int i = 0; i < safeCount; i++) {
         char item[2] = {choices[i], '\0'};
-        widths[i] = u8g2.getStrWidth(item) + 2;
+        widths[i] = GUI::getTextWidth(item) + 2;
     }
 
     int startIndex = 0;
@@ -517,14 +538,14 @@ static void drawHighlightedChoiceBar(int xStart, int baselineY, const char* choi
 
     int x = xStart;
     if (startIndex > 0) {
-        u8g2.drawStr(x, baselineY, "<");
-        x += u8g2.getStrWidth("<") + 2;
+        GUI::drawText(x, baselineY, "<");
+        x += GUI::getTextWidth("<") + 2;
     }
 
     bool clippedRight = false;
     for (int i = startIndex; i < safeCount; i++) {
         char item[2] = {choices[i], '\0'};
-        int charWidth = u8g2.getStrWidth(item);
+        int charWidth = GUI::getTextWidth(item);
         int paddedWidth = charWidth + 2;
         if (x + paddedWidth > GUI::SCREEN_WIDTH - 5) {
             clippedRight = (i < safeCount);
@@ -534,66 +555,36 @@ static void drawHighlightedChoiceBar(int xStart, int baselineY, const char* choi
         if (i == selectedIndex) {
             u8g2.drawBox(x - 1, GUI::getHighlightTop(baselineY), paddedWidth + 1, GUI::getHighlightHeight());
             u8g2.setDrawColor(0);
-            u8g2.drawStr(x, baselineY, item);
+            GUI::drawText(x, baselineY, item);
             u8g2.setDrawColor(1);
         } else {
-            u8g2.drawStr(x, baselineY, item);
+            GUI::drawText(x, baselineY, item);
         }
         x += paddedWidth;
     }
 
     if (clippedRight) {
-        u8g2.drawStr(GUI::SCREEN_WIDTH - 5, baselineY, ">");
-    }
-}
-
-static bool isWrapBoundaryChar(char c) {
-    unsigned char uc = static_cast<unsigned char>(c);
-    if (uc <= ' ') return true;
-    if ((uc >= '0' && uc <= '9') ||
-        (uc >= 'A' && uc <= 'Z') ||
-        (uc >= 'a' && uc <= 'z') ||
-        uc == '_') {
-        return false;
-    }
-    if (uc >= 0x80) return false;
-    return true;
-}
-
-static int getWrappedFitLength(const String& segment, int segStart, int segmentLen, int textAreaWidth) {
-    int fitLen = 0;
-    int lastBoundaryLen = -1;
-
-    while (segStart + fitLen < segmentLen) {
-        String sub = segment.substring(segStart, segStart + fitLen + 1);
-        if (u8g2.getUTF8Width(sub.c_str()) > textAreaWidth) break;
-        fitLen++;
-
-        if (isWrapBoundaryChar(segment[segStart + fitLen - 1])) {
-            lastBoundaryLen = fitLen;
-        }
-    }
-
-    if (fitLen == 0 && segStart < segmentLen) return 1;
-
-    if (segStart + fitLen < segmentLen && lastBoundaryLen > 0) {
-        return lastBoundaryLen;
+        GUI::drawText(GUI::SCREEN_WIDTH - 5, baselineY, ">");
     }
-
-    return fitLen;
 }
 
-T9EditorApp::T9EditorApp() {
+T9EditorApp::T9EditorApp()
+    : viewerReader(kEditorViewerIndexRoot), search(kSearchChunkBytes),
+      undoLog(kEditorUndoArenaBytes, kEditorUndoMaxSteps) {
     scrollOffset = 0;
+    cursorLineIndex = 0;
     openMode = OPEN_READ_WRITE;
     sourceKind = SOURCE_BUFFER;
     sourcePageSize = static_cast<int>(getT9EditorReadOnlyPageBytes());
     documentLabel = "T9 EDITOR";
     documentPath = "";
     sourceBuffer = "";
-    documentBuffer = "";
+    documentBuffer.clear();
     resetPagedSession();
     exitRequested = false;
+    saveCount = 0;
+    lastSaveMs = 0;
+    maxSaveMs = 0;
     resetEditorSession();
 }
 
@@ -608,7 +599,7 @@ void T9EditorApp::start() {
                  : SOURCE_BUFFER;
     documentPath = appTransferPath;
     sourceBuffer = appTransferString;
-    documentBuffer = appTransferString;
+    documentBuffer.assign(appTransferString);
     documentLabel = appTransferLabel;
     resetPagedSession();
     if (documentLabel.length() == 0) {
@@ -629,21 +620,14 @@ void T9EditorApp::start() {
     if (sourceKind == SOURCE_PAGED_FILE) {
         String error;
         if (!isReadOnly()) {
+            EditorSdSessionGuard session;
+            if (session.begin()) recoverInterruptedSaveUnlocked(documentPath);
             size_t fileSize = 0;
             if (!statPagedDocument(fileSize, error)) {
                 Serial.printf("[T9Editor] Paged open failed: %s\n", error.c_str());
                 sourceKind = SOURCE_BUFFER;
                 openMode = OPEN_READ_ONLY;
-                documentBuffer = error;
-                documentPath = "";
-            } else if (fileSize > kT9EditorReadWriteMaxBytes) {
-                Serial.printf("[T9Editor] RW open blocked by size cap: %u > %u\n",
-                              static_cast<unsigned>(fileSize),
-                              static_cast<unsigned>(kT9EditorReadWriteMaxBytes));
-                sourceKind = SOURCE_BUFFER;
-                openMode = OPEN_READ_ONLY;
-                documentLabel = "RW blocked";
-                documentBuffer = "RW cap exceeded.\nUse browser Enter for RO.";
+                documentBuffer.assign(error);
                 documentPath = "";
             }
         }
@@ -660,7 +644,7 @@ void T9EditorApp::start() {
             Serial.printf("[T9Editor] Paged open failed: %s\n", error.c_str());
             sourceKind = SOURCE_BUFFER;
             openMode = OPEN_READ_ONLY;
-            documentBuffer = error;
+            documentBuffer.assign(error);
             documentPath = "";
         }
     }
@@ -670,7 +654,7 @@ void T9EditorApp::start() {
         if (!loadPagedDocument(error)) {
             Serial.printf("[T9Editor] Buffer paging setup failed: %s\n", error.c_str());
             sourceBuffer = error;
-            documentBuffer = error;
+            documentBuffer.assign(error);
         }
     }
     Serial.printf("[T9Editor] Open mode: %s path=%s action=%d\n",
@@ -682,9 +666,14 @@ void T9EditorApp::start() {
 }
 
 void T9EditorApp::stop() {
+    String clipboardError;
+    if (!flushClipboard(clipboardError)) {
+        Serial.printf("[T9Editor] Clipboard flush failed: %s\n", clipboardError.c_str());
+    }
     visualLines.clear();
+    invalidateLayout();
     sourceBuffer = "";
-    documentBuffer = "";
+    documentBuffer.clear();
     documentLabel = "T9 EDITOR";
     documentPath = "";
     resetPagedSession();
@@ -710,9 +699,14 @@ void T9EditorApp::resetEditorSession() {
     scrollOffset = 0;
     clearSelectionState();
     shiftTapPending = false;
-    undoStack.clear();
-    redoStack.clear();
+    undoLog.clear();
     closeClipboardPopup();
+    closeFindPrompt();
+    search.cancel();
+    findPattern = "";
+    searchHitStart = 0;
+    searchHitLength = 0;
+    invalidateLayout();
 }
 
 void T9EditorApp::resetPagedSession() {
@@ -722,9 +716,19 @@ void T9EditorApp::resetPagedSession() {
     totalPageCount = 0;
     pageDirty = false;
     historyDocumentId = "";
-    historyNextSnapshotId = 1;
     activeHistorySnapshotId = 0;
-    nextClipboardSlot = 1;
+    historyJournal.close();
+    historyEditsTracked = false;
+    historyEditPending = false;
+    historyEditStart = 0;
+    historyEditEnd = 0;
+    historyEditDelta = 0;
+    viewerReader.close();
+    spanDocument.close();
+    windowStart = 0;
+    lineNumberBase = 0;
+    pageContinuesLine = false;
+    gotoLineInput = "";
 }
 
 void T9EditorApp::clearSelectionState() {
@@ -791,25 +795,24 @@ void T9EditorApp::clearTransientInputState() {
     fallbackStart = cursorPos;
 }
 
-EditorUndoState T9EditorApp::captureUndoState() const {
-    EditorUndoState state;
-    state.documentBuffer = documentBuffer;
+UndoLog::State T9EditorApp::captureUndoState() const {
+    UndoLog::State state;
     state.cursorPos = cursorPos;
-    state.selectionMode = selectionMode;
+    state.snapshotId = static_cast<uint32_t>(activeHistorySnapshotId);
     state.selectionAnchorPos = selectionAnchorPos;
     state.selectionFocusPos = selectionFocusPos;
-    state.activeHistorySnapshotId = activeHistorySnapshotId;
+    state.selectionMode = selectionMode;
     return state;
 }
 
-void T9EditorApp::restoreUndoState(const EditorUndoState& state) {
-    documentBuffer = state.documentBuffer;
+// Finish an undo or redo that already changed the document.
+void T9EditorApp::applyUndoStep(const UndoLog::State& state, const UndoLog::Change& change) {
+    noteDocumentEdit(change.position, change.removedLength, change.insertedLength);
     cursorPos = state.cursorPos;
     selectionMode = state.selectionMode;
     selectionAnchorPos = state.selectionAnchorPos;
     selectionFocusPos = state.selectionFocusPos;
-    activeHistorySnapshotId = state.activeHistorySnapshotId;
-
+    activeHistorySnapshotId = state.snapshotId;
     if (cursorPos < 0) cursorPos = 0;
     if (cursorPos > getDocumentLength()) cursorPos = getDocumentLength();
 
@@ -830,23 +833,8 @@ void T9EditorApp::restoreUndoState(const EditorUndoState& state) {
     }
 }
 
-void T9EditorApp::pushUndoState(std::vector<EditorUndoState>& stack, const EditorUndoState& state) {
-    if (stack.size() >= kEditorUndoHistoryLimit) {
-        stack.erase(stack.begin());
-    }
-    stack.push_back(state);
-}
-
-void T9EditorApp::recordUndoState() {
-    if (isReadOnly()) {
-        return;
-    }
-    pushUndoState(undoStack, captureUndoState());
-    redoStack.clear();
-}
-
 bool T9EditorApp::undoFromHistory() {
-    if (sourceKind != SOURCE_PAGED_FILE || isReadOnly()) {
+    if (sourceKind != SOURCE_PAGED_FILE || isReadOnly() || isWindowedDocument()) {
         return false;
     }
 
@@ -858,11 +846,7 @@ bool T9EditorApp::undoFromHistory() {
 
     unsigned long candidate = activeHistorySnapshotId;
     if (candidate == 0) {
-        candidate = historyNextSnapshotId;
-    }
-
-    if (candidate <= 1) {
-        return false;
+        candidate = historyJournal.getNextId();
     }
 
     EditorSdSessionGuard session;
@@ -871,25 +855,34 @@ bool T9EditorApp::undoFromHistory() {
         return false;
     }
 
-    while (candidate > 1) {
+    while (candidate > historyJournal.getFirstId()) {
         candidate--;
-        const String snapshotPath = getHistorySnapshotPath(candidate);
-        if (!sdFat.exists(snapshotPath.c_str())) {
-            continue;
-        }
-
-        String snapshotContent;
-        if (!readSmallFileUnlocked(snapshotPath, snapshotContent, error)) {
+        TextBuffer snapshot;
+        if (!historyJournal.readSnapshot(static_cast<uint32_t>(candidate), snapshot, error)) {
             GUI::showToast(error.c_str(), 2000);
             return false;
         }
 
-        if (snapshotContent == documentBuffer) {
+        // Replace only the bytes that differ, so undo, redo and the layout
+        // cache see a small edit.
+        const int documentLength = getDocumentLength();
+        const int snapshotLength = snapshot.length();
+        const int prefix = documentBuffer.commonPrefixLength(snapshot);
+        if (prefix == documentLength && prefix == snapshotLength) {
             continue;
         }
+        const int suffix = documentBuffer.commonSuffixLength(snapshot, min(documentLength, snapshotLength) - prefix);
+        const int replacedLength = documentLength - prefix - suffix;
+        const String replacement = snapshot.substring(prefix, snapshotLength - suffix);
 
-        pushUndoState(redoStack, captureUndoState());
-        documentBuffer = snapshotContent;
+        if (!documentBuffer.reserve(snapshotLength)) {
+            GUI::showToast("Out of memory", 2000);
+            return false;
+        }
+        undoLog.recordUndone(documentBuffer, prefix, replacedLength, replacement.c_str(),
+                             replacement.length(), captureUndoState());
+        documentBuffer.replace(prefix, replacedLength, replacement.c_str(), replacement.length());
+        noteDocumentEdit(prefix, replacedLength, replacement.length());
         if (cursorPos > getDocumentLength()) {
             cursorPos = getDocumentLength();
         }
@@ -909,7 +902,7 @@ bool T9EditorApp::undoEdit() {
         return false;
     }
     const bool selectionWasActive = selectionMode;
-    if (undoStack.empty()) {
+    if (!undoLog.canUndo()) {
         if (undoFromHistory()) {
             if (selectionWasActive) {
                 enterSelectionMode();
@@ -922,10 +915,13 @@ bool T9EditorApp::undoEdit() {
         return false;
     }
 
-    pushUndoState(redoStack, captureUndoState());
-    EditorUndoState state = undoStack.back();
-    undoStack.pop_back();
-    restoreUndoState(state);
+    UndoLog::State state = captureUndoState();
+    UndoLog::Change change;
+    if (!undoLog.undo(documentBuffer, state, change)) {
+        GUI::showToast("Out of memory", 1500);
+        return false;
+    }
+    applyUndoStep(state, change);
     if (selectionWasActive) {
         enterSelectionMode();
     } else {
@@ -940,15 +936,18 @@ bool T9EditorApp::redoEdit() {
         return false;
     }
     const bool selectionWasActive = selectionMode;
-    if (redoStack.empty()) {
+    if (!undoLog.canRedo()) {
         GUI::showToast("Nothing to redo", 1500);
         return false;
     }
 
-    pushUndoState(undoStack, captureUndoState());
-    EditorUndoState state = redoStack.back();
-    redoStack.pop_back();
-    restoreUndoState(state);
+    UndoLog::State state = captureUndoState();
+    UndoLog::Change change;
+    if (!undoLog.redo(documentBuffer, state, change)) {
+        GUI::showToast("Out of memory", 1500);
+        return false;
+    }
+    applyUndoStep(state, change);
     if (selectionWasActive) {
         enterSelectionMode();
     } else {
@@ -967,7 +966,7 @@ String T9EditorApp::getSelectedText() const {
 }
 
 bool T9EditorApp::replaceDocumentRange(int start, int end, const String& replacement, int newCursorPos,
-                                       bool recordUndo) {
+                                       bool recordUndo, bool typed) {
     if (start < 0) start = 0;
     if (end < start) end = start;
 
@@ -981,12 +980,25 @@ bool T9EditorApp::replaceDocumentRange(int start, int end, const String& replace
         showReadWriteCapToast();
         return false;
     }
+    if (isWindowedDocument() &&
+        (spanDocument.getAddedBytes() + replacement.length() > kEditorEditLogMaxBytes ||
+         spanDocument.getSpanCount() + 2 > kEditorEditLogMaxSpans)) {
+        GUI::showToast("Edit log full, save first", 2000);
+        return false;
+    }
+
+    if (!documentBuffer.reserve(newLength)) {
+        GUI::showToast("Out of memory", 1500);
+        return false;
+    }
 
-    if (recordUndo) {
-        recordUndoState();
+    if (recordUndo && !isReadOnly()) {
+        undoLog.record(documentBuffer, start, end - start, replacement.c_str(), replacement.length(),
+                       captureUndoState(), typed);
     }
 
-    documentBuffer = documentBuffer.substring(0, start) + replacement + documentBuffer.substring(end);
+    documentBuffer.replace(start, end - start, replacement.c_str(), replacement.length());
+    noteDocumentEdit(start, end - start, replacement.length());
     cursorPos = newCursorPos;
     if (cursorPos < 0) cursorPos = 0;
     if (cursorPos > getDocumentLength()) cursorPos = getDocumentLength();
@@ -1024,102 +1036,21 @@ String T9EditorApp::previewClipboardText(const String& value) const {
     return preview;
 }
 
-bool T9EditorApp::readClipboardSlotPreview(int slot, String& preview, String& error) const {
-    preview = "";
-    if (slot < 1 || slot > kClipboardSlotCount) {
-        error = "Clipboard slot is out of range";
-        return false;
-    }
-
-    EditorSdSessionGuard session;
-    if (!session.begin()) {
-        error = "Failed to open SD session";
-        return false;
-    }
-
-    FsFile file;
-    if (!file.open(getClipboardSlotPath(slot).c_str(), O_RDONLY)) {
-        error = String("Failed to open fixed record: ") + getClipboardSlotPath(slot);
-        return false;
-    }
-    if (file.isDir()) {
-        error = String("Path is a directory: ") + getClipboardSlotPath(slot);
-        return false;
-    }
-    if (static_cast<size_t>(file.size()) != kEditorRecordSize) {
-        error = String("Unexpected fixed record size: ") + getClipboardSlotPath(slot);
-        return false;
-    }
-
-    uint8_t headerBytes[sizeof(EditorRecordHeader)];
-    int headerRead = file.read(headerBytes, sizeof(headerBytes));
-    if (headerRead != static_cast<int>(sizeof(headerBytes))) {
-        error = String("Failed to read fixed record header: ") + getClipboardSlotPath(slot);
-        return false;
-    }
-
-    EditorRecordHeader header;
-    memcpy(&header, headerBytes, sizeof(header));
-    if (header.magic != kEditorRecordMagic || header.version != kEditorRecordVersion) {
-        error = String("Fixed record header mismatch: ") + getClipboardSlotPath(slot);
-        return false;
-    }
-    if (header.kind != kEditorRecordKindClipboardSlot || header.index != static_cast<uint32_t>(slot)) {
-        error = String("Fixed record kind/index mismatch: ") + getClipboardSlotPath(slot);
-        return false;
-    }
-    if (header.payloadLength > kEditorRecordPayloadBytes) {
-        error = String("Fixed record payload is out of range: ") + getClipboardSlotPath(slot);
-        return false;
-    }
-    if (header.payloadLength == 0) {
-        error = "";
-        return true;
-    }
-
-    static const size_t kClipboardPreviewCharLimit = 96;
-    char buffer[32];
-    size_t remaining = header.payloadLength;
-    bool truncated = false;
-    bool sawLineBreak = false;
-
-    while (remaining > 0 && !sawLineBreak && preview.length() < static_cast<int>(kClipboardPreviewCharLimit)) {
-        size_t chunk = remaining < sizeof(buffer) ? remaining : sizeof(buffer);
-        int bytesRead = file.read(buffer, chunk);
-        if (bytesRead < 0) {
-            error = String("Failed to read fixed record preview: ") + getClipboardSlotPath(slot);
-            return false;
-        }
-        if (bytesRead == 0) {
-            break;
-        }
-
-        remaining -= static_cast<size_t>(bytesRead);
-        for (int i = 0; i < bytesRead; i++) {
-            char c = buffer[i];
-            if (c == '\n' || c == '\r') {
-                sawLineBreak = true;
-                break;
-            }
-            if (preview.length() >= static_cast<int>(kClipboardPreviewCharLimit)) {
-                truncated = true;
-                break;
-            }
-            preview += c;
-        }
-    }
-
-    if (!sawLineBreak && remaining > 0) {
-        truncated = true;
+String T9EditorApp::buildClipboardPreview(const String& content) const {
+    static const unsigned int kClipboardPreviewCharLimit = 96;
+    unsigned int end = 0;
+    while (end < content.length() && end < kClipboardPreviewCharLimit &&
+           content[end] != '\n' && content[end] != '\r') {
+        end++;
     }
+    const bool truncated = end == kClipboardPreviewCharLimit && end < content.length() &&
+                           content[end] != '\n' && content[end] != '\r';
 
-    preview = previewClipboardText(preview);
+    String preview = previewClipboardText(content.substring(0, end));
     if (truncated && preview != "(empty)") {
         preview += "...";
     }
-
-    error = "";
-    return true;
+    return preview;
 }
 
 bool T9EditorApp::rebuildClipboardPopupEntries(String& error) {
@@ -1128,23 +1059,15 @@ bool T9EditorApp::rebuildClipboardPopupEntries(String& error) {
         return false;
     }
 
-    int slot = nextClipboardSlot - 1;
-    if (slot < 1) slot = kClipboardSlotCount;
-    for (int count = 0; count < kClipboardSlotCount; count++) {
-        String readError;
-        String preview;
-        if (!readClipboardSlotPreview(slot, preview, readError)) {
-            error = readError;
-            return false;
-        }
-        if (preview.length() > 0) {
+    for (int age = 0; age < gClipboard.getSlotCount(); age++) {
+        const int slot = gClipboard.slotForAge(age);
+        const String& content = gClipboard.getSlot(slot);
+        if (content.length() > 0) {
             ClipboardPopupEntry entry;
             entry.slot = slot;
-            entry.preview = preview;
+            entry.preview = buildClipboardPreview(content);
             clipboardPopupEntries.push_back(entry);
         }
-        slot--;
-        if (slot < 1) slot = kClipboardSlotCount;
     }
 
     error = "";
@@ -1308,7 +1231,7 @@ int T9EditorApp::getClipboardPopupTopY() const {
 }
 
 int T9EditorApp::getTextBottomY() const {
-    int textBottom = showFooter() ? 53 : 63;
+    int textBottom = (showFooter() || isFindBarVisible()) ? 53 : 63;
     if (clipboardPopupActive) {
         textBottom = min(textBottom, getClipboardPopupTopY() - 2);
     }
@@ -1349,7 +1272,7 @@ void T9EditorApp::renderClipboardPopup() const {
 
         String text = String(index + 1) + ". " + clipboardPopupEntries[index].preview;
         text = GUI::truncateStringToWidth(text, max(1, popupTextWidth));
-        u8g2.drawUTF8(popupX + 4, itemY, text.c_str());
+        GUI::drawText(popupX + 4, itemY, text.c_str());
         u8g2.setDrawColor(1);
     }
 
@@ -1386,11 +1309,11 @@ bool T9EditorApp::isKeyActiveNow(char key) const {
 }
 
 void T9EditorApp::showReadWriteCapToast() const {
-    GUI::showToast("RW cap exceeded", 1500);
+    GUI::showToast(isWindowedDocument() ? "Window full" : "RW cap exceeded", 1500);
 }
 
 bool T9EditorApp::tryInsertTextAtCursor(const String& text, int cursorAdvance) {
-    return replaceDocumentRange(cursorPos, cursorPos, text, cursorPos + cursorAdvance, true);
+    return replaceDocumentRange(cursorPos, cursorPos, text, cursorPos + cursorAdvance, true, true);
 }
 
 bool T9EditorApp::tryInsertCharWithAutoBracket(char c) {
@@ -1399,7 +1322,7 @@ bool T9EditorApp::tryInsertCharWithAutoBracket(char c) {
     if (right != '\0') {
         insertText += right;
     }
-    return replaceDocumentRange(cursorPos, cursorPos, insertText, cursorPos + 1, true);
+    return replaceDocumentRange(cursorPos, cursorPos, insertText, cursorPos + 1, true, true);
 }
 
 bool T9EditorApp::statPagedDocument(size_t& fileSize, String& error) const {
@@ -1478,8 +1401,7 @@ bool T9EditorApp::readFileRange(size_t start, size_t length, String& out, String
             return false;
         }
         if (bytesRead == 0) break;
-        buffer[bytesRead] = '\0';
-        if (!out.concat(buffer)) {
+        if (!out.concat(buffer, static_cast<unsigned int>(bytesRead))) {
             error = String("Failed to append page data: ") + documentPath;
             return false;
         }
@@ -1511,71 +1433,89 @@ void T9EditorApp::markPageDirty() {
     }
 }
 
-String T9EditorApp::getEditorSystemRoot() const {
-    return String(kEditorSystemRoot);
-}
-
-String T9EditorApp::getHistoryRoot() const {
-    return String(kEditorHistoryRoot);
-}
-
-String T9EditorApp::getClipboardRoot() const {
-    return String(kEditorClipboardRoot);
-}
-
-String T9EditorApp::getDocumentHistoryRoot() const {
-    String docId = historyDocumentId.length() > 0 ? historyDocumentId : buildDefaultHistoryDocumentId();
-    return getHistoryRoot() + "/" + docId;
-}
+// ============================================================================
+// WINDOWED RW DOCUMENTS
+// ============================================================================
 
-String T9EditorApp::getDocumentManifestPath() const {
-    return getDocumentHistoryRoot() + "/manifest.txt";
+bool T9EditorApp::isWindowedDocument() const {
+    return !isReadOnly() && spanDocument.isOpen();
 }
 
-String T9EditorApp::getHistorySnapshotPath(unsigned long snapshotId) const {
-    char name[40];
-    snprintf(name, sizeof(name), "%06lu.txt", snapshotId);
-    return getDocumentHistoryRoot() + "/" + String(name);
-}
+bool T9EditorApp::readSpanRange(size_t start, size_t length, String& out, String& error) const {
+    out = "";
+    EditorSdSessionGuard session;
+    if (!session.begin()) {
+        error = "Failed to open SD session";
+        return false;
+    }
 
-String T9EditorApp::getClipboardManifestPath() const {
-    return getClipboardRoot() + "/manifest.txt";
-}
+    FsFile file;
+    if (!file.open(documentPath.c_str(), O_RDONLY)) {
+        error = String("Failed to open file: ") + documentPath;
+        return false;
+    }
+    if (length > 0 && !out.reserve(static_cast<unsigned int>(length))) {
+        error = String("Not enough memory to load window: ") + documentPath;
+        return false;
+    }
 
-String T9EditorApp::getClipboardSlotPath(int slot) const {
-    char name[16];
-    snprintf(name, sizeof(name), "%02d.bin", slot);
-    return getClipboardRoot() + "/" + String(name);
-}
+    // Appended with explicit lengths: a NUL in the file must not shorten
+    // the window, or window offsets stop matching file offsets.
+    char buffer[128];
+    size_t done = 0;
+    while (done < length) {
+        const size_t chunk = min(length - done, sizeof(buffer));
+        const int bytesRead = spanDocument.read(file, start + done, buffer, chunk);
+        if (bytesRead < 0) {
+            error = String("Failed to read file: ") + documentPath;
+            return false;
+        }
+        if (bytesRead == 0) break;
+        if (!out.concat(buffer, static_cast<unsigned int>(bytesRead))) {
+            error = String("Failed to append window data: ") + documentPath;
+            return false;
+        }
+        done += static_cast<size_t>(bytesRead);
+    }
 
-String T9EditorApp::buildDefaultHistoryDocumentId() const {
-    String base = sanitizePathComponent(getPathTail(documentPath));
-    String hash = String(fnv1a32(documentPath), HEX);
-    hash.toUpperCase();
-    return base + "_" + hash;
+    error = "";
+    return true;
 }
 
-bool T9EditorApp::ensureEditorStorage(String& error) {
+bool T9EditorApp::countSpanLineBreaks(size_t end, uint32_t& count, String& error) const {
+    count = 0;
     EditorSdSessionGuard session;
-    if (!session.begin()) {
-        error = "Failed to open SD session";
+    FsFile file;
+    if (!session.begin() || !file.open(documentPath.c_str(), O_RDONLY)) {
+        error = String("Failed to open file: ") + documentPath;
         return false;
     }
 
-    if (!ensureDirectoryChainUnlocked(getEditorSystemRoot(), error)) return false;
-    if (!ensureDirectoryChainUnlocked(getHistoryRoot(), error)) return false;
-    if (!ensureDirectoryChainUnlocked(getClipboardRoot(), error)) return false;
+    char buffer[512];
+    for (size_t offset = 0; offset < end;) {
+        const int bytesRead = spanDocument.read(file, offset, buffer, min(end - offset, sizeof(buffer)));
+        if (bytesRead <= 0) {
+            error = String("Failed to read file: ") + documentPath;
+            return false;
+        }
+        for (int i = 0; i < bytesRead; i++) {
+            if (buffer[i] == '\n') count++;
+        }
+        offset += static_cast<size_t>(bytesRead);
+    }
     error = "";
     return true;
 }
 
-bool T9EditorApp::ensureHistoryDocument(String& error) {
-    if (sourceKind != SOURCE_PAGED_FILE || isReadOnly()) {
-        error = "";
-        return true;
-    }
-    if (!ensureEditorStorage(error)) {
-        return false;
+// Load up to a window of text starting at start, or ending at it when
+// backward. Windows break after a line break where the text has one.
+bool T9EditorApp::loadWindow(size_t start, bool backward, String& error) {
+    const size_t documentLength = spanDocument.length();
+    size_t begin = start;
+    size_t end = min(documentLength, start + kEditorWindowBytes);
+    if (backward) {
+        begin = start > kEditorWindowBytes ? start - kEditorWindowBytes : 0;
+        end = start;
     }
 
     EditorSdSessionGuard session;
@@ -1583,158 +1523,396 @@ bool T9EditorApp::ensureHistoryDocument(String& error) {
         error = "Failed to open SD session";
         return false;
     }
-
-    if (historyDocumentId.length() == 0) {
-        FsFile root;
-        FsFile entry;
-        if (root.open(getHistoryRoot().c_str(), O_RDONLY) && root.isDir()) {
-            char entryName[64];
-            while (entry.openNext(&root, O_RDONLY)) {
-                size_t nameLen = entry.getName(entryName, sizeof(entryName));
-                bool isDir = entry.isDir();
-                entry.close();
-                if (!isDir || nameLen == 0) continue;
-
-                String manifestPath = getHistoryRoot() + "/" + String(entryName) + "/manifest.txt";
-                String manifest;
-                String readError;
-                if (!readSmallFileUnlocked(manifestPath, manifest, readError)) {
-                    continue;
-                }
-                if (manifestValue(manifest, "path") == documentPath || manifestContainsAlias(manifest, documentPath)) {
-                    historyDocumentId = entryName;
-                    String nextValue = manifestValue(manifest, "next_snapshot");
-                    historyNextSnapshotId = nextValue.length() > 0 ? static_cast<unsigned long>(nextValue.toInt()) : 1UL;
-                    activeHistorySnapshotId = historyNextSnapshotId > 1 ? historyNextSnapshotId - 1 : 0;
-                    break;
-                }
-            }
-            root.close();
-        }
-
-        if (historyDocumentId.length() == 0) {
-            historyDocumentId = buildDefaultHistoryDocumentId();
-            historyNextSnapshotId = 1;
-            activeHistorySnapshotId = 0;
+    String text;
+    if (!readSpanRange(begin, end - begin, text, error)) return false;
+    if (backward && begin > 0) {
+        const int firstBreak = text.indexOf('\n');
+        if (firstBreak >= 0 && firstBreak + 1 < static_cast<int>(text.length())) {
+            text = text.substring(firstBreak + 1);
+            begin += static_cast<size_t>(firstBreak + 1);
         }
+    } else if (!backward && end < documentLength) {
+        const int lastBreak = text.lastIndexOf('\n');
+        if (lastBreak >= 0) text = text.substring(0, lastBreak + 1);
     }
+    String before;
+    if (begin > 0 && !readSpanRange(begin - 1, 1, before, error)) return false;
 
-    if (!ensureDirectoryChainUnlocked(getDocumentHistoryRoot(), error)) {
+    if (!documentBuffer.assign(text)) {
+        error = "Out of memory";
         return false;
     }
+    windowStart = begin;
+    pageContinuesLine = before.length() > 0 && before[0] != '\n';
+    // Undo steps hold window offsets, so they end with the window.
+    undoLog.clear();
+    invalidateLayout();
+    searchHitLength = 0;
+    cursorPos = 0;
+    scrollOffset = 0;
+    error = "";
+    return true;
+}
 
-    String manifest = "path=" + documentPath + "\n";
-    manifest += "label=" + documentLabel + "\n";
-    manifest += "alias=" + documentPath + "\n";
-    manifest += "next_snapshot=" + String(historyNextSnapshotId) + "\n";
-    manifest += "size=" + String(static_cast<unsigned long>(pagedDocumentSize)) + "\n";
-    manifest += "mode=rw_whole\n";
-    if (!writeSmallFileUnlocked(getDocumentManifestPath(), manifest, error)) {
-        return false;
+bool T9EditorApp::moveWindow(int direction, String& error) {
+    if (direction > 0) {
+        const int lineBreaks = static_cast<int>(documentBuffer.count('\n'));
+        if (!loadWindow(windowStart + documentBuffer.length(), false, error)) return false;
+        lineNumberBase += lineBreaks;
+        return true;
     }
+    if (!loadWindow(windowStart, true, error)) return false;
+    lineNumberBase -= static_cast<int>(documentBuffer.count('\n'));
+    return true;
+}
 
-    error = "";
+// Open a window on the line holding offset, or up to half a window before
+// it when that line is longer.
+bool T9EditorApp::jumpWindowTo(size_t offset, String& error) {
+    const size_t back = offset > kEditorWindowBytes / 2 ? offset - kEditorWindowBytes / 2 : 0;
+    String before;
+    if (!readSpanRange(back, offset - back, before, error)) return false;
+    const int lastBreak = before.lastIndexOf('\n');
+    const size_t begin = lastBreak >= 0 ? back + static_cast<size_t>(lastBreak + 1) : back;
+
+    uint32_t lineBreaks = 0;
+    if (!countSpanLineBreaks(begin, lineBreaks, error)) return false;
+    if (!loadWindow(begin, false, error)) return false;
+    lineNumberBase = static_cast<int>(lineBreaks);
     return true;
 }
 
-bool T9EditorApp::recordPageSnapshot(const char* reason, String& error) {
-    if (sourceKind != SOURCE_PAGED_FILE || isReadOnly()) {
-        error = "";
-        return true;
+// Stream the spans into a new file, copying untouched ranges straight from
+// the old one, then swap it in. The window and cursor stay where they are.
+bool T9EditorApp::saveWindowedDocument(String& error) {
+    EditorSdSessionGuard session;
+    if (!session.begin()) {
+        error = "Failed to open SD session";
+        return false;
     }
-    if (!ensureHistoryDocument(error)) {
+
+    const String tempPath = sdSaveTempPath(documentPath);
+    FsFile source;
+    FsFile target;
+    if (!source.open(documentPath.c_str(), O_RDONLY)) {
+        error = String("Failed to open file: ") + documentPath;
+        return false;
+    }
+    if (!target.open(tempPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC)) {
+        error = String("Failed to open file for write: ") + tempPath;
         return false;
     }
 
+    bool ok = true;
+    const int spanCount = spanDocument.getSpanCount();
+    for (int i = 0; ok && i < spanCount; i++) {
+        const SpanDocument::Span& span = spanDocument.getSpan(i);
+        if (span.added) {
+            const uint8_t* text = reinterpret_cast<const uint8_t*>(spanDocument.getAddedText() + span.offset);
+            ok = target.write(text, span.length) == span.length;
+            if (!ok) error = String("Failed to write file: ") + tempPath;
+        } else if (!source.seekSet(span.offset)) {
+            error = String("Failed to seek file: ") + documentPath;
+            ok = false;
+        } else if (i + 1 == spanCount && span.offset + span.length == spanDocument.getFileSize()) {
+            ok = appendFileRemainder(source, target, error);
+        } else {
+            ok = appendFileBytes(source, target, span.length, error);
+        }
+    }
+    if (ok && (!target.sync() || static_cast<size_t>(target.size()) != spanDocument.length())) {
+        error = String("Failed to write file: ") + tempPath;
+        ok = false;
+    }
+    source.close();
+    target.close();
+    if (!ok) {
+        sdFat.remove(tempPath.c_str());
+        return false;
+    }
+    if (!sdFat.remove(documentPath.c_str()) || !sdFat.rename(tempPath.c_str(), documentPath.c_str())) {
+        error = String("Failed to replace file: ") + documentPath;
+        return false;
+    }
+    sdNoteFileResized(spanDocument.getFileSize(), spanDocument.length());
+
+    if (!spanDocument.open(documentPath, error)) return false;
+    pagedDocumentSize = spanDocument.length();
+    pageDirty = false;
+    Serial.printf("[T9Editor] Saved %u bytes from %d spans\n",
+                  static_cast<unsigned>(pagedDocumentSize), spanCount);
+    error = "";
+    return true;
+}
+
+String T9EditorApp::getEditorSystemRoot() const {
+    return String(kEditorSystemRoot);
+}
+
+String T9EditorApp::getHistoryRoot() const {
+    return String(kEditorHistoryRoot);
+}
+
+String T9EditorApp::getClipboardRoot() const {
+    return String(kEditorClipboardRoot);
+}
+
+String T9EditorApp::getDocumentHistoryRoot() const {
+    String docId = historyDocumentId.length() > 0 ? historyDocumentId : buildDefaultHistoryDocumentId();
+    return getHistoryRoot() + "/" + docId;
+}
+
+String T9EditorApp::getDocumentManifestPath() const {
+    return getDocumentHistoryRoot() + "/manifest.txt";
+}
+
+String T9EditorApp::getHistorySnapshotPath(unsigned long snapshotId) const {
+    char name[40];
+    snprintf(name, sizeof(name), "%06lu.txt", snapshotId);
+    return getDocumentHistoryRoot() + "/" + String(name);
+}
+
+String T9EditorApp::getHistoryJournalPath() const {
+    return getDocumentHistoryRoot() + "/journal.bin";
+}
+
+String T9EditorApp::getClipboardManifestPath() const {
+    return getClipboardRoot() + "/manifest.txt";
+}
+
+String T9EditorApp::getClipboardSlotPath(int slot) const {
+    char name[16];
+    snprintf(name, sizeof(name), "%02d.bin", slot);
+    return getClipboardRoot() + "/" + String(name);
+}
+
+String T9EditorApp::buildDefaultHistoryDocumentId() const {
+    String base = sanitizePathComponent(getPathTail(documentPath));
+    String hash = String(fnv1a32(documentPath), HEX);
+    hash.toUpperCase();
+    return base + "_" + hash;
+}
+
+bool T9EditorApp::ensureEditorStorage(String& error) {
     EditorSdSessionGuard session;
     if (!session.begin()) {
         error = "Failed to open SD session";
         return false;
     }
 
-    String snapshotPath = getHistorySnapshotPath(historyNextSnapshotId);
-    if (!writeSmallFileUnlocked(snapshotPath, documentBuffer, error)) {
-        return false;
-    }
+    if (!ensureDirectoryChainUnlocked(getEditorSystemRoot(), error)) return false;
+    if (!ensureDirectoryChainUnlocked(getHistoryRoot(), error)) return false;
+    if (!ensureDirectoryChainUnlocked(getClipboardRoot(), error)) return false;
+    error = "";
+    return true;
+}
 
-    historyNextSnapshotId++;
-    activeHistorySnapshotId = historyNextSnapshotId - 1;
+bool T9EditorApp::writeHistoryManifest(String& error) {
     String manifest = "path=" + documentPath + "\n";
     manifest += "label=" + documentLabel + "\n";
     manifest += "alias=" + documentPath + "\n";
-    manifest += "next_snapshot=" + String(historyNextSnapshotId) + "\n";
-    manifest += "size=" + String(static_cast<unsigned long>(documentBuffer.length())) + "\n";
-    manifest += "mode=rw_whole\n";
-    if (!writeSmallFileUnlocked(getDocumentManifestPath(), manifest, error)) {
-        return false;
+    manifest += "mode=journal\n";
+    return writeSmallFileUnlocked(getDocumentManifestPath(), manifest, error);
+}
+
+// Older firmware kept one full-text file per snapshot. Fold them into the
+// fresh journal, oldest first, and delete them.
+bool T9EditorApp::importLegacyHistory(unsigned long legacyNextSnapshotId, String& error) {
+    for (unsigned long snapshotId = 1; snapshotId < legacyNextSnapshotId; snapshotId++) {
+        const String snapshotPath = getHistorySnapshotPath(snapshotId);
+        if (!sdFat.exists(snapshotPath.c_str())) continue;
+
+        String content;
+        TextBuffer text;
+        if (!readSmallFileUnlocked(snapshotPath, content, error)) return false;
+        if (!text.assign(content)) {
+            error = "Out of memory";
+            return false;
+        }
+        content = "";
+        uint32_t journalId = 0;
+        bool changed = false;
+        if (!historyJournal.appendText(text, journalId, changed, error)) return false;
+        sdFat.remove(snapshotPath.c_str());
     }
-
+    Serial.printf("[T9Editor] Imported legacy history: %lu snapshots\n",
+                  static_cast<unsigned long>(historyJournal.getLatestId()));
     error = "";
     return true;
 }
 
-bool T9EditorApp::loadClipboardState(String& error) {
+// One-time migration: map every manifest under the history root into the
+// index. Afterwards documents are added as their history is created.
+bool T9EditorApp::rebuildHistoryIndex(String& error) {
+    std::vector<HistoryIndex::Entry> entries;
+    FsFile root;
+    FsFile entry;
+    if (root.open(getHistoryRoot().c_str(), O_RDONLY) && root.isDir()) {
+        char entryName[64];
+        while (entry.openNext(&root, O_RDONLY)) {
+            size_t nameLen = entry.getName(entryName, sizeof(entryName));
+            bool isDir = entry.isDir();
+            entry.close();
+            if (!isDir || nameLen == 0) continue;
+
+            String manifestPath = getHistoryRoot() + "/" + String(entryName) + "/manifest.txt";
+            String manifest;
+            String readError;
+            if (!readSmallFileUnlocked(manifestPath, manifest, readError)) {
+                continue;
+            }
+            std::vector<String> paths;
+            paths.push_back(manifestValue(manifest, "path"));
+            collectManifestAliases(manifest, paths);
+            for (const String& path : paths) {
+                HistoryIndex::Entry indexed;
+                if (path.length() > 0 && HistoryIndex::makeEntry(path, String(entryName), indexed)) {
+                    entries.push_back(indexed);
+                }
+            }
+        }
+        root.close();
+    }
+    if (!gHistoryIndex.rebuild(entries, error)) return false;
+    Serial.printf("[T9Editor] History index rebuilt: %u paths\n", static_cast<unsigned>(entries.size()));
+    return true;
+}
+
+bool T9EditorApp::ensureHistoryDocument(String& error) {
+    // Snapshots hold the whole document, so windowed files have none.
+    if (sourceKind != SOURCE_PAGED_FILE || isReadOnly() || isWindowedDocument()) {
+        error = "";
+        return true;
+    }
+    if (historyJournal.isOpen()) {
+        error = "";
+        return true;
+    }
     if (!ensureEditorStorage(error)) {
         return false;
     }
 
-    nextClipboardSlot = 1;
     EditorSdSessionGuard session;
     if (!session.begin()) {
         error = "Failed to open SD session";
         return false;
     }
 
-    if (sdFat.exists(getClipboardManifestPath().c_str())) {
-        String manifest;
-        if (!readSmallFileUnlocked(getClipboardManifestPath(), manifest, error)) {
-            return false;
-        }
-        String nextValue = manifestValue(manifest, "next_slot");
-        if (nextValue.length() > 0) {
-            nextClipboardSlot = nextValue.toInt();
-        }
-        if (nextClipboardSlot < 1 || nextClipboardSlot > kClipboardSlotCount) {
-            nextClipboardSlot = 1;
+    bool manifestCurrent = false;
+    bool needsIndexEntry = false;
+    unsigned long legacyNextSnapshotId = 0;
+    bool indexUsable = false;
+    if (historyDocumentId.length() == 0) {
+        indexUsable = gHistoryIndex.isAvailable() || (rebuildHistoryIndex(error) && gHistoryIndex.isAvailable());
+        if (!indexUsable) {
+            Serial.printf("[T9Editor] History index rebuild failed: %s\n", error.c_str());
+        }
+
+        String indexedId;
+        if (indexUsable && gHistoryIndex.find(documentPath, indexedId)) {
+            historyDocumentId = indexedId;
+            String manifest;
+            String readError;
+            if (readSmallFileUnlocked(getDocumentManifestPath(), manifest, readError)) {
+                manifestCurrent = manifestValue(manifest, "mode") == "journal";
+                String nextValue = manifestValue(manifest, "next_snapshot");
+                if (!manifestCurrent && nextValue.length() > 0) {
+                    legacyNextSnapshotId = static_cast<unsigned long>(nextValue.toInt());
+                }
+            }
+        } else {
+            historyDocumentId = buildDefaultHistoryDocumentId();
+            // Inserting into a missing index would write one holding only
+            // this document and hide every other history; the next open
+            // retries the rebuild instead.
+            needsIndexEntry = indexUsable;
         }
     }
 
-    for (int slot = 1; slot <= kClipboardSlotCount; slot++) {
-        String slotPath = getClipboardSlotPath(slot);
-        if (!sdFat.exists(slotPath.c_str()) &&
-            !writeFixedRecordUnlocked(slotPath,
-                                      kEditorRecordKindClipboardSlot,
-                                      static_cast<uint32_t>(slot),
-                                      0,
-                                      0,
-                                      "",
-                                      error)) {
-            return false;
+    if (!ensureDirectoryChainUnlocked(getDocumentHistoryRoot(), error)) {
+        return false;
+    }
+    if (!historyJournal.open(getHistoryJournalPath(), error)) {
+        return false;
+    }
+    if (legacyNextSnapshotId > 1 && historyJournal.getLatestId() == 0 &&
+        !importLegacyHistory(legacyNextSnapshotId, error)) {
+        Serial.printf("[T9Editor] Legacy history import stopped: %s\n", error.c_str());
+    }
+    // The manifest only maps the document to its history directory, so it
+    // is written once instead of on every snapshot.
+    if (!manifestCurrent && !writeHistoryManifest(error)) {
+        historyJournal.close();
+        return false;
+    }
+    if (needsIndexEntry) {
+        String indexError;
+        if (!gHistoryIndex.insert(documentPath, historyDocumentId, indexError)) {
+            Serial.printf("[T9Editor] History index update failed: %s\n", indexError.c_str());
         }
     }
+    activeHistorySnapshotId = historyJournal.getLatestId();
 
-    return storeClipboardState(error);
+    error = "";
+    return true;
 }
 
-bool T9EditorApp::storeClipboardState(String& error) {
+bool T9EditorApp::recordPageSnapshot(const char* reason, String& error) {
+    if (sourceKind != SOURCE_PAGED_FILE || isReadOnly() || isWindowedDocument()) {
+        error = "";
+        return true;
+    }
+    if (!ensureHistoryDocument(error)) {
+        return false;
+    }
+
     EditorSdSessionGuard session;
     if (!session.begin()) {
         error = "Failed to open SD session";
         return false;
     }
 
-    String manifest = "next_slot=" + String(nextClipboardSlot) + "\n";
-    manifest += "slot_count=" + String(kClipboardSlotCount) + "\n";
-    return writeSmallFileUnlocked(getClipboardManifestPath(), manifest, error);
+    // With every edit since the latest snapshot folded into one range, the
+    // new snapshot is written as just that range.
+    uint32_t snapshotId = 0;
+    bool written = false;
+    if (historyEditsTracked && historyJournal.getLatestId() != 0) {
+        if (!historyEditPending) {
+            activeHistorySnapshotId = historyJournal.getLatestId();
+            error = "";
+            return true;
+        }
+        const int removedLength = historyEditEnd - historyEditDelta - historyEditStart;
+        const int insertedLength = historyEditEnd - historyEditStart;
+        written = historyJournal.appendEdit(documentBuffer, historyEditStart, removedLength,
+                                            insertedLength, snapshotId, error);
+    }
+    if (!written) {
+        bool changed = false;
+        if (!historyJournal.appendText(documentBuffer, snapshotId, changed, error)) {
+            return false;
+        }
+        written = changed;
+    }
+
+    historyEditsTracked = true;
+    historyEditPending = false;
+    activeHistorySnapshotId = snapshotId;
+    if (written) {
+        Serial.printf("[T9Editor] History %s: snapshot %lu, %u bytes\n", reason,
+                      static_cast<unsigned long>(snapshotId),
+                      static_cast<unsigned>(historyJournal.getLastAppendBytes()));
+    }
+    error = "";
+    return true;
 }
 
-bool T9EditorApp::writeClipboardSlot(const String& content, int& writtenSlot, String& error) {
-    writtenSlot = 0;
-    if (!loadClipboardState(error)) {
-        return false;
+bool T9EditorApp::loadClipboardState(String& error) {
+    if (gClipboard.isLoaded()) {
+        error = "";
+        return true;
     }
-    if (static_cast<size_t>(content.length()) > kEditorRecordPayloadBytes) {
-        error = "Clipboard content exceeds page size";
+    if (!ensureEditorStorage(error)) {
         return false;
     }
 
@@ -1743,31 +1921,62 @@ bool T9EditorApp::writeClipboardSlot(const String& content, int& writtenSlot, St
         error = "Failed to open SD session";
         return false;
     }
+    if (!gClipboard.load(error)) {
+        return false;
+    }
+    if (!gClipboard.hasFile() && sdFat.exists(getClipboardManifestPath().c_str())) {
+        return importLegacyClipboard(error);
+    }
+    return true;
+}
 
-    writtenSlot = nextClipboardSlot;
-    if (!writeFixedRecordUnlocked(getClipboardSlotPath(writtenSlot),
-                                  kEditorRecordKindClipboardSlot,
-                                  static_cast<uint32_t>(writtenSlot),
-                                  static_cast<uint32_t>(content.length()),
-                                  0,
-                                  content,
-                                  error)) {
-        writtenSlot = 0;
+// Move the clipboard from one record file per slot plus a manifest into the
+// packed file, then delete the old files.
+bool T9EditorApp::importLegacyClipboard(String& error) {
+    String manifest;
+    if (!readSmallFileUnlocked(getClipboardManifestPath(), manifest, error)) {
         return false;
     }
+    int legacyNextSlot = manifestValue(manifest, "next_slot").toInt();
+    if (legacyNextSlot < 1 || legacyNextSlot > kClipboardSlotCount) {
+        legacyNextSlot = 1;
+    }
 
-    nextClipboardSlot++;
-    if (nextClipboardSlot > kClipboardSlotCount) {
-        nextClipboardSlot = 1;
+    int imported = 0;
+    for (int slot = 1; slot <= kClipboardSlotCount; slot++) {
+        const String slotPath = getClipboardSlotPath(slot);
+        if (!sdFat.exists(slotPath.c_str())) continue;
+        String content;
+        String readError;
+        uint32_t documentLength = 0;
+        uint32_t flags = 0;
+        if (readFixedRecordUnlocked(slotPath, kEditorRecordKindClipboardSlot, static_cast<uint32_t>(slot),
+                                    content, documentLength, flags, readError)) {
+            if (content.length() > 0) imported++;
+            gClipboard.setSlot(slot - 1, content);
+        } else {
+            Serial.printf("[T9Editor] Skipping legacy clipboard slot: %s\n", readError.c_str());
+        }
     }
-    return storeClipboardState(error);
+    gClipboard.setNextSlot(legacyNextSlot - 1);
+    if (!gClipboard.flush(error)) {
+        return false;
+    }
+
+    for (int slot = 1; slot <= kClipboardSlotCount; slot++) {
+        const String slotPath = getClipboardSlotPath(slot);
+        if (sdFat.exists(slotPath.c_str())) sdFat.remove(slotPath.c_str());
+    }
+    sdFat.remove(getClipboardManifestPath().c_str());
+    Serial.printf("[T9Editor] Imported %d legacy clipboard slots\n", imported);
+    error = "";
+    return true;
 }
 
-bool T9EditorApp::readClipboardSlot(int slot, String& content, String& error) const {
-    content = "";
-    if (slot < 1 || slot > kClipboardSlotCount) {
-        error = "Clipboard slot is out of range";
-        return false;
+bool T9EditorApp::flushClipboard(String& error) {
+    if (!gClipboard.isDirty()) {
+        error = "";
+        return true;
     }
 
     EditorSdSessionGuard session;
@@ -1775,24 +1984,27 @@ bool T9EditorApp::readClipboardSlot(int slot, String& content, String& error) co
         error = "Failed to open SD session";
         return false;
     }
-
-    uint32_t documentLength = 0;
-    uint32_t flags = 0;
-    if (!readFixedRecordUnlocked(getClipboardSlotPath(slot),
-                                 kEditorRecordKindClipboardSlot,
-                                 static_cast<uint32_t>(slot),
-                                 content,
-                                 documentLength,
-                                 flags,
-                                 error)) {
+    if (!ensureDirectoryChainUnlocked(getClipboardRoot(), error)) {
         return false;
     }
-    if (static_cast<size_t>(content.length()) > kEditorRecordPayloadBytes) {
-        error = "Clipboard slot exceeds page size";
-        content = "";
+    return gClipboard.flush(error);
+}
+
+bool T9EditorApp::writeClipboardSlot(const String& content, int& writtenSlot, String& error) {
+    writtenSlot = -1;
+    if (!loadClipboardState(error)) {
         return false;
     }
+    return gClipboard.push(content, writtenSlot, error);
+}
 
+bool T9EditorApp::readClipboardSlot(int slot, String& content, String& error) const {
+    content = "";
+    if (slot < 0 || slot >= gClipboard.getSlotCount()) {
+        error = "Clipboard slot is out of range";
+        return false;
+    }
+    content = gClipboard.getSlot(slot);
     error = "";
     return true;
 }
@@ -1806,34 +2018,46 @@ bool T9EditorApp::saveCurrentPage(String& error) {
         error = "Document is read-only";
         return false;
     }
-    if (static_cast<size_t>(documentBuffer.length()) > kT9EditorReadWriteMaxBytes) {
-        error = "Document exceeds RW size cap";
-        return false;
+    // Saving an unchanged document would rewrite the same bytes.
+    if (!pageDirty) {
+        Serial.printf("[T9Editor] Save skipped, no changes: %s\n", documentPath.c_str());
+        error = "";
+        return true;
     }
 
+    // One SD session for the whole save: the document and the history
+    // snapshot each take one sync.
     EditorSdSessionGuard session;
     if (!session.begin()) {
         error = "Failed to open SD session";
         return false;
     }
+    const unsigned long started = millis();
+    if (isWindowedDocument()) {
+        if (!saveWindowedDocument(error)) return false;
+    } else {
+        if (static_cast<size_t>(documentBuffer.length()) > kT9EditorReadWriteMaxBytes) {
+            error = "Document exceeds RW size cap";
+            return false;
+        }
+        if (!writeFileAtomicUnlocked(documentPath, documentBuffer, error)) {
+            return false;
+        }
+        pagedDocumentSize = static_cast<size_t>(documentBuffer.length());
+        updatePagedDocumentMetrics(pagedDocumentSize);
+        pageDirty = false;
 
-    if (!writeSmallFileUnlocked(documentPath, documentBuffer, error)) {
-        return false;
-    }
-
-    pagedDocumentSize = static_cast<size_t>(documentBuffer.length());
-    updatePagedDocumentMetrics(pagedDocumentSize);
-    pageDirty = false;
-
-    if (!ensureHistoryDocument(error)) {
-        return false;
-    }
-
-    String snapshotError;
-    if (!recordPageSnapshot("save", snapshotError)) {
-        Serial.printf("[T9Editor] Snapshot warning after save: %s\n", snapshotError.c_str());
+        String snapshotError;
+        if (!recordPageSnapshot("save", snapshotError)) {
+            Serial.printf("[T9Editor] Snapshot warning after save: %s\n", snapshotError.c_str());
+        }
     }
 
+    lastSaveMs = millis() - started;
+    maxSaveMs = max(maxSaveMs, lastSaveMs);
+    saveCount++;
+    Serial.printf("[T9Editor] Save #%lu: %u bytes in %lu ms (max %lu ms)\n", saveCount,
+                  static_cast<unsigned>(pagedDocumentSize), lastSaveMs, maxSaveMs);
     error = "";
     return true;
 }
@@ -1845,9 +2069,15 @@ bool T9EditorApp::loadPagedDocument(String& error) {
             currentPageIndex = 0;
             return loadPageByIndex(0, error);
         }
-        size_t fileSize = 0;
-        if (!statPagedDocument(fileSize, error)) return false;
-        updatePagedDocumentMetrics(fileSize);
+        EditorSdSessionGuard session;
+        if (!session.begin()) {
+            error = "Failed to open SD session";
+            return false;
+        }
+        if (!viewerReader.open(documentPath, getT9EditorReadOnlyPageBytes(), error)) return false;
+        Serial.printf("[T9Editor] Viewer index: %s, %u bytes\n",
+                      viewerReader.wasIndexCached() ? "cached" : "building",
+                      static_cast<unsigned>(viewerReader.getFileSize()));
         currentPageIndex = 0;
         return loadPageByIndex(0, error);
     }
@@ -1863,6 +2093,7 @@ bool T9EditorApp::loadPagedDocument(String& error) {
 }
 
 bool T9EditorApp::loadPageByIndex(int pageIndex, String& error) {
+    searchHitLength = 0;
     if (isReadOnly()) {
         if (sourceKind == SOURCE_BUFFER) {
             const size_t bufferSize = static_cast<size_t>(sourceBuffer.length());
@@ -1879,8 +2110,8 @@ bool T9EditorApp::loadPageByIndex(int pageIndex, String& error) {
                 length = remaining < static_cast<size_t>(sourcePageSize) ? remaining : static_cast<size_t>(sourcePageSize);
             }
 
-            documentBuffer = sourceBuffer.substring(static_cast<unsigned int>(start),
-                                                    static_cast<unsigned int>(start + length));
+            documentBuffer.assign(sourceBuffer.c_str() + start, length);
+            invalidateLayout();
             currentPageIndex = pageIndex;
             pageDirty = false;
             cursorPos = 0;
@@ -1888,29 +2119,25 @@ bool T9EditorApp::loadPageByIndex(int pageIndex, String& error) {
             error = "";
             return true;
         }
-        size_t fileSize = 0;
-        if (!statPagedDocument(fileSize, error)) {
+        EditorSdSessionGuard session;
+        if (!session.begin()) {
+            error = "Failed to open SD session";
             return false;
         }
-        updatePagedDocumentMetrics(fileSize);
-        if (pageIndex < 0 || pageIndex >= totalPageCount) {
-            error = "Requested page is out of range";
+        String pageText;
+        if (pageIndex < 0 || !viewerReader.readPage(pageIndex, pageText, error)) {
+            if (error.length() == 0) error = "Requested page is out of range";
             return false;
         }
+        syncViewerPageCount();
 
-        const size_t start = static_cast<size_t>(pageIndex) * static_cast<size_t>(sourcePageSize);
-        size_t length = 0;
-        if (fileSize > start) {
-            const size_t remaining = fileSize - start;
-            length = remaining < static_cast<size_t>(sourcePageSize) ? remaining : static_cast<size_t>(sourcePageSize);
-        }
-
-        String pageText;
-        if (!readFileRange(start, length, pageText, error)) {
+        if (!documentBuffer.assign(pageText)) {
+            error = "Out of memory";
             return false;
         }
-
-        documentBuffer = pageText;
+        invalidateLayout();
+        lineNumberBase = static_cast<int>(viewerReader.getPageFirstLine(pageIndex)) - 1;
+        pageContinuesLine = viewerReader.pageStartsMidLine(pageIndex);
         currentPageIndex = pageIndex;
         pageDirty = false;
         cursorPos = 0;
@@ -1922,22 +2149,37 @@ bool T9EditorApp::loadPageByIndex(int pageIndex, String& error) {
     if (!statPagedDocument(fileSize, error)) {
         return false;
     }
-    if (fileSize > kT9EditorReadWriteMaxBytes) {
-        error = "File too large for RW";
-        return false;
-    }
     updatePagedDocumentMetrics(fileSize);
     if (pageIndex != 0) {
         error = "Requested page is out of range";
         return false;
     }
+    if (fileSize > kT9EditorReadWriteMaxBytes) {
+        EditorSdSessionGuard session;
+        if (!session.begin()) {
+            error = "Failed to open SD session";
+            return false;
+        }
+        if (!spanDocument.open(documentPath, error)) return false;
+        Serial.printf("[T9Editor] Editing %u bytes through %u byte windows\n",
+                      static_cast<unsigned>(fileSize), static_cast<unsigned>(kEditorWindowBytes));
+        lineNumberBase = 0;
+        pageDirty = false;
+        return loadWindow(0, false, error);
+    }
 
     String fullText;
     if (!readFileRange(0, fileSize, fullText, error)) {
         return false;
     }
 
-    documentBuffer = fullText;
+    if (!documentBuffer.assign(fullText)) {
+        error = "Out of memory";
+        return false;
+    }
+    invalidateLayout();
+    historyEditsTracked = false;
+    historyEditPending = false;
     currentPageIndex = 0;
     pageDirty = false;
     cursorPos = 0;
@@ -1950,12 +2192,310 @@ bool T9EditorApp::isReadOnlyPaged() const {
     return isReadOnly() && totalPageCount > 0;
 }
 
+bool T9EditorApp::isViewingFile() const {
+    return isReadOnly() && sourceKind == SOURCE_PAGED_FILE && viewerReader.isOpen();
+}
+
+void T9EditorApp::syncViewerPageCount() {
+    sourcePageSize = static_cast<int>(getT9EditorReadOnlyPageBytes());
+    pagedDocumentSize = viewerReader.getFileSize();
+    totalPageCount = max(1, viewerReader.getPageCount());
+}
+
+// Digits typed in the viewer build a line number; Enter jumps to it.
+bool T9EditorApp::handleGotoLineInput(char key) {
+    if (key >= '0' && key <= '9') {
+        if (gotoLineInput.length() < 7 && !(gotoLineInput.length() == 0 && key == '0')) {
+            gotoLineInput += key;
+        }
+        return true;
+    }
+    if (gotoLineInput.length() == 0) return false;
+    if (key == KEY_BKSP) {
+        gotoLineInput.remove(gotoLineInput.length() - 1);
+        return true;
+    }
+    if (key == KEY_ESC) {
+        gotoLineInput = "";
+        return true;
+    }
+    if (key == KEY_ENTER) {
+        const unsigned long line = strtoul(gotoLineInput.c_str(), nullptr, 10);
+        gotoLineInput = "";
+        jumpToLine(line);
+        return true;
+    }
+    return false;
+}
+
+bool T9EditorApp::jumpToLine(unsigned long line) {
+    String error;
+    int page = 0;
+    size_t offset = 0;
+    {
+        EditorSdSessionGuard session;
+        if (!session.begin()) {
+            GUI::showToast("Failed to open SD session", 2000);
+            return false;
+        }
+        if (!viewerReader.isIndexComplete()) {
+            drawCenteredStatusDialog("indexing");
+        }
+        if (!viewerReader.findLine(static_cast<uint32_t>(line), page, offset, error) ||
+            !loadPageByIndex(page, error)) {
+            GUI::showToast(error.c_str(), 2000);
+            return false;
+        }
+    }
+
+    // Put the line at the top of the screen.
+    cursorPos = static_cast<int>(offset);
+    recalculateLayout();
+    scrollOffset = cursorLineIndex;
+    recalculateLayout();
+    return true;
+}
+
+// ============================================================================
+// FIND
+// ============================================================================
+
+static int readSearchFile(void* context, size_t offset, char* out, size_t length) {
+    FsFile* file = static_cast<FsFile*>(context);
+    if (!file->seekSet(offset)) return -1;
+    return file->read(out, length);
+}
+
+static int readSearchString(void* context, size_t offset, char* out, size_t length) {
+    const String* text = static_cast<const String*>(context);
+    const size_t size = static_cast<size_t>(text->length());
+    if (offset >= size) return 0;
+    if (length > size - offset) length = size - offset;
+    memcpy(out, text->c_str() + offset, length);
+    return static_cast<int>(length);
+}
+
+static int readSearchTextBuffer(void* context, size_t offset, char* out, size_t length) {
+    return static_cast<int>(static_cast<const TextBuffer*>(context)->copyRange(offset, length, out));
+}
+
+struct SpanSearchSource {
+    const SpanDocument* document;
+    FsFile file;
+};
+
+static int readSearchSpans(void* context, size_t offset, char* out, size_t length) {
+    SpanSearchSource* source = static_cast<SpanSearchSource*>(context);
+    return source->document->read(source->file, offset, out, length);
+}
+
+bool T9EditorApp::isFindBarVisible() const {
+    return findPromptActive || search.isActive();
+}
+
+void T9EditorApp::openFindPrompt() {
+    clearTransientInputState();
+    findPromptActive = true;
+    findTapKey = '\0';
+    findTapIndex = 0;
+    findTapTime = 0;
+    recalculateLayout();
+}
+
+void T9EditorApp::closeFindPrompt() {
+    findPromptActive = false;
+    findTapKey = '\0';
+    findTapIndex = 0;
+    findTapTime = 0;
+}
+
+void T9EditorApp::commitFindTap() {
+    if (findTapKey == '\0') return;
+    const char* map = multiTapMap[findTapKey - '0'];
+    if (findPattern.length() < static_cast<int>(StreamSearch::MAX_PATTERN)) {
+        findPattern += map[findTapIndex % strlen(map)];
+    }
+    findTapKey = '\0';
+    findTapIndex = 0;
+}
+
+void T9EditorApp::handleFindInput(char key) {
+    if (search.isActive()) {
+        if (key == KEY_ESC) {
+            search.cancel();
+            recalculateLayout();
+        }
+        return;
+    }
+
+    if (key >= '0' && key <= '9') {
+        const unsigned long now = millis();
+        if (key == findTapKey && now - findTapTime < MULTITAP_TIMEOUT) {
+            findTapIndex = (findTapIndex + 1) % strlen(multiTapMap[key - '0']);
+        } else {
+            commitFindTap();
+            findTapKey = key;
+            findTapIndex = 0;
+        }
+        findTapTime = now;
+        return;
+    }
+    if (key == KEY_BKSP) {
+        if (findTapKey != '\0') {
+            findTapKey = '\0';
+            findTapIndex = 0;
+        } else if (findPattern.length() > 0) {
+            findPattern.remove(findPattern.length() - 1);
+        } else {
+            closeFindPrompt();
+            recalculateLayout();
+        }
+        return;
+    }
+    if (key == KEY_ESC) {
+        closeFindPrompt();
+        recalculateLayout();
+        return;
+    }
+    if (key == KEY_ENTER) {
+        commitFindTap();
+        closeFindPrompt();
+        if (findPattern.length() > 0) {
+            startSearch();
+        }
+        recalculateLayout();
+    }
+}
+
+// Search from just after the current hit, else from the top of the screen
+// (viewer) or the cursor (editor), wrapping around the whole document.
+bool T9EditorApp::startSearch() {
+    size_t base = 0;
+    size_t length = 0;
+    if (isViewingFile()) {
+        base = viewerReader.getPageOffset(currentPageIndex);
+        length = viewerReader.getFileSize();
+    } else if (isReadOnly() && sourceKind == SOURCE_BUFFER) {
+        base = static_cast<size_t>(currentPageIndex) * static_cast<size_t>(sourcePageSize);
+        length = static_cast<size_t>(sourceBuffer.length());
+    } else if (isWindowedDocument()) {
+        base = windowStart;
+        length = spanDocument.length();
+    } else {
+        length = documentBuffer.length();
+    }
+
+    int local = cursorPos;
+    if (searchHitLength > 0) {
+        local = searchHitStart + 1;
+    } else if (isReadOnly() && !visualLines.empty()) {
+        local = visualLines[min(scrollOffset, static_cast<int>(visualLines.size()) - 1)].byteStartIndex;
+    }
+    if (!search.start(findPattern, length, base + static_cast<size_t>(max(0, local)))) {
+        GUI::showToast("Search unavailable", 1500);
+        return false;
+    }
+    return true;
+}
+
+void T9EditorApp::serviceSearch() {
+    if (!search.isActive()) return;
+
+    StreamSearch::Status status;
+    if (isViewingFile()) {
+        EditorSdSessionGuard session;
+        FsFile file;
+        if (!session.begin() || !file.open(documentPath.c_str(), O_RDONLY)) {
+            search.cancel();
+            GUI::showToast("Search failed", 1500);
+            recalculateLayout();
+            return;
+        }
+        status = search.step(readSearchFile, &file, kSearchBytesPerUpdate);
+    } else if (isWindowedDocument()) {
+        EditorSdSessionGuard session;
+        SpanSearchSource source;
+        source.document = &spanDocument;
+        if (!session.begin() || !source.file.open(documentPath.c_str(), O_RDONLY)) {
+            search.cancel();
+            GUI::showToast("Search failed", 1500);
+            recalculateLayout();
+            return;
+        }
+        status = search.step(readSearchSpans, &source, kSearchBytesPerUpdate);
+    } else if (isReadOnly() && sourceKind == SOURCE_BUFFER) {
+        status = search.step(readSearchString, &sourceBuffer, kSearchBytesPerUpdate);
+    } else {
+        status = search.step(readSearchTextBuffer, &documentBuffer, kSearchBytesPerUpdate);
+    }
+
+    if (status == StreamSearch::SEARCHING) return;
+    if (status == StreamSearch::FOUND) {
+        const bool wrapped = search.isMatchWrapped();
+        const size_t offset = search.getMatchOffset();
+        const size_t length = search.getPatternLength();
+        search.cancel();
+        if (showSearchHit(offset, length) && wrapped) {
+            GUI::showToast("Search wrapped", 1000);
+        }
+        return;
+    }
+    GUI::showToast(status == StreamSearch::NOT_FOUND ? "Not found" : "Search failed", 1500);
+    searchHitLength = 0;
+    recalculateLayout();
+}
+
+bool T9EditorApp::showSearchHit(size_t offset, size_t length) {
+    String error;
+    int page = currentPageIndex;
+    size_t local = offset;
+    if (isViewingFile()) {
+        EditorSdSessionGuard session;
+        if (!session.begin() || !viewerReader.findOffset(offset, page, local, error)) {
+            GUI::showToast(error.length() > 0 ? error.c_str() : "Failed to open SD session", 2000);
+            return false;
+        }
+    } else if (isReadOnly() && sourceKind == SOURCE_BUFFER) {
+        page = static_cast<int>(offset / static_cast<size_t>(sourcePageSize));
+        local = offset % static_cast<size_t>(sourcePageSize);
+    } else if (isWindowedDocument()) {
+        if ((offset < windowStart || offset >= windowStart + documentBuffer.length()) &&
+            !jumpWindowTo(offset, error)) {
+            GUI::showToast(error.c_str(), 2000);
+            return false;
+        }
+        local = offset - windowStart;
+    }
+    if (isReadOnly() && page != currentPageIndex && !loadPageByIndex(page, error)) {
+        GUI::showToast(error.c_str(), 2000);
+        return false;
+    }
+
+    // A hit that runs into the next page is highlighted up to the page end.
+    const int documentLength = getDocumentLength();
+    searchHitStart = min(static_cast<int>(local), documentLength);
+    searchHitLength = min(static_cast<int>(length), documentLength - searchHitStart);
+    cursorPos = searchHitStart;
+    recalculateLayout();
+    if (isReadOnly()) {
+        const int line = findVisualLine(searchHitStart);
+        if (line < scrollOffset || line >= scrollOffset + getVisibleLineCount()) {
+            scrollOffset = line;
+            recalculateLayout();
+        }
+    }
+    return true;
+}
+
 bool T9EditorApp::hasPreviousPage() const {
+    if (isWindowedDocument()) return windowStart > 0;
     if (isReadOnlyPaged()) return currentPageIndex > 0;
     return sourceKind == SOURCE_PAGED_FILE && currentPageIndex > 0;
 }
 
 bool T9EditorApp::hasNextPage() const {
+    if (isViewingFile() && !viewerReader.isIndexComplete()) return true;
+    if (isWindowedDocument()) return windowStart + documentBuffer.length() < spanDocument.length();
     if (isReadOnlyPaged()) return currentPageIndex + 1 < totalPageCount;
     return sourceKind == SOURCE_PAGED_FILE && currentPageIndex + 1 < totalPageCount;
 }
@@ -1985,19 +2525,15 @@ int T9EditorApp::getVisibleLineCount() const {
 }
 
 int T9EditorApp::countLogicalLines() const {
-    int count = 1;
-    for (int i = 0; i < getDocumentLength(); i++) {
-        if (documentBuffer[i] == '\n') count++;
-    }
-    return count;
+    return 1 + static_cast<int>(documentBuffer.count('\n'));
 }
 
 int T9EditorApp::getGutterWidth(int logicalLineCount) const {
     if (!showLineNumbers()) return 0;
     char buf[12];
-    snprintf(buf, sizeof(buf), "%d", max(1, logicalLineCount));
-    u8g2.setFont(getCurrentFontMetrics().font);
-    return u8g2.getStrWidth(buf) + 4;
+    snprintf(buf, sizeof(buf), "%d", max(1, lineNumberBase + logicalLineCount));
+    GUI::setFont(getCurrentFontMetrics().font);
+    return GUI::getTextWidth(buf) + 4;
 }
 
 int T9EditorApp::getTextLeft(int logicalLineCount) const {
@@ -2021,7 +2557,7 @@ void T9EditorApp::requestExit(bool saveRequested) {
                           static_cast<unsigned>(documentBuffer.length()),
                           documentPath.length() > 0 ? documentPath.c_str() : "(buffer)");
         }
-        appTransferString = (sourceKind == SOURCE_PAGED_FILE) ? String("") : documentBuffer;
+        appTransferString = (sourceKind == SOURCE_PAGED_FILE) ? String("") : documentBuffer.toString();
     }
     appTransferBool = saveRequested;
     appTransferResultReady = true;
@@ -2090,11 +2626,37 @@ String T9EditorApp::getPreviewText() const {
     return preview;
 }
 
-String T9EditorApp::getDisplayText(String* previewOut) const {
-    String preview = getPreviewText();
-    if (previewOut) *previewOut = preview;
-    if (preview.length() == 0) return documentBuffer;
-    return documentBuffer.substring(0, cursorPos) + preview + documentBuffer.substring(cursorPos);
+// The display text is documentBuffer with preview inserted at cursorPos.
+// Slices are composed from the two without building the whole text.
+String T9EditorApp::readDisplaySlice(int start, int length, const String& preview) const {
+    const int previewLength = preview.length();
+    if (previewLength == 0 || start + length <= cursorPos) {
+        return documentBuffer.substring(start, start + length);
+    }
+    if (start >= cursorPos + previewLength) {
+        return documentBuffer.substring(start - previewLength, start - previewLength + length);
+    }
+
+    String slice;
+    slice.reserve(length);
+    for (int i = start; i < start + length; i++) {
+        if (i < cursorPos) slice += documentBuffer[i];
+        else if (i < cursorPos + previewLength) slice += preview[i - cursorPos];
+        else slice += documentBuffer[i - previewLength];
+    }
+    return slice;
+}
+
+// Display offset of the next '\n' at or after from, or the display length.
+int T9EditorApp::findDisplayLineEnd(int from, const String& preview) const {
+    const int previewLength = preview.length();
+    int docFrom = from;
+    if (from >= cursorPos) {
+        docFrom = max(cursorPos, from - previewLength);
+    }
+    const int newline = documentBuffer.indexOf('\n', docFrom);
+    if (newline < 0) return getDocumentLength() + previewLength;
+    return (newline < cursorPos) ? newline : newline + previewLength;
 }
 
 void T9EditorApp::commitMultiTap() {
@@ -2182,25 +2744,7 @@ void T9EditorApp::moveCursorVertically(int dir) {
         return;
     }
 
-    int currentVisualLine = -1;
-    for (int i = 0; i < static_cast<int>(visualLines.size()); i++) {
-        const VisualLine& vl = visualLines[i];
-        int absStart = vl.byteStartIndex;
-        int absEnd = absStart + vl.byteLength;
-        bool segmentEnd = (i + 1 >= static_cast<int>(visualLines.size())) ||
-                          (visualLines[i + 1].byteStartIndex != absEnd);
-        if ((cursorPos >= absStart && cursorPos < absEnd) ||
-            (vl.byteLength == 0 && cursorPos == absStart) ||
-            (segmentEnd && cursorPos == absEnd)) {
-            currentVisualLine = i;
-            break;
-        }
-    }
-
-    if (currentVisualLine < 0) {
-        return;
-    }
-
+    int currentVisualLine = findVisualLine(cursorPos);
     int targetVisualLine = currentVisualLine + dir;
     if (targetVisualLine < 0 || targetVisualLine >= static_cast<int>(visualLines.size())) {
         return;
@@ -2259,6 +2803,11 @@ void T9EditorApp::handleInput(char key) {
         return;
     }
 
+    if (isFindBarVisible()) {
+        handleFindInput(key);
+        return;
+    }
+
     if (selectionMode) {
         if (key == KEY_SHIFT) {
             if (isKeyHeld(KEY_SHIFT)) {
@@ -2340,6 +2889,10 @@ void T9EditorApp::handleInput(char key) {
         return;
     }
 
+    if (isViewingFile() && handleGotoLineInput(key)) {
+        return;
+    }
+
     bool layoutChanged = false;
 
     if (!isReadOnly() && zeroPending && key != '0') {
@@ -2355,6 +2908,23 @@ void T9EditorApp::handleInput(char key) {
         cursorMoveTime = millis();
     }
 
+    if (key == KEY_ESC && searchHitLength > 0) {
+        searchHitLength = 0;
+        return;
+    }
+
+    // Enter in the viewer (Alt+Enter in the editor) finds the next hit, or
+    // opens the find bar.
+    if (key == KEY_ENTER && (isReadOnly() || isKeyActiveNow(KEY_ALT))) {
+        if (searchHitLength > 0 && findPattern.length() > 0) {
+            startSearch();
+        } else {
+            openFindPrompt();
+        }
+        recalculateLayout();
+        return;
+    }
+
     if (key == KEY_ESC) {
         if (isReadOnly()) {
             requestExit(false);
@@ -2493,7 +3063,7 @@ void T9EditorApp::handleInput(char key) {
         if (sourceKind == SOURCE_PAGED_FILE) {
             if (key == KEY_LEFT && cursorPos == 0 && hasPreviousPage()) {
                 String error;
-                if (!loadPageByIndex(currentPageIndex - 1, error)) {
+                if (isWindowedDocument() ? !moveWindow(-1, error) : !loadPageByIndex(currentPageIndex - 1, error)) {
                     GUI::showToast(error.c_str(), 2000);
                 } else {
                     cursorPos = getDocumentLength();
@@ -2503,7 +3073,7 @@ void T9EditorApp::handleInput(char key) {
             }
             if (key == KEY_RIGHT && cursorPos == getDocumentLength() && hasNextPage()) {
                 String error;
-                if (!loadPageByIndex(currentPageIndex + 1, error)) {
+                if (isWindowedDocument() ? !moveWindow(1, error) : !loadPageByIndex(currentPageIndex + 1, error)) {
                     GUI::showToast(error.c_str(), 2000);
                 } else {
                     cursorPos = 0;
@@ -2764,81 +3334,270 @@ void T9EditorApp::update() {
         }
     }
 
+    // Index the viewed file and read ahead a few KB per frame.
+    if (isViewingFile() && viewerReader.hasPendingWork()) {
+        EditorSdSessionGuard session;
+        if (session.begin()) {
+            viewerReader.service(kViewerIndexBytesPerUpdate);
+            syncViewerPageCount();
+        }
+    }
+
+    if (search.isActive()) {
+        serviceSearch();
+    } else if (findPromptActive && findTapKey != '\0' && millis() - findTapTime > MULTITAP_TIMEOUT) {
+        commitFindTap();
+    }
+
+    // Copies stay in RAM until the clipboard has been quiet for a while.
+    if (gClipboard.isDirty() && millis() - gClipboard.getLastChangeMs() >= CLIPBOARD_FLUSH_IDLE_MS) {
+        String clipboardError;
+        if (!flushClipboard(clipboardError)) {
+            Serial.printf("[T9Editor] Clipboard flush failed: %s\n", clipboardError.c_str());
+        }
+    }
+
     if (layoutChanged) {
         recalculateLayout();
     }
 }
 
-void T9EditorApp::recalculateLayout() {
-    visualLines.clear();
+void T9EditorApp::invalidateLayout() {
+    layoutValid = false;
+    layoutDamaged = false;
+    layoutFont = nullptr;
+    layoutTextLeft = 0;
+    layoutLogicalLineCount = 1;
+    layoutDisplayLength = 0;
+    layoutPreviewLength = 0;
+    layoutDamageStart = 0;
+    layoutDamageEnd = 0;
+    layoutDamageDelta = 0;
+}
+
+// Fold an edit into a range of changed text. rangeEnd is in current
+// document coordinates and rangeDelta is the net bytes the range gained.
+static void mergeEditRange(bool& active, int& rangeStart, int& rangeEnd, int& rangeDelta,
+                           int start, int removedLength, int insertedLength) {
+    const int insertedEnd = start + insertedLength;
+    if (!active) {
+        active = true;
+        rangeStart = start;
+        rangeEnd = insertedEnd;
+        rangeDelta = insertedLength - removedLength;
+        return;
+    }
 
-    if (selectionMode) {
-        syncSelectionFocusToCursor();
+    int end = rangeEnd;
+    if (end > start + removedLength) end += insertedLength - removedLength;
+    else if (end > start) end = insertedEnd;
+    rangeStart = min(rangeStart, start);
+    rangeEnd = max(end, insertedEnd);
+    rangeDelta += insertedLength - removedLength;
+}
+
+// Text outside the damaged range is unchanged since the last layout,
+// shifted by layoutDamageDelta past its end.
+void T9EditorApp::noteDocumentEdit(int start, int removedLength, int insertedLength) {
+    searchHitLength = 0;
+    if (historyEditsTracked) {
+        mergeEditRange(historyEditPending, historyEditStart, historyEditEnd, historyEditDelta,
+                       start, removedLength, insertedLength);
+    }
+    if (isWindowedDocument()) {
+        String error;
+        const String inserted = documentBuffer.substring(start, start + insertedLength);
+        if (!spanDocument.replace(windowStart + static_cast<size_t>(start), static_cast<size_t>(removedLength),
+                                  inserted.c_str(), static_cast<size_t>(insertedLength), error)) {
+            Serial.printf("[T9Editor] Edit log update failed: %s\n", error.c_str());
+        }
     }
+    if (layoutValid) {
+        mergeEditRange(layoutDamaged, layoutDamageStart, layoutDamageEnd, layoutDamageDelta,
+                       start, removedLength, insertedLength);
+    }
+}
 
-    String preview;
-    String displayText = getDisplayText(&preview);
-    u8g2.setFont(getCurrentFontMetrics().font);
+// Wrap the display range [start, end), which holds no '\n', into rows.
+void T9EditorApp::wrapLogicalLine(int start, int end, int logicalLineNum, const String& preview,
+                                  int textAreaWidth, std::vector<VisualLine>& out) const {
+    VisualLine vl;
+    vl.byteStartIndex = start;
+    vl.byteLength = 0;
+    vl.logicalLineNum = logicalLineNum;
+    vl.wrapped = false;
+    if (end <= start) {
+        out.push_back(vl);
+        return;
+    }
 
-    int logicalLineCount = countLogicalLines();
-    int textLeft = getTextLeft(logicalLineCount);
-    int textAreaWidth = GUI::SCREEN_WIDTH - textLeft - 1;
-    if (textAreaWidth < 1) textAreaWidth = 1;
+    // Only a line that holds the preview or straddles the buffer gap needs
+    // a composed copy.
+    const int previewLength = preview.length();
+    const char* text = nullptr;
+    if (previewLength == 0 || end <= cursorPos) {
+        text = documentBuffer.rangePtr(start, end - start);
+    } else if (start >= cursorPos + previewLength) {
+        text = documentBuffer.rangePtr(start - previewLength, end - start);
+    }
+    String composed;
+    if (text == nullptr) {
+        composed = readDisplaySlice(start, end - start, preview);
+        text = composed.c_str();
+    }
+
+    const int length = end - start;
+    int offset = 0;
+    while (offset < length) {
+        const int fitLen = TextWrap::fitLength(layoutFont, text + offset, length - offset, textAreaWidth);
+        vl.byteStartIndex = start + offset;
+        vl.byteLength = fitLen;
+        vl.wrapped = (offset > 0);
+        out.push_back(vl);
+        offset += fitLen;
+    }
+}
 
-    int currentLogicalLine = 1;
+void T9EditorApp::layoutAll(const String& preview, int textAreaWidth) {
+    visualLines.clear();
+    const int displayLength = getDocumentLength() + preview.length();
+    int logicalLineNum = 1;
     int start = 0;
-    while (start <= displayText.length()) {
-        int end = displayText.indexOf('\n', start);
-        if (end == -1) end = displayText.length();
-
-        String segment = displayText.substring(start, end);
-        int segmentLen = segment.length();
-        if (segmentLen == 0) {
-            VisualLine vl;
-            vl.content = "";
-            vl.logicalLineNum = currentLogicalLine;
-            vl.byteStartIndex = start;
-            vl.byteLength = 0;
-            vl.hasCursor = (cursorPos == start);
-            visualLines.push_back(vl);
-        } else {
-            int segStart = 0;
-            while (segStart < segmentLen) {
-                int fitLen = getWrappedFitLength(segment, segStart, segmentLen, textAreaWidth);
-
-                VisualLine vl;
-                vl.content = segment.substring(segStart, segStart + fitLen);
-                vl.logicalLineNum = (segStart == 0) ? currentLogicalLine : -1;
-                vl.byteStartIndex = start + segStart;
-                vl.byteLength = fitLen;
-
-                int absStart = start + segStart;
-                int absEnd = absStart + fitLen;
-                bool isSegmentEnd = (segStart + fitLen == segmentLen);
-                if (cursorPos >= absStart && cursorPos < absEnd) {
-                    vl.hasCursor = true;
-                } else if (isSegmentEnd && cursorPos == absEnd) {
-                    vl.hasCursor = true;
-                } else {
-                    vl.hasCursor = false;
-                }
+    while (true) {
+        const int end = findDisplayLineEnd(start, preview);
+        wrapLogicalLine(start, end, logicalLineNum, preview, textAreaWidth, visualLines);
+        if (end >= displayLength) break;
+        start = end + 1;
+        logicalLineNum++;
+    }
+}
+
+// Re-wrap from the first logical line touched by the damaged range until a
+// new row starts where an old row did, then splice and shift the old tail.
+// Returns false if the old rows cannot be reused.
+bool T9EditorApp::layoutDamagedRange(const String& preview, int textAreaWidth) {
+    const int previewLength = preview.length();
+    const int displayLength = getDocumentLength() + previewLength;
+
+    // Both the old and the new preview sit inside the damaged range, so in
+    // display coordinates it only grows by their lengths.
+    int damageStart = layoutDamageStart;
+    int damageEnd = layoutDamageEnd;
+    if (previewLength > 0) {
+        damageStart = min(damageStart, cursorPos);
+        damageEnd = max(damageEnd, cursorPos);
+    }
+    const int oldDamageEnd = damageEnd - layoutDamageDelta + layoutPreviewLength;
+    const int newDamageEnd = damageEnd + previewLength;
+    const int delta = newDamageEnd - oldDamageEnd;
+    if (layoutDisplayLength + delta != displayLength || visualLines.empty()) {
+        return false;
+    }
+
+    int first = findVisualLine(damageStart);
+    while (first > 0 && visualLines[first].wrapped) first--;
 
-                visualLines.push_back(vl);
-                segStart += fitLen;
+    std::vector<VisualLine> fresh;
+    int oldIndex = first;
+    const int oldCount = static_cast<int>(visualLines.size());
+    int logicalLineNum = visualLines[first].logicalLineNum;
+    int start = visualLines[first].byteStartIndex;
+    while (true) {
+        const int end = findDisplayLineEnd(start, preview);
+        const size_t firstNew = fresh.size();
+        wrapLogicalLine(start, end, logicalLineNum, preview, textAreaWidth, fresh);
+
+        for (size_t i = firstNew; i < fresh.size(); i++) {
+            const VisualLine& row = fresh[i];
+            if (row.byteStartIndex < newDamageEnd) continue;
+            const int oldStart = row.byteStartIndex - delta;
+            while (oldIndex < oldCount && visualLines[oldIndex].byteStartIndex < oldStart) oldIndex++;
+            if (oldIndex >= oldCount) break;
+            const VisualLine& old = visualLines[oldIndex];
+            if (old.byteStartIndex != oldStart || old.wrapped != row.wrapped) continue;
+
+            const int lineDelta = row.logicalLineNum - old.logicalLineNum;
+            fresh.resize(i);
+            visualLines.erase(visualLines.begin() + first, visualLines.begin() + oldIndex);
+            visualLines.insert(visualLines.begin() + first, fresh.begin(), fresh.end());
+            for (size_t k = first + fresh.size(); k < visualLines.size(); k++) {
+                visualLines[k].byteStartIndex += delta;
+                visualLines[k].logicalLineNum += lineDelta;
             }
+            return true;
         }
+
+        if (end >= displayLength) break;
         start = end + 1;
-        currentLogicalLine++;
+        logicalLineNum++;
     }
 
-    int cursorLineIndex = 0;
-    for (int i = 0; i < (int)visualLines.size(); i++) {
-        if (visualLines[i].hasCursor) {
-            cursorLineIndex = i;
-            break;
+    // Wrapped to the end of the text without meeting an old row start.
+    visualLines.erase(visualLines.begin() + first, visualLines.end());
+    visualLines.insert(visualLines.end(), fresh.begin(), fresh.end());
+    return true;
+}
+
+// Row holding displayPos: the last row starting at or before it.
+int T9EditorApp::findVisualLine(int displayPos) const {
+    int lo = 0;
+    int hi = static_cast<int>(visualLines.size()) - 1;
+    while (lo < hi) {
+        const int mid = (lo + hi + 1) / 2;
+        if (visualLines[mid].byteStartIndex <= displayPos) lo = mid;
+        else hi = mid - 1;
+    }
+    return lo;
+}
+
+void T9EditorApp::recalculateLayout() {
+    if (selectionMode) {
+        syncSelectionFocusToCursor();
+    }
+
+    const String preview = getPreviewText();
+    const uint8_t* font = getCurrentFontMetrics().font;
+    GUI::setFont(font);
+
+    if (font != layoutFont || getTextLeft(layoutLogicalLineCount) != layoutTextLeft) {
+        layoutValid = false;
+    }
+
+    if (layoutValid) {
+        const int textAreaWidth = max(1, GUI::SCREEN_WIDTH - layoutTextLeft - 1);
+        bool reused = true;
+        if (layoutDamaged || layoutPreviewLength > 0 || preview.length() > 0) {
+            if (!layoutDamaged) {
+                layoutDamageStart = cursorPos;
+                layoutDamageEnd = cursorPos;
+                layoutDamageDelta = 0;
+            }
+            reused = layoutDamagedRange(preview, textAreaWidth);
+        }
+        // A new digit in the line count widens the gutter: lay out again.
+        if (!reused || getTextLeft(visualLines.back().logicalLineNum) != layoutTextLeft) {
+            layoutValid = false;
         }
     }
 
+    if (!layoutValid) {
+        layoutFont = font;
+        layoutTextLeft = getTextLeft(countLogicalLines());
+        layoutAll(preview, max(1, GUI::SCREEN_WIDTH - layoutTextLeft - 1));
+        layoutValid = true;
+    }
+
+    layoutLogicalLineCount = visualLines.back().logicalLineNum;
+    layoutDisplayLength = getDocumentLength() + preview.length();
+    layoutPreviewLength = preview.length();
+    // The preview changes in place on the next keystroke; keep it damaged.
+    layoutDamaged = (layoutPreviewLength > 0);
+    layoutDamageStart = cursorPos;
+    layoutDamageEnd = cursorPos;
+    layoutDamageDelta = 0;
+
+    cursorLineIndex = findVisualLine(cursorPos);
+
     int visibleLines = getVisibleLineCount();
     if (isReadOnlyPaged()) {
         int maxScroll = max(0, static_cast<int>(visualLines.size()) - visibleLines);
@@ -2856,7 +3615,11 @@ void T9EditorApp::renderHeader() {
 
     char rightText[24];
     if (isReadOnly()) {
-        if (totalPageCount > 0) {
+        if (gotoLineInput.length() > 0) {
+            snprintf(rightText, sizeof(rightText), "Ln %s_", gotoLineInput.c_str());
+        } else if (isViewingFile() && !viewerReader.isIndexComplete()) {
+            snprintf(rightText, sizeof(rightText), "RO %d/%d+", currentPageIndex + 1, totalPageCount);
+        } else if (totalPageCount > 0) {
             snprintf(rightText, sizeof(rightText), "RO %d/%d", currentPageIndex + 1, totalPageCount);
         } else {
             snprintf(rightText, sizeof(rightText), "RO");
@@ -2867,7 +3630,13 @@ void T9EditorApp::renderHeader() {
                               (inputMode == MODE_ABC) ? "ABC" : "123";
         const char* shiftStr = (shiftMode == 2) ? "^^" :
                                (shiftMode == 1) ? "^" : "";
-        snprintf(rightText, sizeof(rightText), "RW %s%s", shiftStr, modeStr);
+        if (isWindowedDocument()) {
+            const size_t length = max(static_cast<size_t>(1), spanDocument.length());
+            snprintf(rightText, sizeof(rightText), "RW %u%% %s%s",
+                     static_cast<unsigned>(static_cast<uint64_t>(windowStart) * 100 / length), shiftStr, modeStr);
+        } else {
+            snprintf(rightText, sizeof(rightText), "RW %s%s", shiftStr, modeStr);
+        }
     }
 
     String title = documentLabel.length() > 0 ? documentLabel : String("T9 EDITOR");
@@ -2876,21 +3645,43 @@ void T9EditorApp::renderHeader() {
 }
 
 void T9EditorApp::renderFooter() const {
-    if (!showFooter()) return;
+    if (!showFooter() && !isFindBarVisible()) return;
 
     const int footerBaselineY = GUI::getFooterBaselineY();
     u8g2.drawHLine(0, GUI::getFooterSeparatorY(), GUI::SCREEN_WIDTH);
     GUI::setFontSystem();
+    if (isFindBarVisible()) {
+        String text;
+        if (search.isActive()) {
+            char bar[32];
+            snprintf(bar, sizeof(bar), "Find %d%% ESC:stop", search.getProgressPercent());
+            text = bar;
+        } else {
+            // Keep the end of a long pattern in view.
+            String typed = findPattern;
+            if (findTapKey != '\0') {
+                const char* map = multiTapMap[findTapKey - '0'];
+                typed += map[findTapIndex % strlen(map)];
+            }
+            text = "Find:" + typed + "_";
+            while (typed.length() > 0 && GUI::getTextWidth(text.c_str()) > GUI::SCREEN_WIDTH - 2) {
+                typed.remove(0, 1);
+                text = "Find:" + typed + "_";
+            }
+        }
+        GUI::drawText(1, footerBaselineY, text.c_str());
+        return;
+    }
     if (isReadOnly()) {
-        String text = GUI::truncateStringToWidth(String("RO U/D:scroll L/R:pg"), GUI::SCREEN_WIDTH - 2);
-        u8g2.drawUTF8(1, footerBaselineY, text.c_str());
+        String text = GUI::truncateStringToWidth(String("RO L/R:pg ENT:find"), GUI::SCREEN_WIDTH - 2);
+        GUI::drawText(1, footerBaselineY, text.c_str());
         return;
     }
 
     if (selectionMode) {
         String text = GUI::truncateStringToWidth(String("SEL ON 1,2,3:text ops 7,9:hist"),
                                                 GUI::SCREEN_WIDTH - 2);
-        u8g2.drawUTF8(1, footerBaselineY, text.c_str());
+        GUI::drawText(1, footerBaselineY, text.c_str());
         return;
     }
 
@@ -2899,9 +3690,9 @@ void T9EditorApp::renderFooter() const {
         char bar[32];
         snprintf(bar, sizeof(bar), "?[%s] %d/%d", map, tapIndex + 1, (int)strlen(map));
         String text = GUI::truncateStringToWidth(String(bar), GUI::SCREEN_WIDTH - 2);
-        u8g2.drawUTF8(1, footerBaselineY, text.c_str());
+        GUI::drawText(1, footerBaselineY, text.c_str());
     } else if (fallback) {
-        u8g2.drawStr(1, footerBaselineY, "?ABC 0:sp exits");
+        GUI::drawText(1, footerBaselineY, "?ABC 0:sp exits");
     } else if (inputMode == MODE_T9 && t9predict.hasInput()) {
         char bar[40];
         int dc = t9predict.getDigitCount();
@@ -2934,7 +3725,7 @@ void T9EditorApp::renderFooter() const {
             }
         }
         String text = GUI::truncateStringToWidth(String(bar), GUI::SCREEN_WIDTH - 2);
-        u8g2.drawUTF8(1, footerBaselineY, text.c_str());
+        GUI::drawText(1, footerBaselineY, text.c_str());
     } else if (inputMode == MODE_T9 && tapKey == '1') {
         drawHighlightedChoiceBar(1, footerBaselineY, multiTapMap[1], tapIndex);
     } else if (inputMode == MODE_ABC && tapKey != '\0') {
@@ -2942,13 +3733,13 @@ void T9EditorApp::renderFooter() const {
         char bar[32];
         snprintf(bar, sizeof(bar), "[%s] %d/%d", map, tapIndex + 1, (int)strlen(map));
         String text = GUI::truncateStringToWidth(String(bar), GUI::SCREEN_WIDTH - 2);
-        u8g2.drawUTF8(1, footerBaselineY, text.c_str());
+        GUI::drawText(1, footerBaselineY, text.c_str());
     } else {
         const char* hint = (inputMode == MODE_T9)  ? "A+TAB:ABC SH*:SEL" :
                            (inputMode == MODE_ABC) ? "A+TAB:123 SH*:SEL" :
                                                      "A+TAB:T9 SH*:SEL";
         String text = GUI::truncateStringToWidth(String(hint), GUI::SCREEN_WIDTH - 2);
-        u8g2.drawUTF8(1, footerBaselineY, text.c_str());
+        GUI::drawText(1, footerBaselineY, text.c_str());
     }
 }
 
@@ -2960,9 +3751,8 @@ void T9EditorApp::renderSavePrompt() {
 void T9EditorApp::render() {
     renderHeader();
 
-    String preview;
-    getDisplayText(&preview);
-    int logicalLineCount = countLogicalLines();
+    const String preview = getPreviewText();
+    int logicalLineCount = layoutLogicalLineCount;
     int gutterWidth = getGutterWidth(logicalLineCount);
     int textLeft = getTextLeft(logicalLineCount);
     int textTop = showHeader() ? 13 : 1;
@@ -2970,7 +3760,7 @@ void T9EditorApp::render() {
     int visibleLines = getVisibleLineCount();
     const GUI::FontMetrics& metrics = getCurrentFontMetrics();
 
-    u8g2.setFont(metrics.font);
+    GUI::setFont(metrics.font);
 
     if (showLineNumbers()) {
         u8g2.drawVLine(gutterWidth, textTop, textBottom - textTop + 1);
@@ -2983,9 +3773,12 @@ void T9EditorApp::render() {
         fbDispEnd = cursorPos + (int)preview.length();
     }
 
-    const bool selectionVisible = hasSelectionRange();
-    const int selectionStart = selectionVisible ? getSelectionStart() : -1;
-    const int selectionEnd = selectionVisible ? getSelectionEnd() : -1;
+    // A search hit is drawn like a selection.
+    const bool hitVisible = !hasSelectionRange() && searchHitLength > 0;
+    const bool selectionVisible = hasSelectionRange() || hitVisible;
+    const int selectionStart = hitVisible ? searchHitStart : (selectionVisible ? getSelectionStart() : -1);
+    const int selectionEnd = hitVisible ? searchHitStart + searchHitLength
+                                        : (selectionVisible ? getSelectionEnd() : -1);
 
     int y = textTop + metrics.baselineOffset;
     for (int i = 0; i < visibleLines; i++) {
@@ -2993,10 +3786,11 @@ void T9EditorApp::render() {
         if (idx >= (int)visualLines.size()) break;
 
         const VisualLine& vl = visualLines[idx];
-        if (showLineNumbers() && vl.logicalLineNum != -1) {
+        const String content = readDisplaySlice(vl.byteStartIndex, vl.byteLength, preview);
+        if (showLineNumbers() && !vl.wrapped && !(idx == 0 && pageContinuesLine)) {
             char ln[12];
-            snprintf(ln, sizeof(ln), "%d", vl.logicalLineNum);
-            u8g2.drawStr(1, y, ln);
+            snprintf(ln, sizeof(ln), "%d", lineNumberBase + vl.logicalLineNum);
+            GUI::drawText(1, y, ln);
         }
 
         bool selectionRendered = false;
@@ -3009,26 +3803,26 @@ void T9EditorApp::render() {
             int regionS = max(selectionStart, vl.byteStartIndex) - vl.byteStartIndex;
             int regionE = min(selectionEnd, vl.byteStartIndex + vl.byteLength) - vl.byteStartIndex;
             if (regionS > 0) {
-                String before = vl.content.substring(0, regionS);
-                u8g2.drawUTF8(textLeft, y, before.c_str());
+                String before = content.substring(0, regionS);
+                GUI::drawText(textLeft, y, before.c_str());
             }
 
-            String selectedText = vl.content.substring(regionS, regionE);
-            int selectedX = textLeft + u8g2.getUTF8Width(vl.content.substring(0, regionS).c_str());
-            int selectedWidth = u8g2.getUTF8Width(selectedText.c_str());
+            String selectedText = content.substring(regionS, regionE);
+            int selectedX = textLeft + GUI::getTextWidth(content.substring(0, regionS).c_str());
+            int selectedWidth = GUI::getTextWidth(selectedText.c_str());
             if (selectedWidth < 1) {
                 selectedWidth = 3;
             }
             u8g2.drawBox(selectedX, y - metrics.glyphTopOffset, selectedWidth, metrics.boxHeight);
             u8g2.setDrawColor(0);
             if (selectedText.length() > 0) {
-                u8g2.drawUTF8(selectedX, y, selectedText.c_str());
+                GUI::drawText(selectedX, y, selectedText.c_str());
             }
             u8g2.setDrawColor(1);
 
-            if (regionE < (int)vl.content.length()) {
-                String after = vl.content.substring(regionE);
-                u8g2.drawUTF8(selectedX + selectedWidth, y, after.c_str());
+            if (regionE < (int)content.length()) {
+                String after = content.substring(regionE);
+                GUI::drawText(selectedX + selectedWidth, y, after.c_str());
             }
             selectionRendered = true;
         }
@@ -3038,35 +3832,35 @@ void T9EditorApp::render() {
             int regionS = max(fbDispStart, vl.byteStartIndex) - vl.byteStartIndex;
             int regionE = min(fbDispEnd, vl.byteStartIndex + vl.byteLength) - vl.byteStartIndex;
             if (regionS > 0) {
-                String before = vl.content.substring(0, regionS);
-                u8g2.drawUTF8(textLeft, y, before.c_str());
+                String before = content.substring(0, regionS);
+                GUI::drawText(textLeft, y, before.c_str());
             }
 
-            String fbPart = vl.content.substring(regionS, regionE);
-            int xFb = textLeft + u8g2.getUTF8Width(vl.content.substring(0, regionS).c_str());
-            int wFb = u8g2.getUTF8Width(fbPart.c_str());
+            String fbPart = content.substring(regionS, regionE);
+            int xFb = textLeft + GUI::getTextWidth(content.substring(0, regionS).c_str());
+            int wFb = GUI::getTextWidth(fbPart.c_str());
             u8g2.drawBox(xFb, y - metrics.glyphTopOffset, wFb, metrics.boxHeight);
             u8g2.setDrawColor(0);
-            u8g2.drawUTF8(xFb, y, fbPart.c_str());
+            GUI::drawText(xFb, y, fbPart.c_str());
             u8g2.setDrawColor(1);
 
-            if (regionE < (int)vl.content.length()) {
-                String after = vl.content.substring(regionE);
-                u8g2.drawUTF8(xFb + wFb, y, after.c_str());
+            if (regionE < (int)content.length()) {
+                String after = content.substring(regionE);
+                GUI::drawText(xFb + wFb, y, after.c_str());
             }
         } else if (!selectionRendered) {
-            u8g2.drawUTF8(textLeft, y, vl.content.c_str());
+            GUI::drawText(textLeft, y, content.c_str());
         }
 
-        if (!isReadOnly() && vl.hasCursor) {
+        if (!isReadOnly() && idx == cursorLineIndex) {
             int localCursorIdx = cursorPos - vl.byteStartIndex;
             if (localCursorIdx < 0) localCursorIdx = 0;
             if (localCursorIdx > vl.byteLength) localCursorIdx = vl.byteLength;
 
-            String before = vl.content.substring(0, localCursorIdx);
-            int cursorX = textLeft + u8g2.getUTF8Width(before.c_str());
+            String before = content.substring(0, localCursorIdx);
+            int cursorX = textLeft + GUI::getTextWidth(before.c_str());
             if (preview.length() > 0) {
-                int pw = u8g2.getUTF8Width(preview.c_str());
+                int pw = GUI::getTextWidth(preview.c_str());
                 u8g2.drawHLine(cursorX, y + metrics.underlineOffset, pw);
             } else {
                 bool recentMove = (millis() - cursorMoveTime < CURSOR_BLINK_RATE);
@@ -3,30 +3,28 @@
 // STATUS: [Level 2 - Implementation]
 // TRUTH_LINK: TACTICAL_TODO TASK_2
 // LOG_REF: 2026-05-02
-// Description: Canonical T9 editor/viewer app with split RO paging and capped RW editing.
+// Description: Canonical T9 editor/viewer app with split RO paging and windowed RW editing.
 
 #ifndef APP_T9_EDITOR_H
 #define APP_T9_EDITOR_H
 
 #include "../app_interface.h"
 #include "../t9_predict.h"
+#include "../history_journal.h"
+#include "../paged_reader.h"
+#include "../span_document.h"
+#include "../stream_search.h"
+#include "../text_buffer.h"
+#include "../undo_log.h"
 #include <vector>
 
+// One wrapped row of the display text (document with the T9 preview spliced
+// in at the cursor). Rows hold offsets only; text is sliced when drawn.
 struct VisualLine {
-  String content;
-  int logicalLineNum;
-  bool hasCursor;
   int byteStartIndex;
   int byteLength;
-};
-
-struct EditorUndoState {
-  String documentBuffer;
-  int cursorPos;
-  bool selectionMode;
-  int selectionAnchorPos;
-  int selectionFocusPos;
-  unsigned long activeHistorySnapshotId;
+  int logicalLineNum;   // 1-based, also set on wrapped continuation rows
+  bool wrapped;         // Continues the previous row's logical line
 };
 
 struct ClipboardPopupEntry {
@@ -77,6 +75,25 @@ class T9EditorApp : public App {
   private:
     std::vector<VisualLine> visualLines;
   int scrollOffset;
+  int cursorLineIndex;
+
+  // Incremental layout state. Edits since the last layout are folded into
+  // one damaged document range; rows before it are kept and rows after it
+  // are reused once the new wrap lands on an old row start again.
+  bool layoutValid;
+  const uint8_t* layoutFont;
+  int layoutTextLeft;
+  int layoutLogicalLineCount;
+  int layoutDisplayLength;
+  int layoutPreviewLength;
+  bool layoutDamaged;
+  int layoutDamageStart;
+  int layoutDamageEnd;      // Current document coordinates
+  int layoutDamageDelta;    // Bytes added by the damaged range
+#ifdef PLATFORM_EMULATOR
+  // Emulator self-tests check incremental layout against a full re-layout.
+  friend struct T9EditorLayoutSelfTest;
+#endif
 
   EditorOpenMode openMode;
   DocumentSourceKind sourceKind;
@@ -84,15 +101,46 @@ class T9EditorApp : public App {
   String documentLabel;
   String documentPath;
   String sourceBuffer;
-  String documentBuffer;
+  TextBuffer documentBuffer;
   size_t pagedDocumentSize;
   int currentPageIndex;
   int totalPageCount;
+  // Read-only files are paged by line through the viewer reader. Line
+  // numbers continue across pages.
+  PagedReader viewerReader;
+  int lineNumberBase;
+  bool pageContinuesLine;
+  String gotoLineInput;
+  // Find bar: the pattern is typed with multi-tap and searched a few KB
+  // per frame. The hit is in current page (or document) coordinates.
+  StreamSearch search;
+  bool findPromptActive;
+  String findPattern;
+  char findTapKey;
+  int findTapIndex;
+  unsigned long findTapTime;
+  int searchHitStart;
+  int searchHitLength;
+  // RW files over kT9EditorReadWriteMaxBytes are edited through a window:
+  // documentBuffer holds the span document from windowStart on, and every
+  // edit to it is recorded in the spans as it happens.
+  SpanDocument spanDocument;
+  size_t windowStart;
   bool pageDirty;
+  // Save latency, reported over serial after each save
+  unsigned long saveCount;
+  unsigned long lastSaveMs;
+  unsigned long maxSaveMs;
   String historyDocumentId;
-  unsigned long historyNextSnapshotId;
   unsigned long activeHistorySnapshotId;
-  int nextClipboardSlot;
+  HistoryJournal historyJournal;
+  // Edits since the latest journal snapshot, folded into one range like the
+  // layout damage. Untracked after a load, when the next snapshot is diffed.
+  bool historyEditsTracked;
+  bool historyEditPending;
+  int historyEditStart;
+  int historyEditEnd;       // Current document coordinates
+  int historyEditDelta;
 
   T9Predict t9predict;
   int cursorPos;
@@ -113,8 +161,7 @@ class T9EditorApp : public App {
   bool shiftTapPending;
   int selectionAnchorPos;
   int selectionFocusPos;
-  std::vector<EditorUndoState> undoStack;
-  std::vector<EditorUndoState> redoStack;
+  UndoLog undoLog;
   bool clipboardPopupActive;
   int clipboardPopupSelection;
   int clipboardPopupScroll;
@@ -130,19 +177,17 @@ class T9EditorApp : public App {
   int getSelectionStart() const;
   int getSelectionEnd() const;
   void clearTransientInputState();
-  EditorUndoState captureUndoState() const;
-  void restoreUndoState(const EditorUndoState& state);
-  void pushUndoState(std::vector<EditorUndoState>& stack, const EditorUndoState& state);
-  void recordUndoState();
+  UndoLog::State captureUndoState() const;
+  void applyUndoStep(const UndoLog::State& state, const UndoLog::Change& change);
   bool undoFromHistory();
   bool undoEdit();
   bool redoEdit();
   String getSelectedText() const;
   bool replaceDocumentRange(int start, int end, const String& replacement, int newCursorPos,
-                            bool recordUndo = true);
+                            bool recordUndo = true, bool typed = false);
   bool removeDocumentRange(int start, int end, bool recordUndo = true);
   String previewClipboardText(const String& value) const;
-  bool readClipboardSlotPreview(int slot, String& preview, String& error) const;
+  String buildClipboardPreview(const String& content) const;
   bool rebuildClipboardPopupEntries(String& error);
   bool openClipboardPopup();
   void closeClipboardPopup();
@@ -163,13 +208,24 @@ class T9EditorApp : public App {
   bool loadPagedDocument(String& error);
   bool loadPageByIndex(int pageIndex, String& error);
   void updatePagedDocumentMetrics(size_t fileSize);
+  bool isWindowedDocument() const;
+  bool readSpanRange(size_t start, size_t length, String& out, String& error) const;
+  bool countSpanLineBreaks(size_t end, uint32_t& count, String& error) const;
+  bool loadWindow(size_t start, bool backward, String& error);
+  bool moveWindow(int direction, String& error);
+  bool jumpWindowTo(size_t offset, String& error);
+  bool saveWindowedDocument(String& error);
   void markPageDirty();
   bool saveCurrentPage(String& error);
   bool ensureEditorStorage(String& error);
   bool ensureHistoryDocument(String& error);
+  bool rebuildHistoryIndex(String& error);
   bool recordPageSnapshot(const char* reason, String& error);
+  bool importLegacyHistory(unsigned long legacyNextSnapshotId, String& error);
+  bool writeHistoryManifest(String& error);
   bool loadClipboardState(String& error);
-  bool storeClipboardState(String& error);
+  bool importLegacyClipboard(String& error);
+  bool flushClipboard(String& error);
   bool writeClipboardSlot(const String& content, int& writtenSlot, String& error);
   bool readClipboardSlot(int slot, String& content, String& error) const;
   String getEditorSystemRoot() const;
@@ -178,10 +234,23 @@ class T9EditorApp : public App {
   String getDocumentHistoryRoot() const;
   String getDocumentManifestPath() const;
   String getHistorySnapshotPath(unsigned long snapshotId) const;
+  String getHistoryJournalPath() const;
   String getClipboardManifestPath() const;
   String getClipboardSlotPath(int slot) const;
   String buildDefaultHistoryDocumentId() const;
   bool isReadOnlyPaged() const;
+  bool isViewingFile() const;
+  void syncViewerPageCount();
+  bool handleGotoLineInput(char key);
+  bool jumpToLine(unsigned long line);
+  bool isFindBarVisible() const;
+  void openFindPrompt();
+  void closeFindPrompt();
+  void commitFindTap();
+  void handleFindInput(char key);
+  bool startSearch();
+  void serviceSearch();
+  bool showSearchHit(size_t offset, size_t length);
   bool hasPreviousPage() const;
   bool hasNextPage() const;
   bool isReadOnly() const;
@@ -193,13 +262,21 @@ class T9EditorApp : public App {
   int getGutterWidth(int logicalLineCount) const;
   int getTextLeft(int logicalLineCount) const;
   String getPreviewText() const;
-  String getDisplayText(String* previewOut = nullptr) const;
+  String readDisplaySlice(int start, int length, const String& preview) const;
+  int findDisplayLineEnd(int from, const String& preview) const;
   void requestExit(bool saveRequested);
   bool isKeyActiveNow(char key) const;
   String getMultiTapChar() const;
   void commitMultiTap();
   void commitPrediction();
     void recalculateLayout();
+  void invalidateLayout();
+  void noteDocumentEdit(int start, int removedLength, int insertedLength);
+  void wrapLogicalLine(int start, int end, int logicalLineNum, const String& preview,
+                       int textAreaWidth, std::vector<VisualLine>& out) const;
+  void layoutAll(const String& preview, int textAreaWidth);
+  bool layoutDamagedRange(const String& preview, int textAreaWidth);
+  int findVisualLine(int displayPos) const;
   void moveCursorVertically(int dir);
   void handleSavePromptInput(char key);
     void renderHeader();
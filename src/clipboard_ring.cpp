@@ -0,0 +1,279 @@
+// PROJECT: ESP32-S2-Mini handheld terminal
+// MODULE: src/clipboard_ring.cpp
+// STATUS: [Level 2 - Implementation]
+// TRUTH_LINK: TACTICAL_TODO TASK_2
+// LOG_REF: 2026-10-17
+// Description: RAM clipboard ring for the T9 editor.
+
+#include "clipboard_ring.h"
+
+// File layout: [RingFileHeader][slot 0][slot 1]... Every slot takes slotBytes
+// and starts with a SlotHeader; the payload follows it and the rest of the
+// slot is unused.
+
+struct RingFileHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t slotCount;
+    uint32_t slotBytes;
+    uint32_t nextSlot;
+    uint32_t checksum;     // FNV-1a over this header (checksum = 0)
+};
+
+struct SlotHeader {
+    uint32_t length;
+    uint32_t checksum;     // FNV-1a over slot index, length and payload
+};
+
+static const uint32_t kRingMagic = 0x52504C43UL;     // "CLPR"
+static const uint32_t kRingVersion = 1;
+
+static uint32_t fnv1aUpdate(uint32_t hash, const void* data, size_t length) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < length; i++) {
+        hash ^= bytes[i];
+        hash *= 16777619UL;
+    }
+    return hash;
+}
+
+static uint32_t headerChecksum(RingFileHeader header) {
+    header.checksum = 0;
+    return fnv1aUpdate(2166136261UL, &header, sizeof(header));
+}
+
+static uint32_t slotChecksum(uint32_t slot, const char* text, uint32_t length) {
+    uint32_t hash = fnv1aUpdate(2166136261UL, &slot, sizeof(slot));
+    hash = fnv1aUpdate(hash, &length, sizeof(length));
+    return fnv1aUpdate(hash, text, length);
+}
+
+static size_t slotOffset(size_t slotBytes, int slot) {
+    return sizeof(RingFileHeader) + slotBytes * static_cast<size_t>(slot);
+}
+
+ClipboardRing::ClipboardRing(const char* filePath, int slotCount, size_t slotBytes)
+    : filePath(filePath), slotCount(max(1, min(slotCount, static_cast<int>(MAX_SLOTS)))), slotBytes(slotBytes),
+      slots(nullptr), nextSlot(0), dirtySlots(0), headerDirty(false), loaded(false),
+      fileFound(false), lastChangeMs(0), slotWrites(0) {
+    slots = new String[this->slotCount];
+}
+
+ClipboardRing::~ClipboardRing() {
+    delete[] slots;
+}
+
+size_t ClipboardRing::getMaxTextBytes() const {
+    return slotBytes - sizeof(SlotHeader);
+}
+
+size_t ClipboardRing::fileBytes() const {
+    return slotOffset(slotBytes, slotCount);
+}
+
+uint32_t ClipboardRing::allSlotsMask() const {
+    return slotCount >= 32 ? 0xFFFFFFFFUL : ((1UL << slotCount) - 1);
+}
+
+void ClipboardRing::markChanged() {
+    headerDirty = true;
+    lastChangeMs = millis();
+}
+
+// ============================================================================
+// RAM RING
+// ============================================================================
+
+bool ClipboardRing::push(const String& text, int& slot, String& error) {
+    slot = -1;
+    if (static_cast<size_t>(text.length()) > getMaxTextBytes()) {
+        error = "Clipboard content exceeds page size";
+        return false;
+    }
+    slot = nextSlot;
+    slots[slot] = text;
+    dirtySlots |= 1UL << slot;
+    nextSlot = (nextSlot + 1) % slotCount;
+    markChanged();
+    error = "";
+    return true;
+}
+
+int ClipboardRing::slotForAge(int age) const {
+    return ((nextSlot - 1 - age) % slotCount + slotCount) % slotCount;
+}
+
+const String& ClipboardRing::getSlot(int slot) const {
+    static const String kEmpty;
+    if (slot < 0 || slot >= slotCount) return kEmpty;
+    return slots[slot];
+}
+
+void ClipboardRing::setSlot(int slot, const String& text) {
+    if (slot < 0 || slot >= slotCount || static_cast<size_t>(text.length()) > getMaxTextBytes()) return;
+    slots[slot] = text;
+    dirtySlots |= 1UL << slot;
+    markChanged();
+}
+
+void ClipboardRing::setNextSlot(int slot) {
+    if (slot < 0 || slot >= slotCount) return;
+    nextSlot = slot;
+    markChanged();
+}
+
+// ============================================================================
+// PERSISTENCE
+// ============================================================================
+
+bool ClipboardRing::readSlot(FsFile& file, int slot) {
+    SlotHeader header;
+    if (!file.seekSet(slotOffset(slotBytes, slot)) ||
+        file.read(&header, sizeof(header)) != static_cast<int>(sizeof(header)) ||
+        header.length > getMaxTextBytes()) {
+        return false;
+    }
+    if (header.length == 0) {
+        slots[slot] = "";
+        return header.checksum == slotChecksum(static_cast<uint32_t>(slot), "", 0);
+    }
+
+    char* text = static_cast<char*>(malloc(header.length + 1));
+    if (text == nullptr) return false;
+    const int got = file.read(text, header.length);
+    bool ok = got >= 0 && static_cast<uint32_t>(got) == header.length &&
+              slotChecksum(static_cast<uint32_t>(slot), text, header.length) == header.checksum;
+    if (ok) {
+        text[header.length] = '\0';
+        slots[slot] = text;
+    }
+    free(text);
+    return ok;
+}
+
+bool ClipboardRing::load(String& error) {
+    if (loaded) {
+        error = "";
+        return true;
+    }
+
+    FsFile file;
+    if (!file.open(filePath.c_str(), O_RDONLY)) {
+        // Nothing stored yet; the first flush creates the file.
+        loaded = true;
+        fileFound = false;
+        error = "";
+        return true;
+    }
+    fileFound = true;
+
+    RingFileHeader header;
+    if (static_cast<size_t>(file.size()) < fileBytes() ||
+        file.read(&header, sizeof(header)) != static_cast<int>(sizeof(header)) ||
+        header.magic != kRingMagic || header.version != kRingVersion ||
+        header.slotCount != static_cast<uint32_t>(slotCount) ||
+        header.slotBytes != static_cast<uint32_t>(slotBytes) ||
+        header.nextSlot >= static_cast<uint32_t>(slotCount) || headerChecksum(header) != header.checksum) {
+        // Unusable layout: start empty and rewrite every slot on the next flush.
+        Serial.printf("[Clipboard] Ignoring unreadable clipboard file: %s\n", filePath.c_str());
+        dirtySlots = allSlotsMask();
+        headerDirty = true;
+        loaded = true;
+        error = "";
+        return true;
+    }
+
+    nextSlot = static_cast<int>(header.nextSlot);
+    for (int slot = 0; slot < slotCount; slot++) {
+        if (!readSlot(file, slot)) {
+            // A torn write loses only this entry.
+            Serial.printf("[Clipboard] Slot %d failed its checksum, cleared\n", slot);
+            slots[slot] = "";
+            dirtySlots |= 1UL << slot;
+        }
+    }
+    loaded = true;
+    error = "";
+    return true;
+}
+
+bool ClipboardRing::createFile(FsFile& file, String& error) {
+    // Every slot has a fixed place, so later flushes only overwrite.
+    const size_t total = fileBytes();
+    if (!file.preAllocate(total)) {
+        uint8_t zeros[64];
+        memset(zeros, 0, sizeof(zeros));
+        if (!file.seekSet(0)) {
+            error = String("Failed to create clipboard file: ") + filePath;
+            return false;
+        }
+        for (size_t written = 0; written < total;) {
+            const size_t chunk = min(sizeof(zeros), total - written);
+            if (file.write(zeros, chunk) != chunk) {
+                error = String("Failed to create clipboard file: ") + filePath;
+                return false;
+            }
+            written += chunk;
+        }
+    }
+    dirtySlots = allSlotsMask();
+    headerDirty = true;
+    return true;
+}
+
+bool ClipboardRing::flush(String& error) {
+    if (!loaded || !isDirty()) {
+        error = "";
+        return true;
+    }
+
+    error = "";
+    FsFile file;
+    bool ok = file.open(filePath.c_str(), O_RDWR | O_CREAT);
+    if (ok && static_cast<size_t>(file.size()) < fileBytes()) {
+        ok = createFile(file, error);
+    } else if (!ok) {
+        error = String("Failed to open clipboard file: ") + filePath;
+    }
+
+    // Slots first: a power cut before the header lands leaves the old next
+    // slot, and a torn slot fails its checksum on the next load.
+    for (int slot = 0; ok && slot < slotCount; slot++) {
+        if ((dirtySlots & (1UL << slot)) == 0) continue;
+        const String& text = slots[slot];
+        SlotHeader header;
+        header.length = static_cast<uint32_t>(text.length());
+        header.checksum = slotChecksum(static_cast<uint32_t>(slot), text.c_str(), header.length);
+        ok = file.seekSet(slotOffset(slotBytes, slot)) &&
+             file.write(reinterpret_cast<const uint8_t*>(&header), sizeof(header)) == sizeof(header) &&
+             (header.length == 0 ||
+              file.write(reinterpret_cast<const uint8_t*>(text.c_str()), header.length) == header.length);
+        if (ok) {
+            dirtySlots &= ~(1UL << slot);
+            slotWrites++;
+        }
+    }
+
+    if (ok) {
+        RingFileHeader header;
+        header.magic = kRingMagic;
+        header.version = kRingVersion;
+        header.slotCount = static_cast<uint32_t>(slotCount);
+        header.slotBytes = static_cast<uint32_t>(slotBytes);
+        header.nextSlot = static_cast<uint32_t>(nextSlot);
+        header.checksum = headerChecksum(header);
+        ok = file.sync() && file.seekSet(0) &&
+             file.write(reinterpret_cast<const uint8_t*>(&header), sizeof(header)) == sizeof(header) &&
+             file.sync();
+    }
+
+    if (!ok) {
+        if (error.length() == 0) error = String("Failed to write clipboard file: ") + filePath;
+        lastChangeMs = millis();
+        return false;
+    }
+    headerDirty = false;
+    fileFound = true;
+    error = "";
+    return true;
+}
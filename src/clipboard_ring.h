@@ -0,0 +1,77 @@
+// PROJECT: ESP32-S2-Mini handheld terminal
+// MODULE: src/clipboard_ring.h
+// STATUS: [Level 2 - Implementation]
+// TRUTH_LINK: TACTICAL_TODO TASK_2
+// LOG_REF: 2026-10-17
+// Description: RAM clipboard ring for the T9 editor.
+//              Copy, cut and paste work on the slots in RAM. Changed slots
+//              are written back lazily to one packed file with a fixed
+//              offset and checksum per slot, so a flush rewrites only the
+//              slots that changed.
+
+#ifndef CLIPBOARD_RING_H
+#define CLIPBOARD_RING_H
+
+#include <Arduino.h>
+#include <SdFat.h>
+
+// load() and flush() expect the caller to hold an SD session.
+class ClipboardRing {
+public:
+    static const int MAX_SLOTS = 32;
+
+    ClipboardRing(const char* filePath, int slotCount, size_t slotBytes);
+    ~ClipboardRing();
+    ClipboardRing(const ClipboardRing& other) = delete;
+    ClipboardRing& operator=(const ClipboardRing& other) = delete;
+
+    // Read the packed file once. A missing file gives an empty ring; a slot
+    // with a bad checksum comes back empty. Later calls do nothing.
+    bool load(String& error);
+    bool isLoaded() const { return loaded; }
+    // Whether the packed file existed when the ring was loaded
+    bool hasFile() const { return fileFound; }
+
+    int getSlotCount() const { return slotCount; }
+    size_t getMaxTextBytes() const;
+
+    // Store text as the newest entry, replacing the oldest. RAM only.
+    bool push(const String& text, int& slot, String& error);
+
+    // Slot holding the entry age steps older than the newest (0 = newest)
+    int slotForAge(int age) const;
+    const String& getSlot(int slot) const;
+
+    // Restore a slot and the write position, e.g. when importing older data
+    void setSlot(int slot, const String& text);
+    void setNextSlot(int slot);
+
+    // Write the changed slots and then the header. On failure the slots
+    // stay dirty and the quiet period restarts, so callers can retry later.
+    bool flush(String& error);
+    bool isDirty() const { return dirtySlots != 0 || headerDirty; }
+    unsigned long getLastChangeMs() const { return lastChangeMs; }
+
+    uint32_t getSlotWrites() const { return slotWrites; }
+
+private:
+    String filePath;
+    int slotCount;
+    size_t slotBytes;
+    String* slots;
+    int nextSlot;
+    uint32_t dirtySlots;       // Bit per slot
+    bool headerDirty;
+    bool loaded;
+    bool fileFound;
+    unsigned long lastChangeMs;
+    uint32_t slotWrites;       // Slots written by flush(), for diagnostics
+
+    size_t fileBytes() const;
+    uint32_t allSlotsMask() const;
+    void markChanged();
+    bool readSlot(FsFile& file, int slot);
+    bool createFile(FsFile& file, String& error);
+};
+
+#endif
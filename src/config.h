@@ -117,4 +117,20 @@ extern int emulator_frame_overhead_ms;
 #define SLEEP_TIMEOUT_MS     60000  // 60 seconds of inactivity before sleep
 #define SLEEP_ENABLED        true   // Enable sleep mode
 
+// SD card session: the volume stays mounted between file operations and is
+// released after this much idle time (and always before sleep)
+#define SD_IDLE_RELEASE_MS   5000
+
+// SD free space: FAT sectors counted per frame by the background scan
+// started at mount (a FAT32 card's FAT is several MB)
+#define SD_FREE_SCAN_SECTORS_PER_FRAME 4
+// Frames a failed FAT read is retried before used space is reported unknown
+#define SD_FREE_SCAN_MAX_RETRIES 3
+
+// SD request queue (fs.readAsync etc.): bytes moved per frame
+#define SD_IO_BYTES_PER_FRAME 4096
+
+// T9 editor clipboard: copies are written back to SD after this much quiet
+#define CLIPBOARD_FLUSH_IDLE_MS 3000
+
 #endif
\ No newline at end of file
@@ -0,0 +1,178 @@
+// PROJECT: ESP32-S2-Mini handheld terminal
+// MODULE: src/display.cpp
+// STATUS: [Level 2 - Implementation]
+// TRUTH_LINK: TRUTH_HARDWARE.md Section 1
+// LOG_REF: 2026-10-16
+
+#include "display.h"
+#include "hal.h"
+
+namespace Display {
+
+// --------------------------------------------------------------------------
+// INTERNAL STATE
+// --------------------------------------------------------------------------
+
+// ST7920 full buffer uses the horizontal layout: each byte holds 8 pixels of
+// one pixel row (MSB = leftmost), 16 bytes per pixel row. Tile (tx, ty) is
+// therefore the byte column tx of pixel rows ty*8 .. ty*8+7.
+constexpr int ROW_BYTES = TILE_COLS;
+constexpr int BUFFER_BYTES = TILE_COLS * TILE_ROWS * TILE_SIZE;
+constexpr uint16_t ALL_TILES = 0xFFFF;
+
+static uint16_t pendingTiles[TILE_ROWS];   // Tiles to compare on next flush
+static uint16_t drawnTiles[TILE_ROWS];     // Tiles drawn since the last clear
+static uint8_t shadowBuffer[BUFFER_BYTES]; // What the LCD currently shows
+static bool shadowValid = false;
+static uint32_t shadowHash = 0;            // Hash of the buffer last sent
+static FlushStats stats = {};
+
+// FNV-1a over 32-bit words. The buffer is read with memcpy because the u8g2
+// buffer carries no alignment guarantee and Xtensa faults on unaligned loads.
+static uint32_t hashBuffer(const uint8_t* buffer) {
+    uint32_t hash = 2166136261UL;
+    for (int offset = 0; offset < BUFFER_BYTES; offset += sizeof(uint32_t)) {
+        uint32_t word;
+        memcpy(&word, buffer + offset, sizeof(word));
+        hash = (hash ^ word) * 16777619UL;
+    }
+    return hash;
+}
+
+static inline int tileOffset(int tx, int ty) {
+    return (ty * TILE_SIZE * ROW_BYTES) + tx;
+}
+
+static bool tileDiffers(const uint8_t* buffer, int tx, int ty) {
+    const int base = tileOffset(tx, ty);
+    for (int r = 0; r < TILE_SIZE; r++) {
+        const int offset = base + (r * ROW_BYTES);
+        if (buffer[offset] != shadowBuffer[offset]) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// --------------------------------------------------------------------------
+// DIRTY TRACKING
+// --------------------------------------------------------------------------
+
+void clear() {
+    u8g2.clearBuffer();
+    for (int ty = 0; ty < TILE_ROWS; ty++) {
+        pendingTiles[ty] |= drawnTiles[ty];
+        drawnTiles[ty] = 0;
+    }
+}
+
+void markDirty(int x, int y, int w, int h) {
+    if (w <= 0 || h <= 0) return;
+
+    int x0 = max(0, x);
+    int y0 = max(0, y);
+    int x1 = min(TILE_COLS * TILE_SIZE - 1, x + w - 1);
+    int y1 = min(TILE_ROWS * TILE_SIZE - 1, y + h - 1);
+    if (x0 > x1 || y0 > y1) return;
+
+    const int tx0 = x0 / TILE_SIZE;
+    const int tx1 = x1 / TILE_SIZE;
+    const uint16_t mask = static_cast<uint16_t>(((1UL << (tx1 + 1)) - 1) & ~((1UL << tx0) - 1));
+    for (int ty = y0 / TILE_SIZE; ty <= y1 / TILE_SIZE; ty++) {
+        pendingTiles[ty] |= mask;
+        drawnTiles[ty] |= mask;
+    }
+}
+
+void markAllDirty() {
+    for (int ty = 0; ty < TILE_ROWS; ty++) {
+        pendingTiles[ty] = ALL_TILES;
+        drawnTiles[ty] = ALL_TILES;
+    }
+}
+
+// --------------------------------------------------------------------------
+// FLUSH
+// --------------------------------------------------------------------------
+
+int flush() {
+    if (!shadowValid) {
+        flushFull();
+        return TILE_COLS * TILE_ROWS;
+    }
+
+    const uint8_t* buffer = u8g2.getBufferPtr();
+    const uint32_t hash = hashBuffer(buffer);
+    if (hash == shadowHash) {
+        for (int ty = 0; ty < TILE_ROWS; ty++) {
+            pendingTiles[ty] = 0;
+        }
+        stats.framesSkipped++;
+        return 0;
+    }
+
+    shadowHash = hash;
+    stats.framesSent++;
+    int sentTiles = 0;
+
+    for (int ty = 0; ty < TILE_ROWS; ty++) {
+        const uint16_t candidates = pendingTiles[ty];
+        pendingTiles[ty] = 0;
+        if (candidates == 0) continue;
+
+        bool changed = false;
+        for (int tx = 0; tx < TILE_COLS && !changed; tx++) {
+            if ((candidates & (1U << tx)) == 0) continue;
+            stats.tilesCompared++;
+            changed = tileDiffers(buffer, tx, ty);
+        }
+        if (!changed) continue;
+
+        // u8g2 locates the source of a partial update as if the buffer used
+        // the vertical tile layout, and the ST7920 tile handler then steps
+        // through it by the span width instead of 16 bytes per pixel row.
+        // Only a full-width row lands on the right bytes, so send whole rows.
+        const int rowOffset = tileOffset(0, ty);
+        memcpy(shadowBuffer + rowOffset, buffer + rowOffset, TILE_SIZE * ROW_BYTES);
+        u8g2.updateDisplayArea(0, ty, TILE_COLS, 1);
+
+        sentTiles += TILE_COLS;
+        stats.areaCount++;
+    }
+
+    stats.tilesSent += sentTiles;
+    stats.bytesSent += static_cast<uint32_t>(sentTiles) * TILE_SIZE;
+    return sentTiles;
+}
+
+void flushFull() {
+    u8g2.sendBuffer();
+    memcpy(shadowBuffer, u8g2.getBufferPtr(), BUFFER_BYTES);
+    shadowHash = hashBuffer(shadowBuffer);
+    shadowValid = true;
+    for (int ty = 0; ty < TILE_ROWS; ty++) {
+        pendingTiles[ty] = 0;
+        drawnTiles[ty] = ALL_TILES;
+    }
+
+    stats.framesSent++;
+    stats.areaCount++;
+    stats.tilesSent += TILE_COLS * TILE_ROWS;
+    stats.bytesSent += BUFFER_BYTES;
+}
+
+const FlushStats& getStats() {
+    return stats;
+}
+
+void resetStats() {
+    stats = {};
+}
+
+int getSkippedFramePercent() {
+    const uint32_t total = stats.framesSent + stats.framesSkipped;
+    if (total == 0) return 0;
+    return static_cast<int>((static_cast<uint64_t>(stats.framesSkipped) * 100ULL) / total);
+}
+
+} // namespace Display
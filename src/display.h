@@ -0,0 +1,60 @@
+// PROJECT: ESP32-S2-Mini handheld terminal
+// MODULE: src/display.h
+// STATUS: [Level 2 - Implementation]
+// TRUTH_LINK: TRUTH_HARDWARE.md Section 1
+// LOG_REF: 2026-10-16
+
+#ifndef DISPLAY_H
+#define DISPLAY_H
+
+#include <Arduino.h>
+
+// Dirty-tile tracking and partial LCD flush for the ST7920 framebuffer.
+//
+// The panel is addressed in 8x8 tiles (16 columns x 8 rows). Every drawing
+// entry point in GUI:: and the gfx Lua module marks the tiles it touches;
+// flush() then compares only those tiles against a shadow of what the LCD
+// already shows and pushes each changed tile row with updateDisplayArea().
+// Code that draws on u8g2 directly must call markAllDirty() before flushing.
+// A word-wise hash of the whole buffer is taken first, so a frame that is
+// pixel-identical to the last one sent skips the SPI transfer entirely.
+namespace Display {
+
+constexpr int TILE_SIZE = 8;
+constexpr int TILE_COLS = 16;
+constexpr int TILE_ROWS = 8;
+
+struct FlushStats {
+    uint32_t framesSent;      // flushes that reached the LCD
+    uint32_t framesSkipped;   // flushes suppressed as identical to the last frame
+    uint32_t areaCount;       // updateDisplayArea() transfers issued
+    uint32_t tilesSent;       // tiles pushed over SW SPI
+    uint32_t tilesCompared;   // dirty candidates checked against the shadow
+    uint32_t bytesSent;       // framebuffer bytes pushed over SW SPI
+};
+
+// Clear the framebuffer. Tiles drawn since the previous clear become dirty.
+void clear();
+
+// Mark a pixel rectangle as modified. Coordinates are clipped to the screen.
+void markDirty(int x, int y, int w, int h);
+
+// Mark the whole screen as modified (for untracked direct u8g2 drawing).
+void markAllDirty();
+
+// Push changed tile rows to the LCD. Returns the number of tiles sent (0 when
+// the frame was identical to the previous one and the transfer was skipped).
+int flush();
+
+// Push the whole buffer unconditionally and resync the shadow copy.
+void flushFull();
+
+const FlushStats& getStats();
+void resetStats();
+
+// Percentage of flushes skipped as identical frames (0-100).
+int getSkippedFramePercent();
+
+} // namespace Display
+
+#endif
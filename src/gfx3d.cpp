@@ -0,0 +1,414 @@
+// PROJECT: ESP32-S2-Mini handheld terminal
+// MODULE: src/gfx3d.cpp
+// STATUS: [Level 2 - Implementation]
+// TRUTH_LINK: TRUTH_HARDWARE.md Section 1
+// LOG_REF: 2026-10-16
+
+#include "gfx3d.h"
+#include "hal.h"
+#include "display.h"
+#include "gui.h"
+#include <math.h>
+
+namespace Gfx3D {
+
+// --------------------------------------------------------------------------
+// INTERNAL STATE
+// --------------------------------------------------------------------------
+
+constexpr int QUARTER_STEPS = ANGLE_STEPS / 4;
+constexpr fixed NEAR_DEPTH = FIXED_ONE / 10;   // Clamp for vertices at/behind the eye
+constexpr int32_t SCREEN_LIMIT = 0x3FFF;       // Keeps projected coords in int16 range
+constexpr int SHADE_LEVELS = 16;               // 4x4 ordered dither
+constexpr int SHADE_AMBIENT = 3;               // Level for faces turned away from the light
+
+// Quarter-wave sine, Q16.16. Built once; everything else is table lookups.
+static fixed sinTable[QUARTER_STEPS + 1];
+static bool tablesReady = false;
+
+static const uint8_t kBayer4[4][4] = {
+    { 0,  8,  2, 10},
+    {12,  4, 14,  6},
+    { 3, 11,  1,  9},
+    {15,  7, 13,  5}
+};
+
+// Direction towards the light in camera space (upper left, viewer side), Q16.16.
+// (-1, 1, -1) / sqrt(3)
+static const fixed kLightX = -37837;
+static const fixed kLightY = 37837;
+static const fixed kLightZ = -37837;
+
+static void buildTables() {
+    if (tablesReady) return;
+    for (int i = 0; i <= QUARTER_STEPS; i++) {
+        sinTable[i] = toFixed(sin((M_PI / 2.0) * i / QUARTER_STEPS));
+    }
+    tablesReady = true;
+}
+
+static inline int32_t clampScreen(int64_t value) {
+    if (value > SCREEN_LIMIT) return SCREEN_LIMIT;
+    if (value < -SCREEN_LIMIT) return -SCREEN_LIMIT;
+    return static_cast<int32_t>(value);
+}
+
+static uint32_t isqrt64(uint64_t value) {
+    uint64_t result = 0;
+    uint64_t bit = 1ULL << 62;
+    while (bit > value) bit >>= 2;
+    while (bit != 0) {
+        if (value >= result + bit) {
+            value -= result + bit;
+            result = (result >> 1) + bit;
+        } else {
+            result >>= 1;
+        }
+        bit >>= 2;
+    }
+    return static_cast<uint32_t>(result);
+}
+
+static inline size_t alignUp(size_t value) {
+    return (value + 7) & ~static_cast<size_t>(7);
+}
+
+// --------------------------------------------------------------------------
+// FIXED-POINT MATH
+// --------------------------------------------------------------------------
+
+int angleFromRadians(double radians) {
+    const double steps = radians * (ANGLE_STEPS / (2.0 * M_PI));
+    const long rounded = static_cast<long>(steps < 0 ? steps - 0.5 : steps + 0.5);
+    return static_cast<int>(rounded & (ANGLE_STEPS - 1));
+}
+
+fixed sinStep(int step) {
+    buildTables();
+    const int s = step & (ANGLE_STEPS - 1);
+    const int index = s & (QUARTER_STEPS - 1);
+    switch (s / QUARTER_STEPS) {
+        case 0: return sinTable[index];
+        case 1: return sinTable[QUARTER_STEPS - index];
+        case 2: return -sinTable[index];
+        default: return -sinTable[QUARTER_STEPS - index];
+    }
+}
+
+fixed cosStep(int step) {
+    return sinStep(step + QUARTER_STEPS);
+}
+
+// Rows of a 3x3 Q16.16 matrix
+typedef fixed Matrix3[3][3];
+
+static void multiply(const Matrix3 a, const Matrix3 b, Matrix3 out) {
+    for (int r = 0; r < 3; r++) {
+        for (int c = 0; c < 3; c++) {
+            const int64_t sum = static_cast<int64_t>(a[r][0]) * b[0][c]
+                              + static_cast<int64_t>(a[r][1]) * b[1][c]
+                              + static_cast<int64_t>(a[r][2]) * b[2][c];
+            out[r][c] = static_cast<fixed>(sum >> FIXED_SHIFT);
+        }
+    }
+}
+
+// Rotation about Y, then X, then Z (same order render3d.lua always used).
+static void buildRotation(const Transform& transform, Matrix3 out) {
+    const fixed sx = sinStep(transform.angleX), cx = cosStep(transform.angleX);
+    const fixed sy = sinStep(transform.angleY), cy = cosStep(transform.angleY);
+    const fixed sz = sinStep(transform.angleZ), cz = cosStep(transform.angleZ);
+
+    const Matrix3 ry = {{cy, 0, sy}, {0, FIXED_ONE, 0}, {-sy, 0, cy}};
+    const Matrix3 rx = {{FIXED_ONE, 0, 0}, {0, cx, -sx}, {0, sx, cx}};
+    const Matrix3 rz = {{cz, -sz, 0}, {sz, cz, 0}, {0, 0, FIXED_ONE}};
+
+    Matrix3 xy;
+    multiply(rx, ry, xy);
+    multiply(rz, xy, out);
+}
+
+// --------------------------------------------------------------------------
+// MESH STORAGE
+// --------------------------------------------------------------------------
+
+size_t meshBytes(int vertexCount, int faceCount) {
+    return alignUp(sizeof(Mesh))
+         + alignUp(sizeof(Vec3) * vertexCount) * 2        // vertices, world
+         + alignUp(sizeof(int32_t) * 2 * vertexCount)     // screen
+         + alignUp(sizeof(int32_t) * faceCount)           // depth
+         + alignUp(sizeof(Face) * faceCount)              // faces
+         + alignUp(sizeof(uint16_t) * faceCount);         // order
+}
+
+Mesh* initMesh(void* block, int vertexCount, int faceCount) {
+    buildTables();
+    uint8_t* cursor = static_cast<uint8_t*>(block);
+    Mesh* mesh = reinterpret_cast<Mesh*>(cursor);
+    cursor += alignUp(sizeof(Mesh));
+
+    mesh->vertexCount = static_cast<uint16_t>(vertexCount);
+    mesh->faceCount = static_cast<uint16_t>(faceCount);
+    mesh->vertices = reinterpret_cast<Vec3*>(cursor);
+    cursor += alignUp(sizeof(Vec3) * vertexCount);
+    mesh->world = reinterpret_cast<Vec3*>(cursor);
+    cursor += alignUp(sizeof(Vec3) * vertexCount);
+    mesh->screen = reinterpret_cast<int32_t*>(cursor);
+    cursor += alignUp(sizeof(int32_t) * 2 * vertexCount);
+    mesh->depth = reinterpret_cast<int32_t*>(cursor);
+    cursor += alignUp(sizeof(int32_t) * faceCount);
+    mesh->faces = reinterpret_cast<Face*>(cursor);
+    cursor += alignUp(sizeof(Face) * faceCount);
+    mesh->order = reinterpret_cast<uint16_t*>(cursor);
+    return mesh;
+}
+
+// --------------------------------------------------------------------------
+// RASTERIZATION
+// --------------------------------------------------------------------------
+
+enum : uint8_t {
+    OUT_LEFT = 1,
+    OUT_RIGHT = 2,
+    OUT_TOP = 4,
+    OUT_BOTTOM = 8
+};
+
+static uint8_t outCode(int32_t x, int32_t y) {
+    uint8_t code = 0;
+    if (x < 0) code |= OUT_LEFT;
+    else if (x >= GUI::SCREEN_WIDTH) code |= OUT_RIGHT;
+    if (y < 0) code |= OUT_TOP;
+    else if (y >= GUI::SCREEN_HEIGHT) code |= OUT_BOTTOM;
+    return code;
+}
+
+// Cohen-Sutherland clip to the panel, then hand the segment to u8g2.
+static void drawClippedLine(int32_t x0, int32_t y0, int32_t x1, int32_t y1) {
+    uint8_t code0 = outCode(x0, y0);
+    uint8_t code1 = outCode(x1, y1);
+    while (true) {
+        if ((code0 | code1) == 0) {
+            u8g2.drawLine(x0, y0, x1, y1);
+            return;
+        }
+        if (code0 & code1) return;
+
+        const uint8_t code = code0 ? code0 : code1;
+        const int64_t dx = x1 - x0;
+        const int64_t dy = y1 - y0;
+        int32_t x;
+        int32_t y;
+        if (code & OUT_BOTTOM) {
+            y = GUI::SCREEN_HEIGHT - 1;
+            x = x0 + static_cast<int32_t>(dx * (y - y0) / dy);
+        } else if (code & OUT_TOP) {
+            y = 0;
+            x = x0 + static_cast<int32_t>(dx * (y - y0) / dy);
+        } else if (code & OUT_RIGHT) {
+            x = GUI::SCREEN_WIDTH - 1;
+            y = y0 + static_cast<int32_t>(dy * (x - x0) / dx);
+        } else {
+            x = 0;
+            y = y0 + static_cast<int32_t>(dy * (x - x0) / dx);
+        }
+        if (code == code0) {
+            x0 = x;
+            y0 = y;
+            code0 = outCode(x0, y0);
+        } else {
+            x1 = x;
+            y1 = y;
+            code1 = outCode(x1, y1);
+        }
+    }
+}
+
+static inline int32_t edgeX(int32_t xa, int32_t ya, int32_t xb, int32_t yb, int32_t y) {
+    if (yb == ya) return xa;
+    return xa + static_cast<int32_t>(static_cast<int64_t>(xb - xa) * (y - ya) / (yb - ya));
+}
+
+// One opaque span: background first, then the lit dither pixels on top.
+static void drawShadedSpan(int32_t xl, int32_t xr, int32_t y, int level, int color) {
+    if (xl > xr) {
+        const int32_t swap = xl;
+        xl = xr;
+        xr = swap;
+    }
+    if (xr < 0 || xl >= GUI::SCREEN_WIDTH) return;
+    if (xl < 0) xl = 0;
+    if (xr > GUI::SCREEN_WIDTH - 1) xr = GUI::SCREEN_WIDTH - 1;
+    const int width = xr - xl + 1;
+
+    if (level >= SHADE_LEVELS) {
+        u8g2.setDrawColor(color);
+        u8g2.drawHLine(xl, y, width);
+        return;
+    }
+    if (color < 2) {
+        u8g2.setDrawColor(color ^ 1);
+        u8g2.drawHLine(xl, y, width);
+    }
+    u8g2.setDrawColor(color);
+    const uint8_t* row = kBayer4[y & 3];
+    for (int32_t x = xl; x <= xr; x++) {
+        if (row[x & 3] < level) {
+            u8g2.drawPixel(x, y);
+        }
+    }
+}
+
+static void fillTriangle(const int32_t* p0, const int32_t* p1, const int32_t* p2, int level, int color) {
+    // Sort by y so p0 is on top
+    if (p1[1] < p0[1]) { const int32_t* t = p0; p0 = p1; p1 = t; }
+    if (p2[1] < p0[1]) { const int32_t* t = p0; p0 = p2; p2 = t; }
+    if (p2[1] < p1[1]) { const int32_t* t = p1; p1 = p2; p2 = t; }
+
+    const int32_t yStart = (p0[1] < 0) ? 0 : p0[1];
+    const int32_t yEnd = (p2[1] > GUI::SCREEN_HEIGHT - 1) ? GUI::SCREEN_HEIGHT - 1 : p2[1];
+    for (int32_t y = yStart; y <= yEnd; y++) {
+        const int32_t longX = edgeX(p0[0], p0[1], p2[0], p2[1], y);
+        const int32_t shortX = (y < p1[1])
+            ? edgeX(p0[0], p0[1], p1[0], p1[1], y)
+            : edgeX(p1[0], p1[1], p2[0], p2[1], y);
+        drawShadedSpan(longX, shortX, y, level, color);
+    }
+}
+
+// --------------------------------------------------------------------------
+// PIPELINE
+// --------------------------------------------------------------------------
+
+static void transformVertices(Mesh& mesh, const Transform& transform) {
+    Matrix3 m;
+    buildRotation(transform, m);
+    const Vec3& p = transform.position;
+    for (int i = 0; i < mesh.vertexCount; i++) {
+        const Vec3& v = mesh.vertices[i];
+        Vec3& w = mesh.world[i];
+        w.x = static_cast<fixed>(((static_cast<int64_t>(m[0][0]) * v.x + static_cast<int64_t>(m[0][1]) * v.y
+                                  + static_cast<int64_t>(m[0][2]) * v.z) >> FIXED_SHIFT)) + p.x;
+        w.y = static_cast<fixed>(((static_cast<int64_t>(m[1][0]) * v.x + static_cast<int64_t>(m[1][1]) * v.y
+                                  + static_cast<int64_t>(m[1][2]) * v.z) >> FIXED_SHIFT)) + p.y;
+        w.z = static_cast<fixed>(((static_cast<int64_t>(m[2][0]) * v.x + static_cast<int64_t>(m[2][1]) * v.y
+                                  + static_cast<int64_t>(m[2][2]) * v.z) >> FIXED_SHIFT)) + p.z;
+    }
+}
+
+// Screen coordinates are floor(center +/- offset), matching the old Lua path.
+static void projectVertices(Mesh& mesh, const View& view) {
+    const int64_t centerX = static_cast<int64_t>(view.centerX) << FIXED_SHIFT;
+    const int64_t centerY = static_cast<int64_t>(view.centerY) << FIXED_SHIFT;
+    for (int i = 0; i < mesh.vertexCount; i++) {
+        const Vec3& w = mesh.world[i];
+        int64_t offsetX = static_cast<int64_t>(w.x) * view.scale;   // Q32
+        int64_t offsetY = static_cast<int64_t>(w.y) * view.scale;
+        if (view.perspective) {
+            const fixed depth = max(w.z, NEAR_DEPTH);
+            offsetX /= depth;                                         // Q16
+            offsetY /= depth;
+        } else {
+            offsetX >>= FIXED_SHIFT;
+            offsetY >>= FIXED_SHIFT;
+        }
+        mesh.screen[i * 2] = clampScreen((centerX + offsetX) >> FIXED_SHIFT);
+        mesh.screen[i * 2 + 1] = clampScreen((centerY - offsetY) >> FIXED_SHIFT);
+    }
+}
+
+// Face normal in Q16.16 (wide, so large meshes cannot overflow).
+static void faceNormal(const Vec3& p1, const Vec3& p2, const Vec3& p3, int64_t normal[3]) {
+    const int64_t ax = p2.x - p1.x, ay = p2.y - p1.y, az = p2.z - p1.z;
+    const int64_t bx = p3.x - p1.x, by = p3.y - p1.y, bz = p3.z - p1.z;
+    normal[0] = (ay * bz - az * by) >> FIXED_SHIFT;
+    normal[1] = (az * bx - ax * bz) >> FIXED_SHIFT;
+    normal[2] = (ax * by - ay * bx) >> FIXED_SHIFT;
+}
+
+static bool isFrontFacing(const int64_t normal[3], const Vec3& p1, bool perspective) {
+    if (!perspective) {
+        return normal[2] < 0;
+    }
+    return (normal[0] * p1.x + normal[1] * p1.y + normal[2] * p1.z) < 0;
+}
+
+static int shadeLevel(const int64_t normal[3]) {
+    const uint64_t lengthSquared = static_cast<uint64_t>(normal[0] * normal[0])
+                                 + static_cast<uint64_t>(normal[1] * normal[1])
+                                 + static_cast<uint64_t>(normal[2] * normal[2]);
+    const uint32_t length = isqrt64(lengthSquared);
+    if (length == 0) return SHADE_AMBIENT;
+
+    const int64_t dot = normal[0] * kLightX + normal[1] * kLightY + normal[2] * kLightZ;
+    const int64_t lambert = dot / length;   // Q16.16, -1..1
+    if (lambert <= 0) return SHADE_AMBIENT;
+    return SHADE_AMBIENT + static_cast<int>((lambert * (SHADE_LEVELS - SHADE_AMBIENT)) >> FIXED_SHIFT);
+}
+
+int drawMesh(Mesh& mesh, const Transform& transform, const View& view, uint8_t mode, int color) {
+    transformVertices(mesh, transform);
+    projectVertices(mesh, view);
+
+    // Cull and collect visible faces with a depth key
+    int visible = 0;
+    int64_t normal[3];
+    for (int f = 0; f < mesh.faceCount; f++) {
+        const Face& face = mesh.faces[f];
+        const Vec3& p1 = mesh.world[face.a];
+        if (view.culling) {
+            faceNormal(p1, mesh.world[face.b], mesh.world[face.c], normal);
+            if (!isFrontFacing(normal, p1, view.perspective)) continue;
+        }
+        mesh.order[visible] = static_cast<uint16_t>(f);
+        mesh.depth[visible] = p1.z + mesh.world[face.b].z + mesh.world[face.c].z;
+        visible++;
+    }
+    if (visible == 0) return 0;
+
+    // Painter's order is only needed when faces are opaque
+    if (mode & MODE_FILL) {
+        for (int i = 1; i < visible; i++) {
+            const uint16_t face = mesh.order[i];
+            const int32_t key = mesh.depth[i];
+            int j = i - 1;
+            while (j >= 0 && mesh.depth[j] < key) {
+                mesh.order[j + 1] = mesh.order[j];
+                mesh.depth[j + 1] = mesh.depth[j];
+                j--;
+            }
+            mesh.order[j + 1] = face;
+            mesh.depth[j + 1] = key;
+        }
+    }
+
+    int32_t minX = SCREEN_LIMIT, minY = SCREEN_LIMIT;
+    int32_t maxX = -SCREEN_LIMIT, maxY = -SCREEN_LIMIT;
+    for (int i = 0; i < visible; i++) {
+        const Face& face = mesh.faces[mesh.order[i]];
+        const int32_t* s0 = &mesh.screen[face.a * 2];
+        const int32_t* s1 = &mesh.screen[face.b * 2];
+        const int32_t* s2 = &mesh.screen[face.c * 2];
+        minX = min(minX, min(s0[0], min(s1[0], s2[0])));
+        maxX = max(maxX, max(s0[0], max(s1[0], s2[0])));
+        minY = min(minY, min(s0[1], min(s1[1], s2[1])));
+        maxY = max(maxY, max(s0[1], max(s1[1], s2[1])));
+
+        if (mode & MODE_FILL) {
+            faceNormal(mesh.world[face.a], mesh.world[face.b], mesh.world[face.c], normal);
+            fillTriangle(s0, s1, s2, shadeLevel(normal), color);
+        }
+        if (mode & MODE_WIREFRAME) {
+            u8g2.setDrawColor(color);
+            drawClippedLine(s0[0], s0[1], s1[0], s1[1]);
+            drawClippedLine(s1[0], s1[1], s2[0], s2[1]);
+            drawClippedLine(s2[0], s2[1], s0[0], s0[1]);
+        }
+    }
+
+    u8g2.setDrawColor(color);
+    Display::markDirty(minX, minY, maxX - minX + 1, maxY - minY + 1);
+    return visible;
+}
+
+} // namespace Gfx3D
@@ -0,0 +1,95 @@
+// PROJECT: ESP32-S2-Mini handheld terminal
+// MODULE: src/gfx3d.h
+// STATUS: [Level 2 - Implementation]
+// TRUTH_LINK: TRUTH_HARDWARE.md Section 1
+// LOG_REF: 2026-10-16
+
+#ifndef GFX3D_H
+#define GFX3D_H
+
+#include <Arduino.h>
+
+// Fixed-point mesh transform and rasterizer behind the gfx3d Lua module.
+//
+// All geometry is Q16.16 fixed point. Angles are turned into indices of a
+// quarter-wave sine table built once at startup, so a frame costs no float
+// math and no allocation: vertex, face and scratch storage live in a single
+// block that the caller (the Lua binding) allocates from meshBytes().
+namespace Gfx3D {
+
+typedef int32_t fixed;   // Q16.16
+
+constexpr int FIXED_SHIFT = 16;
+constexpr fixed FIXED_ONE = 1L << FIXED_SHIFT;
+constexpr int ANGLE_STEPS = 1024;     // Full turn in table steps
+
+constexpr int MAX_VERTICES = 512;
+constexpr int MAX_FACES = 512;
+
+// Draw mode flags for drawMesh()
+constexpr uint8_t MODE_WIREFRAME = 0x01;  // Triangle edges in the current color
+constexpr uint8_t MODE_FILL = 0x02;       // Opaque dithered flat shading
+
+struct Vec3 {
+    fixed x;
+    fixed y;
+    fixed z;
+};
+
+struct Face {
+    uint16_t a;
+    uint16_t b;
+    uint16_t c;
+};
+
+struct Mesh {
+    uint16_t vertexCount;
+    uint16_t faceCount;
+    Vec3* vertices;       // Model space
+    Face* faces;          // Zero-based, counter-clockwise seen from outside
+    Vec3* world;          // Scratch: camera space after transform
+    int32_t* screen;      // Scratch: projected x/y pairs in pixels
+    uint16_t* order;      // Scratch: visible faces, back to front
+    int32_t* depth;       // Scratch: sort key per visible face
+};
+
+struct View {
+    int centerX;
+    int centerY;
+    fixed scale;          // Focal length (perspective) or pixels per unit
+    bool perspective;
+    bool culling;
+};
+
+struct Transform {
+    Vec3 position;
+    int angleX;           // Table steps, any sign
+    int angleY;
+    int angleZ;
+};
+
+inline fixed toFixed(double value) {
+    return static_cast<fixed>(value * FIXED_ONE + (value < 0 ? -0.5 : 0.5));
+}
+
+// Radians to table steps (wrapped into 0..ANGLE_STEPS-1).
+int angleFromRadians(double radians);
+
+// Q16.16 sine/cosine for a table step.
+fixed sinStep(int step);
+fixed cosStep(int step);
+
+// Bytes needed for a mesh with the given counts, including scratch buffers.
+size_t meshBytes(int vertexCount, int faceCount);
+
+// Lay out a mesh inside a block of meshBytes() bytes. Vertices and faces are
+// left for the caller to fill.
+Mesh* initMesh(void* block, int vertexCount, int faceCount);
+
+// Transform, cull, project and rasterize one mesh. Draws in `color` (u8g2
+// draw color) and leaves that color selected. Returns faces drawn.
+int drawMesh(Mesh& mesh, const Transform& transform, const View& view, uint8_t mode, int color);
+
+} // namespace Gfx3D
+
+#endif
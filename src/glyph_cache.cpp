@@ -0,0 +1,290 @@
+// PROJECT: ESP32-S2-Mini handheld terminal
+// MODULE: src/glyph_cache.cpp
+// STATUS: [Level 2 - Implementation]
+// TRUTH_LINK: TRUTH_HARDWARE.md Section 1
+// LOG_REF: 2026-10-16
+
+#include "glyph_cache.h"
+#include "hal.h"
+#include "gui.h"
+
+namespace GlyphCache {
+
+// --------------------------------------------------------------------------
+// INTERNAL STATE
+// --------------------------------------------------------------------------
+
+constexpr int MAX_GLYPH_WIDTH = 8;    // One byte per row
+constexpr int MAX_GLYPH_ROWS = 10;    // Tallest system font is 5x8
+constexpr int FONT_HEADER_SIZE = 23;  // u8g2 font header bytes
+constexpr int SCREEN_ROW_BYTES = GUI::SCREEN_WIDTH / 8;
+
+struct GlyphEntry {
+    int8_t xOffset;
+    int8_t yOffset;
+    uint8_t width;
+    uint8_t height;
+    int8_t advance;
+    uint8_t present;
+    uint16_t rowOffset;   // First row in FontCache::rows
+};
+
+struct FontCache {
+    bool decoded;
+    bool usable;          // False when a glyph does not fit the row format
+    GlyphEntry glyphs[GLYPH_COUNT];
+    WidthTable widths;
+    uint8_t rows[GLYPH_COUNT * MAX_GLYPH_ROWS];   // MSB = leftmost pixel
+};
+
+static FontCache caches[GUI::FONT_SIZE_COUNT];
+
+// u8g2 font header fields used by the glyph decoder
+struct FontInfo {
+    uint8_t bitsPer0;
+    uint8_t bitsPer1;
+    uint8_t bitsPerWidth;
+    uint8_t bitsPerHeight;
+    uint8_t bitsPerX;
+    uint8_t bitsPerY;
+    uint8_t bitsPerAdvance;
+};
+
+// LSB-first bit reader over u8g2 glyph data
+struct BitReader {
+    const uint8_t* ptr;
+    uint8_t bitPos;
+
+    uint8_t readUnsigned(uint8_t count) {
+        uint16_t value = ptr[0] >> bitPos;
+        uint8_t end = bitPos + count;
+        if (end >= 8) {
+            value |= static_cast<uint16_t>(ptr[1]) << (8 - bitPos);
+            ptr++;
+            end -= 8;
+        }
+        bitPos = end;
+        return static_cast<uint8_t>(value & ((1U << count) - 1));
+    }
+
+    int8_t readSigned(uint8_t count) {
+        return static_cast<int8_t>(readUnsigned(count) - (1 << (count - 1)));
+    }
+};
+
+// --------------------------------------------------------------------------
+// DECODING
+// --------------------------------------------------------------------------
+
+static FontCache* findCache(const uint8_t* font) {
+    for (int size = 0; size < GUI::FONT_SIZE_COUNT; size++) {
+        if (GUI::getFontMetrics(size).font == font) {
+            return &caches[size];
+        }
+    }
+    return nullptr;
+}
+
+// Unpack one RLE glyph into MSB-first row bytes. Returns false if it is too
+// large for the one-byte-per-row table.
+static bool decodeGlyph(const uint8_t* data, const FontInfo& info, GlyphEntry& entry, uint8_t* rows) {
+    BitReader reader = {data, 0};
+    const uint8_t width = reader.readUnsigned(info.bitsPerWidth);
+    const uint8_t height = reader.readUnsigned(info.bitsPerHeight);
+    entry.xOffset = reader.readSigned(info.bitsPerX);
+    entry.yOffset = reader.readSigned(info.bitsPerY);
+    entry.advance = reader.readSigned(info.bitsPerAdvance);
+    entry.width = width;
+    entry.height = height;
+    entry.present = 1;
+    if (width > MAX_GLYPH_WIDTH || height > MAX_GLYPH_ROWS) {
+        return false;
+    }
+
+    memset(rows, 0, height);
+    if (width == 0) {
+        return true;
+    }
+
+    int x = 0;
+    int y = 0;
+    while (y < height) {
+        const uint8_t zeros = reader.readUnsigned(info.bitsPer0);
+        const uint8_t ones = reader.readUnsigned(info.bitsPer1);
+        do {
+            for (int run = 0; run < 2; run++) {
+                int count = (run == 0) ? zeros : ones;
+                while (count > 0 && y < height) {
+                    const int span = min(count, width - x);
+                    if (run == 1) {
+                        const uint8_t bits = static_cast<uint8_t>(0xFF << (MAX_GLYPH_WIDTH - span));
+                        rows[y] |= static_cast<uint8_t>(bits >> x);
+                    }
+                    x += span;
+                    count -= span;
+                    if (x >= width) {
+                        x = 0;
+                        y++;
+                    }
+                }
+            }
+        } while (reader.readUnsigned(1) != 0);
+    }
+    return true;
+}
+
+static void decodeFont(FontCache& cache, const uint8_t* font) {
+    cache.decoded = true;
+    cache.usable = true;
+    memset(cache.glyphs, 0, sizeof(cache.glyphs));
+    memset(&cache.widths, 0, sizeof(cache.widths));
+
+    const FontInfo info = {font[2], font[3], font[4], font[5], font[6], font[7], font[8]};
+    uint16_t nextRow = 0;
+
+    // Glyph records: encoding, record size, bitstream. A zero size ends the
+    // 8-bit table; the printable range always lives in it.
+    const uint8_t* record = font + FONT_HEADER_SIZE;
+    while (record[1] != 0) {
+        const uint8_t encoding = record[0];
+        if (encoding >= FIRST_GLYPH && encoding <= LAST_GLYPH) {
+            GlyphEntry& entry = cache.glyphs[encoding - FIRST_GLYPH];
+            entry.rowOffset = nextRow;
+            if (!decodeGlyph(record + 2, info, entry, &cache.rows[nextRow])) {
+                cache.usable = false;
+                Serial.printf("[GlyphCache] Glyph %u too large, font left to u8g2\n", encoding);
+                return;
+            }
+            nextRow += entry.height;
+
+            const int index = encoding - FIRST_GLYPH;
+            cache.widths.advance[index] = entry.advance;
+            cache.widths.extent[index] = (entry.width != 0)
+                ? static_cast<int8_t>(entry.width + entry.xOffset)
+                : entry.advance;
+        }
+        record += record[1];
+    }
+}
+
+static const FontCache* getCache(const uint8_t* font) {
+    FontCache* cache = findCache(font);
+    if (cache == nullptr) return nullptr;
+    if (!cache->decoded) {
+        decodeFont(*cache, font);
+    }
+    return cache->usable ? cache : nullptr;
+}
+
+static bool isCachedString(const FontCache& cache, const char* str) {
+    for (const uint8_t* p = reinterpret_cast<const uint8_t*>(str); *p; p++) {
+        if (*p < FIRST_GLYPH || *p > LAST_GLYPH) return false;
+        if (!cache.glyphs[*p - FIRST_GLYPH].present) return false;
+    }
+    return true;
+}
+
+// --------------------------------------------------------------------------
+// BLITTING
+// --------------------------------------------------------------------------
+
+#ifndef PLATFORM_EMULATOR
+// Combine a row byte into the ST7920 horizontal buffer (MSB = leftmost).
+static inline void applyByte(uint8_t* target, uint8_t bits, uint8_t color) {
+    if (color == 0) *target &= ~bits;
+    else if (color == 2) *target ^= bits;
+    else *target |= bits;
+}
+#endif
+
+static void blitGlyph(const FontCache& cache, const GlyphEntry& entry, int x, int baselineY) {
+    const int left = x + entry.xOffset;
+    const int top = baselineY - (entry.height + entry.yOffset);
+    const uint8_t* rows = &cache.rows[entry.rowOffset];
+
+#ifdef PLATFORM_EMULATOR
+    // The emulator framebuffer is one byte per pixel; go through drawPixel.
+    for (int r = 0; r < entry.height; r++) {
+        const uint8_t bits = rows[r];
+        for (int c = 0; bits != 0 && c < entry.width; c++) {
+            if (bits & (0x80 >> c)) {
+                u8g2.drawPixel(left + c, top + r);
+            }
+        }
+    }
+#else
+    uint8_t* buffer = u8g2.getBufferPtr();
+    const uint8_t color = u8g2.getU8g2()->draw_color;
+    const int column = left >> 3;   // Floor, also for negative x
+    const int shift = left & 7;
+    for (int r = 0; r < entry.height; r++) {
+        const int y = top + r;
+        if (y < 0 || y >= GUI::SCREEN_HEIGHT || rows[r] == 0) continue;
+        uint8_t* line = buffer + (y * SCREEN_ROW_BYTES);
+        if (column >= 0 && column < SCREEN_ROW_BYTES) {
+            applyByte(line + column, static_cast<uint8_t>(rows[r] >> shift), color);
+        }
+        if (shift != 0 && column + 1 >= 0 && column + 1 < SCREEN_ROW_BYTES) {
+            applyByte(line + column + 1, static_cast<uint8_t>(rows[r] << (8 - shift)), color);
+        }
+    }
+#endif
+}
+
+// --------------------------------------------------------------------------
+// PUBLIC API
+// --------------------------------------------------------------------------
+
+bool drawText(const uint8_t* font, int x, int y, const char* str) {
+    if (str == nullptr) return true;
+    const FontCache* cache = getCache(font);
+    if (cache == nullptr || !isCachedString(*cache, str)) return false;
+
+    for (const uint8_t* p = reinterpret_cast<const uint8_t*>(str); *p; p++) {
+        const GlyphEntry& entry = cache->glyphs[*p - FIRST_GLYPH];
+        if (entry.width != 0) {
+            blitGlyph(*cache, entry, x, y);
+        }
+        x += entry.advance;
+    }
+    return true;
+}
+
+int textWidth(const uint8_t* font, const char* str) {
+    if (str == nullptr) return 0;
+    const FontCache* cache = getCache(font);
+    if (cache == nullptr || !isCachedString(*cache, str)) return -1;
+
+    int width = 0;
+    const GlyphEntry* last = nullptr;
+    for (const uint8_t* p = reinterpret_cast<const uint8_t*>(str); *p; p++) {
+        last = &cache->glyphs[*p - FIRST_GLYPH];
+        width += last->advance;
+    }
+    // Same rule as u8g2_string_width(): the last glyph counts with its box.
+    if (last != nullptr && last->width != 0) {
+        width += last->width + last->xOffset - last->advance;
+    }
+    return width;
+}
+
+const WidthTable* getWidthTable(const uint8_t* font) {
+    const FontCache* cache = getCache(font);
+    return (cache != nullptr) ? &cache->widths : nullptr;
+}
+
+void warmUp() {
+    for (int size = 0; size < GUI::FONT_SIZE_COUNT; size++) {
+        getCache(GUI::getFontMetrics(size).font);
+    }
+}
+
+size_t getMemoryUsage() {
+    size_t total = 0;
+    for (int size = 0; size < GUI::FONT_SIZE_COUNT; size++) {
+        if (caches[size].decoded) total += sizeof(FontCache);
+    }
+    return total;
+}
+
+} // namespace GlyphCache
@@ -0,0 +1,53 @@
+// PROJECT: ESP32-S2-Mini handheld terminal
+// MODULE: src/glyph_cache.h
+// STATUS: [Level 2 - Implementation]
+// TRUTH_LINK: TRUTH_HARDWARE.md Section 1
+// LOG_REF: 2026-10-16
+
+#ifndef GLYPH_CACHE_H
+#define GLYPH_CACHE_H
+
+#include <Arduino.h>
+
+// Pre-decoded printable-ASCII glyphs for the three system fonts.
+//
+// u8g2 stores glyphs RLE-compressed and decodes them on every draw and every
+// width query. The first time a system font is used, its 95 printable glyphs
+// are unpacked here into one byte per glyph row plus their metrics, so text
+// drawing becomes row blits into the framebuffer and measuring becomes a sum
+// of table entries. Strings with any non-ASCII byte, and fonts outside the
+// system set, are reported as uncached and the caller falls back to u8g2.
+namespace GlyphCache {
+
+constexpr int FIRST_GLYPH = 32;
+constexpr int LAST_GLYPH = 126;
+constexpr int GLYPH_COUNT = LAST_GLYPH - FIRST_GLYPH + 1;
+
+// Per-glyph horizontal metrics, indexed by (c - FIRST_GLYPH). A string is
+// as wide as the advances of all but its last glyph plus that glyph's extent.
+struct WidthTable {
+    int8_t advance[GLYPH_COUNT];
+    int8_t extent[GLYPH_COUNT];   // Bounding-box right edge (advance if blank)
+};
+
+// Draw str with its baseline at y in the current u8g2 draw color
+// (transparent font mode). Returns false, drawing nothing, when the font or
+// string is not covered by the cache.
+bool drawText(const uint8_t* font, int x, int y, const char* str);
+
+// Pixel width as u8g2 reports it (advances, with the last glyph counted by
+// its bounding box). Returns -1 when the font or string is not cached.
+int textWidth(const uint8_t* font, const char* str);
+
+// Width table for a system font, or nullptr when the font is not cached.
+const WidthTable* getWidthTable(const uint8_t* font);
+
+// Decode all system fonts now instead of on first use.
+void warmUp();
+
+// Bytes of RAM held by decoded glyph tables.
+size_t getMemoryUsage();
+
+} // namespace GlyphCache
+
+#endif
@@ -6,6 +6,8 @@
 
 #include "gui.h"
 #include "hal.h"
+#include "display.h"
+#include "glyph_cache.h"
 
 namespace GUI {
 
@@ -27,6 +29,7 @@ static const int kSystemFontOptionToSize[kSystemFontOptionCount] = {
     FONT_SIZE_TINY,
 };
 static int gSystemFontOptionIndex = 2;
+static const uint8_t* gCurrentFont = nullptr;
 
 const uint8_t* FONT_TINY   = kSystemFontMetrics[FONT_SIZE_TINY].font;
 const uint8_t* FONT_SMALL  = kSystemFontMetrics[FONT_SIZE_SMALL].font;
@@ -95,8 +98,13 @@ const FontMetrics& getSecondaryFontMetrics() {
     return getFontMetrics(getSecondaryFontSize());
 }
 
+void setFont(const uint8_t* font) {
+    gCurrentFont = font;
+    u8g2.setFont(font);
+}
+
 void setFontBySize(int fontSize) {
-    u8g2.setFont(getFontMetrics(fontSize).font);
+    setFont(getFontMetrics(fontSize).font);
 }
 
 void setFontSystem() {
@@ -184,18 +192,19 @@ void drawHeader(const char* title, const char* rightText) {
     const int baselineY = getHeaderBaselineY(fontSize);
     const int padX = getHorizontalPaddingForFont(fontSize);
 
+    Display::markDirty(0, 0, SCREEN_WIDTH, headerHeight);
     u8g2.drawBox(0, 0, SCREEN_WIDTH, headerHeight);
     u8g2.setDrawColor(0);
     setFontSystem();
 
     String right = rightText ? truncateStringToWidth(String(rightText), (SCREEN_WIDTH / 2) - (padX * 2)) : String("");
-    int rightWidth = right.length() > 0 ? u8g2.getUTF8Width(right.c_str()) : 0;
+    int rightWidth = right.length() > 0 ? getTextWidth(right.c_str()) : 0;
     int titleMaxWidth = SCREEN_WIDTH - (padX * 2) - (rightWidth > 0 ? rightWidth + padX + 1 : 0);
     String titleText = truncateStringToWidth(String(title ? title : ""), max(1, titleMaxWidth));
-    u8g2.drawUTF8(padX, baselineY, titleText.c_str());
+    drawText(padX, baselineY, titleText.c_str());
 
     if (rightWidth > 0) {
-        u8g2.drawUTF8(SCREEN_WIDTH - rightWidth - padX, baselineY, right.c_str());
+        drawText(SCREEN_WIDTH - rightWidth - padX, baselineY, right.c_str());
     }
     
     u8g2.setDrawColor(1);
@@ -216,13 +225,14 @@ void drawFooter(const char* text) {
     const int separatorY = getFooterSeparatorY(fontSize);
     const int maxWidth = SCREEN_WIDTH - (getHorizontalPaddingForFont(fontSize) * 2);
 
+    Display::markDirty(0, separatorY, SCREEN_WIDTH, SCREEN_HEIGHT - separatorY);
     setFontSystem();
     u8g2.drawHLine(0, separatorY, SCREEN_WIDTH);
 
     String footerText = truncateStringToWidth(String(text ? text : ""), maxWidth);
-    int textWidth = u8g2.getUTF8Width(footerText.c_str());
+    int textWidth = getTextWidth(footerText.c_str());
     int x = (SCREEN_WIDTH - textWidth) / 2;
-    u8g2.drawUTF8(x, baselineY, footerText.c_str());
+    drawText(x, baselineY, footerText.c_str());
 }
 
 void drawFooterHints(const char* leftHint, const char* rightHint) {
@@ -232,18 +242,19 @@ void drawFooterHints(const char* leftHint, const char* rightHint) {
     const int padX = getHorizontalPaddingForFont(fontSize);
     const int halfWidth = (SCREEN_WIDTH - SCROLLBAR_WIDTH - (padX * 3)) / 2;
 
+    Display::markDirty(0, separatorY, SCREEN_WIDTH, SCREEN_HEIGHT - separatorY);
     setFontSystem();
     u8g2.drawHLine(0, separatorY, SCREEN_WIDTH);
 
     if (leftHint != nullptr && leftHint[0] != '\0') {
         String left = truncateStringToWidth(String(leftHint), halfWidth);
-        u8g2.drawUTF8(padX, baselineY, left.c_str());
+        drawText(padX, baselineY, left.c_str());
     }
 
     if (rightHint != nullptr && rightHint[0] != '\0') {
         String right = truncateStringToWidth(String(rightHint), halfWidth);
-        int textWidth = u8g2.getUTF8Width(right.c_str());
-        u8g2.drawUTF8(SCREEN_WIDTH - textWidth - SCROLLBAR_WIDTH - padX, baselineY, right.c_str());
+        int textWidth = getTextWidth(right.c_str());
+        drawText(SCREEN_WIDTH - textWidth - SCROLLBAR_WIDTH - padX, baselineY, right.c_str());
     }
 }
 
@@ -254,7 +265,7 @@ static void resolveListConfig(const ListConfig& config,
                               int& leftMargin) {
     const int fontSize = getSystemFontSize();
     const int padX = getHorizontalPaddingForFont(fontSize);
-    const int selectorWidth = u8g2.getUTF8Width(">") + padX + 1;
+    const int selectorWidth = getTextWidth(">") + padX + 1;
 
     startY = config.startY >= 0 ? config.startY : getContentBaselineStart(fontSize);
     lineHeight = config.lineHeight > 0 ? config.lineHeight : getListLineHeight(fontSize);
@@ -276,13 +287,14 @@ void drawList(const char* const* items, int itemCount, int selectedIndex,
     resolveListConfig(config, startY, visibleItems, lineHeight, leftMargin);
     const int fontSize = getSystemFontSize();
     const int textMaxWidth = SCREEN_WIDTH - leftMargin - (config.showScrollbar ? SCROLLBAR_WIDTH + 4 : 2);
+    Display::markDirty(0, getHighlightTop(startY, fontSize), SCREEN_WIDTH, visibleItems * lineHeight + 1);
     
     for (int i = 0; i < visibleItems && (scrollOffset + i) < itemCount; i++) {
         int idx = scrollOffset + i;
         int y = startY + (i * lineHeight);
         
         if (config.showSelector && idx == selectedIndex) {
-            u8g2.drawUTF8(0, y, ">");
+            drawText(0, y, ">");
         }
         
         if (idx == selectedIndex) {
@@ -294,7 +306,7 @@ void drawList(const char* const* items, int itemCount, int selectedIndex,
         }
         
         String itemText = truncateStringToWidth(String(items[idx] ? items[idx] : ""), max(1, textMaxWidth));
-        u8g2.drawUTF8(leftMargin, y, itemText.c_str());
+        drawText(leftMargin, y, itemText.c_str());
         u8g2.setDrawColor(1);
     }
     
@@ -319,13 +331,14 @@ void drawStringList(const String* items, int itemCount, int selectedIndex,
     resolveListConfig(config, startY, visibleItems, lineHeight, leftMargin);
     const int fontSize = getSystemFontSize();
     const int textMaxWidth = SCREEN_WIDTH - leftMargin - (config.showScrollbar ? SCROLLBAR_WIDTH + 4 : 2);
+    Display::markDirty(0, getHighlightTop(startY, fontSize), SCREEN_WIDTH, visibleItems * lineHeight + 1);
     
     for (int i = 0; i < visibleItems && (scrollOffset + i) < itemCount; i++) {
         int idx = scrollOffset + i;
         int y = startY + (i * lineHeight);
         
         if (config.showSelector && idx == selectedIndex) {
-            u8g2.drawUTF8(0, y, ">");
+            drawText(0, y, ">");
         }
         
         if (idx == selectedIndex) {
@@ -337,7 +350,7 @@ void drawStringList(const String* items, int itemCount, int selectedIndex,
         }
         
         String displayStr = truncateStringToWidth(items[idx], max(1, textMaxWidth));
-        u8g2.drawUTF8(leftMargin, y, displayStr.c_str());
+        drawText(leftMargin, y, displayStr.c_str());
         u8g2.setDrawColor(1);
     }
     
@@ -355,6 +368,7 @@ void drawStringList(const String* items, int itemCount, int selectedIndex,
 void drawScrollbar(int x, int yStart, int height,
                    int totalItems, int visibleItems, int scrollOffset) {
     if (totalItems <= visibleItems) return;
+    Display::markDirty(x, yStart, SCROLLBAR_WIDTH, height);
     
     // Draw track
     u8g2.drawVLine(x + 1, yStart, height);
@@ -374,15 +388,18 @@ void drawScrollbar(int x, int yStart, int height,
 // ==========================================================================
 
 void drawHighlight(int x, int y, int width, int height) {
+    Display::markDirty(x, y, width, height);
     u8g2.drawBox(x, y, width, height);
 }
 
 void drawSelectableText(int x, int y, const char* text, bool selected, int width) {
     const int fontSize = getSystemFontSize();
     setFontSystem();
+    Display::markDirty(x - getHighlightPaddingX(fontSize), getHighlightTop(y, fontSize),
+                       SCREEN_WIDTH, getHighlightHeight(fontSize));
     
     if (selected) {
-        int w = (width > 0) ? width : u8g2.getUTF8Width(text) + (getHighlightPaddingX(fontSize) * 2);
+        int w = (width > 0) ? width : getTextWidth(text) + (getHighlightPaddingX(fontSize) * 2);
         u8g2.drawBox(x - getHighlightPaddingX(fontSize),
                      getHighlightTop(y, fontSize),
                      w,
@@ -390,7 +407,7 @@ void drawSelectableText(int x, int y, const char* text, bool selected, int width
         u8g2.setDrawColor(0);
     }
     
-    u8g2.drawUTF8(x, y, text);
+    drawText(x, y, text);
     u8g2.setDrawColor(1);
 }
 
@@ -399,6 +416,7 @@ void drawSelectableText(int x, int y, const char* text, bool selected, int width
 // ==========================================================================
 
 void drawPopupFrame(int x, int y, int width, int height, bool clearBackground) {
+    Display::markDirty(x, y, width, height);
     if (clearBackground) {
         u8g2.setDrawColor(0);
         u8g2.drawBox(x + 1, y + 1, width - 2, height - 2);
@@ -422,7 +440,7 @@ void drawContextMenu(const char* const* items, int itemCount, int selectedIndex,
     setFontSystem();
     int maxWidth = 0;
     for (int i = 0; i < itemCount; i++) {
-        int w = u8g2.getUTF8Width(items[i]);
+        int w = getTextWidth(items[i]);
         if (w > maxWidth) maxWidth = w;
     }
     
@@ -443,10 +461,10 @@ void drawYesNoDialog(const char* message, bool yesSelected) {
 
     setFontSystem();
     String msg = truncateStringToWidth(String(message ? message : ""), 96);
-    int msgWidth = u8g2.getUTF8Width(msg.c_str());
+    int msgWidth = getTextWidth(msg.c_str());
     int msgX = (SCREEN_WIDTH - msgWidth) / 2;
     int msgY = 12 + 6 + metrics.baselineOffset;
-    u8g2.drawUTF8(msgX, msgY, msg.c_str());
+    drawText(msgX, msgY, msg.c_str());
 
     const int buttonY = 44;
     const int buttonWidth = 30;
@@ -457,14 +475,14 @@ void drawYesNoDialog(const char* message, bool yesSelected) {
         u8g2.drawBox(yesX, getHighlightTop(buttonY), buttonWidth, getHighlightHeight());
         u8g2.setDrawColor(0);
     }
-    u8g2.drawUTF8(yesX + 6, buttonY, "YES");
+    drawText(yesX + 6, buttonY, "YES");
     u8g2.setDrawColor(1);
 
     if (!yesSelected) {
         u8g2.drawBox(noX, getHighlightTop(buttonY), buttonWidth, getHighlightHeight());
         u8g2.setDrawColor(0);
     }
-    u8g2.drawUTF8(noX + 9, buttonY, "NO");
+    drawText(noX + 9, buttonY, "NO");
     u8g2.setDrawColor(1);
 }
 
@@ -473,14 +491,14 @@ void drawMessageDialog(const char* message, const char* buttonLabel, bool invert
 
     setFontSystem();
     String msg = truncateStringToWidth(String(message ? message : ""), 96);
-    int msgWidth = u8g2.getUTF8Width(msg.c_str());
+    int msgWidth = getTextWidth(msg.c_str());
     int msgX = (SCREEN_WIDTH - msgWidth) / 2;
     int msgY = 12 + 6 + getSystemFontMetrics().baselineOffset;
-    u8g2.drawUTF8(msgX, msgY, msg.c_str());
+    drawText(msgX, msgY, msg.c_str());
 
     const char* label = (buttonLabel != nullptr && buttonLabel[0] != '\0') ? buttonLabel : "OK";
     const int buttonY = 44;
-    int buttonWidth = u8g2.getUTF8Width(label) + 12;
+    int buttonWidth = getTextWidth(label) + 12;
     if (buttonWidth < 30) {
         buttonWidth = 30;
     }
@@ -493,9 +511,9 @@ void drawMessageDialog(const char* message, const char* buttonLabel, bool invert
         u8g2.drawFrame(buttonX, getHighlightTop(buttonY), buttonWidth, getHighlightHeight());
         u8g2.setDrawColor(1);
     }
-    int labelWidth = u8g2.getUTF8Width(label);
+    int labelWidth = getTextWidth(label);
     int labelX = buttonX + (buttonWidth - labelWidth) / 2;
-    u8g2.drawUTF8(labelX, buttonY, label);
+    drawText(labelX, buttonY, label);
     u8g2.setDrawColor(1);
 }
 
@@ -504,10 +522,10 @@ void drawThreeOptionDialog(const char* message, const char* const labels[3], int
 
     setFontSystem();
     String msg = truncateStringToWidth(String(message ? message : ""), 104);
-    int msgWidth = u8g2.getUTF8Width(msg.c_str());
+    int msgWidth = getTextWidth(msg.c_str());
     int msgX = (SCREEN_WIDTH - msgWidth) / 2;
     int msgY = 10 + 6 + getSystemFontMetrics().baselineOffset;
-    u8g2.drawUTF8(msgX, msgY, msg.c_str());
+    drawText(msgX, msgY, msg.c_str());
 
     const int buttonY = 41;
     const int buttonWidth = 30;
@@ -518,9 +536,9 @@ void drawThreeOptionDialog(const char* message, const char* const labels[3], int
             u8g2.drawBox(buttonXs[i], getHighlightTop(buttonY), buttonWidth, getHighlightHeight());
             u8g2.setDrawColor(0);
         }
-        int labelWidth = u8g2.getUTF8Width(label);
+        int labelWidth = getTextWidth(label);
         int labelX = buttonXs[i] + (buttonWidth - labelWidth) / 2;
-        u8g2.drawUTF8(labelX, buttonY, label);
+        drawText(labelX, buttonY, label);
         u8g2.setDrawColor(1);
     }
 }
@@ -547,7 +565,7 @@ bool updateToast(int footerTopY) {
     setFontSystem();
     const FontMetrics& metrics = getSystemFontMetrics();
     String message = truncateStringToWidth(toastMessage, SCREEN_WIDTH - 12);
-    int msgWidth = u8g2.getUTF8Width(message.c_str());
+    int msgWidth = getTextWidth(message.c_str());
     int boxWidth = msgWidth + 8;
     int boxX = (SCREEN_WIDTH - boxWidth) / 2;
     int boxHeight = metrics.boxHeight + 4;
@@ -556,11 +574,12 @@ bool updateToast(int footerTopY) {
         boxY = 0;
     }
 
+    Display::markDirty(boxX, boxY, boxWidth, boxHeight);
     u8g2.setDrawColor(0);
     u8g2.drawBox(boxX, boxY, boxWidth, boxHeight);
     u8g2.setDrawColor(1);
     u8g2.drawFrame(boxX, boxY, boxWidth, boxHeight);
-    u8g2.drawUTF8(boxX + 4, boxY + metrics.baselineOffset + 2, message.c_str());
+    drawText(boxX + 4, boxY + metrics.baselineOffset + 2, message.c_str());
     
     return true;
 }
@@ -575,29 +594,31 @@ void clearToast() {
 // ==========================================================================
 
 void drawGameOver(const char* title, int score, const char* restartHint) {
+    Display::markDirty(0, getContentAreaTop(), SCREEN_WIDTH, SCREEN_HEIGHT - getContentAreaTop());
     setFontSystem();
     String titleText = truncateStringToWidth(String(title ? title : ""), SCREEN_WIDTH - 4);
-    int titleWidth = u8g2.getUTF8Width(titleText.c_str());
+    int titleWidth = getTextWidth(titleText.c_str());
     int titleY = getContentBaselineStart();
-    u8g2.drawUTF8((SCREEN_WIDTH - titleWidth) / 2, titleY, titleText.c_str());
+    drawText((SCREEN_WIDTH - titleWidth) / 2, titleY, titleText.c_str());
     
     setFontSecondary();
     char scoreStr[20];
     snprintf(scoreStr, sizeof(scoreStr), "Score: %d", score);
-    int scoreWidth = u8g2.getUTF8Width(scoreStr);
+    int scoreWidth = getTextWidth(scoreStr);
     int scoreY = titleY + getSystemFontMetrics().lineHeight + getSecondaryFontMetrics().baselineOffset;
-    u8g2.drawUTF8((SCREEN_WIDTH - scoreWidth) / 2, scoreY, scoreStr);
+    drawText((SCREEN_WIDTH - scoreWidth) / 2, scoreY, scoreStr);
     
     String hint = truncateStringToWidth(String(restartHint ? restartHint : ""), SCREEN_WIDTH - 4);
-    int hintWidth = u8g2.getUTF8Width(hint.c_str());
-    u8g2.drawUTF8((SCREEN_WIDTH - hintWidth) / 2, getFooterBaselineY(), hint.c_str());
+    int hintWidth = getTextWidth(hint.c_str());
+    drawText((SCREEN_WIDTH - hintWidth) / 2, getFooterBaselineY(), hint.c_str());
 }
 
 void drawScore(int x, int y, const char* label, int value) {
     setFontSystem();
     char str[32];
     snprintf(str, sizeof(str), "%s%d", label, value);
-    u8g2.drawUTF8(x, y, str);
+    Display::markDirty(x, y - u8g2.getMaxCharHeight(), SCREEN_WIDTH - x, u8g2.getMaxCharHeight() * 2);
+    drawText(x, y, str);
 }
 
 // ==========================================================================
@@ -667,12 +688,12 @@ String truncateStringToWidth(const String& str, int maxWidth, const char* ellips
         return "";
     }
 
-    if (u8g2.getUTF8Width(str.c_str()) <= maxWidth) {
+    if (getTextWidth(str.c_str()) <= maxWidth) {
         return str;
     }
 
     String suffix = (ellipsis != nullptr) ? String(ellipsis) : String("...");
-    if (u8g2.getUTF8Width(suffix.c_str()) > maxWidth) {
+    if (getTextWidth(suffix.c_str()) > maxWidth) {
         return "";
     }
 
@@ -680,7 +701,7 @@ String truncateStringToWidth(const String& str, int maxWidth, const char* ellips
     while (candidate.length() > 0) {
         candidate.remove(candidate.length() - 1);
         String withSuffix = candidate + suffix;
-        if (u8g2.getUTF8Width(withSuffix.c_str()) <= maxWidth) {
+        if (getTextWidth(withSuffix.c_str()) <= maxWidth) {
             return withSuffix;
         }
     }
@@ -689,12 +710,19 @@ String truncateStringToWidth(const String& str, int maxWidth, const char* ellips
 }
 
 int centerTextX(const char* text) {
-    int textWidth = u8g2.getStrWidth(text);
+    int textWidth = getTextWidth(text);
     return (SCREEN_WIDTH - textWidth) / 2;
 }
 
 int getTextWidth(const char* text) {
-    return u8g2.getStrWidth(text);
+    const int width = GlyphCache::textWidth(gCurrentFont, text);
+    return (width >= 0) ? width : u8g2.getUTF8Width(text);
+}
+
+void drawText(int x, int y, const char* text) {
+    if (!GlyphCache::drawText(gCurrentFont, x, y, text)) {
+        u8g2.drawUTF8(x, y, text);
+    }
 }
 
 void setFontTiny() {
@@ -344,11 +344,25 @@ int centerTextX(const char* text);
 
 /**
  * Get width of text string in current font.
- * @param text Text to measure
+ * Uses the pre-decoded glyph cache for system fonts.
+ * @param text Text to measure (UTF-8)
  * @return Width in pixels
  */
 int getTextWidth(const char* text);
 
+/**
+ * Draw text with its baseline at y in the current font and draw color.
+ * Uses the pre-decoded glyph cache for system fonts, u8g2 otherwise.
+ * @param text Text to draw (UTF-8)
+ */
+void drawText(int x, int y, const char* text);
+
+/**
+ * Select a font. Use this instead of u8g2.setFont() so text drawing knows
+ * which glyph table applies.
+ */
+void setFont(const uint8_t* font);
+
 /**
  * Set the standard tiny font.
  */
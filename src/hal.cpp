@@ -32,9 +32,23 @@ int systemBrightness = 38;  // Default ~15% brightness (0-255)
 SdFat sdFat;
 static SPIClass sdSpi(FSPI);
 static bool sdCardDetected = false;   // Card was found (cached between sessions)
-static bool sdSessionActive = false;  // HW SPI bus is currently held for SD
+static bool sdSessionActive = false;  // Volume is mounted and HW SPI bus held
+static int sdSessionUsers = 0;        // Open sdBeginSession() calls not yet ended
+static unsigned long sdLastUseMs = 0; // millis() of the last session end
+static unsigned long sdIdleReleaseMs = SD_IDLE_RELEASE_MS;
+static uint32_t sdMountCount = 0;     // Full card inits (sdFat.begin)
+static uint32_t sdReuseCount = 0;     // Sessions served by the mounted volume
 static uint64_t sdCachedTotal = 0;    // Cached total bytes (refreshed on mount)
-static uint64_t sdCachedUsed = 0;     // Cached used bytes (refreshed on mount)
+static uint64_t sdCachedUsed = 0;     // Cached used bytes (valid once the scan is done)
+static uint32_t sdBytesPerCluster = 0;
+static bool sdUsedReady = false;      // Free-space scan finished
+static bool sdFreeScanActive = false; // Free-space scan in progress
+static uint32_t sdFreeScanCluster = 0;  // Next FAT entry to count
+static uint32_t sdFreeScanFree = 0;     // Free clusters counted so far
+static int64_t sdFreeScanAdjust = 0;    // Our own writes noted during the scan
+static int sdFreeScanRetries = 0;      // Failed FAT reads in a row
+static bool sdUsedFailed = false;     // Scan gave up; used space unknown
+static unsigned long sdFreeScanStartMs = 0;
 
 // --------------------------------------------------------------------------
 // INPUT MATRIX CONFIG
@@ -128,8 +142,7 @@ void setupHardware() {
   // Probe SD card on HW SPI (FSPI) — dedicated pins, no LCD interference
   Serial.println("[HAL] Probing SD card...");
   if (mountSD()) {
-      Serial.printf("[HAL] SD card: detected (%llu/%llu bytes used)\n",
-                    (unsigned long long)sdUsedBytes(),
+      Serial.printf("[HAL] SD card: detected (%llu bytes, used pending)\n",
                     (unsigned long long)sdTotalBytes());
   } else {
       Serial.println("[HAL] SD card: not found");
@@ -140,18 +153,27 @@ void setupHardware() {
 // SD CARD SESSION MANAGEMENT
 // --------------------------------------------------------------------------
 
-// Acquire HW SPI bus and mount SD card for file operations.
-// LCD is on separate pins — no conflict.
+// The volume stays mounted between sessions. A full card init costs tens
+// of milliseconds, so sdBeginSession() only mounts when nothing is mounted;
+// sdServiceSession() releases the card once it has been idle for
+// sdIdleReleaseMs, and sdReleaseSession() releases it on demand (sleep,
+// remount). LCD is on separate pins, so holding the bus is harmless.
 bool sdBeginSession() {
-    if (sdSessionActive) return true;
+    if (sdSessionActive) {
+        sdSessionUsers++;
+        sdReuseCount++;
+        return true;
+    }
 
     pinMode(PIN_SD_CS, OUTPUT);
     digitalWrite(PIN_SD_CS, HIGH);
 
     sdSpi.begin(PIN_SPI_SCLK, PIN_SPI_MISO, PIN_SPI_MOSI);
     SdSpiConfig spiCfg(PIN_SD_CS, DEDICATED_SPI, SD_SCK_MHZ(4), &sdSpi);
+    sdMountCount++;
     if (sdFat.begin(spiCfg)) {
         sdSessionActive = true;
+        sdSessionUsers = 1;
         return true;
     }
     Serial.printf("[HAL] SdFat fail type=%d code=0x%02X\n",
@@ -161,30 +183,79 @@ bool sdBeginSession() {
     sdCardDetected = false;
     sdCachedTotal = 0;
     sdCachedUsed = 0;
+    sdUsedReady = false;
+    sdUsedFailed = false;
+    sdFreeScanActive = false;
     return false;
 }
 
-// Release HW SPI bus.
+// End one session. The volume stays mounted until it has been idle.
 void sdEndSession() {
+    if (!sdSessionActive) return;
+    if (sdSessionUsers > 0) sdSessionUsers--;
+    sdLastUseMs = millis();
+}
+
+// Unmount and release the HW SPI bus now, even if sessions are open.
+void sdReleaseSession() {
     if (!sdSessionActive) return;
     sdFat.end();
     sdSpi.end();
     sdSessionActive = false;
+    sdSessionUsers = 0;
+}
+
+void sdServiceSession() {
+    if (!sdSessionActive || sdSessionUsers > 0) return;
+    if (millis() - sdLastUseMs >= sdIdleReleaseMs) {
+        sdReleaseSession();
+    }
+}
+
+bool sdIsSessionMounted() {
+    return sdSessionActive;
+}
+
+void sdSetIdleReleaseMs(unsigned long idleMs) {
+    sdIdleReleaseMs = idleMs;
+}
+
+unsigned long sdGetIdleReleaseMs() {
+    return sdIdleReleaseMs;
+}
+
+uint32_t sdGetMountCount() {
+    return sdMountCount;
+}
+
+uint32_t sdGetReuseCount() {
+    return sdReuseCount;
 }
 
 // --------------------------------------------------------------------------
 // SD CARD PUBLIC API (uses cached values — no SPI bus needed)
 // --------------------------------------------------------------------------
 
+// Counting free clusters walks the whole FAT, which takes seconds on a
+// large card, so mountSD() only caches the size and leaves the count to
+// sdServiceFreeSpace(). Used space reads as pending until it finishes, or
+// as unknown if the FAT cannot be read.
 bool mountSD() {
-    // Full mount cycle: acquire bus, read info, release bus
+    // Acquire the volume (mounting it if idle-released) and refresh cached info
     if (sdBeginSession()) {
         uint32_t clusterCount = sdFat.clusterCount();
         uint32_t sectorsPerCluster = sdFat.sectorsPerCluster();
-        sdCachedTotal = (uint64_t)clusterCount * sectorsPerCluster * 512ULL;
-        uint32_t freeClusterCount = sdFat.freeClusterCount();
-        uint64_t freeBytes = (uint64_t)freeClusterCount * sectorsPerCluster * 512ULL;
-        sdCachedUsed = sdCachedTotal - freeBytes;
+        sdBytesPerCluster = sectorsPerCluster * 512;
+        sdCachedTotal = (uint64_t)clusterCount * sdBytesPerCluster;
+        sdCachedUsed = 0;
+        sdUsedReady = false;
+        sdFreeScanActive = true;
+        sdFreeScanCluster = 2;  // Entries 0 and 1 are reserved
+        sdFreeScanFree = 0;
+        sdFreeScanAdjust = 0;
+        sdFreeScanRetries = 0;
+        sdUsedFailed = false;
+        sdFreeScanStartMs = millis();
         sdEndSession();
         sdCardDetected = true;
         return true;
@@ -192,14 +263,103 @@ bool mountSD() {
     sdCardDetected = false;
     sdCachedTotal = 0;
     sdCachedUsed = 0;
+    sdUsedReady = false;
+    sdUsedFailed = false;
+    sdFreeScanActive = false;
     return false;
 }
 
 void unmountSD() {
-    sdEndSession();
+    sdReleaseSession();
     sdCardDetected = false;
     sdCachedTotal = 0;
     sdCachedUsed = 0;
+    sdUsedReady = false;
+    sdUsedFailed = false;
+    sdFreeScanActive = false;
+}
+
+static void finishFreeSpaceScan(uint32_t freeClusters) {
+    const int64_t used = (int64_t)sdCachedTotal - (int64_t)freeClusters * sdBytesPerCluster + sdFreeScanAdjust;
+    sdCachedUsed = (uint64_t)max((int64_t)0, min((int64_t)sdCachedTotal, used));
+    sdUsedReady = true;
+    sdFreeScanActive = false;
+    Serial.printf("[HAL] SD free space: %lu clusters free, %llu bytes used (%lu ms)\n",
+                  (unsigned long)freeClusters,
+                  (unsigned long long)sdCachedUsed,
+                  (unsigned long)(millis() - sdFreeScanStartMs));
+}
+
+// Count free FAT entries in a slice of SD_FREE_SCAN_SECTORS_PER_FRAME
+// sectors. FAT12 volumes are tiny and exFAT keeps a one-bit-per-cluster
+// bitmap, so for those the library's own count is quick enough.
+void sdServiceFreeSpace() {
+    if (!sdFreeScanActive) return;
+    if (!sdBeginSession()) return;
+
+    const uint8_t fatType = sdFat.fatType();
+    if (fatType != 16 && fatType != 32) {
+        const int32_t freeClusters = sdFat.freeClusterCount();
+        if (freeClusters >= 0) {
+            finishFreeSpaceScan((uint32_t)freeClusters);
+        } else {
+            sdFreeScanActive = false;
+            sdUsedFailed = true;
+            Serial.println("[HAL] SD free space: count failed");
+        }
+        sdEndSession();
+        return;
+    }
+
+    const uint32_t entryBytes = fatType / 8;
+    const uint32_t entriesPerSector = 512 / entryBytes;
+    const uint32_t lastCluster = sdFat.clusterCount() + 1;
+    uint8_t sector[512];
+    for (int i = 0; i < SD_FREE_SCAN_SECTORS_PER_FRAME && sdFreeScanCluster <= lastCluster; i++) {
+        if (!sdFat.card()->readSector(sdFat.fatStartSector() + sdFreeScanCluster / entriesPerSector, sector)) {
+            // Resume from the same cluster on a later frame; give up after
+            // a few failures in a row rather than stay pending forever.
+            if (++sdFreeScanRetries > SD_FREE_SCAN_MAX_RETRIES) {
+                sdFreeScanActive = false;
+                sdUsedFailed = true;
+                Serial.println("[HAL] SD free space: FAT read failed, used space unknown");
+            } else {
+                Serial.println("[HAL] SD free space: FAT read failed, retrying");
+            }
+            break;
+        }
+        sdFreeScanRetries = 0;
+        for (uint32_t entry = sdFreeScanCluster % entriesPerSector;
+             entry < entriesPerSector && sdFreeScanCluster <= lastCluster; entry++, sdFreeScanCluster++) {
+            const uint8_t* bytes = sector + entry * entryBytes;
+            uint32_t value = (uint32_t)bytes[0] | ((uint32_t)bytes[1] << 8);
+            if (entryBytes == 4) value |= ((uint32_t)bytes[2] << 16) | ((uint32_t)(bytes[3] & 0x0F) << 24);
+            if (value == 0) sdFreeScanFree++;
+        }
+    }
+    if (sdFreeScanActive && sdFreeScanCluster > lastCluster) {
+        finishFreeSpaceScan(sdFreeScanFree);
+    }
+    sdEndSession();
+}
+
+void sdNoteFileResized(uint64_t oldBytes, uint64_t newBytes) {
+    if (!sdCardDetected || sdBytesPerCluster == 0) return;
+    const int64_t oldClusters = (int64_t)((oldBytes + sdBytesPerCluster - 1) / sdBytesPerCluster);
+    const int64_t newClusters = (int64_t)((newBytes + sdBytesPerCluster - 1) / sdBytesPerCluster);
+    const int64_t delta = (newClusters - oldClusters) * sdBytesPerCluster;
+    if (sdUsedReady) {
+        const int64_t used = (int64_t)sdCachedUsed + delta;
+        sdCachedUsed = (uint64_t)max((int64_t)0, min((int64_t)sdCachedTotal, used));
+    } else if (sdFreeScanActive) {
+        // Applied when the scan finishes. Clusters in the part already
+        // counted are right; ones the scan still reaches count twice.
+        sdFreeScanAdjust += delta;
+    }
+}
+
+String sdSaveTempPath(const String& path) {
+    return path + ".~t9save";
 }
 
 bool isSDMounted() {
@@ -214,6 +374,14 @@ uint64_t sdUsedBytes() {
     return sdCachedUsed;
 }
 
+bool sdIsUsedBytesReady() {
+    return sdUsedReady;
+}
+
+bool sdIsUsedBytesUnknown() {
+    return sdUsedFailed;
+}
+
 // --------------------------------------------------------------------------
 // MATRIX SCANNING LOGIC
 // --------------------------------------------------------------------------
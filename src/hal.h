@@ -31,15 +31,31 @@ extern int systemBrightness;  // Global backlight brightness (0-255)
 // SD card uses HW SPI (FSPI) on dedicated pins GPIO 35/36/37.
 // LCD is on separate GPIO 33/34 — no bus conflict.
 // Uses SdFat library (Arduino SD library's ESP-IDF driver fails on S2).
-bool sdBeginSession();    // Acquire HW SPI + mount SD.
-void sdEndSession();      // Release HW SPI bus.
+bool sdBeginSession();    // Acquire SD; mounts only if not already mounted.
+void sdEndSession();      // End a session; volume stays mounted until idle.
+void sdReleaseSession();  // Unmount + release HW SPI bus now (sleep, remount).
+void sdServiceSession();  // Call every frame: releases after the idle period.
+bool sdIsSessionMounted();                 // Volume currently mounted
+void sdSetIdleReleaseMs(unsigned long idleMs);
+unsigned long sdGetIdleReleaseMs();
+uint32_t sdGetMountCount();  // Full card inits since boot
+uint32_t sdGetReuseCount();  // Sessions served without a new mount
 
 // Public API (cached values — no SPI bus needed)
-bool mountSD();           // Full cycle: acquire, cache info, release. Returns success.
-void unmountSD();         // Clear cached state + release if active
+bool mountSD();           // Acquire, cache size, start the free-space scan. Returns success.
+void unmountSD();         // Clear cached state + release the volume
 bool isSDMounted();       // Card was detected (cached, no SPI needed)
 uint64_t sdTotalBytes();  // Cached total SD card space (0 if not detected)
-uint64_t sdUsedBytes();   // Cached used SD card space (0 if not detected)
+uint64_t sdUsedBytes();   // Cached used SD card space (0 if not detected or pending)
+bool sdIsUsedBytesReady();  // False while the free-space scan is still running
+bool sdIsUsedBytesUnknown();  // Free-space scan gave up after failed FAT reads
+void sdServiceFreeSpace();  // Call every frame: counts a slice of the FAT
+// Account for a file written or deleted (newBytes 0) since the scan, rounded
+// to whole clusters, so the cached used space follows our own writes.
+void sdNoteFileResized(uint64_t oldBytes, uint64_t newBytes);
+// Sibling file an atomic save writes before swapping it in over path. The
+// marker suffix keeps it clear of user files such as "notes.txt.tmp".
+String sdSaveTempPath(const String& path);
 
 // SdFat filesystem access (only valid between sdBeginSession/sdEndSession)
 extern SdFat sdFat;
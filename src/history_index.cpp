@@ -0,0 +1,338 @@
+// PROJECT: ESP32-S2-Mini handheld terminal
+// MODULE: src/history_index.cpp
+// STATUS: [Level 2 - Implementation]
+// TRUTH_LINK: TACTICAL_TODO TASK_2
+// LOG_REF: 2026-10-16
+// Description: Sorted path-hash index of T9 editor history documents.
+
+#include "history_index.h"
+#include "hal.h"
+#include <algorithm>
+
+// File layout: [IndexFileHeader][fence: uint32 per page][page][page]...
+// A page holds kEntriesPerPage entries sorted by (pathHash, pathCheck); only
+// the last page may be partly filled.
+
+struct IndexFileHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t count;
+    uint32_t pageCount;
+    uint32_t checksum;     // FNV-1a over this header (checksum = 0) and the fence
+};
+
+static const uint32_t kIndexMagic = 0x49444948UL;    // "HIDI"
+static const uint32_t kIndexVersion = 1;
+static const uint32_t kEntriesPerPage = 8;
+static const size_t kPageBytes = kEntriesPerPage * sizeof(HistoryIndex::Entry);
+
+static uint32_t fnv1aUpdate(uint32_t hash, const void* data, size_t length) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < length; i++) {
+        hash ^= bytes[i];
+        hash *= 16777619UL;
+    }
+    return hash;
+}
+
+static uint32_t headerChecksum(IndexFileHeader header, const uint32_t* fence) {
+    header.checksum = 0;
+    uint32_t hash = fnv1aUpdate(2166136261UL, &header, sizeof(header));
+    return fnv1aUpdate(hash, fence, sizeof(uint32_t) * header.pageCount);
+}
+
+static size_t pageOffset(uint32_t pageCount, uint32_t page) {
+    return sizeof(IndexFileHeader) + sizeof(uint32_t) * pageCount + kPageBytes * page;
+}
+
+static bool entryLess(const HistoryIndex::Entry& a, const HistoryIndex::Entry& b) {
+    if (a.pathHash != b.pathHash) return a.pathHash < b.pathHash;
+    return a.pathCheck < b.pathCheck;
+}
+
+static bool sameKey(const HistoryIndex::Entry& a, const HistoryIndex::Entry& b) {
+    return a.pathHash == b.pathHash && a.pathCheck == b.pathCheck;
+}
+
+// Streams sorted entries into a new index file, page by page, and writes the
+// header and fence once the page count is final.
+class IndexWriter {
+public:
+    IndexWriter(FsFile& file, uint32_t totalCount)
+        : file(file), pageCount((totalCount + kEntriesPerPage - 1) / kEntriesPerPage),
+          fence(pageCount, 0), written(0), pending(0), ok(true) {}
+
+    void add(const HistoryIndex::Entry& entry) {
+        if (pending == 0) fence[written / kEntriesPerPage] = entry.pathHash;
+        page[pending++] = entry;
+        written++;
+        if (pending == kEntriesPerPage) flushPage();
+    }
+
+    bool finish(String& error) {
+        if (pending > 0) flushPage();
+        IndexFileHeader header;
+        header.magic = kIndexMagic;
+        header.version = kIndexVersion;
+        header.count = written;
+        header.pageCount = pageCount;
+        header.checksum = 0;
+        header.checksum = headerChecksum(header, fence.data());
+        ok = ok && written <= pageCount * kEntriesPerPage && file.seekSet(0) &&
+             file.write(reinterpret_cast<const uint8_t*>(&header), sizeof(header)) == sizeof(header) &&
+             (pageCount == 0 ||
+              file.write(reinterpret_cast<const uint8_t*>(fence.data()), sizeof(uint32_t) * pageCount) ==
+                  sizeof(uint32_t) * pageCount) &&
+             file.sync();
+        if (!ok) error = "Failed to write history index";
+        return ok;
+    }
+
+    const std::vector<uint32_t>& getFence() const { return fence; }
+    uint32_t getWritten() const { return written; }
+
+private:
+    void flushPage() {
+        const uint32_t pageIndex = (written - 1) / kEntriesPerPage;
+        const size_t bytes = sizeof(HistoryIndex::Entry) * pending;
+        ok = ok && pageIndex < pageCount && file.seekSet(pageOffset(pageCount, pageIndex)) &&
+             file.write(reinterpret_cast<const uint8_t*>(page), bytes) == bytes;
+        pending = 0;
+    }
+
+    FsFile& file;
+    uint32_t pageCount;
+    std::vector<uint32_t> fence;
+    HistoryIndex::Entry page[kEntriesPerPage];
+    uint32_t written;
+    uint32_t pending;
+    bool ok;
+};
+
+HistoryIndex::HistoryIndex(const char* indexPath)
+    : indexPath(indexPath), loaded(false), available(false), count(0), pageCount(0),
+      fence(nullptr), loadedMount(0), pageReads(0) {}
+
+HistoryIndex::~HistoryIndex() {
+    invalidate();
+}
+
+void HistoryIndex::invalidate() {
+    free(fence);
+    fence = nullptr;
+    loaded = false;
+    available = false;
+    count = 0;
+    pageCount = 0;
+}
+
+bool HistoryIndex::makeEntry(const String& path, const String& documentId, Entry& entry) {
+    memset(&entry, 0, sizeof(entry));
+    if (documentId.length() >= sizeof(entry.documentId)) return false;
+
+    // 64-bit FNV-1a split in two: the high half orders the index, the low
+    // half tells colliding paths apart.
+    uint64_t hash = 14695981039346656037ULL;
+    for (unsigned int i = 0; i < path.length(); i++) {
+        hash ^= static_cast<uint8_t>(path[i]);
+        hash *= 1099511628211ULL;
+    }
+    entry.pathHash = static_cast<uint32_t>(hash >> 32);
+    entry.pathCheck = static_cast<uint32_t>(hash);
+    memcpy(entry.documentId, documentId.c_str(), documentId.length());
+    return true;
+}
+
+// ============================================================================
+// LOADING
+// ============================================================================
+
+bool HistoryIndex::load() {
+    if (loaded && loadedMount != sdGetMountCount()) invalidate();
+    if (loaded) return available;
+    loaded = true;
+    loadedMount = sdGetMountCount();
+    available = false;
+
+    // A rewrite that lost power between remove and rename leaves only the
+    // new file; an earlier interruption leaves a stale one.
+    const String tempPath = indexPath + ".tmp";
+    if (sdFat.exists(tempPath.c_str())) {
+        if (!sdFat.exists(indexPath.c_str())) {
+            sdFat.rename(tempPath.c_str(), indexPath.c_str());
+        } else {
+            sdFat.remove(tempPath.c_str());
+        }
+    }
+
+    FsFile file;
+    if (!file.open(indexPath.c_str(), O_RDONLY)) return false;
+    IndexFileHeader header;
+    if (file.read(&header, sizeof(header)) != sizeof(header) ||
+        header.magic != kIndexMagic || header.version != kIndexVersion ||
+        header.pageCount != (header.count + kEntriesPerPage - 1) / kEntriesPerPage ||
+        file.size() < pageOffset(header.pageCount, 0) + sizeof(Entry) * header.count) {
+        return false;
+    }
+
+    uint32_t* loadedFence = static_cast<uint32_t*>(malloc(sizeof(uint32_t) * (header.pageCount + 1)));
+    if (loadedFence == nullptr) return false;
+    const size_t fenceBytes = sizeof(uint32_t) * header.pageCount;
+    if (static_cast<size_t>(file.read(loadedFence, fenceBytes)) != fenceBytes ||
+        headerChecksum(header, loadedFence) != header.checksum) {
+        free(loadedFence);
+        return false;
+    }
+
+    fence = loadedFence;
+    count = header.count;
+    pageCount = header.pageCount;
+    available = true;
+    return true;
+}
+
+bool HistoryIndex::isAvailable() {
+    return load();
+}
+
+bool HistoryIndex::readPage(FsFile& file, uint32_t page, Entry* entries, uint32_t& entryCount) const {
+    entryCount = count - page * kEntriesPerPage;
+    if (entryCount > kEntriesPerPage) entryCount = kEntriesPerPage;
+    const size_t bytes = sizeof(Entry) * entryCount;
+    return file.seekSet(pageOffset(pageCount, page)) &&
+           static_cast<size_t>(file.read(entries, bytes)) == bytes;
+}
+
+// ============================================================================
+// LOOKUP
+// ============================================================================
+
+bool HistoryIndex::find(const String& path, String& documentId) {
+    Entry key;
+    makeEntry(path, "", key);
+    if (!load() || count == 0) return false;
+
+    // The first entry with this hash is on the page before the first page
+    // that starts at or after it (or on that page, if it starts with it).
+    uint32_t page = static_cast<uint32_t>(std::lower_bound(fence, fence + pageCount, key.pathHash) - fence);
+    if (page > 0) page--;
+
+    FsFile file;
+    if (!file.open(indexPath.c_str(), O_RDONLY)) return false;
+    Entry entries[kEntriesPerPage];
+    for (; page < pageCount && fence[page] <= key.pathHash; page++) {
+        uint32_t entryCount = 0;
+        pageReads++;
+        if (!readPage(file, page, entries, entryCount)) return false;
+        for (uint32_t i = 0; i < entryCount; i++) {
+            if (sameKey(entries[i], key)) {
+                entries[i].documentId[sizeof(entries[i].documentId) - 1] = '\0';
+                documentId = entries[i].documentId;
+                return true;
+            }
+            if (entryLess(key, entries[i])) return false;
+        }
+    }
+    return false;
+}
+
+// ============================================================================
+// UPDATES
+// ============================================================================
+
+bool HistoryIndex::replaceWithTemp(const String& tempPath, String& error) {
+    if ((sdFat.exists(indexPath.c_str()) && !sdFat.remove(indexPath.c_str())) ||
+        !sdFat.rename(tempPath.c_str(), indexPath.c_str())) {
+        error = "Failed to replace history index";
+        return false;
+    }
+    return true;
+}
+
+bool HistoryIndex::insert(const String& path, const String& documentId, String& error) {
+    Entry added;
+    if (!makeEntry(path, documentId, added)) {
+        error = "History id too long for index";
+        return false;
+    }
+    String existingId;
+    const bool replacing = find(path, existingId);
+    if (replacing && existingId == documentId) {
+        error = "";
+        return true;
+    }
+
+    const String tempPath = indexPath + ".tmp";
+    FsFile target;
+    if (!target.open(tempPath.c_str(), O_RDWR | O_CREAT | O_TRUNC)) {
+        error = String("Failed to create history index: ") + tempPath;
+        return false;
+    }
+
+    // Merge the new entry into the old pages on the fly.
+    IndexWriter writer(target, count + (replacing ? 0 : 1));
+    bool addedWritten = false;
+    if (available && count > 0) {
+        FsFile source;
+        if (!source.open(indexPath.c_str(), O_RDONLY)) {
+            error = "Failed to read history index";
+            return false;
+        }
+        Entry entries[kEntriesPerPage];
+        for (uint32_t page = 0; page < pageCount; page++) {
+            uint32_t entryCount = 0;
+            if (!readPage(source, page, entries, entryCount)) {
+                error = "Failed to read history index";
+                return false;
+            }
+            for (uint32_t i = 0; i < entryCount; i++) {
+                if (!addedWritten && !entryLess(entries[i], added)) {
+                    writer.add(added);
+                    addedWritten = true;
+                }
+                if (!sameKey(entries[i], added)) writer.add(entries[i]);
+            }
+        }
+    }
+    if (!addedWritten) writer.add(added);
+    if (!writer.finish(error)) return false;
+    target.close();
+
+    if (!replaceWithTemp(tempPath, error)) return false;
+
+    // Adopt the new fence without reading the file back.
+    invalidate();
+    const std::vector<uint32_t>& newFence = writer.getFence();
+    fence = static_cast<uint32_t*>(malloc(sizeof(uint32_t) * (newFence.size() + 1)));
+    if (fence != nullptr) {
+        if (!newFence.empty()) memcpy(fence, newFence.data(), sizeof(uint32_t) * newFence.size());
+        count = writer.getWritten();
+        pageCount = static_cast<uint32_t>(newFence.size());
+        loaded = true;
+        loadedMount = sdGetMountCount();
+        available = true;
+    }
+    error = "";
+    return true;
+}
+
+bool HistoryIndex::rebuild(std::vector<Entry>& entries, String& error) {
+    std::sort(entries.begin(), entries.end(), entryLess);
+    entries.erase(std::unique(entries.begin(), entries.end(), sameKey), entries.end());
+
+    const String tempPath = indexPath + ".tmp";
+    FsFile target;
+    if (!target.open(tempPath.c_str(), O_RDWR | O_CREAT | O_TRUNC)) {
+        error = String("Failed to create history index: ") + tempPath;
+        return false;
+    }
+    IndexWriter writer(target, static_cast<uint32_t>(entries.size()));
+    for (const Entry& entry : entries) writer.add(entry);
+    if (!writer.finish(error)) return false;
+    target.close();
+
+    if (!replaceWithTemp(tempPath, error)) return false;
+    invalidate();
+    error = "";
+    return true;
+}
@@ -0,0 +1,74 @@
+// PROJECT: ESP32-S2-Mini handheld terminal
+// MODULE: src/history_index.h
+// STATUS: [Level 2 - Implementation]
+// TRUTH_LINK: TACTICAL_TODO TASK_2
+// LOG_REF: 2026-10-16
+// Description: Sorted path-hash index of T9 editor history documents.
+//              Maps a document path to its directory under the history
+//              root. Entries are stored in 512-byte pages sorted by hash,
+//              behind a small fence table (first hash of each page) that
+//              stays cached in RAM, so a lookup reads a single page.
+
+#ifndef HISTORY_INDEX_H
+#define HISTORY_INDEX_H
+
+#include <Arduino.h>
+#include <SdFat.h>
+#include <vector>
+
+// All methods that touch the file expect the caller to hold an SD session.
+class HistoryIndex {
+public:
+    // One indexed document: path hash, a second hash to reject collisions
+    // and the NUL-terminated history directory name.
+    struct Entry {
+        uint32_t pathHash;
+        uint32_t pathCheck;
+        char documentId[56];
+    };
+
+    explicit HistoryIndex(const char* indexPath);
+    ~HistoryIndex();
+    HistoryIndex(const HistoryIndex& other) = delete;
+    HistoryIndex& operator=(const HistoryIndex& other) = delete;
+
+    // False if the index file is missing or unreadable; the caller should
+    // rebuild it from the manifests.
+    bool isAvailable();
+
+    // Look up the history directory of path. False if it is not indexed.
+    bool find(const String& path, String& documentId);
+
+    // Add or update one document. Rewrites the index into a temp file and
+    // swaps it in, so a power cut leaves either the old or the new index.
+    bool insert(const String& path, const String& documentId, String& error);
+
+    // Replace the whole index, e.g. after scanning the manifests.
+    bool rebuild(std::vector<Entry>& entries, String& error);
+
+    // Build an entry for path. False if documentId does not fit.
+    static bool makeEntry(const String& path, const String& documentId, Entry& entry);
+
+    // Drop the cached fence table. Also happens on its own after any new
+    // card init, since the card may have been swapped while released.
+    void invalidate();
+
+    uint32_t getCount() const { return count; }
+    uint32_t getPageReads() const { return pageReads; }
+
+private:
+    String indexPath;
+    bool loaded;
+    bool available;
+    uint32_t count;
+    uint32_t pageCount;
+    uint32_t* fence;       // First hash of each page
+    uint32_t loadedMount;  // sdGetMountCount() when the fence was cached
+    uint32_t pageReads;    // Pages read by find(), for diagnostics
+
+    bool load();
+    bool readPage(FsFile& file, uint32_t page, Entry* entries, uint32_t& entryCount) const;
+    bool replaceWithTemp(const String& tempPath, String& error);
+};
+
+#endif
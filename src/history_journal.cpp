@@ -0,0 +1,566 @@
+// PROJECT: ESP32-S2-Mini handheld terminal
+// MODULE: src/history_journal.cpp
+// STATUS: [Level 2 - Implementation]
+// TRUTH_LINK: TACTICAL_TODO TASK_2
+// LOG_REF: 2026-10-16
+// Description: Append-only snapshot journal for the T9 editor history.
+
+#include "history_journal.h"
+#include "hal.h"
+
+// File layout:
+//   [FileHeader][record][record]...[index: uint32 per snapshot] ... [Trailer]
+// The file is pre-allocated and grown in steps, so the trailer sits at the
+// end of the file and points at the index just past the last record. An
+// append overwrites the old index with the new record, then writes a new
+// index and trailer. If power is lost in between, the trailer checksum no
+// longer matches and open() replays the records instead.
+
+struct JournalFileHeader {
+    uint32_t magic;
+    uint32_t version;
+};
+
+static const uint32_t kJournalMagic = 0x4A483954UL;     // "T9HJ"
+static const uint32_t kJournalVersion = 1;
+static const uint32_t kRecordMagic = 0x43455248UL;      // "HREC"
+static const uint32_t kTrailerMagic = 0x58444948UL;     // "HIDX"
+static const uint32_t kRecordCheckpoint = 1;
+static const uint32_t kRecordDelta = 2;
+static const uint32_t kCheckpointFlag = 0x80000000UL;
+static const size_t kJournalInitialBytes = 16 * 1024;
+static const size_t kJournalGrowBytes = 16 * 1024;
+static const size_t kJournalMaxBytes = 128 * 1024;      // Soft cap; compaction keeps the newest half
+static const int kCheckpointInterval = 16;
+static const size_t kCopyChunkBytes = 256;
+
+static uint32_t crc32Update(uint32_t crc, const void* data, size_t length) {
+    static const uint32_t kTable[16] = {
+        0x00000000UL, 0x1DB71064UL, 0x3B6E20C8UL, 0x26D930ACUL,
+        0x76DC4190UL, 0x6B6B51F4UL, 0x4DB26158UL, 0x5005713CUL,
+        0xEDB88320UL, 0xF00F9344UL, 0xD6D6A3E8UL, 0xCB61B38CUL,
+        0x9B64C2B0UL, 0x86D3D2D4UL, 0xA00AE278UL, 0xBDBDF21CUL};
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    crc = ~crc;
+    for (size_t i = 0; i < length; i++) {
+        crc = kTable[(crc ^ bytes[i]) & 0x0F] ^ (crc >> 4);
+        crc = kTable[(crc ^ (bytes[i] >> 4)) & 0x0F] ^ (crc >> 4);
+    }
+    return ~crc;
+}
+
+static bool readAt(FsFile& file, size_t offset, void* out, size_t length) {
+    if (!file.seekSet(offset)) return false;
+    return static_cast<size_t>(file.read(out, length)) == length;
+}
+
+static bool writeAt(FsFile& file, size_t offset, const void* data, size_t length) {
+    if (!file.seekSet(offset)) return false;
+    return file.write(static_cast<const uint8_t*>(data), length) == length;
+}
+
+HistoryJournal::HistoryJournal()
+    : offsets(nullptr), indexCapacity(0), firstId(1), count(0), dataEnd(0),
+      fileSize(0), latestLength(0), lastAppendBytes(0) {}
+
+HistoryJournal::~HistoryJournal() {
+    close();
+}
+
+void HistoryJournal::close() {
+    free(offsets);
+    offsets = nullptr;
+    indexCapacity = 0;
+    journalPath = "";
+    firstId = 1;
+    count = 0;
+    dataEnd = 0;
+    fileSize = 0;
+    latestLength = 0;
+    lastAppendBytes = 0;
+}
+
+size_t HistoryJournal::recordOffset(int index) const {
+    return offsets[index] & ~kCheckpointFlag;
+}
+
+bool HistoryJournal::isCheckpoint(int index) const {
+    return (offsets[index] & kCheckpointFlag) != 0;
+}
+
+bool HistoryJournal::reserveIndex(int entries) {
+    if (entries <= indexCapacity) return true;
+    int grown = indexCapacity + indexCapacity / 2;
+    if (grown < 32) grown = 32;
+    if (grown < entries) grown = entries;
+    uint32_t* resized = static_cast<uint32_t*>(realloc(offsets, sizeof(uint32_t) * grown));
+    if (resized == nullptr) return false;
+    offsets = resized;
+    indexCapacity = grown;
+    return true;
+}
+
+// ============================================================================
+// FILE STRUCTURE
+// ============================================================================
+
+// SdFat cannot seek past the end of a file, so growth writes zeros.
+bool HistoryJournal::ensureFileSize(FsFile& file, size_t needed, String& error) {
+    if (needed <= fileSize) return true;
+    size_t target = fileSize + kJournalGrowBytes;
+    while (target < needed) target += kJournalGrowBytes;
+
+    uint8_t zeros[kCopyChunkBytes];
+    memset(zeros, 0, sizeof(zeros));
+    if (!file.seekSet(fileSize)) {
+        error = "Failed to seek history journal";
+        return false;
+    }
+    for (size_t pos = fileSize; pos < target; pos += sizeof(zeros)) {
+        const size_t chunk = (target - pos) < sizeof(zeros) ? (target - pos) : sizeof(zeros);
+        if (file.write(zeros, chunk) != chunk) {
+            error = "Failed to grow history journal";
+            return false;
+        }
+    }
+    fileSize = target;
+    return true;
+}
+
+bool HistoryJournal::writeFooter(FsFile& file, String& error) {
+    const size_t indexBytes = sizeof(uint32_t) * count;
+    if (!ensureFileSize(file, dataEnd + indexBytes + sizeof(Trailer), error)) return false;
+
+    Trailer trailer;
+    trailer.magic = kTrailerMagic;
+    trailer.firstId = firstId;
+    trailer.count = static_cast<uint32_t>(count);
+    trailer.dataEnd = static_cast<uint32_t>(dataEnd);
+    trailer.crc = 0;
+    trailer.crc = crc32Update(crc32Update(0, offsets, indexBytes), &trailer, sizeof(trailer));
+
+    if ((indexBytes > 0 && !writeAt(file, dataEnd, offsets, indexBytes)) ||
+        !writeAt(file, fileSize - sizeof(Trailer), &trailer, sizeof(trailer)) ||
+        !file.sync()) {
+        error = "Failed to write history index";
+        return false;
+    }
+    return true;
+}
+
+bool HistoryJournal::createFile(const String& path, String& error) {
+    FsFile file;
+    if (!file.open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC)) {
+        error = String("Failed to create history journal: ") + path;
+        return false;
+    }
+
+    // Contiguous clusters keep later appends from walking the FAT.
+    fileSize = 0;
+    if (file.preAllocate(kJournalInitialBytes)) {
+        fileSize = kJournalInitialBytes;
+    } else if (!ensureFileSize(file, kJournalInitialBytes, error)) {
+        return false;
+    }
+
+    const JournalFileHeader header = {kJournalMagic, kJournalVersion};
+    if (!writeAt(file, 0, &header, sizeof(header))) {
+        error = String("Failed to write history journal: ") + path;
+        return false;
+    }
+    firstId = 1;
+    count = 0;
+    dataEnd = sizeof(JournalFileHeader);
+    latestLength = 0;
+    return writeFooter(file, error);
+}
+
+bool HistoryJournal::loadFooter(FsFile& file) {
+    Trailer trailer;
+    if (!readAt(file, fileSize - sizeof(Trailer), &trailer, sizeof(trailer))) return false;
+    if (trailer.magic != kTrailerMagic || trailer.count > fileSize / sizeof(RecordHeader)) return false;
+    const size_t indexBytes = sizeof(uint32_t) * trailer.count;
+    if (trailer.dataEnd < sizeof(JournalFileHeader) ||
+        trailer.dataEnd + indexBytes + sizeof(Trailer) > fileSize) {
+        return false;
+    }
+    if (!reserveIndex(static_cast<int>(trailer.count))) return false;
+    if (indexBytes > 0 && !readAt(file, trailer.dataEnd, offsets, indexBytes)) return false;
+
+    const uint32_t storedCrc = trailer.crc;
+    trailer.crc = 0;
+    if (crc32Update(crc32Update(0, offsets, indexBytes), &trailer, sizeof(trailer)) != storedCrc) {
+        return false;
+    }
+
+    firstId = trailer.firstId;
+    count = static_cast<int>(trailer.count);
+    dataEnd = trailer.dataEnd;
+    latestLength = 0;
+    if (count > 0) {
+        RecordHeader last;
+        if (!readAt(file, recordOffset(count - 1), &last, sizeof(last)) || last.magic != kRecordMagic) {
+            return false;
+        }
+        latestLength = last.textLength;
+    }
+    return true;
+}
+
+// Rebuild the index from the records, stopping at the first one that is
+// torn or does not follow from the one before it.
+bool HistoryJournal::replay(FsFile& file) {
+    firstId = 1;
+    count = 0;
+    dataEnd = sizeof(JournalFileHeader);
+    latestLength = 0;
+    const size_t limit = fileSize - sizeof(Trailer);
+    uint8_t chunk[kCopyChunkBytes];
+
+    while (dataEnd + sizeof(RecordHeader) <= limit) {
+        RecordHeader header;
+        if (!readAt(file, dataEnd, &header, sizeof(header)) || header.magic != kRecordMagic) break;
+        const bool checkpoint = header.type == kRecordCheckpoint;
+        if (count == 0 && !checkpoint) break;
+        if (count > 0 && header.snapshotId != firstId + count) break;
+        if (checkpoint) {
+            if (header.position != 0 || header.insertedLength != header.textLength) break;
+        } else if (header.type != kRecordDelta ||
+                   header.position + header.removedLength > latestLength ||
+                   header.textLength != latestLength - header.removedLength + header.insertedLength) {
+            break;
+        }
+        const size_t end = dataEnd + sizeof(RecordHeader) + header.insertedLength;
+        if (end > limit) break;
+
+        const uint32_t storedCrc = header.crc;
+        header.crc = 0;
+        uint32_t crc = crc32Update(0, &header, sizeof(header));
+        bool readable = true;
+        for (size_t done = 0; readable && done < header.insertedLength; done += sizeof(chunk)) {
+            const size_t part = (header.insertedLength - done) < sizeof(chunk)
+                ? (header.insertedLength - done) : sizeof(chunk);
+            readable = static_cast<size_t>(file.read(chunk, part)) == part;
+            crc = crc32Update(crc, chunk, part);
+        }
+        if (!readable || crc != storedCrc || !reserveIndex(count + 1)) break;
+
+        if (count == 0) firstId = header.snapshotId;
+        offsets[count++] = static_cast<uint32_t>(dataEnd) | (checkpoint ? kCheckpointFlag : 0);
+        latestLength = header.textLength;
+        dataEnd = end;
+    }
+    return true;
+}
+
+bool HistoryJournal::open(const String& path, String& error) {
+    close();
+
+    // A compaction that lost power between remove and rename leaves only
+    // the new file behind; an earlier interruption leaves a stale copy.
+    const String tempPath = path + ".tmp";
+    if (sdFat.exists(tempPath.c_str())) {
+        if (!sdFat.exists(path.c_str())) {
+            sdFat.rename(tempPath.c_str(), path.c_str());
+        } else {
+            sdFat.remove(tempPath.c_str());
+        }
+    }
+
+    if (!sdFat.exists(path.c_str())) {
+        if (!createFile(path, error)) {
+            close();
+            return false;
+        }
+        journalPath = path;
+        error = "";
+        return true;
+    }
+
+    FsFile file;
+    if (!file.open(path.c_str(), O_RDWR)) {
+        error = String("Failed to open history journal: ") + path;
+        return false;
+    }
+    fileSize = static_cast<size_t>(file.size());
+    JournalFileHeader header = {0, 0};
+    if (fileSize < sizeof(JournalFileHeader) + sizeof(Trailer) ||
+        !readAt(file, 0, &header, sizeof(header)) ||
+        header.magic != kJournalMagic || header.version != kJournalVersion) {
+        Serial.printf("[History] Unreadable journal, starting over: %s\n", path.c_str());
+        file.close();
+        sdFat.remove(path.c_str());
+        if (!createFile(path, error)) {
+            close();
+            return false;
+        }
+        journalPath = path;
+        error = "";
+        return true;
+    }
+
+    if (!loadFooter(file)) {
+        replay(file);
+        Serial.printf("[History] Replayed %d snapshots from %s\n", count, path.c_str());
+        if (!writeFooter(file, error)) {
+            close();
+            return false;
+        }
+    }
+    journalPath = path;
+    error = "";
+    return true;
+}
+
+// ============================================================================
+// APPENDING
+// ============================================================================
+
+// A checkpoint is due when replaying back to the last one would touch more
+// than a checkpoint's worth of deltas, or too many of them.
+bool HistoryJournal::isCheckpointDue() const {
+    if (count == 0) return true;
+    int last = count - 1;
+    while (last > 0 && !isCheckpoint(last)) last--;
+    if (count - 1 - last >= kCheckpointInterval) return true;
+    return dataEnd - recordOffset(last) > 2 * (sizeof(RecordHeader) + latestLength);
+}
+
+bool HistoryJournal::appendRecord(const TextBuffer& text, uint32_t type, size_t position,
+                                  size_t removedLength, size_t insertedLength, String& error) {
+    if (!reserveIndex(count + 1)) {
+        error = "Out of memory";
+        return false;
+    }
+
+    FsFile file;
+    if (!file.open(journalPath.c_str(), O_RDWR)) {
+        error = String("Failed to open history journal: ") + journalPath;
+        return false;
+    }
+    const size_t recordBytes = sizeof(RecordHeader) + insertedLength;
+    const size_t footerBytes = sizeof(uint32_t) * (count + 1) + sizeof(Trailer);
+    if (!ensureFileSize(file, dataEnd + recordBytes + footerBytes, error)) return false;
+
+    RecordHeader header;
+    header.magic = kRecordMagic;
+    header.snapshotId = getNextId();
+    header.position = static_cast<uint32_t>(position);
+    header.removedLength = static_cast<uint32_t>(removedLength);
+    header.insertedLength = static_cast<uint32_t>(insertedLength);
+    header.textLength = static_cast<uint32_t>(text.length());
+    header.type = type;
+    header.crc = 0;
+    uint32_t crc = crc32Update(0, &header, sizeof(header));
+
+    // Payload first, header last: a torn record never carries a valid header.
+    if (!file.seekSet(dataEnd + sizeof(RecordHeader))) {
+        error = "Failed to seek history journal";
+        return false;
+    }
+    char chunk[kCopyChunkBytes];
+    for (size_t done = 0; done < insertedLength; done += sizeof(chunk)) {
+        const size_t part = (insertedLength - done) < sizeof(chunk) ? (insertedLength - done) : sizeof(chunk);
+        text.copyRange(position + done, part, chunk);
+        crc = crc32Update(crc, chunk, part);
+        if (file.write(reinterpret_cast<const uint8_t*>(chunk), part) != part) {
+            error = "Failed to write history journal";
+            return false;
+        }
+    }
+    header.crc = crc;
+    // The footer's sync covers the record too: SdFat writes sectors back in
+    // the order they were written, so the trailer still lands last.
+    if (!writeAt(file, dataEnd, &header, sizeof(header))) {
+        error = "Failed to write history journal";
+        return false;
+    }
+
+    offsets[count++] = static_cast<uint32_t>(dataEnd) | (type == kRecordCheckpoint ? kCheckpointFlag : 0);
+    dataEnd += recordBytes;
+    latestLength = text.length();
+    lastAppendBytes = recordBytes;
+    return writeFooter(file, error);
+}
+
+bool HistoryJournal::appendEdit(const TextBuffer& text, size_t position, size_t removedLength,
+                                size_t insertedLength, uint32_t& snapshotId, String& error) {
+    snapshotId = getLatestId();
+    if (!isOpen()) {
+        error = "History journal is not open";
+        return false;
+    }
+    if (count > 0 && (position + removedLength > latestLength ||
+                      position + insertedLength > text.length() ||
+                      latestLength - removedLength + insertedLength != text.length())) {
+        error = "History journal out of sync";
+        return false;
+    }
+
+    bool checkpoint = isCheckpointDue();
+    const size_t recordBytes = sizeof(RecordHeader) + (checkpoint ? text.length() : insertedLength);
+    if (count > 1 && dataEnd + recordBytes > kJournalMaxBytes) {
+        if (!compact(error)) return false;
+        checkpoint = isCheckpointDue();
+    }
+
+    const bool written = checkpoint
+        ? appendRecord(text, kRecordCheckpoint, 0, 0, text.length(), error)
+        : appendRecord(text, kRecordDelta, position, removedLength, insertedLength, error);
+    if (!written) return false;
+    snapshotId = getLatestId();
+    error = "";
+    return true;
+}
+
+bool HistoryJournal::appendText(const TextBuffer& text, uint32_t& snapshotId, bool& changed, String& error) {
+    changed = false;
+    snapshotId = getLatestId();
+    if (count == 0) {
+        changed = true;
+        return appendEdit(text, 0, 0, text.length(), snapshotId, error);
+    }
+
+    TextBuffer latest;
+    if (!readSnapshot(getLatestId(), latest, error)) return false;
+    const size_t prefix = text.commonPrefixLength(latest);
+    if (prefix == text.length() && prefix == latest.length()) {
+        error = "";
+        return true;
+    }
+    const size_t shorter = text.length() < latest.length() ? text.length() : latest.length();
+    const size_t suffix = text.commonSuffixLength(latest, shorter - prefix);
+    changed = true;
+    return appendEdit(text, prefix, latest.length() - prefix - suffix,
+                      text.length() - prefix - suffix, snapshotId, error);
+}
+
+// Rewrite the journal from the middle snapshot onwards: a checkpoint of it
+// followed by the later records copied as-is. The old file is replaced only
+// once the new one is complete.
+bool HistoryJournal::compact(String& error) {
+    const int keep = count / 2;
+    TextBuffer keptText;
+    if (!readSnapshot(firstId + keep, keptText, error)) return false;
+
+    HistoryJournal compacted;
+    const String tempPath = journalPath + ".tmp";
+    if (!compacted.createFile(tempPath, error)) return false;
+    compacted.journalPath = tempPath;
+    compacted.firstId = firstId + keep;
+    if (!compacted.appendRecord(keptText, kRecordCheckpoint, 0, 0, keptText.length(), error)) {
+        return false;
+    }
+
+    {
+        FsFile source;
+        FsFile target;
+        if (!source.open(journalPath.c_str(), O_RDONLY) || !target.open(tempPath.c_str(), O_RDWR)) {
+            error = "Failed to open history journal";
+            return false;
+        }
+        const size_t copyStart = (keep + 1 < count) ? recordOffset(keep + 1) : dataEnd;
+        const size_t copyBytes = dataEnd - copyStart;
+        const int copiedCount = count - keep - 1;
+        if (!compacted.reserveIndex(compacted.count + copiedCount)) {
+            error = "Out of memory";
+            return false;
+        }
+        if (!compacted.ensureFileSize(target, compacted.dataEnd + copyBytes +
+                                      sizeof(uint32_t) * (compacted.count + copiedCount) +
+                                      sizeof(Trailer), error)) {
+            return false;
+        }
+
+        char chunk[kCopyChunkBytes];
+        if (!source.seekSet(copyStart) || !target.seekSet(compacted.dataEnd)) {
+            error = "Failed to seek history journal";
+            return false;
+        }
+        for (size_t done = 0; done < copyBytes; done += sizeof(chunk)) {
+            const size_t part = (copyBytes - done) < sizeof(chunk) ? (copyBytes - done) : sizeof(chunk);
+            if (static_cast<size_t>(source.read(chunk, part)) != part ||
+                target.write(reinterpret_cast<const uint8_t*>(chunk), part) != part) {
+                error = "Failed to copy history journal";
+                return false;
+            }
+        }
+
+        for (int i = keep + 1; i < count; i++) {
+            const uint32_t moved = static_cast<uint32_t>(recordOffset(i) - copyStart + compacted.dataEnd);
+            compacted.offsets[compacted.count++] = moved | (offsets[i] & kCheckpointFlag);
+        }
+        compacted.dataEnd += copyBytes;
+        compacted.latestLength = latestLength;
+        if (!compacted.writeFooter(target, error)) return false;
+    }
+
+    if (!sdFat.remove(journalPath.c_str()) || !sdFat.rename(tempPath.c_str(), journalPath.c_str())) {
+        error = "Failed to replace history journal";
+        return false;
+    }
+    Serial.printf("[History] Compacted %s: kept %d of %d snapshots\n",
+                  journalPath.c_str(), compacted.count, count);
+
+    uint32_t* ownOffsets = offsets;
+    offsets = compacted.offsets;
+    compacted.offsets = ownOffsets;
+    const int ownCapacity = indexCapacity;
+    indexCapacity = compacted.indexCapacity;
+    compacted.indexCapacity = ownCapacity;
+    firstId = compacted.firstId;
+    count = compacted.count;
+    dataEnd = compacted.dataEnd;
+    fileSize = compacted.fileSize;
+    return true;
+}
+
+// ============================================================================
+// READING
+// ============================================================================
+
+bool HistoryJournal::readSnapshot(uint32_t snapshotId, TextBuffer& out, String& error) const {
+    if (count == 0 || snapshotId < firstId || snapshotId > getLatestId()) {
+        error = "Snapshot is not in history";
+        return false;
+    }
+    const int target = static_cast<int>(snapshotId - firstId);
+    int index = target;
+    while (index > 0 && !isCheckpoint(index)) index--;
+
+    FsFile file;
+    if (!file.open(journalPath.c_str(), O_RDONLY)) {
+        error = String("Failed to open history journal: ") + journalPath;
+        return false;
+    }
+
+    char chunk[kCopyChunkBytes];
+    for (; index <= target; index++) {
+        RecordHeader header;
+        if (!readAt(file, recordOffset(index), &header, sizeof(header)) ||
+            header.magic != kRecordMagic || header.snapshotId != firstId + index) {
+            error = "Corrupt history journal record";
+            return false;
+        }
+        if (header.type == kRecordCheckpoint) out.clear();
+        if (!out.reserve(header.textLength)) {
+            error = "Out of memory";
+            return false;
+        }
+        out.erase(header.position, header.removedLength);
+
+        size_t position = header.position;
+        for (size_t done = 0; done < header.insertedLength; done += sizeof(chunk)) {
+            const size_t part = (header.insertedLength - done) < sizeof(chunk)
+                ? (header.insertedLength - done) : sizeof(chunk);
+            if (static_cast<size_t>(file.read(chunk, part)) != part) {
+                error = "Failed to read history journal";
+                return false;
+            }
+            out.insert(position, chunk, part);
+            position += part;
+        }
+    }
+    error = "";
+    return true;
+}
@@ -0,0 +1,103 @@
+// PROJECT: ESP32-S2-Mini handheld terminal
+// MODULE: src/history_journal.h
+// STATUS: [Level 2 - Implementation]
+// TRUTH_LINK: TACTICAL_TODO TASK_2
+// LOG_REF: 2026-10-16
+// Description: Append-only snapshot journal for the T9 editor history.
+//              One pre-allocated file per document holds a full checkpoint
+//              followed by single-range deltas, with a checkpoint every few
+//              snapshots. A footer index locates every snapshot; after a
+//              crash the index is rebuilt by replaying the checksummed
+//              records.
+
+#ifndef HISTORY_JOURNAL_H
+#define HISTORY_JOURNAL_H
+
+#include <Arduino.h>
+#include <SdFat.h>
+#include "text_buffer.h"
+
+// All methods that touch the file expect the caller to hold an SD session.
+class HistoryJournal {
+public:
+    HistoryJournal();
+    ~HistoryJournal();
+    HistoryJournal(const HistoryJournal& other) = delete;
+    HistoryJournal& operator=(const HistoryJournal& other) = delete;
+
+    // Open the journal at path, creating it if missing. A stale footer
+    // (power lost mid-append) is repaired by replaying the records; a torn
+    // last record is dropped.
+    bool open(const String& path, String& error);
+    void close();
+    bool isOpen() const { return journalPath.length() > 0; }
+
+    // Snapshot ids are consecutive. Compaction drops the oldest ones, so the
+    // first id grows over time. Latest is 0 while the journal is empty.
+    uint32_t getFirstId() const { return firstId; }
+    uint32_t getLatestId() const { return count > 0 ? firstId + count - 1 : 0; }
+    uint32_t getNextId() const { return firstId + count; }
+    size_t getLatestLength() const { return latestLength; }
+    size_t getDataBytes() const { return dataEnd; }
+    size_t getLastAppendBytes() const { return lastAppendBytes; }
+
+    // Append text as a new snapshot that equals the latest one with
+    // [position, position + removedLength) replaced by
+    // text[position, position + insertedLength). Writes a full checkpoint
+    // instead when one is due. Fails if the lengths do not match the
+    // latest snapshot.
+    bool appendEdit(const TextBuffer& text, size_t position, size_t removedLength,
+                    size_t insertedLength, uint32_t& snapshotId, String& error);
+
+    // Append text as a new snapshot, diffing it against the latest one.
+    // changed is false, and nothing is written, if they are equal.
+    bool appendText(const TextBuffer& text, uint32_t& snapshotId, bool& changed, String& error);
+
+    // Rebuild a snapshot from its checkpoint and the deltas after it.
+    bool readSnapshot(uint32_t snapshotId, TextBuffer& out, String& error) const;
+
+private:
+    struct RecordHeader {
+        uint32_t magic;
+        uint32_t snapshotId;
+        uint32_t position;
+        uint32_t removedLength;
+        uint32_t insertedLength;   // Payload bytes
+        uint32_t textLength;       // Document length after this record
+        uint32_t type;
+        uint32_t crc;              // Header (crc = 0) and payload
+    };
+
+    struct Trailer {
+        uint32_t magic;
+        uint32_t firstId;
+        uint32_t count;
+        uint32_t dataEnd;          // Footer index starts here
+        uint32_t crc;              // Index entries and the fields above
+    };
+
+    String journalPath;
+    uint32_t* offsets;     // Record offset per snapshot; top bit = checkpoint
+    int indexCapacity;
+    uint32_t firstId;
+    int count;
+    size_t dataEnd;        // End of the last record
+    size_t fileSize;       // Pre-allocated size; the trailer ends the file
+    size_t latestLength;
+    size_t lastAppendBytes;
+
+    bool createFile(const String& path, String& error);
+    bool loadFooter(FsFile& file);
+    bool replay(FsFile& file);
+    bool writeFooter(FsFile& file, String& error);
+    bool reserveIndex(int entries);
+    bool ensureFileSize(FsFile& file, size_t needed, String& error);
+    bool isCheckpointDue() const;
+    bool appendRecord(const TextBuffer& text, uint32_t type, size_t position, size_t removedLength,
+                      size_t insertedLength, String& error);
+    bool compact(String& error);
+    size_t recordOffset(int index) const;
+    bool isCheckpoint(int index) const;
+};
+
+#endif
@@ -37,7 +37,8 @@ CUSTOM MODULE: gfx
 - gfx.clear()
  Clear the display buffer.
 - gfx.send()
- Send the current buffer to the LCD.
+ Send the current buffer to the LCD. Only tiles that changed since the
+ last send are transferred.
 - gfx.pixel(x, y)
 - gfx.line(x1, y1, x2, y2)
 - gfx.rect(x, y, w, h)
@@ -45,6 +46,13 @@ CUSTOM MODULE: gfx
 - gfx.circle(x, y, r)
 - gfx.fillCircle(x, y, r)
 - gfx.text(x, y, str)
+- gfx.bitmap(x, y, w, h, data)
+ Draw a packed 1bpp bitmap string (XBM layout: rows padded to whole bytes,
+ least significant bit = leftmost pixel). Set bits use the current color.
+- gfx.compileBitmap(rows)
+ Pack an array of text rows into a gfx.bitmap() string.
+ Spaces are empty pixels, any other character is lit.
+ Returns data, width, height. Compile once and reuse the result.
 - gfx.setFont(size)
  Accepts nil for the current system font, or "tiny", "small", or "medium".
  Also accepts legacy numeric aliases: 0=small, 1=medium, 2=medium, 3=tiny.
@@ -64,6 +72,29 @@ Example:
  gfx.rect(0, 12, 40, 10)
  gfx.send()
 
+CUSTOM MODULE: gfx3d
+====================
+Native fixed-point 3D pipeline (rotation, projection, backface culling,
+wireframe and dithered flat fill). Build meshes once, draw them every frame.
+- gfx3d.mesh(vertices, faces)
+ vertices = {{x, y, z}, ...}, faces = {{a, b, c}, ...} with 1-based vertex
+ indices. Front faces are the ones render3d.lua winds counter-clockwise.
+ Up to 512 vertices and 512 faces. Returns a mesh userdata.
+- gfx3d.setView(cx, cy, scale, perspective, culling)
+ Screen center, focal length (perspective) or pixels per unit (orthographic).
+ perspective and culling default to true.
+- mesh:draw(x, y, z, rx, ry, rz, mode)
+ Rotate about Y, X, then Z (radians), move to x/y/z in camera space
+ (+z is into the screen), project and draw in the current color.
+ mode is gfx3d.WIREFRAME (default), gfx3d.FILL, or their sum.
+ Returns the number of faces drawn.
+- mesh:vertexCount() / mesh:faceCount()
+
+Example:
+ local cube = gfx3d.mesh(verts, faces)
+ gfx3d.setView(64, 37, 90)
+ cube:draw(0, 0, 4, 0, angle, 0)
+
 CUSTOM MODULE: input
 ====================
 - input.pressed(key)
@@ -108,6 +139,11 @@ CUSTOM MODULE: sys
  Returns a table with:
  heap_total, heap_free, heap_min_free, heap_max_alloc,
  psram_found, psram_total, psram_free, psram_min_free, psram_max_alloc.
+- sys.displayStats()
+ Returns a table with:
+ frames_sent, frames_skipped, tiles_sent, bytes_sent.
+ frames_skipped counts gfx.send() calls whose frame was identical to the
+ previous one, so no LCD transfer happened.
 - print(...)
  Global serial print helper.
 
@@ -127,6 +163,16 @@ CUSTOM MODULE: fs
  Returns file contents or nil, err.
 - fs.write(path, content)
  Writes a full text file. Returns true or nil, err.
+- fs.readAsync(path), fs.writeAsync(path, content),
+ fs.appendAsync(path, content), fs.listAsync(path), fs.statAsync(path)
+ Queue the request and return a handle (or nil, err). The queue moves a
+ few KB per frame, so large files never stall _update. It holds 8
+ requests until fs.poll collects them; more return nil, "SD queue full".
+- fs.poll(handle)
+ Returns false, percent while queued. Then returns the result once:
+ read: contents; write/append: true; list: entries with the same
+ fields as fs.list; stat: {is_dir, size}; or nil, err. The handle is
+ then released.
 
 Example:
  local entries, err = fs.list("/")
@@ -138,6 +184,16 @@ Example:
   end
  end
 
+ -- In _init: pending = fs.readAsync("/notes.txt")
+ -- In _update:
+ if pending then
+  local text, err = fs.poll(pending)
+  if text ~= false then
+   pending = nil
+   notes = text or err
+  end
+ end
+
 CUSTOM MODULE: ui
 =================
 - ui.header(title, rightText)
@@ -155,7 +211,7 @@ CUSTOM MODULE: ui
  Open an SD text file in the native RO viewer.
 - ui.editFile(path, label)
  Open an SD text file in the native RW editor.
- Files above the RW cap are rejected.
+ Large files are edited a window at a time.
 - ui.takeEditorResult()
  After a Lua-owned RW edit session returns, this gives a table with:
  action, save, path, label, source_kind, content
@@ -286,38 +286,69 @@ local function sort_entries(entries)
     end)
 end
 
-local function draw_icon(icon, tile_x, tile_y)
+-- Compiled icon bitmaps, keyed weakly by descriptor. Each entry remembers the
+-- icon box it was cropped for so a font change recompiles it once.
+local icon_cache = setmetatable({}, { __mode = "k" })
+
+local function compile_icon(icon, box_w, box_h)
+    local normalized = normalize_icon(icon)
+    if not normalized then
+        return { box_w = box_w, box_h = box_h, invalid = true }
+    end
+
+    local src_w = normalized.width
+    local src_h = normalized.height
+    local target_w = math.min(box_w, src_w)
+    local target_h = math.min(box_h, src_h)
+    local start_x = math.floor((src_w - target_w) / 2)
+    local start_y = math.floor((src_h - target_h) / 2)
+    if target_w < 1 or target_h < 1 then
+        return { box_w = box_w, box_h = box_h, invalid = true }
+    end
+
+    local rows = {}
+    for y = 1, target_h do
+        local row = icon[start_y + y]
+        row = row .. string.rep(" ", src_w - #row)
+        rows[y] = row:sub(start_x + 1, start_x + target_w)
+    end
+
+    local data, width, height = gfx.compileBitmap(rows)
+    return {
+        box_w = box_w,
+        box_h = box_h,
+        data = data,
+        width = width,
+        height = height,
+        offset_x = math.floor((box_w - width) / 2),
+        offset_y = math.floor((box_h - height) / 2)
+    }
+end
+
+local function draw_icon(descriptor, tile_x, tile_y)
     local layout = ui.metrics()
     local tile_w = math.floor(layout.screen_width / GRID_COLS)
     local tile_h = math.floor(layout.content_height / GRID_ROWS)
     local tile_pad_x = layout.font == "tiny" and 2 or 3
     local icon_box_w = tile_w - (tile_pad_x * 2)
     local icon_box_h = tile_h - layout.box_height - 1
-    local normalized = normalize_icon(icon)
-    if not normalized then
+
+    local compiled = icon_cache[descriptor]
+    if not compiled or compiled.box_w ~= icon_box_w or compiled.box_h ~= icon_box_h then
+        compiled = compile_icon(descriptor.icon, icon_box_w, icon_box_h)
+        icon_cache[descriptor] = compiled
+    end
+
+    if compiled.invalid then
         draw_fallback_icon(tile_x, tile_y)
         return
     end
 
-    local src_w = normalized.width
-    local src_h = normalized.height
-    local pixels = normalized.pixels
-
-    local target_w = math.min(icon_box_w, src_w)
-    local target_h = math.min(icon_box_h, src_h)
-    local start_x = math.floor((src_w - target_w) / 2)
-    local start_y = math.floor((src_h - target_h) / 2)
-    local draw_x = tile_x + tile_pad_x + math.floor((icon_box_w - target_w) / 2)
-    local draw_y = tile_y + math.floor((icon_box_h - target_h) / 2)
-
-    for y = 0, target_h - 1 do
-        for x = 0, target_w - 1 do
-            local pixel = pixels[(start_y + y) * src_w + (start_x + x) + 1]
-            if pixel == 1 or pixel == true then
-                gfx.pixel(draw_x + x, draw_y + y)
-            end
-        end
-    end
+    gfx.bitmap(tile_x + tile_pad_x + compiled.offset_x,
+        tile_y + compiled.offset_y,
+        compiled.width,
+        compiled.height,
+        compiled.data)
 end
 
 local function centered_label_x(tile_x, text)
@@ -846,13 +877,13 @@ local function draw_desktop_tile(descriptor, x, y, selected)
     if selected then
         gfx.fillRect(x + 1, y, tile_w - 2, tile_h)
         gfx.setColor(0)
-        draw_icon(descriptor.icon, x, y)
+        draw_icon(descriptor, x, y)
         gfx.fillRect(x + tile_pad_x, label_box_y, label_box_w, layout.box_height)
         gfx.setColor(1)
     else
         gfx.rect(x + 1, y, tile_w - 2, tile_h)
         gfx.setColor(1)
-        draw_icon(descriptor.icon, x, y)
+        draw_icon(descriptor, x, y)
     end
 
     gfx.setFont(layout.font)
@@ -1269,8 +1300,6 @@ function file_browser:open_selected()
     if not ok then
         if err == "SD not mounted" then
             self:show_message("No SD card mounted")
-        elseif err == "File too large for RW" then
-            self:show_message("File too large for RW")
         else
             self:show_toast(err or "Open failed", 2000)
         end
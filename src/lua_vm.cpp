@@ -9,6 +9,9 @@
 #include "config.h"
 #include "clock.h"
 #include "gui.h"
+#include "display.h"
+#include "gfx3d.h"
+#include "sd_io_queue.h"
 #include "app_control.h"
 #include "app_transfer.h"
 #include "apps/t9_editor.h"
@@ -29,6 +32,7 @@ static lua_State* L = nullptr;
 static String lastError = "";
 static int luaCurrentFontSize = GUI::FONT_SIZE_SMALL;
 static bool luaUsesSystemFont = true;
+static int luaDrawColor = 1;   // Last gfx.setColor(), reused by gfx3d rasterization
 
 static void applyLuaCurrentFont() {
     GUI::setFontBySize(luaUsesSystemFont ? GUI::getSystemFontSize() : luaCurrentFontSize);
@@ -87,6 +91,9 @@ static bool hasPendingLuaEditorResult() {
            appTransferPath.length() > 0;
 }
 
+// Largest file fs.read() and fs.readAsync() load into a Lua string
+static const size_t kLuaReadMaxBytes = 262144;
+
 static bool readSdTextFile(const String& path, String& content, String& error) {
     if (!isSDMounted()) {
         error = "SD not mounted";
@@ -109,7 +116,7 @@ static bool readSdTextFile(const String& path, String& content, String& error) {
     }
 
     uint64_t fileSize = file.size();
-    if (fileSize > 262144ULL) {
+    if (fileSize > kLuaReadMaxBytes) {
         error = String("File too large for Lua read: ") + path;
         return false;
     }
@@ -189,6 +196,11 @@ static bool writeSdTextFile(const String& path, const String& content, String& e
         Serial.println("[LuaVM] Save failed: could not open SD session");
         return false;
     }
+    uint64_t previousSize = 0;
+    if (file.open(path.c_str(), O_RDONLY)) {
+        previousSize = file.isDir() ? 0 : file.size();
+        file.close();
+    }
     if (!file.open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC)) {
         error = String("Failed to open file for write: ") + path +
                 String(" (code=0x") + String(sdFat.sdErrorCode(), HEX) +
@@ -217,6 +229,7 @@ static bool writeSdTextFile(const String& path, const String& content, String& e
         Serial.println(String("[LuaVM] ") + error);
         return false;
     }
+    sdNoteFileResized(previousSize, contentLength);
 
     error = "";
     Serial.printf("[LuaVM] Saved %u bytes to %s\n",
@@ -301,15 +314,22 @@ static String formatFatFullDateTime(uint16_t fatDate, uint16_t fatTime) {
 // LUA BINDINGS - Display Functions
 // --------------------------------------------------------------------------
 
+// Conservative bounding box for text drawn at baseline y: anything from x to
+// the right edge, one max glyph height above and below the baseline.
+static void markTextDirty(int x, int y) {
+    const int glyphHeight = u8g2.getMaxCharHeight();
+    Display::markDirty(x, y - glyphHeight, GUI::SCREEN_WIDTH - x, glyphHeight * 2);
+}
+
 // gfx.clear() - Clear the display buffer
 static int lua_gfx_clear(lua_State* L) {
-    u8g2.clearBuffer();
+    Display::clear();
     return 0;
 }
 
-// gfx.send() - Send buffer to display
+// gfx.send() - Send changed tiles to display
 static int lua_gfx_send(lua_State* L) {
-    u8g2.sendBuffer();
+    Display::flush();
     return 0;
 }
 
@@ -317,6 +337,7 @@ static int lua_gfx_send(lua_State* L) {
 static int lua_gfx_pixel(lua_State* L) {
     int x = luaL_checkinteger(L, 1);
     int y = luaL_checkinteger(L, 2);
+    Display::markDirty(x, y, 1, 1);
     u8g2.drawPixel(x, y);
     return 0;
 }
@@ -327,6 +348,7 @@ static int lua_gfx_line(lua_State* L) {
     int y1 = luaL_checkinteger(L, 2);
     int x2 = luaL_checkinteger(L, 3);
     int y2 = luaL_checkinteger(L, 4);
+    Display::markDirty(min(x1, x2), min(y1, y2), abs(x2 - x1) + 1, abs(y2 - y1) + 1);
     u8g2.drawLine(x1, y1, x2, y2);
     return 0;
 }
@@ -337,6 +359,7 @@ static int lua_gfx_rect(lua_State* L) {
     int y = luaL_checkinteger(L, 2);
     int w = luaL_checkinteger(L, 3);
     int h = luaL_checkinteger(L, 4);
+    Display::markDirty(x, y, w, h);
     u8g2.drawFrame(x, y, w, h);
     return 0;
 }
@@ -347,6 +370,7 @@ static int lua_gfx_fillRect(lua_State* L) {
     int y = luaL_checkinteger(L, 2);
     int w = luaL_checkinteger(L, 3);
     int h = luaL_checkinteger(L, 4);
+    Display::markDirty(x, y, w, h);
     u8g2.drawBox(x, y, w, h);
     return 0;
 }
@@ -356,6 +380,7 @@ static int lua_gfx_circle(lua_State* L) {
     int x = luaL_checkinteger(L, 1);
     int y = luaL_checkinteger(L, 2);
     int r = luaL_checkinteger(L, 3);
+    Display::markDirty(x - r, y - r, (r * 2) + 1, (r * 2) + 1);
     u8g2.drawCircle(x, y, r);
     return 0;
 }
@@ -365,6 +390,7 @@ static int lua_gfx_fillCircle(lua_State* L) {
     int x = luaL_checkinteger(L, 1);
     int y = luaL_checkinteger(L, 2);
     int r = luaL_checkinteger(L, 3);
+    Display::markDirty(x - r, y - r, (r * 2) + 1, (r * 2) + 1);
     u8g2.drawDisc(x, y, r);
     return 0;
 }
@@ -374,10 +400,76 @@ static int lua_gfx_text(lua_State* L) {
     int x = luaL_checkinteger(L, 1);
     int y = luaL_checkinteger(L, 2);
     const char* str = luaL_checkstring(L, 3);
-    u8g2.drawStr(x, y, str);
+    markTextDirty(x, y);
+    GUI::drawText(x, y, str);
+    return 0;
+}
+
+// gfx.bitmap(x, y, w, h, data) - Draw a packed 1bpp XBM bitmap (LSB = leftmost
+// pixel, rows padded to whole bytes). Only set bits are drawn, in the current color.
+static int lua_gfx_bitmap(lua_State* L) {
+    int x = luaL_checkinteger(L, 1);
+    int y = luaL_checkinteger(L, 2);
+    int w = luaL_checkinteger(L, 3);
+    int h = luaL_checkinteger(L, 4);
+    size_t dataLength = 0;
+    const char* data = luaL_checklstring(L, 5, &dataLength);
+    luaL_argcheck(L, w > 0 && w <= 255, 3, "width out of range");
+    luaL_argcheck(L, h > 0 && h <= 255, 4, "height out of range");
+
+    const size_t rowBytes = static_cast<size_t>((w + 7) / 8);
+    luaL_argcheck(L, dataLength >= rowBytes * static_cast<size_t>(h), 5, "bitmap data too short");
+
+    Display::markDirty(x, y, w, h);
+    u8g2.drawXBM(x, y, w, h, reinterpret_cast<const uint8_t*>(data));
     return 0;
 }
 
+// gfx.compileBitmap(rows) - Pack text rows (space = empty, anything else = lit)
+// into a gfx.bitmap() string. Returns data, width, height.
+static int lua_gfx_compileBitmap(lua_State* L) {
+    luaL_checktype(L, 1, LUA_TTABLE);
+    const int height = static_cast<int>(lua_rawlen(L, 1));
+    luaL_argcheck(L, height > 0 && height <= 255, 1, "expected 1-255 rows");
+
+    size_t width = 0;
+    for (int row = 1; row <= height; row++) {
+        lua_rawgeti(L, 1, row);
+        size_t rowLength = 0;
+        if (lua_type(L, -1) != LUA_TSTRING) {
+            return luaL_argerror(L, 1, "rows must be strings");
+        }
+        lua_tolstring(L, -1, &rowLength);
+        lua_pop(L, 1);
+        if (rowLength > width) width = rowLength;
+    }
+    luaL_argcheck(L, width > 0 && width <= 255, 1, "row width out of range");
+
+    const size_t rowBytes = (width + 7) / 8;
+    const size_t totalBytes = rowBytes * static_cast<size_t>(height);
+    luaL_Buffer packed;
+    uint8_t* out = reinterpret_cast<uint8_t*>(luaL_buffinitsize(L, &packed, totalBytes));
+    memset(out, 0, totalBytes);
+
+    for (int row = 0; row < height; row++) {
+        lua_rawgeti(L, 1, row + 1);
+        size_t rowLength = 0;
+        const char* text = lua_tolstring(L, -1, &rowLength);
+        uint8_t* rowOut = out + (static_cast<size_t>(row) * rowBytes);
+        for (size_t col = 0; col < rowLength; col++) {
+            if (text[col] != ' ') {
+                rowOut[col >> 3] |= static_cast<uint8_t>(1U << (col & 7));
+            }
+        }
+        lua_pop(L, 1);
+    }
+
+    luaL_pushresultsize(&packed, totalBytes);
+    lua_pushinteger(L, static_cast<lua_Integer>(width));
+    lua_pushinteger(L, height);
+    return 3;
+}
+
 static int parseLuaFontSize(lua_State* L, int index) {
     if (lua_isnoneornil(L, index)) {
         return GUI::getSystemFontSize();
@@ -422,13 +514,14 @@ static int lua_gfx_setFont(lua_State* L) {
 // gfx.textWidth(str) - Measure text width in current font
 static int lua_gfx_textWidth(lua_State* L) {
     const char* str = luaL_checkstring(L, 1);
-    lua_pushinteger(L, u8g2.getUTF8Width(str));
+    lua_pushinteger(L, GUI::getTextWidth(str));
     return 1;
 }
 
 // gfx.setColor(color) - Set draw color (0=black, 1=white)
 static int lua_gfx_setColor(lua_State* L) {
     int color = luaL_checkinteger(L, 1);
+    luaDrawColor = color;
     u8g2.setDrawColor(color);
     return 0;
 }
@@ -457,6 +550,8 @@ static void registerGfxModule(lua_State* L) {
         {"circle", lua_gfx_circle},
         {"fillCircle", lua_gfx_fillCircle},
         {"text", lua_gfx_text},
+        {"bitmap", lua_gfx_bitmap},
+        {"compileBitmap", lua_gfx_compileBitmap},
         {"setFont", lua_gfx_setFont},
         {"textWidth", lua_gfx_textWidth},
         {"setColor", lua_gfx_setColor},
@@ -481,6 +576,152 @@ static void registerGfxModule(lua_State* L) {
     lua_setglobal(L, "gfx");
 }
 
+// --------------------------------------------------------------------------
+// LUA BINDINGS - 3D Functions
+// --------------------------------------------------------------------------
+
+static const char* const GFX3D_MESH_METATABLE = "gfx3d.mesh";
+
+static Gfx3D::View luaView = {
+    GUI::SCREEN_WIDTH / 2,
+    GUI::SCREEN_HEIGHT / 2,
+    90 * Gfx3D::FIXED_ONE,
+    true,
+    true
+};
+
+static Gfx3D::Mesh* checkLuaMesh(lua_State* L, int index) {
+    return static_cast<Gfx3D::Mesh*>(luaL_checkudata(L, index, GFX3D_MESH_METATABLE));
+}
+
+// Read element `slot` (1-based) of the table on top of the stack as a number.
+static bool readLuaNumberAt(lua_State* L, int slot, lua_Number* out) {
+    lua_rawgeti(L, -1, slot);
+    int isNumber = 0;
+    *out = lua_tonumberx(L, -1, &isNumber);
+    lua_pop(L, 1);
+    return isNumber != 0;
+}
+
+// gfx3d.mesh(vertices, faces) - Build a mesh from {{x, y, z}, ...} and
+// {{a, b, c}, ...} (1-based vertex indices, counter-clockwise from outside).
+static int lua_gfx3d_mesh(lua_State* L) {
+    luaL_checktype(L, 1, LUA_TTABLE);
+    luaL_checktype(L, 2, LUA_TTABLE);
+    const int vertexCount = static_cast<int>(lua_rawlen(L, 1));
+    const int faceCount = static_cast<int>(lua_rawlen(L, 2));
+    luaL_argcheck(L, vertexCount >= 3 && vertexCount <= Gfx3D::MAX_VERTICES, 1, "vertex count out of range");
+    luaL_argcheck(L, faceCount >= 1 && faceCount <= Gfx3D::MAX_FACES, 2, "face count out of range");
+
+    void* block = lua_newuserdatauv(L, Gfx3D::meshBytes(vertexCount, faceCount), 0);
+    Gfx3D::Mesh* mesh = Gfx3D::initMesh(block, vertexCount, faceCount);
+    luaL_setmetatable(L, GFX3D_MESH_METATABLE);
+
+    for (int i = 0; i < vertexCount; i++) {
+        lua_rawgeti(L, 1, i + 1);
+        lua_Number coords[3];
+        const bool valid = lua_istable(L, -1)
+            && readLuaNumberAt(L, 1, &coords[0])
+            && readLuaNumberAt(L, 2, &coords[1])
+            && readLuaNumberAt(L, 3, &coords[2]);
+        lua_pop(L, 1);
+        if (!valid) {
+            return luaL_error(L, "gfx3d.mesh: vertex %d must be {x, y, z}", i + 1);
+        }
+        mesh->vertices[i] = {Gfx3D::toFixed(coords[0]), Gfx3D::toFixed(coords[1]), Gfx3D::toFixed(coords[2])};
+    }
+
+    for (int i = 0; i < faceCount; i++) {
+        lua_rawgeti(L, 2, i + 1);
+        lua_Number corners[3];
+        const bool valid = lua_istable(L, -1)
+            && readLuaNumberAt(L, 1, &corners[0])
+            && readLuaNumberAt(L, 2, &corners[1])
+            && readLuaNumberAt(L, 3, &corners[2]);
+        lua_pop(L, 1);
+        uint16_t index[3] = {0, 0, 0};
+        bool inRange = valid;
+        for (int c = 0; inRange && c < 3; c++) {
+            const lua_Integer corner = static_cast<lua_Integer>(corners[c]);
+            inRange = corner >= 1 && corner <= vertexCount;
+            index[c] = static_cast<uint16_t>(corner - 1);
+        }
+        if (!inRange) {
+            return luaL_error(L, "gfx3d.mesh: face %d must be {a, b, c} with indices 1..%d", i + 1, vertexCount);
+        }
+        mesh->faces[i] = {index[0], index[1], index[2]};
+    }
+    return 1;
+}
+
+// gfx3d.setView(cx, cy, scale [, perspective [, culling]]) - Screen center,
+// focal length (or pixels per unit in orthographic mode) and pipeline switches.
+static int lua_gfx3d_setView(lua_State* L) {
+    luaView.centerX = luaL_checkinteger(L, 1);
+    luaView.centerY = luaL_checkinteger(L, 2);
+    luaView.scale = Gfx3D::toFixed(luaL_checknumber(L, 3));
+    luaView.perspective = lua_isnoneornil(L, 4) ? true : lua_toboolean(L, 4);
+    luaView.culling = lua_isnoneornil(L, 5) ? true : lua_toboolean(L, 5);
+    return 0;
+}
+
+// mesh:draw(x, y, z, rx, ry, rz [, mode]) - Rotate (Y, X, then Z; radians),
+// translate, project and rasterize. Returns the number of faces drawn.
+static int lua_gfx3d_meshDraw(lua_State* L) {
+    Gfx3D::Mesh* mesh = checkLuaMesh(L, 1);
+    Gfx3D::Transform transform;
+    transform.position.x = Gfx3D::toFixed(luaL_checknumber(L, 2));
+    transform.position.y = Gfx3D::toFixed(luaL_checknumber(L, 3));
+    transform.position.z = Gfx3D::toFixed(luaL_checknumber(L, 4));
+    transform.angleX = Gfx3D::angleFromRadians(luaL_optnumber(L, 5, 0));
+    transform.angleY = Gfx3D::angleFromRadians(luaL_optnumber(L, 6, 0));
+    transform.angleZ = Gfx3D::angleFromRadians(luaL_optnumber(L, 7, 0));
+    const lua_Integer mode = luaL_optinteger(L, 8, Gfx3D::MODE_WIREFRAME);
+    luaL_argcheck(L, mode > 0 && mode <= (Gfx3D::MODE_WIREFRAME | Gfx3D::MODE_FILL), 8, "bad draw mode");
+
+    lua_pushinteger(L, Gfx3D::drawMesh(*mesh, transform, luaView, static_cast<uint8_t>(mode), luaDrawColor));
+    return 1;
+}
+
+// mesh:vertexCount()
+static int lua_gfx3d_meshVertexCount(lua_State* L) {
+    lua_pushinteger(L, checkLuaMesh(L, 1)->vertexCount);
+    return 1;
+}
+
+// mesh:faceCount()
+static int lua_gfx3d_meshFaceCount(lua_State* L) {
+    lua_pushinteger(L, checkLuaMesh(L, 1)->faceCount);
+    return 1;
+}
+
+// Register the gfx3d module and the mesh userdata metatable
+static void registerGfx3dModule(lua_State* L) {
+    static const luaL_Reg mesh_methods[] = {
+        {"draw", lua_gfx3d_meshDraw},
+        {"vertexCount", lua_gfx3d_meshVertexCount},
+        {"faceCount", lua_gfx3d_meshFaceCount},
+        {NULL, NULL}
+    };
+    static const luaL_Reg gfx3d_funcs[] = {
+        {"mesh", lua_gfx3d_mesh},
+        {"setView", lua_gfx3d_setView},
+        {NULL, NULL}
+    };
+
+    luaL_newmetatable(L, GFX3D_MESH_METATABLE);
+    luaL_newlib(L, mesh_methods);
+    lua_setfield(L, -2, "__index");
+    lua_pop(L, 1);
+
+    luaL_newlib(L, gfx3d_funcs);
+    lua_pushinteger(L, Gfx3D::MODE_WIREFRAME);
+    lua_setfield(L, -2, "WIREFRAME");
+    lua_pushinteger(L, Gfx3D::MODE_FILL);
+    lua_setfield(L, -2, "FILL");
+    lua_setglobal(L, "gfx3d");
+}
+
 // --------------------------------------------------------------------------
 // LUA BINDINGS - Input Functions
 // --------------------------------------------------------------------------
@@ -641,6 +882,26 @@ static int lua_sys_memInfo(lua_State* L) {
     return 1;
 }
 
+// sys.displayStats() - Get LCD flush counters as a table
+static int lua_sys_displayStats(lua_State* L) {
+    const Display::FlushStats& stats = Display::getStats();
+    lua_newtable(L);
+
+    lua_pushinteger(L, stats.framesSent);
+    lua_setfield(L, -2, "frames_sent");
+
+    lua_pushinteger(L, stats.framesSkipped);
+    lua_setfield(L, -2, "frames_skipped");
+
+    lua_pushinteger(L, stats.tilesSent);
+    lua_setfield(L, -2, "tiles_sent");
+
+    lua_pushinteger(L, stats.bytesSent);
+    lua_setfield(L, -2, "bytes_sent");
+
+    return 1;
+}
+
 // print(str) - Print to serial
 static int lua_print(lua_State* L) {
     int n = lua_gettop(L);
@@ -676,6 +937,7 @@ static void registerSysModule(lua_State* L) {
         {"timeStr", lua_sys_timeStr},
         {"version", lua_sys_version},
         {"memInfo", lua_sys_memInfo},
+        {"displayStats", lua_sys_displayStats},
         {"openSettings", lua_sys_openSettings},
         {NULL, NULL}
     };
@@ -692,6 +954,45 @@ static void registerSysModule(lua_State* L) {
 // LUA BINDINGS - SD Filesystem Functions
 // --------------------------------------------------------------------------
 
+// One fs.list()/fs.listAsync() row: {name, path, is_dir, size, modified...}
+static void pushFsListEntry(lua_State* L, const String& dirPath, const char* name, bool isDir,
+                            uint64_t size, bool hasModified, uint16_t fatDate, uint16_t fatTime) {
+    lua_newtable(L);
+
+    lua_pushstring(L, name);
+    lua_setfield(L, -2, "name");
+
+    String childPath = dirPath;
+    if (childPath != "/") {
+        childPath += "/";
+    }
+    childPath += name;
+    lua_pushlstring(L, childPath.c_str(), childPath.length());
+    lua_setfield(L, -2, "path");
+
+    lua_pushboolean(L, isDir);
+    lua_setfield(L, -2, "is_dir");
+
+    lua_pushinteger(L, static_cast<lua_Integer>(size));
+    lua_setfield(L, -2, "size");
+
+    const String modified = hasModified ? formatFatDate(fatDate) : "";
+    const String modifiedTime = hasModified ? formatFatTime(fatTime) : "";
+    const String modifiedShort = hasModified ? formatFatCompactDateTime(fatDate, fatTime) : "";
+    const String modifiedFull = hasModified ? formatFatFullDateTime(fatDate, fatTime) : "";
+    lua_pushlstring(L, modified.c_str(), modified.length());
+    lua_setfield(L, -2, "modified");
+
+    lua_pushlstring(L, modifiedTime.c_str(), modifiedTime.length());
+    lua_setfield(L, -2, "modified_time");
+
+    lua_pushlstring(L, modifiedShort.c_str(), modifiedShort.length());
+    lua_setfield(L, -2, "modified_short");
+
+    lua_pushlstring(L, modifiedFull.c_str(), modifiedFull.length());
+    lua_setfield(L, -2, "modified_full");
+}
+
 // fs.list(path) - Return array of {name, path, is_dir, size, modified}
 static int lua_fs_list(lua_State* L) {
     String path = normalizeFsPath(luaL_optstring(L, 1, "/"));
@@ -717,46 +1018,11 @@ static int lua_fs_list(lua_State* L) {
     while (entry.openNext(&dir, O_RDONLY)) {
         size_t nameLen = entry.getName(name, sizeof(name));
         if (nameLen > 0 && strcmp(name, ".") != 0 && strcmp(name, "..") != 0) {
-            lua_newtable(L);
-
-            lua_pushstring(L, name);
-            lua_setfield(L, -2, "name");
-
-            String childPath = path;
-            if (childPath != "/") {
-                childPath += "/";
-            }
-            childPath += name;
-            lua_pushlstring(L, childPath.c_str(), childPath.length());
-            lua_setfield(L, -2, "path");
-
-            bool isDir = entry.isDir();
-            lua_pushboolean(L, isDir);
-            lua_setfield(L, -2, "is_dir");
-
-            uint64_t entrySize = isDir ? 0 : entry.size();
-            lua_pushinteger(L, static_cast<lua_Integer>(entrySize));
-            lua_setfield(L, -2, "size");
-
             uint16_t fatDate = 0;
             uint16_t fatTime = 0;
             const bool hasModified = entry.getModifyDateTime(&fatDate, &fatTime);
-            const String modified = hasModified ? formatFatDate(fatDate) : "";
-            const String modifiedTime = hasModified ? formatFatTime(fatTime) : "";
-            const String modifiedShort = hasModified ? formatFatCompactDateTime(fatDate, fatTime) : "";
-            const String modifiedFull = hasModified ? formatFatFullDateTime(fatDate, fatTime) : "";
-            lua_pushlstring(L, modified.c_str(), modified.length());
-            lua_setfield(L, -2, "modified");
-
-            lua_pushlstring(L, modifiedTime.c_str(), modifiedTime.length());
-            lua_setfield(L, -2, "modified_time");
-
-            lua_pushlstring(L, modifiedShort.c_str(), modifiedShort.length());
-            lua_setfield(L, -2, "modified_short");
-
-            lua_pushlstring(L, modifiedFull.c_str(), modifiedFull.length());
-            lua_setfield(L, -2, "modified_full");
-
+            const bool isDir = entry.isDir();
+            pushFsListEntry(L, path, name, isDir, isDir ? 0 : entry.size(), hasModified, fatDate, fatTime);
             lua_rawseti(L, -2, index++);
         }
         entry.close();
@@ -797,11 +1063,120 @@ static int lua_fs_write(lua_State* L) {
     return 1;
 }
 
+// Handles submitted from Lua and not yet reported done by fs.poll(); they
+// are dropped with the VM so a script that never polls leaks nothing.
+static std::vector<int> luaIoHandles;
+
+static int pushLuaIoHandle(lua_State* L, int handle, const String& error) {
+    if (handle < 0) {
+        return pushLuaResultError(L, error);
+    }
+    luaIoHandles.push_back(handle);
+    lua_pushinteger(L, handle);
+    return 1;
+}
+
+static void forgetLuaIoHandle(int handle) {
+    for (size_t i = 0; i < luaIoHandles.size(); i++) {
+        if (luaIoHandles[i] == handle) {
+            luaIoHandles.erase(luaIoHandles.begin() + static_cast<long>(i));
+            return;
+        }
+    }
+}
+
+// fs.readAsync(path) - Queue a whole-file read; returns a handle for fs.poll
+static int lua_fs_readAsync(lua_State* L) {
+    String path = normalizeFsPath(luaL_checkstring(L, 1));
+    String error;
+    return pushLuaIoHandle(L, sdIoQueue.submitRead(path, kLuaReadMaxBytes, error), error);
+}
+
+// fs.writeAsync(path, content) - Queue a whole-file write
+static int lua_fs_writeAsync(lua_State* L) {
+    String path = normalizeFsPath(luaL_checkstring(L, 1));
+    size_t contentLength = 0;
+    const char* content = luaL_checklstring(L, 2, &contentLength);
+    String error;
+    return pushLuaIoHandle(L, sdIoQueue.submitWrite(path, content, contentLength, error), error);
+}
+
+// fs.appendAsync(path, content) - Queue an append, creating the file
+static int lua_fs_appendAsync(lua_State* L) {
+    String path = normalizeFsPath(luaL_checkstring(L, 1));
+    size_t contentLength = 0;
+    const char* content = luaL_checklstring(L, 2, &contentLength);
+    String error;
+    return pushLuaIoHandle(L, sdIoQueue.submitAppend(path, content, contentLength, error), error);
+}
+
+// fs.listAsync(path) - Queue a directory listing
+static int lua_fs_listAsync(lua_State* L) {
+    String path = normalizeFsPath(luaL_optstring(L, 1, "/"));
+    String error;
+    return pushLuaIoHandle(L, sdIoQueue.submitList(path, error), error);
+}
+
+// fs.statAsync(path) - Queue a size/type lookup
+static int lua_fs_statAsync(lua_State* L) {
+    String path = normalizeFsPath(luaL_checkstring(L, 1));
+    String error;
+    return pushLuaIoHandle(L, sdIoQueue.submitStat(path, error), error);
+}
+
+// fs.poll(handle) - false, percent while queued; then the result (or nil,
+// err) exactly once, after which the handle is released.
+static int lua_fs_poll(lua_State* L) {
+    const int handle = static_cast<int>(luaL_checkinteger(L, 1));
+    const SdIoQueue::Request* request = sdIoQueue.getRequest(handle);
+    if (request == nullptr) {
+        forgetLuaIoHandle(handle);
+        return pushLuaResultError(L, "Unknown fs handle");
+    }
+    if (request->state == SdIoQueue::STATE_PENDING || request->state == SdIoQueue::STATE_RUNNING) {
+        lua_pushboolean(L, false);
+        lua_pushinteger(L, sdIoQueue.getProgressPercent(handle));
+        return 2;
+    }
+
+    int results = 1;
+    if (request->state == SdIoQueue::STATE_FAILED) {
+        results = pushLuaResultError(L, request->error);
+    } else if (request->op == SdIoQueue::OP_READ) {
+        lua_pushlstring(L, request->data.data(), request->data.size());
+    } else if (request->op == SdIoQueue::OP_LIST) {
+        lua_createtable(L, static_cast<int>(request->entries.size()), 0);
+        for (size_t i = 0; i < request->entries.size(); i++) {
+            const SdIoQueue::ListEntry& entry = request->entries[i];
+            pushFsListEntry(L, request->path, entry.name.c_str(), entry.isDir, entry.size, entry.hasModified,
+                            entry.fatDate, entry.fatTime);
+            lua_rawseti(L, -2, static_cast<int>(i) + 1);
+        }
+    } else if (request->op == SdIoQueue::OP_STAT) {
+        lua_newtable(L);
+        lua_pushboolean(L, request->isDir);
+        lua_setfield(L, -2, "is_dir");
+        lua_pushinteger(L, static_cast<lua_Integer>(request->size));
+        lua_setfield(L, -2, "size");
+    } else {
+        lua_pushboolean(L, true);
+    }
+    sdIoQueue.release(handle);
+    forgetLuaIoHandle(handle);
+    return results;
+}
+
 static void registerFsModule(lua_State* L) {
     static const luaL_Reg fs_funcs[] = {
         {"list", lua_fs_list},
         {"read", lua_fs_read},
         {"write", lua_fs_write},
+        {"readAsync", lua_fs_readAsync},
+        {"writeAsync", lua_fs_writeAsync},
+        {"appendAsync", lua_fs_appendAsync},
+        {"listAsync", lua_fs_listAsync},
+        {"statAsync", lua_fs_statAsync},
+        {"poll", lua_fs_poll},
         {NULL, NULL}
     };
 
@@ -968,9 +1343,6 @@ static int lua_ui_editFile(lua_State* L) {
     if (!statSdFilePath(path, fileSize, error)) {
         return pushLuaResultError(L, error);
     }
-    if (fileSize > static_cast<uint64_t>(kT9EditorReadWriteMaxBytes)) {
-        return pushLuaResultError(L, "File too large for RW");
-    }
 
     appTransferAction = ACTION_EDIT_FILE;
     appTransferBool = false;
@@ -1189,6 +1561,7 @@ bool init() {
     
     // Register our custom modules
     registerGfxModule(L);
+    registerGfx3dModule(L);
     registerInputModule(L);
     registerSysModule(L);
     registerFsModule(L);
@@ -1196,6 +1569,7 @@ bool init() {
     registerT9Module(L);
     luaCurrentFontSize = GUI::getSystemFontSize();
     luaUsesSystemFont = true;
+    luaDrawColor = 1;
     applyLuaCurrentFont();
     
     lastError = "";
@@ -1204,6 +1578,10 @@ bool init() {
 }
 
 void shutdown() {
+    for (int handle : luaIoHandles) {
+        sdIoQueue.release(handle);
+    }
+    luaIoHandles.clear();
     if (L != nullptr) {
         lua_close(L);
         L = nullptr;
@@ -15,9 +15,12 @@ int emulator_frame_overhead_ms = 114;
 #include "hal.h"
 #include "clock.h"
 #include "gui.h"
+#include "display.h"
+#include "glyph_cache.h"
 #include "lua_vm.h"
 #include "lua_scripts.h"
 #include "app_transfer.h"
+#include "sd_io_queue.h"
 #include <esp_sleep.h>
 
 // App Modules (only Settings remains as CPP app)
@@ -117,18 +120,18 @@ void showBootSplash() {
     GUI::setFontSystem();
     
     const char* title = FIRMWARE_NAME;
-    int titleWidth = u8g2.getStrWidth(title);
-    u8g2.drawStr((GUI::SCREEN_WIDTH - titleWidth) / 2, 22, title);
+    int titleWidth = GUI::getTextWidth(title);
+    GUI::drawText((GUI::SCREEN_WIDTH - titleWidth) / 2, 22, title);
     
     GUI::setFontSecondary();
     char verStr[32];
     snprintf(verStr, sizeof(verStr), "v%s", FIRMWARE_VERSION);
-    int verWidth = u8g2.getStrWidth(verStr);
-    u8g2.drawStr((GUI::SCREEN_WIDTH - verWidth) / 2, 35, verStr);
+    int verWidth = GUI::getTextWidth(verStr);
+    GUI::drawText((GUI::SCREEN_WIDTH - verWidth) / 2, 35, verStr);
     
-    u8g2.drawStr((GUI::SCREEN_WIDTH - u8g2.getStrWidth("Initializing...")) / 2, 48, "Initializing...");
+    GUI::drawText((GUI::SCREEN_WIDTH - GUI::getTextWidth("Initializing...")) / 2, 48, "Initializing...");
     
-    u8g2.sendBuffer();
+    Display::flushFull();
     delay(1000);  // Show splash for 1 second
 }
 
@@ -146,17 +149,21 @@ void enterSleep() {
     char line2[32];
     snprintf(line2, sizeof(line2), "v%s", FIRMWARE_VERSION);
     const char* line3 = "Press any key";
-    int w1 = u8g2.getStrWidth(line1);
-    int w2 = u8g2.getStrWidth(line2);
-    int w3 = u8g2.getStrWidth(line3);
-    u8g2.drawStr((128 - w1) / 2, 24, line1);
-    u8g2.drawStr((128 - w2) / 2, 34, line2);
-    u8g2.drawStr((128 - w3) / 2, 48, line3);
+    int w1 = GUI::getTextWidth(line1);
+    int w2 = GUI::getTextWidth(line2);
+    int w3 = GUI::getTextWidth(line3);
+    GUI::drawText((128 - w1) / 2, 24, line1);
+    GUI::drawText((128 - w2) / 2, 34, line2);
+    GUI::drawText((128 - w3) / 2, 48, line3);
     u8g2.drawFrame(0, 0, 128, 64);
-    u8g2.sendBuffer();
+    Display::markAllDirty();
+    Display::flush();
     
     // Turn off backlight — LCD keeps showing screensaver
     ledcWrite(0, 0);
+
+    // Unmount SD so the card is in a clean state if power is cut while asleep
+    sdReleaseSession();
     
     // Configure wake-up on any GPIO (simplified - wake on any key)
     // For ESP32-S2, we use light sleep with GPIO wake-up
@@ -205,7 +212,7 @@ void renderLuaError() {
     const GUI::FontMetrics& metrics = GUI::getSystemFontMetrics();
     const char* msg = luaErrorMsg.c_str();
     int y = GUI::getContentBaselineStart();
-    int charWidth = static_cast<int>(u8g2.getStrWidth("W"));
+    int charWidth = static_cast<int>(GUI::getTextWidth("W"));
     if (charWidth < 1) charWidth = 1;
     int maxChars = max(1, (GUI::SCREEN_WIDTH - 4) / charWidth);
     
@@ -223,7 +230,7 @@ void renderLuaError() {
         lineBuf[lineLen] = '\0';
         if (lineLen > 0 && lineBuf[lineLen - 1] == '\n') lineBuf[lineLen - 1] = '\0';
         String line = GUI::truncateStringToWidth(String(lineBuf), GUI::SCREEN_WIDTH - 4);
-        u8g2.drawUTF8(2, y, line.c_str());
+        GUI::drawText(2, y, line.c_str());
         pos += lineLen;
         y += metrics.lineHeight;
     }
@@ -231,7 +238,8 @@ void renderLuaError() {
     // Footer
     GUI::drawFooterHints("ESC:Settings", "Enter:Retry");
     
-    u8g2.sendBuffer();
+    Display::markAllDirty();
+    Display::flush();
 }
 
 // --------------------------------------------------------------------------
@@ -245,6 +253,7 @@ void setup() {
     setupHardware();
     
     showBootSplash();
+    GlyphCache::warmUp();   // Unpack system font glyphs while the splash is up
     
     SystemClock::init();
     lastActivityTime = millis();
@@ -271,8 +280,7 @@ void setup() {
     // SD was already probed in setupHardware() (before LCD init).
     // Log the cached result here for visibility in the boot sequence.
     if (isSDMounted()) {
-        Serial.printf("[main] SD card: detected (%llu/%llu bytes used)\n",
-                      (unsigned long long)sdUsedBytes(),
+        Serial.printf("[main] SD card: detected (%llu bytes, used pending)\n",
                       (unsigned long long)sdTotalBytes());
     } else {
         Serial.println("[main] SD card: not found");
@@ -296,12 +304,15 @@ void loop() {
         // 1. HARDWARE SCAN (finalizes latched keys for this frame)
         scanMatrix();
         
-        // 2. SLEEP MODE CHECK
+        // 2. SLEEP MODE CHECK (+ release an idle SD volume)
+        sdServiceSession();
         checkSleepMode();
         if (isAsleep) {
             delay(100);  // Idle poll — avoid esp_light_sleep which glitches HW SPI
             return;
         }
+        sdServiceFreeSpace();
+        sdIoQueue.service(SD_IO_BYTES_PER_FRAME);
         
         const bool escJustPressed = isJustPressed(KEY_ESC);
 
@@ -439,13 +450,16 @@ void loop() {
                 }
             }
         } else if (currentMode == MODE_SETTINGS) {
-            u8g2.clearBuffer();
+            Display::clear();
             if (activeSettingsApp != nullptr) {
                 activeSettingsApp->render();
             } else {
                 appSettings.render();
             }
-            u8g2.sendBuffer();
+            // Settings apps draw on u8g2 directly; let the shadow compare
+            // find the tiles that actually changed.
+            Display::markAllDirty();
+            Display::flush();
         }
     }
 }
\ No newline at end of file
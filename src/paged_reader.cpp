@@ -0,0 +1,463 @@
+// PROJECT: ESP32-S2-Mini handheld terminal
+// MODULE: src/paged_reader.cpp
+// STATUS: [Level 2 - Implementation]
+// TRUTH_LINK: TACTICAL_TODO TASK_2
+// LOG_REF: 2026-10-17
+// Description: Line-aligned page reader for the read-only viewer.
+
+#include "paged_reader.h"
+#include <algorithm>
+
+// Index cache layout: [IndexCacheHeader][PageStart x pageCount]
+
+struct IndexCacheHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t pathCheck;    // Second hash of the path; the first names the file
+    uint32_t fileSize;
+    uint32_t modified;
+    uint32_t pageBytes;
+    uint32_t pageCount;
+    uint32_t newlines;
+    uint32_t checksum;     // FNV-1a over this header (checksum = 0) and the pages
+};
+
+static const uint32_t kIndexCacheMagic = 0x58444956UL;   // "VIDX"
+static const uint32_t kIndexCacheVersion = 1;
+static const size_t kMinCachedPages = 16;   // Smaller files index in a blink
+static const size_t kScanChunkBytes = 512;
+static const uint32_t kMidLineFlag = 0x80000000UL;
+static const uint32_t kPathCheckSeed = 0x9E3779B9UL;
+
+static uint32_t fnv1aUpdate(uint32_t hash, const void* data, size_t length) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < length; i++) {
+        hash ^= bytes[i];
+        hash *= 16777619UL;
+    }
+    return hash;
+}
+
+static bool isContinuationByte(uint8_t byte) {
+    return (byte & 0xC0) == 0x80;
+}
+
+static bool ensureDirectoryChain(const String& path) {
+    for (int slash = path.indexOf('/', 1); ; slash = path.indexOf('/', slash + 1)) {
+        const String part = slash < 0 ? path : path.substring(0, slash);
+        if (!sdFat.exists(part.c_str()) && !sdFat.mkdir(part.c_str())) return false;
+        if (slash < 0) return true;
+    }
+}
+
+PagedReader::PagedReader(const char* cacheRoot)
+    : cacheRoot(cacheRoot), pageBytes(0), fileSize(0), modified(0), complete(false), scanFailed(false), scanOffset(0),
+      pageStart(0), lastLineStart(0), lastLineStartLine(0), lastCharStart(0), newlines(0), useClock(0),
+      lastRequestedPage(-1), readAheadPage(-1), cacheHits(0), cacheMisses(0), bytesScanned(0),
+      indexFromCache(false) {
+    close();
+}
+
+void PagedReader::close() {
+    filePath = "";
+    fileSize = 0;
+    modified = 0;
+    pages.clear();
+    pages.shrink_to_fit();
+    complete = false;
+    scanFailed = false;
+    scanOffset = 0;
+    pageStart = 0;
+    lastLineStart = 0;
+    lastLineStartLine = 0;
+    lastCharStart = 0;
+    newlines = 0;
+    for (CachedPage& entry : cache) {
+        entry.page = -1;
+        entry.lastUse = 0;
+        entry.text = "";
+    }
+    useClock = 0;
+    lastRequestedPage = -1;
+    readAheadPage = -1;
+    indexFromCache = false;
+}
+
+bool PagedReader::open(const String& path, size_t pageBytes, String& error) {
+    close();
+    FsFile file;
+    if (!file.open(path.c_str(), O_RDONLY)) {
+        error = String("Failed to open file: ") + path;
+        return false;
+    }
+    if (file.isDir()) {
+        error = String("Path is a directory: ") + path;
+        return false;
+    }
+    uint16_t date = 0;
+    uint16_t time = 0;
+    file.getModifyDateTime(&date, &time);
+    fileSize = static_cast<size_t>(file.size());
+    file.close();
+
+    filePath = path;
+    this->pageBytes = max(static_cast<size_t>(16), pageBytes);
+    modified = (static_cast<uint32_t>(date) << 16) | time;
+    pages.push_back({0, 0});
+
+    if (loadIndexCache()) {
+        indexFromCache = true;
+        error = "";
+        return true;
+    }
+    // The first page has to be on screen now; the rest can wait.
+    if (!ensurePage(1, error) && error.length() > 0) return false;
+    error = "";
+    return true;
+}
+
+// ============================================================================
+// INDEXING
+// ============================================================================
+
+int PagedReader::getPageCount() const {
+    return static_cast<int>(complete ? pages.size() : pages.size() - 1);
+}
+
+size_t PagedReader::getPageOffset(int page) const {
+    if (page < 0 || page >= static_cast<int>(pages.size())) return fileSize;
+    return pages[page].offset;
+}
+
+uint32_t PagedReader::getPageFirstLine(int page) const {
+    if (page < 0 || page >= static_cast<int>(pages.size())) return 0;
+    return (pages[page].line & ~kMidLineFlag) + 1;
+}
+
+bool PagedReader::pageStartsMidLine(int page) const {
+    if (page < 0 || page >= static_cast<int>(pages.size())) return false;
+    return (pages[page].line & kMidLineFlag) != 0;
+}
+
+uint32_t PagedReader::getLineCount() const {
+    return newlines + 1;
+}
+
+size_t PagedReader::pageEnd(int page) const {
+    return page + 1 < static_cast<int>(pages.size()) ? pages[page + 1].offset : fileSize;
+}
+
+// Called before the byte at position is counted, once the page starting at
+// pageStart is full.
+void PagedReader::cutPage(size_t position, uint8_t byte) {
+    PageStart next;
+    if (lastLineStart > pageStart) {
+        next.offset = static_cast<uint32_t>(lastLineStart);
+        next.line = lastLineStartLine;
+    } else {
+        // One line fills the page: split it, but not inside a character.
+        const size_t cut = (isContinuationByte(byte) && lastCharStart > pageStart) ? lastCharStart : position;
+        next.offset = static_cast<uint32_t>(cut);
+        next.line = newlines | kMidLineFlag;
+    }
+    pages.push_back(next);
+    pageStart = next.offset;
+}
+
+bool PagedReader::scan(size_t budgetBytes, String& error) {
+    if (complete) return true;
+    FsFile file;
+    if (!file.open(filePath.c_str(), O_RDONLY) || !file.seekSet(scanOffset)) {
+        error = String("Failed to read file: ") + filePath;
+        return false;
+    }
+
+    uint8_t chunk[kScanChunkBytes];
+    size_t budget = budgetBytes;
+    while (budget > 0 && scanOffset < fileSize) {
+        const size_t want = min(min(sizeof(chunk), budget), fileSize - scanOffset);
+        const int got = file.read(chunk, want);
+        if (got <= 0) {
+            error = String("Failed to read file: ") + filePath;
+            return false;
+        }
+        for (int i = 0; i < got; i++) {
+            const size_t position = scanOffset + static_cast<size_t>(i);
+            const uint8_t byte = chunk[i];
+            if (position - pageStart >= pageBytes) cutPage(position, byte);
+            if (!isContinuationByte(byte)) lastCharStart = position;
+            if (byte == '\n') {
+                newlines++;
+                lastLineStart = position + 1;
+                lastLineStartLine = newlines;
+            }
+        }
+        scanOffset += static_cast<size_t>(got);
+        bytesScanned += static_cast<uint32_t>(got);
+        budget -= static_cast<size_t>(got);
+    }
+    file.close();
+
+    if (scanOffset >= fileSize) {
+        complete = true;
+        if (pages.size() >= kMinCachedPages) {
+            String cacheError;
+            if (!saveIndexCache(cacheError)) {
+                Serial.printf("[Viewer] Index cache not saved: %s\n", cacheError.c_str());
+            }
+        }
+    }
+    error = "";
+    return true;
+}
+
+bool PagedReader::ensurePage(int page, String& error) {
+    while (!complete && page >= getPageCount()) {
+        if (!scan(pageBytes * 4, error)) return false;
+    }
+    error = "";
+    return page < getPageCount();
+}
+
+bool PagedReader::findLine(uint32_t line, int& page, size_t& offsetInPage, String& error) {
+    page = 0;
+    offsetInPage = 0;
+    if (line < 1) line = 1;
+    const uint32_t target = line - 1;
+    // Line n (0-based) starts after the n-th line break.
+    while (!complete && newlines < target) {
+        if (!scan(pageBytes * 8, error)) return false;
+    }
+    if (target > newlines) {
+        error = String("File has ") + String(getLineCount()) + " lines";
+        return false;
+    }
+
+    // Last page starting at or before the start of the line; pages that
+    // start inside it sort after it.
+    const uint64_t key = static_cast<uint64_t>(target) * 2;
+    int lo = 0;
+    int hi = static_cast<int>(pages.size()) - 1;
+    while (lo < hi) {
+        const int mid = (lo + hi + 1) / 2;
+        const PageStart& start = pages[mid];
+        const uint64_t midKey = static_cast<uint64_t>(start.line & ~kMidLineFlag) * 2 +
+                                ((start.line & kMidLineFlag) ? 1 : 0);
+        if (midKey <= key) lo = mid;
+        else hi = mid - 1;
+    }
+    if (!ensurePage(lo, error)) {
+        if (error.length() == 0) error = "Line is out of range";
+        return false;
+    }
+
+    String text;
+    if (!readPage(lo, text, error)) return false;
+    uint32_t remaining = target - (pages[lo].line & ~kMidLineFlag);
+    size_t offset = 0;
+    while (remaining > 0 && offset < static_cast<size_t>(text.length())) {
+        if (text[offset] == '\n') remaining--;
+        offset++;
+    }
+    page = lo;
+    offsetInPage = offset;
+    error = "";
+    return true;
+}
+
+bool PagedReader::findOffset(size_t offset, int& page, size_t& offsetInPage, String& error) {
+    page = 0;
+    offsetInPage = 0;
+    if (offset >= fileSize && fileSize > 0) {
+        error = "Offset is past the end of the file";
+        return false;
+    }
+    // The page is bounded once a later page has started.
+    while (!complete && pages.back().offset <= offset) {
+        if (!scan(pageBytes * 8, error)) return false;
+    }
+    int lo = 0;
+    int hi = static_cast<int>(pages.size()) - 1;
+    while (lo < hi) {
+        const int mid = (lo + hi + 1) / 2;
+        if (pages[mid].offset <= offset) lo = mid;
+        else hi = mid - 1;
+    }
+    page = lo;
+    offsetInPage = offset - pages[lo].offset;
+    error = "";
+    return true;
+}
+
+// ============================================================================
+// PAGE CACHE
+// ============================================================================
+
+PagedReader::CachedPage* PagedReader::findCached(int page) {
+    for (CachedPage& entry : cache) {
+        if (entry.page == page) return &entry;
+    }
+    return nullptr;
+}
+
+bool PagedReader::loadPage(int page, CachedPage*& entry, String& error) {
+    entry = findCached(page);
+    if (entry != nullptr) return true;
+
+    CachedPage* victim = &cache[0];
+    for (CachedPage& candidate : cache) {
+        if (candidate.page < 0) {
+            victim = &candidate;
+            break;
+        }
+        if (candidate.lastUse < victim->lastUse) victim = &candidate;
+    }
+
+    const size_t start = pages[page].offset;
+    const size_t length = pageEnd(page) - start;
+    FsFile file;
+    if (!file.open(filePath.c_str(), O_RDONLY) || !file.seekSet(start)) {
+        error = String("Failed to read file: ") + filePath;
+        return false;
+    }
+    char* buffer = static_cast<char*>(malloc(length + 1));
+    if (buffer == nullptr) {
+        error = String("Not enough memory to load page: ") + filePath;
+        return false;
+    }
+    const int got = file.read(buffer, length);
+    const bool ok = got >= 0 && static_cast<size_t>(got) == length;
+    if (ok) {
+        buffer[length] = '\0';
+        victim->text = buffer;
+        victim->page = page;
+    }
+    free(buffer);
+    if (!ok) {
+        victim->page = -1;
+        error = String("Failed to read file: ") + filePath;
+        return false;
+    }
+    entry = victim;
+    return true;
+}
+
+bool PagedReader::readPage(int page, String& text, String& error) {
+    text = "";
+    if (!ensurePage(page, error)) {
+        if (error.length() == 0) error = "Requested page is out of range";
+        return false;
+    }
+
+    CachedPage* entry = findCached(page);
+    if (entry != nullptr) {
+        cacheHits++;
+    } else {
+        cacheMisses++;
+        if (!loadPage(page, entry, error)) return false;
+    }
+    entry->lastUse = ++useClock;
+    text = entry->text;
+
+    // Read ahead in the direction of travel.
+    readAheadPage = (page < lastRequestedPage) ? page - 1 : page + 1;
+    lastRequestedPage = page;
+    error = "";
+    return true;
+}
+
+bool PagedReader::service(size_t budgetBytes) {
+    if (!isOpen()) return false;
+    String error;
+    if (readAheadPage >= 0) {
+        const int page = readAheadPage;
+        readAheadPage = -1;
+        if (page < getPageCount() && findCached(page) == nullptr) {
+            CachedPage* entry = nullptr;
+            if (loadPage(page, entry, error)) {
+                // Just behind the current page in LRU order.
+                entry->lastUse = useClock;
+            }
+            return true;
+        }
+    }
+    if (complete || scanFailed) return false;
+    if (!scan(budgetBytes, error)) {
+        // Page flips retry it synchronously and report the error.
+        Serial.printf("[Viewer] Background indexing stopped: %s\n", error.c_str());
+        scanFailed = true;
+        return false;
+    }
+    return !complete;
+}
+
+// ============================================================================
+// INDEX CACHE
+// ============================================================================
+
+String PagedReader::indexCachePath() const {
+    char name[16];
+    snprintf(name, sizeof(name), "%08lx.idx",
+             static_cast<unsigned long>(fnv1aUpdate(2166136261UL, filePath.c_str(), filePath.length())));
+    return cacheRoot + "/" + name;
+}
+
+bool PagedReader::loadIndexCache() {
+    FsFile file;
+    const String path = indexCachePath();
+    if (!file.open(path.c_str(), O_RDONLY)) return false;
+    IndexCacheHeader header;
+    if (file.read(&header, sizeof(header)) != static_cast<int>(sizeof(header)) ||
+        header.magic != kIndexCacheMagic || header.version != kIndexCacheVersion ||
+        header.pathCheck != fnv1aUpdate(kPathCheckSeed, filePath.c_str(), filePath.length()) ||
+        header.fileSize != fileSize || header.modified != modified || header.pageBytes != pageBytes ||
+        header.pageCount == 0 || file.size() != sizeof(header) + sizeof(PageStart) * header.pageCount) {
+        return false;
+    }
+
+    std::vector<PageStart> loaded(header.pageCount);
+    const size_t bytes = sizeof(PageStart) * header.pageCount;
+    const uint32_t storedChecksum = header.checksum;
+    header.checksum = 0;
+    if (static_cast<size_t>(file.read(loaded.data(), bytes)) != bytes ||
+        fnv1aUpdate(fnv1aUpdate(2166136261UL, &header, sizeof(header)), loaded.data(), bytes) != storedChecksum) {
+        return false;
+    }
+    pages.swap(loaded);
+    newlines = header.newlines;
+    scanOffset = fileSize;
+    complete = true;
+    return true;
+}
+
+bool PagedReader::saveIndexCache(String& error) const {
+    if (!ensureDirectoryChain(cacheRoot)) {
+        error = String("Failed to create directory: ") + cacheRoot;
+        return false;
+    }
+    IndexCacheHeader header;
+    header.magic = kIndexCacheMagic;
+    header.version = kIndexCacheVersion;
+    header.pathCheck = fnv1aUpdate(kPathCheckSeed, filePath.c_str(), filePath.length());
+    header.fileSize = static_cast<uint32_t>(fileSize);
+    header.modified = modified;
+    header.pageBytes = static_cast<uint32_t>(pageBytes);
+    header.pageCount = static_cast<uint32_t>(pages.size());
+    header.newlines = newlines;
+    header.checksum = 0;
+    const size_t bytes = sizeof(PageStart) * pages.size();
+    header.checksum = fnv1aUpdate(fnv1aUpdate(2166136261UL, &header, sizeof(header)), pages.data(), bytes);
+
+    const String path = indexCachePath();
+    FsFile file;
+    if (!file.open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC) ||
+        file.write(reinterpret_cast<const uint8_t*>(&header), sizeof(header)) != sizeof(header) ||
+        file.write(reinterpret_cast<const uint8_t*>(pages.data()), bytes) != bytes || !file.sync()) {
+        file.close();
+        sdFat.remove(path.c_str());
+        error = String("Failed to write index cache: ") + path;
+        return false;
+    }
+    error = "";
+    return true;
+}
@@ -0,0 +1,117 @@
+// PROJECT: ESP32-S2-Mini handheld terminal
+// MODULE: src/paged_reader.h
+// STATUS: [Level 2 - Implementation]
+// TRUTH_LINK: TACTICAL_TODO TASK_2
+// LOG_REF: 2026-10-17
+// Description: Line-aligned page reader for the read-only viewer.
+//              One pass over the file records where each page starts and
+//              which line it starts on; pages end at a line break unless a
+//              single line is longer than a page. The pass runs a few KB at
+//              a time from service(), and the finished index is cached on
+//              SD keyed by file size and mtime. Pages are served from a
+//              small LRU cache that reads the next page ahead.
+
+#ifndef PAGED_READER_H
+#define PAGED_READER_H
+
+#include <Arduino.h>
+#include <SdFat.h>
+#include <vector>
+
+// All methods that touch the file expect the caller to hold an SD session.
+class PagedReader {
+public:
+    explicit PagedReader(const char* cacheRoot);
+    PagedReader(const PagedReader& other) = delete;
+    PagedReader& operator=(const PagedReader& other) = delete;
+
+    // Open path with pages of up to pageBytes. Loads a cached index if it
+    // still matches the file; otherwise indexes enough for the first page.
+    bool open(const String& path, size_t pageBytes, String& error);
+    void close();
+    bool isOpen() const { return filePath.length() > 0; }
+
+    // Background work: read ahead one page, or index up to budgetBytes
+    // more of the file. Returns true while work remains.
+    bool service(size_t budgetBytes);
+    bool hasPendingWork() const { return isOpen() && (readAheadPage >= 0 || (!complete && !scanFailed)); }
+    bool isIndexComplete() const { return complete; }
+
+    // Pages whose bounds are known. Grows until the index is complete.
+    int getPageCount() const;
+    // File offset where page starts; the file size past the known pages
+    size_t getPageOffset(int page) const;
+    // 1-based number of the line page starts on, and whether it starts
+    // part-way through that line (a line longer than a page).
+    uint32_t getPageFirstLine(int page) const;
+    bool pageStartsMidLine(int page) const;
+    // Lines seen so far; the file's line count once the index is complete
+    uint32_t getLineCount() const;
+    size_t getFileSize() const { return fileSize; }
+
+    // Index far enough that page exists, if the file has it.
+    bool ensurePage(int page, String& error);
+    // Read a page through the cache.
+    bool readPage(int page, String& text, String& error);
+    // Find the page and byte offset where a 1-based line starts. Indexes
+    // synchronously as far as needed.
+    bool findLine(uint32_t line, int& page, size_t& offsetInPage, String& error);
+    // Find the page holding a byte offset of the file.
+    bool findOffset(size_t offset, int& page, size_t& offsetInPage, String& error);
+
+    uint32_t getCacheHits() const { return cacheHits; }
+    uint32_t getCacheMisses() const { return cacheMisses; }
+    uint32_t getBytesScanned() const { return bytesScanned; }
+    bool wasIndexCached() const { return indexFromCache; }
+
+private:
+    static const int kCachePages = 4;
+
+    struct PageStart {
+        uint32_t offset;
+        uint32_t line;     // 0-based; top bit set when the page starts mid-line
+    };
+
+    struct CachedPage {
+        int page;
+        uint32_t lastUse;
+        String text;
+    };
+
+    String cacheRoot;
+    String filePath;
+    size_t pageBytes;
+    size_t fileSize;
+    uint32_t modified;     // FAT date << 16 | time
+    std::vector<PageStart> pages;
+    bool complete;
+    bool scanFailed;
+
+    // Indexing state
+    size_t scanOffset;
+    size_t pageStart;
+    size_t lastLineStart;
+    uint32_t lastLineStartLine;
+    size_t lastCharStart;
+    uint32_t newlines;
+
+    CachedPage cache[kCachePages];
+    uint32_t useClock;
+    int lastRequestedPage;
+    int readAheadPage;
+    uint32_t cacheHits;
+    uint32_t cacheMisses;
+    uint32_t bytesScanned;
+    bool indexFromCache;
+
+    bool scan(size_t budgetBytes, String& error);
+    void cutPage(size_t position, uint8_t byte);
+    size_t pageEnd(int page) const;
+    CachedPage* findCached(int page);
+    bool loadPage(int page, CachedPage*& entry, String& error);
+    String indexCachePath() const;
+    bool loadIndexCache();
+    bool saveIndexCache(String& error) const;
+};
+
+#endif
@@ -0,0 +1,373 @@
+// PROJECT: ESP32-S2-Mini handheld terminal
+// MODULE: src/sd_io_queue.cpp
+// STATUS: [Level 2 - Implementation]
+// TRUTH_LINK: TACTICAL_TODO TASK_2
+// LOG_REF: 2026-10-17
+// Description: Queue of SD requests serviced a slice at a time.
+
+#include "sd_io_queue.h"
+#include "hal.h"
+
+SdIoQueue sdIoQueue;
+
+// Directory and stat requests are charged one sector against the budget.
+static const size_t kMetadataCost = 512;
+
+SdIoQueue::SdIoQueue() : nextHandle(1), completedCount(0), sliceCount(0), inCallback(false) {
+    // Callbacks may submit more requests; with the capacity reserved up
+    // front the request they were handed never moves.
+    requests.reserve(MAX_REQUESTS);
+}
+
+// ==========================================================================
+// Submitting
+// ==========================================================================
+
+SdIoQueue::Request* SdIoQueue::add(Op op, const String& path, String& error, Callback callback,
+                                   void* context) {
+    // Never evict: a finished result may still be uncollected, and erasing
+    // would move the request a running callback was handed.
+    if (static_cast<int>(requests.size()) >= MAX_REQUESTS) {
+        error = "SD queue full";
+        return nullptr;
+    }
+
+    Request request;
+    request.handle = nextHandle++;
+    if (nextHandle <= 0) nextHandle = 1;
+    request.op = op;
+    request.state = STATE_PENDING;
+    request.path = path;
+    request.done = 0;
+    request.total = 0;
+    request.maxBytes = 0;
+    request.previousSize = 0;
+    request.isDir = false;
+    request.size = 0;
+    request.callback = callback;
+    request.context = context;
+    request.released = false;
+    requests.push_back(request);
+    error = "";
+    return &requests.back();
+}
+
+int SdIoQueue::submitRead(const String& path, size_t maxBytes, String& error, Callback callback,
+                          void* context) {
+    Request* request = add(OP_READ, path, error, callback, context);
+    if (request == nullptr) return -1;
+    request->maxBytes = maxBytes;
+    return request->handle;
+}
+
+int SdIoQueue::submitWrite(const String& path, const char* bytes, size_t length, String& error,
+                           Callback callback, void* context) {
+    Request* request = add(OP_WRITE, path, error, callback, context);
+    if (request == nullptr) return -1;
+    request->data.assign(bytes, bytes + length);
+    request->total = length;
+    return request->handle;
+}
+
+int SdIoQueue::submitAppend(const String& path, const char* bytes, size_t length, String& error,
+                            Callback callback, void* context) {
+    Request* request = add(OP_APPEND, path, error, callback, context);
+    if (request == nullptr) return -1;
+    request->data.assign(bytes, bytes + length);
+    request->total = length;
+    return request->handle;
+}
+
+int SdIoQueue::submitList(const String& path, String& error, Callback callback, void* context) {
+    Request* request = add(OP_LIST, path, error, callback, context);
+    return request == nullptr ? -1 : request->handle;
+}
+
+int SdIoQueue::submitStat(const String& path, String& error, Callback callback, void* context) {
+    Request* request = add(OP_STAT, path, error, callback, context);
+    return request == nullptr ? -1 : request->handle;
+}
+
+// ==========================================================================
+// Polling
+// ==========================================================================
+
+SdIoQueue::Request* SdIoQueue::findRequest(int handle) {
+    for (Request& request : requests) {
+        if (request.handle == handle && !request.released) return &request;
+    }
+    return nullptr;
+}
+
+const SdIoQueue::Request* SdIoQueue::findRequest(int handle) const {
+    for (const Request& request : requests) {
+        if (request.handle == handle && !request.released) return &request;
+    }
+    return nullptr;
+}
+
+SdIoQueue::State SdIoQueue::getState(int handle) const {
+    const Request* request = findRequest(handle);
+    return request == nullptr ? STATE_UNKNOWN : request->state;
+}
+
+const SdIoQueue::Request* SdIoQueue::getRequest(int handle) const {
+    return findRequest(handle);
+}
+
+int SdIoQueue::getProgressPercent(int handle) const {
+    const Request* request = findRequest(handle);
+    if (request == nullptr || request->state == STATE_PENDING) return 0;
+    if (request->state != STATE_RUNNING || request->total == 0) return 100;
+    return static_cast<int>(static_cast<uint64_t>(request->done) * 100 / request->total);
+}
+
+void SdIoQueue::release(int handle) {
+    for (size_t i = 0; i < requests.size(); i++) {
+        if (requests[i].handle != handle || requests[i].released) continue;
+        if (requests[i].state == STATE_RUNNING && requests[i].op == OP_WRITE && sdBeginSession()) {
+            sdFat.remove(sdSaveTempPath(requests[i].path).c_str());
+            sdEndSession();
+        }
+        if (inCallback) {
+            // Erasing now would move the request the callback holds;
+            // service() drops it once the callback returns.
+            requests[i].released = true;
+            return;
+        }
+        requests.erase(requests.begin() + static_cast<long>(i));
+        return;
+    }
+}
+
+void SdIoQueue::dropReleased() {
+    size_t kept = 0;
+    for (size_t i = 0; i < requests.size(); i++) {
+        if (requests[i].released) continue;
+        if (kept != i) requests[kept] = std::move(requests[i]);
+        kept++;
+    }
+    requests.resize(kept);
+}
+
+bool SdIoQueue::hasPendingWork() const {
+    for (const Request& request : requests) {
+        if (request.released) continue;
+        if (request.state == STATE_PENDING || request.state == STATE_RUNNING) return true;
+    }
+    return false;
+}
+
+// ==========================================================================
+// Servicing
+// ==========================================================================
+
+void SdIoQueue::fail(Request& request, const String& message) {
+    request.state = STATE_FAILED;
+    request.error = message;
+    Serial.println(String("[SdIoQueue] ") + message);
+}
+
+bool SdIoQueue::service(size_t budgetBytes) {
+    if (!hasPendingWork()) return false;
+    const bool mounted = isSDMounted() && sdBeginSession();
+
+    size_t budget = budgetBytes;
+    while (budget > 0) {
+        Request* next = nullptr;
+        for (Request& request : requests) {
+            if (request.released) continue;
+            if (request.state == STATE_PENDING || request.state == STATE_RUNNING) {
+                next = &request;
+                break;
+            }
+        }
+        if (next == nullptr) break;
+
+        if (!mounted) {
+            fail(*next, isSDMounted() ? "Failed to open SD session" : "SD not mounted");
+        } else {
+            budget -= min(budget, step(*next, budget));
+            sliceCount++;
+        }
+
+        if (next->state == STATE_DONE || next->state == STATE_FAILED) {
+            completedCount++;
+            if (next->callback != nullptr) {
+                inCallback = true;
+                next->callback(*next, next->context);
+                inCallback = false;
+                next->released = true;
+                dropReleased();
+            }
+        }
+    }
+
+    if (mounted) sdEndSession();
+    return hasPendingWork();
+}
+
+size_t SdIoQueue::step(Request& request, size_t budgetBytes) {
+    switch (request.op) {
+        case OP_READ:
+            return stepRead(request, budgetBytes);
+        case OP_WRITE:
+        case OP_APPEND:
+            return stepWrite(request, budgetBytes);
+        case OP_LIST:
+            stepList(request);
+            return kMetadataCost;
+        case OP_STAT:
+        default:
+            stepStat(request);
+            return kMetadataCost;
+    }
+}
+
+// Each slice reopens the file, so an idle release or sleep between frames
+// never leaves a stale handle behind.
+size_t SdIoQueue::stepRead(Request& request, size_t budgetBytes) {
+    FsFile file;
+    if (!file.open(request.path.c_str(), O_RDONLY)) {
+        fail(request, String("Failed to open file: ") + request.path);
+        return kMetadataCost;
+    }
+    if (file.isDir()) {
+        fail(request, String("Path is a directory: ") + request.path);
+        return kMetadataCost;
+    }
+    if (request.state == STATE_PENDING) {
+        const uint64_t fileSize = file.size();
+        if (fileSize > request.maxBytes) {
+            fail(request, String("File too large to read: ") + request.path);
+            return kMetadataCost;
+        }
+        request.total = static_cast<size_t>(fileSize);
+        request.data.resize(request.total);
+        request.state = STATE_RUNNING;
+    }
+
+    const size_t part = min(budgetBytes, request.total - request.done);
+    if (part > 0) {
+        if (!file.seekSet(request.done)) {
+            fail(request, String("Failed to seek file: ") + request.path);
+            return kMetadataCost;
+        }
+        const int got = file.read(request.data.data() + request.done, part);
+        if (got < 0) {
+            fail(request, String("Failed to read file: ") + request.path);
+            return kMetadataCost;
+        }
+        request.done += static_cast<size_t>(got);
+        if (static_cast<size_t>(got) < part) {
+            // The file shrank since the read started.
+            request.total = request.done;
+            request.data.resize(request.total);
+        }
+    }
+    if (request.done == request.total) request.state = STATE_DONE;
+    return max(part, static_cast<size_t>(1));
+}
+
+size_t SdIoQueue::stepWrite(Request& request, size_t budgetBytes) {
+    const bool replace = request.op == OP_WRITE;
+    const String target = replace ? sdSaveTempPath(request.path) : request.path;
+    FsFile file;
+    if (request.state == STATE_PENDING) {
+        if (file.open(request.path.c_str(), O_RDONLY)) {
+            request.previousSize = file.isDir() ? 0 : file.size();
+            file.close();
+        }
+        const int flags = replace ? (O_WRONLY | O_CREAT | O_TRUNC) : (O_WRONLY | O_CREAT | O_APPEND);
+        if (!file.open(target.c_str(), flags)) {
+            fail(request, String("Failed to open file for write: ") + target);
+            return kMetadataCost;
+        }
+        request.state = STATE_RUNNING;
+    } else if (!file.open(target.c_str(), O_WRONLY | O_APPEND)) {
+        fail(request, String("Failed to open file for write: ") + target);
+        return kMetadataCost;
+    }
+    if (file.isDir()) {
+        fail(request, String("Path is a directory: ") + request.path);
+        return kMetadataCost;
+    }
+
+    const size_t part = min(budgetBytes, request.total - request.done);
+    if (part > 0 &&
+        file.write(reinterpret_cast<const uint8_t*>(request.data.data() + request.done), part) != part) {
+        file.close();
+        if (replace) sdFat.remove(target.c_str());
+        fail(request, String("Failed to write file: ") + target);
+        return kMetadataCost;
+    }
+    request.done += part;
+    if (request.done < request.total) {
+        file.close();
+        return max(part, static_cast<size_t>(1));
+    }
+
+    if (!file.sync()) {
+        file.close();
+        if (replace) sdFat.remove(target.c_str());
+        fail(request, String("Failed to sync file: ") + target);
+        return kMetadataCost;
+    }
+    file.close();
+    if (replace) {
+        if ((sdFat.exists(request.path.c_str()) && !sdFat.remove(request.path.c_str())) ||
+            !sdFat.rename(target.c_str(), request.path.c_str())) {
+            fail(request, String("Failed to replace file: ") + request.path);
+            return kMetadataCost;
+        }
+        sdNoteFileResized(request.previousSize, request.total);
+    } else {
+        sdNoteFileResized(request.previousSize, request.previousSize + request.total);
+    }
+    request.data.clear();
+    request.data.shrink_to_fit();
+    request.state = STATE_DONE;
+    return max(part, static_cast<size_t>(1));
+}
+
+void SdIoQueue::stepList(Request& request) {
+    FsFile dir;
+    FsFile entry;
+    if (!dir.open(request.path.c_str(), O_RDONLY) || !dir.isDir()) {
+        fail(request, String("Failed to open directory: ") + request.path);
+        return;
+    }
+    dir.rewind();
+    char name[128];
+    while (entry.openNext(&dir, O_RDONLY)) {
+        const size_t nameLength = entry.getName(name, sizeof(name));
+        if (nameLength > 0 && strcmp(name, ".") != 0 && strcmp(name, "..") != 0) {
+            ListEntry item;
+            item.name = name;
+            item.isDir = entry.isDir();
+            item.size = item.isDir ? 0 : entry.size();
+            item.fatDate = 0;
+            item.fatTime = 0;
+            item.hasModified = entry.getModifyDateTime(&item.fatDate, &item.fatTime);
+            request.entries.push_back(item);
+        }
+        entry.close();
+    }
+    if (dir.getError()) {
+        request.entries.clear();
+        fail(request, String("Directory read failed: ") + request.path);
+        return;
+    }
+    request.state = STATE_DONE;
+}
+
+void SdIoQueue::stepStat(Request& request) {
+    FsFile file;
+    if (!file.open(request.path.c_str(), O_RDONLY)) {
+        fail(request, String("Failed to open file: ") + request.path);
+        return;
+    }
+    request.isDir = file.isDir();
+    request.size = request.isDir ? 0 : file.size();
+    request.state = STATE_DONE;
+}
@@ -0,0 +1,110 @@
+// PROJECT: ESP32-S2-Mini handheld terminal
+// MODULE: src/sd_io_queue.h
+// STATUS: [Level 2 - Implementation]
+// TRUTH_LINK: TACTICAL_TODO TASK_2
+// LOG_REF: 2026-10-17
+// Description: Queue of SD requests serviced a slice at a time.
+//              Read, write, append, list and stat requests run in order
+//              from service(), which moves at most a byte budget per frame,
+//              so a large transfer spreads over frames instead of stalling
+//              one. Callers poll a handle or pass a completion callback.
+//              Writes go to sdSaveTempPath(path) and replace the file at
+//              the end.
+
+#ifndef SD_IO_QUEUE_H
+#define SD_IO_QUEUE_H
+
+#include <Arduino.h>
+#include <SdFat.h>
+#include <vector>
+
+// service() opens its own SD session; the submit calls touch RAM only.
+class SdIoQueue {
+public:
+    static const int MAX_REQUESTS = 8;
+
+    enum Op { OP_READ, OP_WRITE, OP_APPEND, OP_LIST, OP_STAT };
+    enum State { STATE_UNKNOWN, STATE_PENDING, STATE_RUNNING, STATE_DONE, STATE_FAILED };
+
+    struct ListEntry {
+        String name;
+        bool isDir;
+        uint64_t size;
+        bool hasModified;
+        uint16_t fatDate;         // FAT modify date/time, valid with hasModified
+        uint16_t fatTime;
+    };
+
+    struct Request {
+        int handle;
+        Op op;
+        State state;
+        String path;
+        std::vector<char> data;   // Read result, or the bytes to write
+        size_t done;              // Bytes moved so far
+        size_t total;             // Bytes to move (reads: file size once known)
+        size_t maxBytes;          // Largest file a read accepts
+        uint64_t previousSize;    // Size of the file a write replaces
+        std::vector<ListEntry> entries;
+        bool isDir;               // Stat result
+        uint64_t size;            // Stat result
+        String error;
+        void (*callback)(const Request& request, void* context);
+        void* context;
+        bool released;            // Released during a callback, dropped after it
+    };
+    typedef void (*Callback)(const Request& request, void* context);
+
+    SdIoQueue();
+    SdIoQueue(const SdIoQueue& other) = delete;
+    SdIoQueue& operator=(const SdIoQueue& other) = delete;
+
+    // Each returns a handle, or -1 with error set when the queue is full.
+    // Finished requests are never evicted to make room; they stay until
+    // release(), or until the callback returns when one was given.
+    int submitRead(const String& path, size_t maxBytes, String& error, Callback callback = nullptr,
+                   void* context = nullptr);
+    int submitWrite(const String& path, const char* bytes, size_t length, String& error,
+                    Callback callback = nullptr, void* context = nullptr);
+    int submitAppend(const String& path, const char* bytes, size_t length, String& error,
+                     Callback callback = nullptr, void* context = nullptr);
+    int submitList(const String& path, String& error, Callback callback = nullptr, void* context = nullptr);
+    int submitStat(const String& path, String& error, Callback callback = nullptr, void* context = nullptr);
+
+    State getState(int handle) const;
+    // The request behind handle, or nullptr once released
+    const Request* getRequest(int handle) const;
+    // 0-100 for transfers; 0 until a request starts
+    int getProgressPercent(int handle) const;
+    // Drop a request. A write cut off part-way leaves the old file alone.
+    void release(int handle);
+
+    // Move up to budgetBytes. Returns true while requests are waiting.
+    bool service(size_t budgetBytes);
+    bool hasPendingWork() const;
+
+    uint32_t getCompletedCount() const { return completedCount; }
+    uint32_t getSliceCount() const { return sliceCount; }
+
+private:
+    std::vector<Request> requests;
+    int nextHandle;
+    uint32_t completedCount;
+    uint32_t sliceCount;
+    bool inCallback;
+
+    Request* findRequest(int handle);
+    const Request* findRequest(int handle) const;
+    Request* add(Op op, const String& path, String& error, Callback callback, void* context);
+    size_t step(Request& request, size_t budgetBytes);
+    size_t stepRead(Request& request, size_t budgetBytes);
+    size_t stepWrite(Request& request, size_t budgetBytes);
+    void stepList(Request& request);
+    void stepStat(Request& request);
+    void fail(Request& request, const String& message);
+    void dropReleased();
+};
+
+extern SdIoQueue sdIoQueue;
+
+#endif
@@ -0,0 +1,143 @@
+// PROJECT: ESP32-S2-Mini handheld terminal
+// MODULE: src/span_document.cpp
+// STATUS: [Level 2 - Implementation]
+// TRUTH_LINK: TACTICAL_TODO TASK_2
+// LOG_REF: 2026-10-17
+// Description: Copy-on-write edit record for files too large for RAM.
+
+#include "span_document.h"
+
+SpanDocument::SpanDocument() : fileSize(0), documentLength(0), modified(false) {}
+
+bool SpanDocument::open(const String& path, String& error) {
+    close();
+
+    FsFile file;
+    if (!file.open(path.c_str(), O_RDONLY)) {
+        error = String("Failed to open file: ") + path;
+        return false;
+    }
+    if (file.isDir()) {
+        error = String("Path is a directory: ") + path;
+        return false;
+    }
+    fileSize = static_cast<size_t>(file.size());
+    file.close();
+
+    filePath = path;
+    documentLength = fileSize;
+    if (fileSize > 0) {
+        Span whole = {0, static_cast<uint32_t>(fileSize), false};
+        spans.push_back(whole);
+    }
+    error = "";
+    return true;
+}
+
+void SpanDocument::close() {
+    filePath = "";
+    fileSize = 0;
+    documentLength = 0;
+    spans.clear();
+    added.clear();
+    modified = false;
+}
+
+// Make a span start at offset and return its index (spans.size() at the
+// end of the document).
+size_t SpanDocument::splitAt(size_t offset) {
+    size_t start = 0;
+    for (size_t i = 0; i < spans.size(); i++) {
+        if (offset == start) return i;
+        const size_t end = start + spans[i].length;
+        if (offset < end) {
+            const uint32_t head = static_cast<uint32_t>(offset - start);
+            Span tail = spans[i];
+            tail.offset += head;
+            tail.length -= head;
+            spans[i].length = head;
+            spans.insert(spans.begin() + static_cast<long>(i) + 1, tail);
+            return i + 1;
+        }
+        start = end;
+    }
+    return spans.size();
+}
+
+bool SpanDocument::replace(size_t offset, size_t removedLength, const char* text, size_t textLength,
+                           String& error) {
+    if (offset > documentLength || removedLength > documentLength - offset) {
+        error = "Edit is outside the document";
+        return false;
+    }
+    if (removedLength == 0 && textLength == 0) {
+        error = "";
+        return true;
+    }
+
+    // Deleting the end of the newest insertion takes its bytes back, so
+    // typing and backspacing stay in one span.
+    if (removedLength > 0 && !spans.empty()) {
+        size_t start = 0;
+        for (size_t i = 0; i < spans.size(); i++) {
+            const size_t end = start + spans[i].length;
+            if (end >= offset + removedLength) {
+                Span& span = spans[i];
+                if (span.added && end == offset + removedLength && offset >= start &&
+                    span.offset + span.length == added.size()) {
+                    span.length -= static_cast<uint32_t>(removedLength);
+                    added.resize(added.size() - removedLength);
+                    if (span.length == 0) spans.erase(spans.begin() + static_cast<long>(i));
+                    documentLength -= removedLength;
+                    removedLength = 0;
+                }
+                break;
+            }
+            start = end;
+        }
+    }
+
+    const size_t first = splitAt(offset);
+    const size_t last = splitAt(offset + removedLength);
+    spans.erase(spans.begin() + static_cast<long>(first), spans.begin() + static_cast<long>(last));
+
+    if (textLength > 0) {
+        // Typing at the end of the previous insertion extends its span.
+        if (first > 0 && spans[first - 1].added &&
+            spans[first - 1].offset + spans[first - 1].length == added.size()) {
+            spans[first - 1].length += static_cast<uint32_t>(textLength);
+        } else {
+            Span inserted = {static_cast<uint32_t>(added.size()), static_cast<uint32_t>(textLength), true};
+            spans.insert(spans.begin() + static_cast<long>(first), inserted);
+        }
+        added.insert(added.end(), text, text + textLength);
+    }
+
+    documentLength = documentLength - removedLength + textLength;
+    modified = true;
+    error = "";
+    return true;
+}
+
+int SpanDocument::read(FsFile& file, size_t offset, char* out, size_t length) const {
+    size_t copied = 0;
+    size_t start = 0;
+    for (const Span& span : spans) {
+        if (copied == length) break;
+        const size_t end = start + span.length;
+        if (offset + copied < end) {
+            const size_t within = offset + copied - start;
+            const size_t part = min(static_cast<size_t>(span.length) - within, length - copied);
+            if (span.added) {
+                memcpy(out + copied, added.data() + span.offset + within, part);
+            } else {
+                if (!file.seekSet(span.offset + within)) return -1;
+                const int got = file.read(out + copied, part);
+                if (got < 0 || static_cast<size_t>(got) != part) return -1;
+            }
+            copied += part;
+        }
+        start = end;
+    }
+    return static_cast<int>(copied);
+}
@@ -0,0 +1,65 @@
+// PROJECT: ESP32-S2-Mini handheld terminal
+// MODULE: src/span_document.h
+// STATUS: [Level 2 - Implementation]
+// TRUTH_LINK: TACTICAL_TODO TASK_2
+// LOG_REF: 2026-10-17
+// Description: Copy-on-write edit record for files too large for RAM.
+//              The document is a list of spans, each a range of the
+//              original file or of an append-only buffer of inserted text.
+//              Edits only split and add spans; the file is untouched until
+//              the caller streams the spans into a new one.
+
+#ifndef SPAN_DOCUMENT_H
+#define SPAN_DOCUMENT_H
+
+#include <Arduino.h>
+#include <SdFat.h>
+#include <vector>
+
+// open() and read() expect the caller to hold an SD session.
+class SpanDocument {
+public:
+    struct Span {
+        uint32_t offset;   // In the original file, or in the added text
+        uint32_t length;
+        bool added;
+    };
+
+    SpanDocument();
+    SpanDocument(const SpanDocument& other) = delete;
+    SpanDocument& operator=(const SpanDocument& other) = delete;
+
+    // Start over with one span covering the whole file at path. The editor
+    // recovers an interrupted save before it opens the file.
+    bool open(const String& path, String& error);
+    void close();
+    bool isOpen() const { return filePath.length() > 0; }
+    bool isModified() const { return modified; }
+
+    size_t length() const { return documentLength; }
+    size_t getFileSize() const { return fileSize; }
+
+    // Replace removedLength bytes at offset with text. RAM only.
+    bool replace(size_t offset, size_t removedLength, const char* text, size_t textLength, String& error);
+
+    // Copy up to length bytes at offset, reading original spans from file,
+    // which must be the open original. Returns the bytes copied, or -1.
+    int read(FsFile& file, size_t offset, char* out, size_t length) const;
+
+    int getSpanCount() const { return static_cast<int>(spans.size()); }
+    const Span& getSpan(int index) const { return spans[index]; }
+    const char* getAddedText() const { return added.data(); }
+    size_t getAddedBytes() const { return added.size(); }
+
+private:
+    String filePath;
+    size_t fileSize;
+    size_t documentLength;
+    std::vector<Span> spans;
+    std::vector<char> added;
+    bool modified;
+
+    size_t splitAt(size_t offset);
+};
+
+#endif
@@ -0,0 +1,140 @@
+// PROJECT: ESP32-S2-Mini handheld terminal
+// MODULE: src/stream_search.cpp
+// STATUS: [Level 2 - Implementation]
+// TRUTH_LINK: TACTICAL_TODO TASK_2
+// LOG_REF: 2026-10-17
+// Description: Incremental Boyer-Moore-Horspool substring search.
+
+#include "stream_search.h"
+
+static inline uint8_t foldCase(uint8_t c) {
+    return (c >= 'A' && c <= 'Z') ? static_cast<uint8_t>(c + ('a' - 'A')) : c;
+}
+
+StreamSearch::StreamSearch(size_t chunkBytes)
+    : chunkBytes(chunkBytes), window(nullptr), patternLength(0), sourceLength(0), from(0), position(0),
+      rangeEnd(0), windowStart(0), windowLength(0), matchOffset(0), matchWrapped(false), wrapped(false),
+      active(false), bytesRead(0) {}
+
+StreamSearch::~StreamSearch() {
+    free(window);
+}
+
+bool StreamSearch::start(const String& pattern, size_t sourceLength, size_t from) {
+    cancel();
+    const size_t length = static_cast<size_t>(pattern.length());
+    if (length == 0 || length > MAX_PATTERN) return false;
+    window = static_cast<char*>(malloc(chunkBytes + MAX_PATTERN - 1));
+    if (window == nullptr) return false;
+
+    // Horspool shift: distance from the last occurrence of a byte (before
+    // the final position) to the end of the pattern.
+    patternLength = length;
+    for (size_t i = 0; i < length; i++) {
+        this->pattern[i] = foldCase(static_cast<uint8_t>(pattern[i]));
+    }
+    memset(shift, static_cast<int>(length), sizeof(shift));
+    for (size_t i = 0; i + 1 < length; i++) {
+        const uint8_t c = this->pattern[i];
+        shift[c] = static_cast<uint8_t>(length - 1 - i);
+        if (c >= 'a' && c <= 'z') shift[c - ('a' - 'A')] = shift[c];
+    }
+
+    this->sourceLength = sourceLength;
+    this->from = from > sourceLength ? 0 : from;
+    position = this->from;
+    rangeEnd = sourceLength;
+    windowStart = position;
+    windowLength = 0;
+    matchOffset = 0;
+    matchWrapped = false;
+    wrapped = false;
+    active = true;
+    bytesRead = 0;
+    return true;
+}
+
+void StreamSearch::cancel() {
+    free(window);
+    window = nullptr;
+    active = false;
+}
+
+int StreamSearch::getProgressPercent() const {
+    if (sourceLength == 0) return 100;
+    const size_t done = wrapped ? (sourceLength - from) + position : position - from;
+    return static_cast<int>(min(static_cast<size_t>(100), done * 100 / sourceLength));
+}
+
+// Slide the window to start at position, keeping the bytes it already has,
+// and read up to a chunk more.
+bool StreamSearch::fill(ReadFn read, void* context, int& got) {
+    size_t keep = 0;
+    if (position >= windowStart && position < windowStart + windowLength) {
+        keep = windowStart + windowLength - position;
+        memmove(window, window + (position - windowStart), keep);
+    }
+    windowStart = position;
+    const size_t capacity = chunkBytes + MAX_PATTERN - 1;
+    const size_t want = min(capacity - keep, rangeEnd - (position + keep));
+    got = want > 0 ? read(context, position + keep, window + keep, want) : 0;
+    if (got < 0) return false;
+    windowLength = keep + static_cast<size_t>(got);
+    bytesRead += static_cast<uint32_t>(got);
+    return true;
+}
+
+StreamSearch::Status StreamSearch::step(ReadFn read, void* context, size_t budgetBytes) {
+    if (!active) return NOT_FOUND;
+
+    const size_t last = patternLength - 1;
+    const uint8_t lastByte = pattern[last];
+    size_t budget = budgetBytes;
+    while (true) {
+        if (position + patternLength > rangeEnd) {
+            if (wrapped || from == 0) {
+                cancel();
+                return NOT_FOUND;
+            }
+            // Second pass: matches that start before the first pass did.
+            wrapped = true;
+            position = 0;
+            rangeEnd = min(sourceLength, from + last);
+            windowStart = 0;
+            windowLength = 0;
+            continue;
+        }
+
+        if (position + patternLength > windowStart + windowLength) {
+            if (budget == 0) return SEARCHING;
+            int got = 0;
+            if (!fill(read, context, got)) {
+                cancel();
+                return FAILED;
+            }
+            budget -= min(budget, static_cast<size_t>(got));
+            if (position + patternLength > windowStart + windowLength) {
+                // The source ended early (e.g. the file shrank).
+                rangeEnd = windowStart + windowLength;
+                continue;
+            }
+        }
+
+        const uint8_t* base = reinterpret_cast<const uint8_t*>(window) - windowStart;
+        const size_t windowEnd = windowStart + windowLength;
+        while (position + patternLength <= windowEnd) {
+            const uint8_t c = base[position + last];
+            if (foldCase(c) == lastByte) {
+                size_t i = 0;
+                while (i < last && foldCase(base[position + i]) == pattern[i]) i++;
+                if (i == last) {
+                    matchOffset = position;
+                    matchWrapped = wrapped;
+                    position++;
+                    return FOUND;
+                }
+            }
+            position += shift[c];
+        }
+    }
+}
@@ -0,0 +1,75 @@
+// PROJECT: ESP32-S2-Mini handheld terminal
+// MODULE: src/stream_search.h
+// STATUS: [Level 2 - Implementation]
+// TRUTH_LINK: TACTICAL_TODO TASK_2
+// LOG_REF: 2026-10-17
+// Description: Incremental Boyer-Moore-Horspool substring search.
+//              Scans any random-access source (SD file, String, gap
+//              buffer) through one fixed chunk buffer, keeping the tail of
+//              each chunk so matches across chunk edges are found. Work is
+//              split into budgeted steps so the UI can keep drawing.
+
+#ifndef STREAM_SEARCH_H
+#define STREAM_SEARCH_H
+
+#include <Arduino.h>
+
+class StreamSearch {
+public:
+    // Copy up to length bytes at offset into out. Returns the bytes copied,
+    // or -1 on a read error.
+    typedef int (*ReadFn)(void* context, size_t offset, char* out, size_t length);
+
+    enum Status {
+        SEARCHING,     // Budget used up; call step() again
+        FOUND,         // getMatchOffset() is valid; step() continues after it
+        NOT_FOUND,     // Every position has been checked
+        FAILED         // Read error
+    };
+
+    static const size_t MAX_PATTERN = 64;
+
+    explicit StreamSearch(size_t chunkBytes);
+    ~StreamSearch();
+    StreamSearch(const StreamSearch& other) = delete;
+    StreamSearch& operator=(const StreamSearch& other) = delete;
+
+    // Search sourceLength bytes for pattern (ASCII case-insensitive),
+    // starting at from and wrapping around to it. False if the pattern is
+    // empty or too long, or the chunk buffer cannot be allocated.
+    bool start(const String& pattern, size_t sourceLength, size_t from);
+    void cancel();
+    bool isActive() const { return active; }
+
+    // Scan at least budgetBytes of new data unless a match or the end
+    // comes first.
+    Status step(ReadFn read, void* context, size_t budgetBytes);
+
+    size_t getMatchOffset() const { return matchOffset; }
+    bool isMatchWrapped() const { return matchWrapped; }
+    size_t getPatternLength() const { return patternLength; }
+    int getProgressPercent() const;
+    uint32_t getBytesRead() const { return bytesRead; }
+
+private:
+    size_t chunkBytes;
+    char* window;          // chunkBytes + MAX_PATTERN - 1 bytes
+    uint8_t pattern[MAX_PATTERN];
+    uint8_t shift[256];
+    size_t patternLength;
+    size_t sourceLength;
+    size_t from;
+    size_t position;       // Next candidate match start
+    size_t rangeEnd;       // Matches must end at or before this
+    size_t windowStart;
+    size_t windowLength;
+    size_t matchOffset;
+    bool matchWrapped;
+    bool wrapped;          // Scanning [0, from) after reaching the end
+    bool active;
+    uint32_t bytesRead;
+
+    bool fill(ReadFn read, void* context, int& got);
+};
+
+#endif
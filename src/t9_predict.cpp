@@ -5,12 +5,47 @@
 // TRUTH_LINK: TACTICAL_TODO TASK_1
 // LOG_REF: 2026-04-22
 // Description: T9 predictive text lookup — binary search on PROGMEM dictionary.
-//              Prefix matching scans sorted index for incremental suggestions.
+//              Prefix matching keeps the most common completions, from a
+//              generated table for short prefixes or a bounded heap.
+//              Index entries pack the digits 3 bits each with an explicit
+//              length, so no key is decoded digit by digit.
 //
 
 #include "t9_predict.h"
 #include "t9_dict.h"
 #include <pgmspace.h>
+#include <algorithm>
+
+// Digits a packed index key holds; sequences are at most KEY_DIGITS - 1 long.
+static const int KEY_DIGITS = 16;
+
+// Index entries are 10 packed bytes; these read the fields out of flash.
+static inline uint32_t entryFirstWord(int indexPos) {
+    T9IndexEntry entry;
+    memcpy_P(&entry, &t9_index[indexPos], sizeof(T9IndexEntry));
+    return static_cast<uint32_t>(entry.firstWord[0]) | (static_cast<uint32_t>(entry.firstWord[1]) << 8) |
+           (static_cast<uint32_t>(entry.firstWord[2]) << 16);
+}
+
+static inline int entryWordCount(const T9IndexEntry& entry) {
+    return entry.lengthCount & 0x0F;
+}
+
+static inline int entryLength(int indexPos) {
+    return pgm_read_byte(&t9_index[indexPos].lengthCount) >> 4;
+}
+
+static inline uint16_t wordRank(uint32_t word) {
+    return pgm_read_word(&t9_word_ranks[word]);
+}
+
+// Flash is memory-mapped, so a view points straight into the word pool.
+static T9WordView wordView(uint32_t word) {
+    const uint32_t start = pgm_read_dword(&t9_word_starts[word]);
+    const uint32_t end = pgm_read_dword(&t9_word_starts[word + 1]);
+    T9WordView view = {&t9_word_pool[start], static_cast<int>(end - start - 1)};
+    return view;
+}
 
 T9Predict::T9Predict() {
     reset();
@@ -24,6 +59,9 @@ void T9Predict::reset() {
     indexPos = -1;
     prefixCandidateCount = 0;
     prefixSelectedIdx = 0;
+    rangeLo[0] = 0;
+    rangeHi[0] = (int)T9_INDEX_COUNT;
+    buildLengthBuckets();
 }
 
 void T9Predict::pushDigit(char digit) {
@@ -33,6 +71,7 @@ void T9Predict::pushDigit(char digit) {
     digits[digitCount] = '\0';
     selectedIdx = 0;
     prefixSelectedIdx = 0;
+    narrowRange();
     updateCandidates();
 }
 
@@ -77,35 +116,16 @@ void T9Predict::prevCandidate() {
     }
 }
 
-const char* T9Predict::getCandidate(int index) const {
-    if (indexPos < 0 || index < 0 || index >= candidateCount) return nullptr;
-
-    // Read entry from PROGMEM
-    T9IndexEntry entry;
-    memcpy_P(&entry, &t9_index[indexPos], sizeof(T9IndexEntry));
-
-    // Walk through null-terminated words in the pool
-    uint32_t pos = entry.offset;
-    for (int i = 0; i < index; i++) {
-        // Skip to next word
-        while (pos < T9_WORD_POOL_SIZE && pgm_read_byte(&t9_word_pool[pos]) != 0) {
-            pos++;
-        }
-        pos++; // skip null terminator
+T9WordView T9Predict::getCandidateView(int index) const {
+    if (indexPos < 0 || index < 0 || index >= candidateCount) {
+        T9WordView none = {nullptr, 0};
+        return none;
     }
+    return wordView(entryFirstWord(indexPos) + static_cast<uint32_t>(index));
+}
 
-    if (pos >= T9_WORD_POOL_SIZE) return nullptr;
-
-    // Copy word from PROGMEM to static buffer
-    static char buf[16];
-    int len = 0;
-    while (len < 15 && pos + len < T9_WORD_POOL_SIZE) {
-        char c = pgm_read_byte(&t9_word_pool[pos + len]);
-        if (c == 0) break;
-        buf[len++] = c;
-    }
-    buf[len] = '\0';
-    return buf;
+const char* T9Predict::getCandidate(int index) const {
+    return getCandidateView(index).text;
 }
 
 const char* T9Predict::getSelectedWord() const {
@@ -119,35 +139,16 @@ int T9Predict::getPrefixCandidateCount() const {
     return prefixCandidateCount;
 }
 
-const char* T9Predict::getPrefixCandidate(int index) const {
-    if (index < 0 || index >= prefixCandidateCount) return nullptr;
-
-    int iPos = prefixMatches[index].indexPos;
-    int wIdx = prefixMatches[index].wordIdx;
-
-    T9IndexEntry entry;
-    memcpy_P(&entry, &t9_index[iPos], sizeof(T9IndexEntry));
-
-    // Walk to the wIdx-th word in the pool for this entry
-    uint32_t pos = entry.offset;
-    for (int i = 0; i < wIdx; i++) {
-        while (pos < T9_WORD_POOL_SIZE && pgm_read_byte(&t9_word_pool[pos]) != 0) {
-            pos++;
-        }
-        pos++;
+T9WordView T9Predict::getPrefixCandidateView(int index) const {
+    if (index < 0 || index >= prefixCandidateCount) {
+        T9WordView none = {nullptr, 0};
+        return none;
     }
+    return wordView(prefixMatches[index].word);
+}
 
-    if (pos >= T9_WORD_POOL_SIZE) return nullptr;
-
-    static char buf[16];
-    int len = 0;
-    while (len < 15 && pos + len < T9_WORD_POOL_SIZE) {
-        char c = pgm_read_byte(&t9_word_pool[pos + len]);
-        if (c == 0) break;
-        buf[len++] = c;
-    }
-    buf[len] = '\0';
-    return buf;
+const char* T9Predict::getPrefixCandidate(int index) const {
+    return getPrefixCandidateView(index).text;
 }
 
 const char* T9Predict::getSelectedPrefixWord() const {
@@ -172,93 +173,31 @@ void T9Predict::prevPrefixCandidate() {
 }
 
 int T9Predict::getPrefixCandidateCountForLength(int targetLen) const {
-    if (targetLen <= 0) return 0;
-    int count = 0;
-    for (int i = 0; i < prefixCandidateCount; i++) {
-        T9IndexEntry entry;
-        memcpy_P(&entry, &t9_index[prefixMatches[i].indexPos], sizeof(T9IndexEntry));
-        if (keyDigitCount(entry.key) == targetLen) count++;
-    }
-    return count;
+    if (targetLen <= 0 || targetLen >= KEY_DIGITS) return 0;
+    return lengthStart[targetLen + 1] - lengthStart[targetLen];
 }
 
 const char* T9Predict::getPrefixCandidateForLength(int targetLen, int index) const {
-    if (targetLen <= 0 || index < 0) return nullptr;
-    int seen = 0;
-    for (int i = 0; i < prefixCandidateCount; i++) {
-        T9IndexEntry entry;
-        memcpy_P(&entry, &t9_index[prefixMatches[i].indexPos], sizeof(T9IndexEntry));
-        if (keyDigitCount(entry.key) != targetLen) continue;
-        if (seen == index) return getPrefixCandidate(i);
-        seen++;
-    }
-    return nullptr;
+    if (index < 0 || index >= getPrefixCandidateCountForLength(targetLen)) return nullptr;
+    return getPrefixCandidate(byLength[lengthStart[targetLen] + index]);
 }
 
-void T9Predict::nextPrefixCandidateForLength(int targetLen) {
-    if (targetLen <= 0 || prefixCandidateCount == 0) return;
-    int count = getPrefixCandidateCountForLength(targetLen);
+// Step through one length bucket; a selection of another length restarts
+// the bucket at its first word.
+void T9Predict::stepPrefixCandidateForLength(int targetLen, int step) {
+    const int count = getPrefixCandidateCountForLength(targetLen);
     if (count <= 0) return;
+    const bool inBucket = prefixMatches[prefixSelectedIdx].length == targetLen;
+    const int current = inBucket ? bucketPos[prefixSelectedIdx] : 0;
+    prefixSelectedIdx = byLength[lengthStart[targetLen] + (current + step + count) % count];
+}
 
-    int filteredIdx = 0;
-    bool foundCurrent = false;
-    for (int i = 0; i < prefixCandidateCount; i++) {
-        T9IndexEntry entry;
-        memcpy_P(&entry, &t9_index[prefixMatches[i].indexPos], sizeof(T9IndexEntry));
-        if (keyDigitCount(entry.key) != targetLen) continue;
-        if (i == prefixSelectedIdx) {
-            foundCurrent = true;
-            break;
-        }
-        filteredIdx++;
-    }
-    if (!foundCurrent) filteredIdx = 0;
-    int nextFiltered = (filteredIdx + 1) % count;
-
-    int seen = 0;
-    for (int i = 0; i < prefixCandidateCount; i++) {
-        T9IndexEntry entry;
-        memcpy_P(&entry, &t9_index[prefixMatches[i].indexPos], sizeof(T9IndexEntry));
-        if (keyDigitCount(entry.key) != targetLen) continue;
-        if (seen == nextFiltered) {
-            prefixSelectedIdx = i;
-            return;
-        }
-        seen++;
-    }
+void T9Predict::nextPrefixCandidateForLength(int targetLen) {
+    stepPrefixCandidateForLength(targetLen, 1);
 }
 
 void T9Predict::prevPrefixCandidateForLength(int targetLen) {
-    if (targetLen <= 0 || prefixCandidateCount == 0) return;
-    int count = getPrefixCandidateCountForLength(targetLen);
-    if (count <= 0) return;
-
-    int filteredIdx = 0;
-    bool foundCurrent = false;
-    for (int i = 0; i < prefixCandidateCount; i++) {
-        T9IndexEntry entry;
-        memcpy_P(&entry, &t9_index[prefixMatches[i].indexPos], sizeof(T9IndexEntry));
-        if (keyDigitCount(entry.key) != targetLen) continue;
-        if (i == prefixSelectedIdx) {
-            foundCurrent = true;
-            break;
-        }
-        filteredIdx++;
-    }
-    if (!foundCurrent) filteredIdx = 0;
-    int prevFiltered = (filteredIdx - 1 + count) % count;
-
-    int seen = 0;
-    for (int i = 0; i < prefixCandidateCount; i++) {
-        T9IndexEntry entry;
-        memcpy_P(&entry, &t9_index[prefixMatches[i].indexPos], sizeof(T9IndexEntry));
-        if (keyDigitCount(entry.key) != targetLen) continue;
-        if (seen == prevFiltered) {
-            prefixSelectedIdx = i;
-            return;
-        }
-        seen++;
-    }
+    stepPrefixCandidateForLength(targetLen, -1);
 }
 
 int T9Predict::getSingleKeyLetterCount(char digit) const {
@@ -273,76 +212,81 @@ int T9Predict::getSingleKeyLetterCount(char digit) const {
 }
 
 const char* T9Predict::getSingleKeyLetter(char digit, int index) const {
-    static const char* letters[] = {
-        "", "", "abc", "def", "ghi", "jkl", "mno", "pqrs", "tuv", "wxyz"
-    };
-    static char out[2];
+    // Each letter NUL-terminated in place, so no buffer is shared
+    static const char kLetters[] = "a\0b\0c\0d\0e\0f\0g\0h\0i\0j\0k\0l\0m\0n\0o\0p\0q\0r\0s\0t\0u\0v\0w\0x\0y\0z";
+    static const uint8_t kFirstLetter[] = {0, 0, 0, 3, 6, 9, 12, 15, 19, 22};
     if (digit < '2' || digit > '9') return nullptr;
-    const char* set = letters[digit - '0'];
     int count = getSingleKeyLetterCount(digit);
     if (index < 0 || index >= count) return nullptr;
-    out[0] = set[index];
-    out[1] = '\0';
-    return out;
+    return &kLetters[(kFirstLetter[digit - '0'] + index) * 2];
 }
 
 // --- Private helpers ---
 
-// All keys are left-aligned to 15 decimal digits.
-// e.g. digits "7663" -> 766300000000000ULL.
-// This guarantees that prefix ordering is preserved in integer sort:
-// all entries whose digit string starts with "7663" form a
-// contiguous range [766300000000000, 766400000000000).
-
-static const int KEY_WIDTH = 15;
+// Index keys pack each digit into 3 bits (digit - 2), first digit in the
+// top bits of a 48-bit code, unused digits zero. All sequences starting
+// with "7663" then have codes in [code("7663"), code("7663") | low bits].
+// Padding with zero makes "766" and "7662" share a code, so entries sort
+// by code and then by the digit count stored beside it.
 
-// Pre-computed powers of 10
-static uint64_t pow10(int n) {
-    uint64_t r = 1;
-    for (int i = 0; i < n; i++) r *= 10;
-    return r;
+static inline uint64_t entrySortKey(int indexPos) {
+    T9IndexEntry entry;
+    memcpy_P(&entry, &t9_index[indexPos], sizeof(T9IndexEntry));
+    uint64_t code = 0;
+    for (int i = 0; i < 6; i++) code = (code << 8) | entry.code[i];
+    return (code << 4) | static_cast<uint64_t>(entry.lengthCount >> 4);
 }
 
-uint64_t T9Predict::digitsToKey() const {
-    uint64_t key = 0;
+uint64_t T9Predict::digitsToCode() const {
+    uint64_t code = 0;
     for (int i = 0; i < digitCount; i++) {
-        key = key * 10 + (digits[i] - '0');
+        code = (code << 3) | static_cast<uint64_t>(digits[i] - '2');
     }
-    // Left-align to KEY_WIDTH digits
-    key *= pow10(KEY_WIDTH - digitCount);
-    return key;
+    return code << (3 * (KEY_DIGITS - digitCount));
 }
 
-int T9Predict::binarySearch(uint64_t key) const {
-    int lo = 0;
-    int hi = T9_INDEX_COUNT - 1;
-    while (lo <= hi) {
-        int mid = (lo + hi) / 2;
-        T9IndexEntry entry;
-        memcpy_P(&entry, &t9_index[mid], sizeof(T9IndexEntry));
-        if (entry.key == key) return mid;
-        if (entry.key < key) lo = mid + 1;
-        else hi = mid - 1;
+// First entry in [lo, hi) whose sort key is >= key
+static int lowerBound(uint64_t key, int lo, int hi) {
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (entrySortKey(mid) < key) lo = mid + 1;
+        else hi = mid;
     }
-    return -1;
+    return lo;
+}
+
+// Entries sharing the first n digits are a sub-range of those sharing the
+// first n - 1, so each new digit searches only inside its parent's range
+// and popping a digit just steps back to the range below it.
+void T9Predict::narrowRange() {
+    const int parentLo = rangeLo[digitCount - 1];
+    const int parentHi = rangeHi[digitCount - 1];
+    const uint64_t code = digitsToCode();
+    const uint64_t tailMask = (1ULL << (3 * (KEY_DIGITS - digitCount))) - 1;
+    const uint64_t firstKey = (code << 4) | static_cast<uint64_t>(digitCount);
+    const uint64_t lastKey = ((code | tailMask) << 4) | 0x0F;
+    rangeLo[digitCount] = lowerBound(firstKey, parentLo, parentHi);
+    rangeHi[digitCount] = lowerBound(lastKey + 1, rangeLo[digitCount], parentHi);
 }
 
 void T9Predict::updateCandidates() {
     if (digitCount == 0) {
         candidateCount = 0;
         indexPos = -1;
-        prefixCandidateCount = 0;
-        prefixSelectedIdx = 0;
+        updatePrefixCandidates();
         return;
     }
 
-    uint64_t key = digitsToKey();
-    indexPos = binarySearch(key);
+    // Every entry in the range is at least digitCount long, and the exact
+    // sequence, if present, sorts first.
+    const int lo = rangeLo[digitCount];
+    const int hi = rangeHi[digitCount];
+    indexPos = (lo < hi && entryLength(lo) == digitCount) ? lo : -1;
 
     if (indexPos >= 0) {
         T9IndexEntry entry;
         memcpy_P(&entry, &t9_index[indexPos], sizeof(T9IndexEntry));
-        candidateCount = entry.count;
+        candidateCount = entryWordCount(entry);
     } else {
         candidateCount = 0;
     }
@@ -354,65 +298,83 @@ void T9Predict::updateCandidates() {
     updatePrefixCandidates();
 }
 
-// With left-aligned keys, prefix matching is a simple range check.
-// All keys sharing the same N-digit prefix fall in a contiguous range.
-// Not used with left-aligned keys, but kept for API compatibility.
-int T9Predict::keyDigitCount(uint64_t key) {
-    if (key == 0) return 0;
-    int trailingZeros = 0;
-    while ((key % 10ULL) == 0ULL && trailingZeros < KEY_WIDTH) {
-        trailingZeros++;
-        key /= 10ULL;
-    }
-    return KEY_WIDTH - trailingZeros;
-}
-
-bool T9Predict::keyStartsWith(uint64_t key, uint64_t prefix, int prefixLen) {
-    (void)prefixLen; // unused with left-aligned keys
-    // Not used in the new prefix scan; kept for compatibility
-    return key >= prefix && key < prefix + pow10(KEY_WIDTH - prefixLen);
+// Heap order for prefixMatches: the least common kept word on top.
+static bool moreCommon(const T9Predict::PrefixMatch& a, const T9Predict::PrefixMatch& b) {
+    return a.rank < b.rank;
 }
 
 void T9Predict::updatePrefixCandidates() {
     prefixCandidateCount = 0;
     prefixSelectedIdx = 0;
 
-    if (digitCount == 0) return;
-
-    uint64_t prefixKey = digitsToKey();  // already left-aligned
-    // All matching keys are in [prefixKey, prefixKey + span)
-    uint64_t span = pow10(KEY_WIDTH - digitCount);
-    uint64_t rangeEnd = prefixKey + span;
-
-    // Binary search for the first index entry >= prefixKey
-    int lo = 0, hi = (int)T9_INDEX_COUNT - 1, firstIdx = (int)T9_INDEX_COUNT;
-    while (lo <= hi) {
-        int mid = (lo + hi) / 2;
-        T9IndexEntry entry;
-        memcpy_P(&entry, &t9_index[mid], sizeof(T9IndexEntry));
-        if (entry.key >= prefixKey) { firstIdx = mid; hi = mid - 1; }
-        else lo = mid + 1;
+    if (digitCount == 0) {
+        buildLengthBuckets();
+        return;
     }
 
-    // Pass 1: exact-length matches first.
-    for (int i = firstIdx; i < (int)T9_INDEX_COUNT && prefixCandidateCount < MAX_PREFIX_MATCHES; i++) {
-        T9IndexEntry entry;
-        memcpy_P(&entry, &t9_index[i], sizeof(T9IndexEntry));
-        if (entry.key >= rangeEnd) break;
-        if (keyDigitCount(entry.key) != digitCount) continue;
-        prefixMatches[prefixCandidateCount].indexPos = i;
-        prefixMatches[prefixCandidateCount].wordIdx = 0;
-        prefixCandidateCount++;
+    // Short prefixes cover thousands of words, so their lists are built
+    // ahead of time by the generator.
+    static_assert(T9_BEST_COUNT <= MAX_PREFIX_MATCHES, "best completion lists must fit prefixMatches");
+    if (digitCount <= T9_BEST_DIGITS) {
+        int row = 0;
+        for (int i = 0; i < digitCount; i++) row = row * 8 + (digits[i] - '2');
+        for (int n = 1; n < digitCount; n++) row += 1 << (3 * n);
+        const int first = pgm_read_word(&t9_best_starts[row]);
+        const int last = pgm_read_word(&t9_best_starts[row + 1]);
+        for (int i = first; i < last; i++) {
+            const uint32_t word = pgm_read_word(&t9_best_words[i]);
+            prefixMatches[prefixCandidateCount].word = word;
+            prefixMatches[prefixCandidateCount].rank = wordRank(word);
+            prefixMatches[prefixCandidateCount].length = static_cast<uint8_t>(wordView(word).length);
+            prefixCandidateCount++;
+        }
+    } else {
+        // Keep the MAX_PREFIX_MATCHES most common words of the range in a
+        // max-heap on rank. An entry lists its words most common first, so
+        // the rest of an entry is skipped once one word fails to get in.
+        const int hi = rangeHi[digitCount];
+        for (int i = rangeLo[digitCount]; i < hi; i++) {
+            T9IndexEntry entry;
+            memcpy_P(&entry, &t9_index[i], sizeof(T9IndexEntry));
+            const uint32_t firstWord = static_cast<uint32_t>(entry.firstWord[0]) |
+                                       (static_cast<uint32_t>(entry.firstWord[1]) << 8) |
+                                       (static_cast<uint32_t>(entry.firstWord[2]) << 16);
+            const int count = entryWordCount(entry);
+            const uint8_t length = static_cast<uint8_t>(entry.lengthCount >> 4);
+            for (int w = 0; w < count; w++) {
+                PrefixMatch match = {firstWord + static_cast<uint32_t>(w), wordRank(firstWord + w), length};
+                if (prefixCandidateCount < MAX_PREFIX_MATCHES) {
+                    prefixMatches[prefixCandidateCount++] = match;
+                    std::push_heap(prefixMatches, prefixMatches + prefixCandidateCount, moreCommon);
+                } else if (match.rank < prefixMatches[0].rank) {
+                    std::pop_heap(prefixMatches, prefixMatches + prefixCandidateCount, moreCommon);
+                    prefixMatches[prefixCandidateCount - 1] = match;
+                    std::push_heap(prefixMatches, prefixMatches + prefixCandidateCount, moreCommon);
+                } else {
+                    break;
+                }
+            }
+        }
+        std::sort_heap(prefixMatches, prefixMatches + prefixCandidateCount, moreCommon);
     }
+    buildLengthBuckets();
+}
 
-    // Pass 2: longer keys that share the same prefix.
-    for (int i = firstIdx; i < (int)T9_INDEX_COUNT && prefixCandidateCount < MAX_PREFIX_MATCHES; i++) {
-        T9IndexEntry entry;
-        memcpy_P(&entry, &t9_index[i], sizeof(T9IndexEntry));
-        if (entry.key >= rangeEnd) break;
-        if (keyDigitCount(entry.key) <= digitCount) continue;
-        prefixMatches[prefixCandidateCount].indexPos = i;
-        prefixMatches[prefixCandidateCount].wordIdx = 0;
-        prefixCandidateCount++;
+// Group prefixMatches by length once per key press, so the editor cycling
+// through one length never rescans the list.
+void T9Predict::buildLengthBuckets() {
+    int counts[KEY_DIGITS + 1] = {};
+    for (int i = 0; i < prefixCandidateCount; i++) counts[prefixMatches[i].length]++;
+    lengthStart[0] = 0;
+    for (int len = 0; len < KEY_DIGITS; len++) {
+        lengthStart[len + 1] = static_cast<uint8_t>(lengthStart[len] + counts[len]);
+    }
+    // Filling in list order keeps each bucket most common first.
+    uint8_t fill[KEY_DIGITS];
+    memcpy(fill, lengthStart, sizeof(fill));
+    for (int i = 0; i < prefixCandidateCount; i++) {
+        const int len = prefixMatches[i].length;
+        bucketPos[i] = static_cast<uint8_t>(fill[len] - lengthStart[len]);
+        byLength[fill[len]++] = static_cast<uint8_t>(i);
     }
 }
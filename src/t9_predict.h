@@ -6,7 +6,8 @@
 // LOG_REF: 2026-04-22
 // Description: T9 predictive text lookup engine.
 //              Maps digit sequences to dictionary words via binary search.
-//              Prefix matching for incremental word suggestion.
+//              Prefix matching for incremental word suggestion,
+//              ranked by word frequency.
 //
 
 #ifndef T9_PREDICT_H
@@ -14,6 +15,13 @@
 
 #include <Arduino.h>
 
+// A dictionary word in flash. text is NUL-terminated and stays valid for
+// the life of the program, so views can be held while others are read.
+struct T9WordView {
+    const char* text;   // nullptr for an out-of-range candidate
+    int length;
+};
+
 class T9Predict {
 public:
     T9Predict();
@@ -32,16 +40,26 @@ public:
     int getDigitCount() const;
     bool hasInput() const;
 
-    // Exact-match candidates for current digit sequence
+    // Exact-match candidates for current digit sequence. Words are read
+    // in place from the dictionary; nothing is copied.
     int getCandidateCount() const;
+    T9WordView getCandidateView(int index) const;
     const char* getCandidate(int index) const;
     int getSelectedIndex() const;
     void nextCandidate();
     void prevCandidate();
     const char* getSelectedWord() const;
 
-    // Prefix-match candidates (words whose digit sequence starts with current digits)
+    // Prefix-match candidates (words whose digit sequence starts with current
+    // digits), most common first, at most MAX_PREFIX_MATCHES of them
+    struct PrefixMatch {
+        uint32_t word;      // Index into t9_word_starts
+        uint16_t rank;      // Frequency rank, 0 = most common
+        uint8_t length;     // Digit count, which is also the letter count
+    };
+    static const int MAX_PREFIX_MATCHES = 64;
     int getPrefixCandidateCount() const;
+    T9WordView getPrefixCandidateView(int index) const;
     const char* getPrefixCandidate(int index) const;
     const char* getSelectedPrefixWord() const;
     int getSelectedPrefixIndex() const;
@@ -62,18 +80,28 @@ private:
     int indexPos;           // Position in t9_index for exact match (-1 = none)
 
     // Prefix matching state
-    struct PrefixMatch { int indexPos; int wordIdx; };
-    static const int MAX_PREFIX_MATCHES = 64;
     PrefixMatch prefixMatches[MAX_PREFIX_MATCHES];
     int prefixCandidateCount;
     int prefixSelectedIdx;
 
+    // prefixMatches grouped by length: byLength[lengthStart[n] ..
+    // lengthStart[n + 1]) are the positions of the length-n matches, most
+    // common first, and bucketPos[i] is match i's place in its bucket.
+    uint8_t lengthStart[17];
+    uint8_t byLength[MAX_PREFIX_MATCHES];
+    uint8_t bucketPos[MAX_PREFIX_MATCHES];
+
+    // [rangeLo[n], rangeHi[n]) holds the index entries that start with the
+    // first n digits; entry 0 is the whole index.
+    int rangeLo[16];
+    int rangeHi[16];
+
+    void narrowRange();
     void updateCandidates();
     void updatePrefixCandidates();
-    int binarySearch(uint64_t key) const;
-    uint64_t digitsToKey() const;
-    static int keyDigitCount(uint64_t key);
-    static bool keyStartsWith(uint64_t key, uint64_t prefix, int prefixLen);
+    void buildLengthBuckets();
+    void stepPrefixCandidateForLength(int targetLen, int step);
+    uint64_t digitsToCode() const;
 };
 
 #endif
@@ -0,0 +1,262 @@
+// PROJECT: ESP32-S2-Mini handheld terminal
+// MODULE: src/text_buffer.cpp
+// STATUS: [Level 2 - Implementation]
+// TRUTH_LINK: TACTICAL_TODO TASK_2
+// LOG_REF: 2026-10-16
+// Description: Gap buffer holding the T9 editor document.
+
+#include "text_buffer.h"
+
+static const size_t kMinGapBytes = 256;
+
+static bool isUtf8Continuation(char c) {
+    return (static_cast<uint8_t>(c) & 0xC0) == 0x80;
+}
+
+TextBuffer::TextBuffer() : data(nullptr), capacity(0), gapStart(0), gapEnd(0) {}
+
+TextBuffer::~TextBuffer() {
+    free(data);
+}
+
+// ============================================================================
+// GAP MANAGEMENT
+// ============================================================================
+
+void TextBuffer::moveGap(size_t pos) {
+    if (pos > length()) pos = length();
+    const size_t gapLength = gapEnd - gapStart;
+    if (pos < gapStart) {
+        const size_t moved = gapStart - pos;
+        memmove(data + gapEnd - moved, data + pos, moved);
+    } else if (pos > gapStart) {
+        const size_t moved = pos - gapStart;
+        memmove(data + gapStart, data + gapEnd, moved);
+    }
+    gapStart = pos;
+    gapEnd = pos + gapLength;
+}
+
+// Grow by at least half the current size so repeated inserts stay
+// amortized O(1). The gap keeps its position.
+bool TextBuffer::ensureGap(size_t needed) {
+    const size_t gapLength = gapEnd - gapStart;
+    if (gapLength >= needed) return true;
+
+    size_t growth = capacity / 2;
+    if (growth < kMinGapBytes) growth = kMinGapBytes;
+    if (growth < needed - gapLength) growth = needed - gapLength;
+    const size_t newCapacity = capacity + growth;
+
+    char* grown = static_cast<char*>(realloc(data, newCapacity));
+    if (grown == nullptr) return false;
+
+    const size_t tailLength = capacity - gapEnd;
+    memmove(grown + newCapacity - tailLength, grown + gapEnd, tailLength);
+    data = grown;
+    gapEnd = newCapacity - tailLength;
+    capacity = newCapacity;
+    return true;
+}
+
+bool TextBuffer::reserve(size_t textLength) {
+    if (textLength <= length()) return true;
+    return ensureGap(textLength - length());
+}
+
+// ============================================================================
+// EDITING
+// ============================================================================
+
+// Grow first, so a failed allocation leaves the old text in place.
+bool TextBuffer::assign(const char* text, size_t textLength) {
+    if (!reserve(textLength)) return false;
+    clear();
+    return insert(0, text, textLength);
+}
+
+bool TextBuffer::assign(const String& text) {
+    return assign(text.c_str(), text.length());
+}
+
+void TextBuffer::clear() {
+    gapStart = 0;
+    gapEnd = capacity;
+}
+
+bool TextBuffer::insert(size_t pos, const char* text, size_t textLength) {
+    return replace(pos, 0, text, textLength);
+}
+
+bool TextBuffer::insert(size_t pos, const String& text) {
+    return replace(pos, 0, text.c_str(), text.length());
+}
+
+void TextBuffer::erase(size_t pos, size_t eraseLength) {
+    replace(pos, eraseLength, nullptr, 0);
+}
+
+bool TextBuffer::replace(size_t pos, size_t eraseLength, const char* text, size_t textLength) {
+    const size_t total = length();
+    if (pos > total) pos = total;
+    if (eraseLength > total - pos) eraseLength = total - pos;
+    if (textLength > eraseLength && !ensureGap(textLength - eraseLength)) {
+        return false;
+    }
+
+    // Erasing after the gap only widens it, so place the gap at pos.
+    moveGap(pos);
+    gapEnd += eraseLength;
+    if (textLength > 0) {
+        memcpy(data + gapStart, text, textLength);
+        gapStart += textLength;
+    }
+    return true;
+}
+
+// ============================================================================
+// RANGE ACCESS
+// ============================================================================
+
+size_t TextBuffer::copyRange(size_t start, size_t rangeLength, char* out) const {
+    const size_t total = length();
+    if (start > total) start = total;
+    if (rangeLength > total - start) rangeLength = total - start;
+
+    size_t copied = 0;
+    if (start < gapStart) {
+        copied = gapStart - start;
+        if (copied > rangeLength) copied = rangeLength;
+        memcpy(out, data + start, copied);
+    }
+    if (copied < rangeLength) {
+        const size_t physical = start + copied + (gapEnd - gapStart);
+        memcpy(out + copied, data + physical, rangeLength - copied);
+    }
+    return rangeLength;
+}
+
+String TextBuffer::substring(size_t start, size_t end) const {
+    const size_t total = length();
+    if (end > total) end = total;
+    if (start >= end) return String();
+
+    const char* direct = rangePtr(start, end - start);
+    if (direct != nullptr) {
+        return String(direct, static_cast<unsigned int>(end - start));
+    }
+
+    String result;
+    result.reserve(end - start);
+    for (size_t i = start; i < end; i++) {
+        result += charAt(i);
+    }
+    return result;
+}
+
+String TextBuffer::toString() const {
+    return substring(0, length());
+}
+
+bool TextBuffer::equals(const char* text, size_t textLength) const {
+    if (textLength != length()) return false;
+    if (textLength == 0) return true;
+    const size_t before = gapStart < textLength ? gapStart : textLength;
+    if (memcmp(data, text, before) != 0) return false;
+    return memcmp(data + gapEnd, text + before, textLength - before) == 0;
+}
+
+bool TextBuffer::equals(const String& text) const {
+    return equals(text.c_str(), text.length());
+}
+
+const char* TextBuffer::rangePtr(size_t start, size_t rangeLength) const {
+    if (data == nullptr) return "";
+    if (start + rangeLength <= gapStart) return data + start;
+    if (start >= gapStart) return data + start + (gapEnd - gapStart);
+    return nullptr;
+}
+
+// ============================================================================
+// SEARCH
+// ============================================================================
+
+int TextBuffer::indexOf(char c, size_t from) const {
+    const size_t total = length();
+    const size_t gapLength = gapEnd - gapStart;
+    if (from < gapStart) {
+        const void* hit = memchr(data + from, c, gapStart - from);
+        if (hit != nullptr) return static_cast<const char*>(hit) - data;
+        from = gapStart;
+    }
+    if (from < total) {
+        const void* hit = memchr(data + from + gapLength, c, total - from);
+        if (hit != nullptr) return static_cast<const char*>(hit) - data - gapLength;
+    }
+    return -1;
+}
+
+int TextBuffer::lastIndexOf(char c, size_t before) const {
+    if (before > length()) before = length();
+    while (before > 0) {
+        before--;
+        if (charAt(before) == c) return static_cast<int>(before);
+    }
+    return -1;
+}
+
+size_t TextBuffer::count(char c) const {
+    size_t found = 0;
+    for (size_t i = 0; i < gapStart; i++) {
+        if (data[i] == c) found++;
+    }
+    for (size_t i = gapEnd; i < capacity; i++) {
+        if (data[i] == c) found++;
+    }
+    return found;
+}
+
+size_t TextBuffer::commonPrefixLength(const TextBuffer& other) const {
+    const size_t limit = length() < other.length() ? length() : other.length();
+    size_t matched = 0;
+    while (matched < limit && charAt(matched) == other.charAt(matched)) matched++;
+    return matched;
+}
+
+size_t TextBuffer::commonSuffixLength(const TextBuffer& other, size_t limit) const {
+    const size_t ownLength = length();
+    const size_t otherLength = other.length();
+    if (limit > ownLength) limit = ownLength;
+    if (limit > otherLength) limit = otherLength;
+    size_t matched = 0;
+    while (matched < limit &&
+           charAt(ownLength - 1 - matched) == other.charAt(otherLength - 1 - matched)) {
+        matched++;
+    }
+    return matched;
+}
+
+// ============================================================================
+// UTF-8
+// ============================================================================
+
+bool TextBuffer::isUtf8Boundary(size_t pos) const {
+    if (pos == 0 || pos >= length()) return true;
+    return !isUtf8Continuation(charAt(pos));
+}
+
+size_t TextBuffer::nextUtf8Boundary(size_t pos) const {
+    const size_t total = length();
+    if (pos >= total) return total;
+    pos++;
+    while (pos < total && isUtf8Continuation(charAt(pos))) pos++;
+    return pos;
+}
+
+size_t TextBuffer::prevUtf8Boundary(size_t pos) const {
+    if (pos > length()) pos = length();
+    if (pos == 0) return 0;
+    pos--;
+    while (pos > 0 && isUtf8Continuation(charAt(pos))) pos--;
+    return pos;
+}
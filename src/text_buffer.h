@@ -0,0 +1,103 @@
+// PROJECT: ESP32-S2-Mini handheld terminal
+// MODULE: src/text_buffer.h
+// STATUS: [Level 2 - Implementation]
+// TRUTH_LINK: TACTICAL_TODO TASK_2
+// LOG_REF: 2026-10-16
+// Description: Gap buffer holding the T9 editor document.
+//              Text lives in one heap block with a movable hole at the
+//              edit point, so typing and deleting at the cursor only move
+//              the hole by the distance the cursor travelled.
+
+#ifndef TEXT_BUFFER_H
+#define TEXT_BUFFER_H
+
+#include <Arduino.h>
+
+class TextBuffer {
+public:
+    // Forward byte iterator over the logical text (skips the gap)
+    class Iterator {
+    public:
+        char operator*() const { return owner->charAt(pos); }
+        Iterator& operator++() { pos++; return *this; }
+        bool operator!=(const Iterator& other) const { return pos != other.pos; }
+        size_t position() const { return pos; }
+
+    private:
+        friend class TextBuffer;
+        Iterator(const TextBuffer* owner, size_t pos) : owner(owner), pos(pos) {}
+        const TextBuffer* owner;
+        size_t pos;
+    };
+
+    TextBuffer();
+    ~TextBuffer();
+    TextBuffer(const TextBuffer& other) = delete;
+    TextBuffer& operator=(const TextBuffer& other) = delete;
+
+    // Replace the whole text. False (text unchanged) if out of memory.
+    bool assign(const char* data, size_t length);
+    bool assign(const String& text);
+    void clear();
+
+    // Make room for a text of `length` bytes without moving it again.
+    bool reserve(size_t length);
+
+    size_t length() const { return capacity - (gapEnd - gapStart); }
+    bool isEmpty() const { return length() == 0; }
+    char charAt(size_t pos) const {
+        return (pos < gapStart) ? data[pos] : data[pos + (gapEnd - gapStart)];
+    }
+    char operator[](size_t pos) const { return charAt(pos); }
+
+    // Edits. Positions are clamped to the text. Insert and replace return
+    // false, leaving the text unchanged, if the buffer cannot grow.
+    bool insert(size_t pos, const char* text, size_t textLength);
+    bool insert(size_t pos, const String& text);
+    void erase(size_t pos, size_t eraseLength);
+    bool replace(size_t pos, size_t eraseLength, const char* text, size_t textLength);
+
+    // Range access
+    String substring(size_t start, size_t end) const;
+    size_t copyRange(size_t start, size_t rangeLength, char* out) const;
+    String toString() const;
+    bool equals(const char* text, size_t textLength) const;
+    bool equals(const String& text) const;
+    // Pointer to [start, start + rangeLength) if it does not straddle the
+    // gap, else nullptr. Valid until the next edit.
+    const char* rangePtr(size_t start, size_t rangeLength) const;
+
+    // Search
+    int indexOf(char c, size_t from = 0) const;
+    int lastIndexOf(char c, size_t before) const;
+    size_t count(char c) const;
+
+    // Bytes shared with other at the start, and at the end (the suffix is
+    // capped at `limit`, so a caller can keep it clear of the prefix).
+    size_t commonPrefixLength(const TextBuffer& other) const;
+    size_t commonSuffixLength(const TextBuffer& other, size_t limit) const;
+
+    Iterator begin() const { return Iterator(this, 0); }
+    Iterator end() const { return Iterator(this, length()); }
+    Iterator iteratorAt(size_t pos) const { return Iterator(this, pos < length() ? pos : length()); }
+
+    // UTF-8 boundaries: a position is a boundary unless it points at a
+    // continuation byte. next/prev step one code point, clamped to the text.
+    bool isUtf8Boundary(size_t pos) const;
+    size_t nextUtf8Boundary(size_t pos) const;
+    size_t prevUtf8Boundary(size_t pos) const;
+
+    // Heap bytes held by the buffer
+    size_t getMemoryUsage() const { return capacity; }
+
+private:
+    char* data;          // capacity bytes; [gapStart, gapEnd) is unused
+    size_t capacity;
+    size_t gapStart;
+    size_t gapEnd;
+
+    void moveGap(size_t pos);
+    bool ensureGap(size_t needed);
+};
+
+#endif
@@ -0,0 +1,95 @@
+// PROJECT: ESP32-S2-Mini handheld terminal
+// MODULE: src/text_wrap.cpp
+// STATUS: [Level 2 - Implementation]
+// TRUTH_LINK: TRUTH_HARDWARE.md Section 1
+// LOG_REF: 2026-10-16
+
+#include "text_wrap.h"
+#include "glyph_cache.h"
+#include "gui.h"
+
+namespace TextWrap {
+
+// --------------------------------------------------------------------------
+// GLYPH MEASUREMENT
+// --------------------------------------------------------------------------
+
+static int utf8SequenceLength(uint8_t lead) {
+    if (lead < 0xC0) return 1;   // ASCII or stray continuation byte
+    if (lead < 0xE0) return 2;
+    if (lead < 0xF0) return 3;
+    return 4;
+}
+
+// Advance and extent of the glyph at text, and its byte count.
+static int measureGlyph(const GlyphCache::WidthTable* table, const char* text, int remaining,
+                        int& advance, int& extent) {
+    const uint8_t lead = static_cast<uint8_t>(text[0]);
+    if (table != nullptr && lead >= GlyphCache::FIRST_GLYPH && lead <= GlyphCache::LAST_GLYPH) {
+        advance = table->advance[lead - GlyphCache::FIRST_GLYPH];
+        extent = table->extent[lead - GlyphCache::FIRST_GLYPH];
+        return 1;
+    }
+    if (lead < GlyphCache::FIRST_GLYPH) {
+        advance = 0;   // Control bytes have no glyph in the system fonts
+        extent = 0;
+        return 1;
+    }
+
+    int bytes = utf8SequenceLength(lead);
+    if (bytes > remaining) bytes = remaining;
+    char glyph[5];
+    memcpy(glyph, text, bytes);
+    glyph[bytes] = '\0';
+    advance = GUI::getTextWidth(glyph);
+    extent = advance;
+    return bytes;
+}
+
+// --------------------------------------------------------------------------
+// PUBLIC API
+// --------------------------------------------------------------------------
+
+bool isBreakChar(char c) {
+    unsigned char uc = static_cast<unsigned char>(c);
+    if (uc <= ' ') return true;
+    if ((uc >= '0' && uc <= '9') ||
+        (uc >= 'A' && uc <= 'Z') ||
+        (uc >= 'a' && uc <= 'z') ||
+        uc == '_') {
+        return false;
+    }
+    if (uc >= 0x80) return false;
+    return true;
+}
+
+int fitLength(const uint8_t* font, const char* text, int length, int maxWidth) {
+    if (length <= 0) return 0;
+    const GlyphCache::WidthTable* table = GlyphCache::getWidthTable(font);
+
+    // A prefix is as wide as the advances before its last glyph plus that
+    // glyph's extent, the same rule u8g2_string_width() applies.
+    int advanceSum = 0;
+    int fitLen = 0;
+    int lastBreakLen = -1;
+    int firstGlyphLen = 0;
+    while (fitLen < length) {
+        int advance = 0;
+        int extent = 0;
+        const int bytes = measureGlyph(table, text + fitLen, length - fitLen, advance, extent);
+        if (firstGlyphLen == 0) firstGlyphLen = bytes;
+        if (advanceSum + extent > maxWidth) break;
+
+        advanceSum += advance;
+        fitLen += bytes;
+        if (isBreakChar(text[fitLen - 1])) {
+            lastBreakLen = fitLen;
+        }
+    }
+
+    if (fitLen == 0) return firstGlyphLen;
+    if (fitLen < length && lastBreakLen > 0) return lastBreakLen;
+    return fitLen;
+}
+
+} // namespace TextWrap
@@ -0,0 +1,32 @@
+// PROJECT: ESP32-S2-Mini handheld terminal
+// MODULE: src/text_wrap.h
+// STATUS: [Level 2 - Implementation]
+// TRUTH_LINK: TRUTH_HARDWARE.md Section 1
+// LOG_REF: 2026-10-16
+
+#ifndef TEXT_WRAP_H
+#define TEXT_WRAP_H
+
+#include <Arduino.h>
+
+// Single-pass word wrap over a byte range.
+//
+// Each glyph is measured once from the glyph cache width table (u8g2 is only
+// asked for non-ASCII characters and uncached fonts), and the last break
+// opportunity is remembered while walking, so laying out a line costs one
+// table lookup per byte instead of re-measuring every growing prefix.
+namespace TextWrap {
+
+// True if a line may break after c (whitespace and ASCII punctuation).
+bool isBreakChar(char c);
+
+// Bytes of text[0..length) that go on the first visual line of maxWidth
+// pixels in font, which must also be the current u8g2 font. Breaks after the
+// last break character when the range continues past the line, never splits
+// a UTF-8 sequence, and always returns at least one character for a
+// non-empty range.
+int fitLength(const uint8_t* font, const char* text, int length, int maxWidth);
+
+} // namespace TextWrap
+
+#endif
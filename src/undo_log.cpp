@@ -0,0 +1,231 @@
+// PROJECT: ESP32-S2-Mini handheld terminal
+// MODULE: src/undo_log.cpp
+// STATUS: [Level 2 - Implementation]
+// TRUTH_LINK: TACTICAL_TODO TASK_2
+// LOG_REF: 2026-10-16
+// Description: Delta undo/redo log for the T9 editor.
+
+#include "undo_log.h"
+
+// A step is a Header followed by its deleted bytes, then its inserted bytes,
+// stored contiguously in the arena. Steps are placed in order, wrapping to
+// the arena start when the tail is too short, so the live region is always
+// one circular run from the oldest step to head.
+
+static bool isWordSpace(char c) {
+    return c == ' ' || c == '\n' || c == '\t';
+}
+
+UndoLog::UndoLog(size_t arenaBytes, int maxSteps)
+    : arena(nullptr), arenaSize(arenaBytes), slots(nullptr), maxSteps(maxSteps),
+      first(0), count(0), current(0), head(0) {}
+
+UndoLog::~UndoLog() {
+    clear();
+}
+
+// ============================================================================
+// ARENA
+// ============================================================================
+
+bool UndoLog::ensureStorage() {
+    if (arena != nullptr) return true;
+    arena = static_cast<char*>(malloc(arenaSize));
+    slots = static_cast<Slot*>(malloc(sizeof(Slot) * maxSteps));
+    if (arena == nullptr || slots == nullptr) {
+        clear();
+        return false;
+    }
+    return true;
+}
+
+void UndoLog::clear() {
+    free(arena);
+    free(slots);
+    arena = nullptr;
+    slots = nullptr;
+    first = 0;
+    count = 0;
+    current = 0;
+    head = 0;
+}
+
+size_t UndoLog::getMemoryUsage() const {
+    return (arena != nullptr) ? arenaSize + sizeof(Slot) * maxSteps : 0;
+}
+
+// Headers are copied out and in because arena offsets are not aligned.
+UndoLog::Header UndoLog::readHeader(int index) const {
+    Header header;
+    memcpy(&header, arena + slotAt(index).offset, sizeof(Header));
+    return header;
+}
+
+void UndoLog::writeHeader(int index, const Header& header) {
+    memcpy(arena + slotAt(index).offset, &header, sizeof(Header));
+}
+
+void UndoLog::dropRedo() {
+    count = current;
+    head = (count > 0) ? slotAt(count - 1).offset + slotAt(count - 1).size : 0;
+}
+
+void UndoLog::dropOldest() {
+    first = (first + 1) % maxSteps;
+    count--;
+    if (current > 0) current--;
+    if (count == 0) head = 0;
+}
+
+bool UndoLog::isFree(size_t start, size_t size) const {
+    if (start + size > arenaSize) return false;
+    if (count == 0) return true;
+    const size_t oldest = slotAt(0).offset;
+    if (oldest < head) {
+        return start >= head || start + size <= oldest;
+    }
+    return start >= head && start + size <= oldest;
+}
+
+bool UndoLog::allocate(size_t size, size_t& offset) {
+    if (size > arenaSize) return false;
+    if (count == maxSteps) dropOldest();
+    while (true) {
+        if (count == 0) {
+            head = 0;
+            offset = 0;
+            break;
+        }
+        offset = (head + size <= arenaSize) ? head : 0;
+        if (isFree(offset, size)) break;
+        dropOldest();
+    }
+
+    Slot& slot = slots[(first + count) % maxSteps];
+    slot.offset = static_cast<uint32_t>(offset);
+    slot.size = static_cast<uint32_t>(size);
+    count++;
+    head = offset + size;
+    return true;
+}
+
+// ============================================================================
+// RECORDING
+// ============================================================================
+
+bool UndoLog::tryExtendTyped(int position, const char* inserted, int insertedLength) {
+    if (count == 0 || insertedLength <= 0) return false;
+    Header last = readHeader(count - 1);
+    if (!last.typed || last.deletedLength != 0 || last.insertedLength == 0) return false;
+    if (last.position + last.insertedLength != position) return false;
+
+    // A new word after whitespace starts a new undo step.
+    const char previous = arena[head - 1];
+    if (isWordSpace(previous) && !isWordSpace(inserted[0])) return false;
+    if (!isFree(head, insertedLength)) return false;
+
+    memcpy(arena + head, inserted, insertedLength);
+    head += insertedLength;
+    slotAt(count - 1).size += insertedLength;
+    last.insertedLength += insertedLength;
+    writeHeader(count - 1, last);
+    return true;
+}
+
+bool UndoLog::record(const TextBuffer& text, int position, int deletedLength,
+                     const char* inserted, int insertedLength, const State& before, bool typed) {
+    if (!ensureStorage()) return false;
+    dropRedo();
+    if (typed && deletedLength == 0 && tryExtendTyped(position, inserted, insertedLength)) {
+        return true;
+    }
+
+    size_t offset = 0;
+    if (!allocate(sizeof(Header) + deletedLength + insertedLength, offset)) {
+        clear();
+        return false;
+    }
+
+    Header header;
+    header.position = position;
+    header.deletedLength = deletedLength;
+    header.insertedLength = insertedLength;
+    header.saved = before;
+    header.typed = typed ? 1 : 0;
+    writeHeader(count - 1, header);
+    char* payload = arena + offset + sizeof(Header);
+    text.copyRange(position, deletedLength, payload);
+    memcpy(payload + deletedLength, inserted, insertedLength);
+    current = count;
+    return true;
+}
+
+bool UndoLog::recordUndone(const TextBuffer& text, int position, int replacedLength,
+                           const char* replacement, int replacementLength, const State& state) {
+    if (!ensureStorage()) return false;
+    dropRedo();
+
+    size_t offset = 0;
+    if (!allocate(sizeof(Header) + replacementLength + replacedLength, offset)) {
+        clear();
+        return false;
+    }
+
+    // Stored as the forward edit replacement -> current bytes, not yet redone.
+    Header header;
+    header.position = position;
+    header.deletedLength = replacementLength;
+    header.insertedLength = replacedLength;
+    header.saved = state;
+    header.typed = 0;
+    writeHeader(count - 1, header);
+    char* payload = arena + offset + sizeof(Header);
+    memcpy(payload, replacement, replacementLength);
+    text.copyRange(position, replacedLength, payload + replacementLength);
+    current = count - 1;
+    return true;
+}
+
+// ============================================================================
+// UNDO / REDO
+// ============================================================================
+
+bool UndoLog::undo(TextBuffer& text, State& state, Change& change) {
+    if (!canUndo()) return false;
+    const int index = current - 1;
+    Header header = readHeader(index);
+    const char* deleted = arena + slotAt(index).offset + sizeof(Header);
+    if (!text.reserve(text.length() - header.insertedLength + header.deletedLength)) return false;
+
+    text.replace(header.position, header.insertedLength, deleted, header.deletedLength);
+    const State restored = header.saved;
+    header.saved = state;
+    state = restored;
+    writeHeader(index, header);
+    current--;
+
+    change.position = header.position;
+    change.removedLength = header.insertedLength;
+    change.insertedLength = header.deletedLength;
+    return true;
+}
+
+bool UndoLog::redo(TextBuffer& text, State& state, Change& change) {
+    if (!canRedo()) return false;
+    const int index = current;
+    Header header = readHeader(index);
+    const char* inserted = arena + slotAt(index).offset + sizeof(Header) + header.deletedLength;
+    if (!text.reserve(text.length() - header.deletedLength + header.insertedLength)) return false;
+
+    text.replace(header.position, header.deletedLength, inserted, header.insertedLength);
+    const State restored = header.saved;
+    header.saved = state;
+    state = restored;
+    writeHeader(index, header);
+    current++;
+
+    change.position = header.position;
+    change.removedLength = header.deletedLength;
+    change.insertedLength = header.insertedLength;
+    return true;
+}
@@ -0,0 +1,106 @@
+// PROJECT: ESP32-S2-Mini handheld terminal
+// MODULE: src/undo_log.h
+// STATUS: [Level 2 - Implementation]
+// TRUTH_LINK: TACTICAL_TODO TASK_2
+// LOG_REF: 2026-10-16
+// Description: Delta undo/redo log for the T9 editor.
+//              Each step stores only the replaced and inserted bytes of
+//              one edit, packed into a fixed ring arena. When the arena
+//              or the step index is full the oldest steps are dropped.
+
+#ifndef UNDO_LOG_H
+#define UNDO_LOG_H
+
+#include <Arduino.h>
+#include "text_buffer.h"
+
+class UndoLog {
+public:
+    // Editor state restored together with the text. Undo and redo swap it
+    // with the caller's current state.
+    struct State {
+        int32_t cursorPos;
+        uint32_t snapshotId;     // Caller-defined (history snapshot in use)
+        int32_t selectionAnchorPos;
+        int32_t selectionFocusPos;
+        bool selectionMode;
+    };
+
+    // Range of the text touched by an undo or redo
+    struct Change {
+        int position;
+        int removedLength;
+        int insertedLength;
+    };
+
+    UndoLog(size_t arenaBytes, int maxSteps);
+    ~UndoLog();
+    UndoLog(const UndoLog& other) = delete;
+    UndoLog& operator=(const UndoLog& other) = delete;
+
+    // Record replacing deletedLength bytes of text at position with
+    // inserted. Call before applying the edit. Drops all redo steps. A
+    // typed insert that continues the previous typed insert in the same
+    // word extends that step instead of adding one. Returns false if the
+    // step cannot be stored; the log is then emptied, since older steps
+    // no longer apply.
+    bool record(const TextBuffer& text, int position, int deletedLength,
+                const char* inserted, int insertedLength, const State& before, bool typed);
+
+    // Record that text[position, position + replacedLength) is about to be
+    // replaced by an undo that bypasses the log (e.g. a history snapshot).
+    // The step is stored as already undone, so redo puts the current bytes
+    // and state back. Drops all redo steps first.
+    bool recordUndone(const TextBuffer& text, int position, int replacedLength,
+                      const char* replacement, int replacementLength, const State& state);
+
+    bool canUndo() const { return current > 0; }
+    bool canRedo() const { return current < count; }
+
+    // Apply the inverse (undo) or the edit again (redo) to text and swap
+    // state. False, with nothing changed, if there is no step or the text
+    // cannot grow.
+    bool undo(TextBuffer& text, State& state, Change& change);
+    bool redo(TextBuffer& text, State& state, Change& change);
+
+    // Forget all steps and free the arena.
+    void clear();
+
+    int getStepCount() const { return count; }
+    size_t getMemoryUsage() const;
+
+private:
+    struct Header {
+        int32_t position;
+        int32_t deletedLength;
+        int32_t insertedLength;
+        State saved;
+        uint8_t typed;
+    };
+
+    struct Slot {
+        uint32_t offset;
+        uint32_t size;
+    };
+
+    char* arena;
+    size_t arenaSize;
+    Slot* slots;
+    int maxSteps;
+    int first;       // Oldest step in slots
+    int count;       // Steps stored
+    int current;     // Steps that can be undone; the rest can be redone
+    size_t head;     // Arena offset just past the newest step
+
+    bool ensureStorage();
+    Slot& slotAt(int index) const { return slots[(first + index) % maxSteps]; }
+    Header readHeader(int index) const;
+    void writeHeader(int index, const Header& header);
+    void dropRedo();
+    void dropOldest();
+    bool isFree(size_t start, size_t size) const;
+    bool allocate(size_t size, size_t& offset);
+    bool tryExtendTyped(int position, const char* inserted, int insertedLength);
+};
+
+#endif